@@ -0,0 +1,1504 @@
+//
+//  MathBench.cpp
+//
+#include "Math/Bounds.h"
+#include "Math/FastMath.h"
+#include "Math/LCP.h"
+#include "Math/Matrix.h"
+#include "Math/Quat.h"
+#include "Math/Transforms.h"
+#include "Math/Vector.h"
+#include <algorithm>
+#include <chrono>
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+/*
+========================================================================================================
+
+math_bench
+
+Times the hot operations of src/Math over arrays of deterministic random inputs and checks
+every result against the same math done in double precision.  Throughput is in operations
+per nanosecond, the error columns are:
+
+	max ulp		largest error in units in the last place of the result's magnitude, the largest
+				component of the double result, so a component that cancels down to almost zero
+				is measured against the size of the whole result instead of blowing up
+	max rel		largest error divided by that magnitude
+	mean rel	average of the same over every result
+
+Build with -DMATH_FORCE_SCALAR=ON for the scalar backend and compare the two runs.  The
+results themselves can be compared too, --dump writes every result of the run and --compare
+checks this run against a dump from the other backend, failing when they disagree by more
+than the case allows.  ctest runs that against math_bench_scalar.
+
+	math_bench [--case name] [--json file|-] [--label text] [--dump file] [--compare file]
+
+========================================================================================================
+*/
+
+static const int NUM_INPUTS = 4096;
+static const int NUM_TRIALS = 7;
+static const double MIN_TRIAL_NS = 2.0e6;
+
+/*
+====================================================
+benchRandom_t
+
+Small deterministic generator, so every run sees the exact same inputs
+====================================================
+*/
+struct benchRandom_t {
+	unsigned int state;
+
+	explicit benchRandom_t( const unsigned int seed ) : state( seed ) {}
+
+	float Float( const float lo, const float hi ) {
+		state = state * 1664525u + 1013904223u;
+		const float t = float( state >> 8 ) / float( 1 << 24 );
+		return lo + ( hi - lo ) * t;
+	}
+
+	Vec3 Vector( const float lo, const float hi ) {
+		return Vec3( Float( lo, hi ), Float( lo, hi ), Float( lo, hi ) );
+	}
+
+	Quat Orientation() {
+		Quat q( Float( -1, 1 ), Float( -1, 1 ), Float( -1, 1 ), Float( -1, 1 ) );
+		q.Normalize();
+		return q;
+	}
+};
+
+/*
+====================================================
+errorStats_t
+====================================================
+*/
+struct errorStats_t {
+	double maxUlp;
+	double maxRel;
+	double sumRel;
+	int count;
+
+	// Every result as it came out, for --dump and --compare
+	std::vector< float > values;
+	std::vector< int > sizes;
+	std::vector< double > magnitudes;
+
+	errorStats_t() : maxUlp( 0 ), maxRel( 0 ), sumRel( 0 ), count( 0 ) {}
+
+	// One result of num components
+	void Add( const float * result, const double * reference, const int num ) {
+		double magnitude = 0.0;
+		for ( int i = 0; i < num; i++ ) {
+			magnitude = std::max( magnitude, fabs( reference[ i ] ) );
+		}
+		magnitude = std::max( magnitude, (double)FLT_MIN );
+
+		const float mag = (float)magnitude;
+		const double ulp = (double)nextafterf( mag, FLT_MAX ) - (double)mag;
+
+		double error = 0.0;
+		for ( int i = 0; i < num; i++ ) {
+			error = std::max( error, fabs( (double)result[ i ] - reference[ i ] ) );
+		}
+
+		const double rel = error / magnitude;
+		maxUlp = std::max( maxUlp, error / ulp );
+		maxRel = std::max( maxRel, rel );
+		sumRel += rel;
+		count++;
+
+		values.insert( values.end(), result, result + num );
+		sizes.push_back( num );
+		magnitudes.push_back( magnitude );
+	}
+
+	// A yes / no result, a wrong answer counts as a relative error of 1
+	void AddBool( const bool result, const bool reference ) {
+		const double rel = ( result == reference ) ? 0.0 : 1.0;
+		maxRel = std::max( maxRel, rel );
+		sumRel += rel;
+		count++;
+
+		values.push_back( result ? 1.0f : 0.0f );
+		sizes.push_back( 1 );
+		magnitudes.push_back( 1.0 );
+	}
+
+	double MeanRel() const { return ( count > 0 ) ? sumRel / count : 0.0; }
+};
+
+/*
+====================================================
+caseResult_t
+====================================================
+*/
+struct caseResult_t {
+	const char * name;
+	double opsPerNS;
+	errorStats_t error;
+};
+
+/*
+====================================================
+benchInputs_t
+====================================================
+*/
+struct benchInputs_t {
+	std::vector< Vec3 > vecA;
+	std::vector< Vec3 > vecB;
+	std::vector< Vec4 > vec4s;
+	std::vector< Quat > quatA;
+	std::vector< Quat > quatB;
+	std::vector< Vec3 > scales;
+	std::vector< Mat4 > general;	// random entries with a strong diagonal, well conditioned
+	std::vector< Mat4 > affine;		// rotation, scale and translation
+	std::vector< Mat4 > orthonormal;	// rotation and translation
+	std::vector< Bounds > bounds;
+
+	void Build() {
+		benchRandom_t random( 7 );
+
+		vecA.resize( NUM_INPUTS );
+		vecB.resize( NUM_INPUTS );
+		vec4s.resize( NUM_INPUTS );
+		quatA.resize( NUM_INPUTS );
+		quatB.resize( NUM_INPUTS );
+		scales.resize( NUM_INPUTS );
+		general.resize( NUM_INPUTS );
+		affine.resize( NUM_INPUTS );
+		orthonormal.resize( NUM_INPUTS );
+		bounds.resize( NUM_INPUTS );
+
+		for ( int i = 0; i < NUM_INPUTS; i++ ) {
+			vecA[ i ] = random.Vector( -10, 10 );
+			vecB[ i ] = random.Vector( -10, 10 );
+			vec4s[ i ] = Vec4( random.Float( -10, 10 ), random.Float( -10, 10 ), random.Float( -10, 10 ), 1.0f );
+			quatA[ i ] = random.Orientation();
+			quatB[ i ] = random.Orientation();
+			scales[ i ] = random.Vector( 0.5f, 2.0f );
+
+			for ( int r = 0; r < 4; r++ ) {
+				for ( int c = 0; c < 4; c++ ) {
+					general[ i ].rows[ r ][ c ] = random.Float( -1, 1 ) + ( ( r == c ) ? 4.0f : 0.0f );
+				}
+			}
+
+			const Vec3 fwd = quatA[ i ].RotatePoint( Vec3( 1, 0, 0 ) );
+			const Vec3 up = quatA[ i ].RotatePoint( Vec3( 0, 0, 1 ) );
+			orthonormal[ i ].Orient( vecA[ i ], fwd, up );
+			affine[ i ] = orthonormal[ i ] * Mat4::Scaling( scales[ i ] );
+
+			const Vec3 center = random.Vector( -50, 50 );
+			const Vec3 halfSize = random.Vector( 0.1f, 5.0f );
+			bounds[ i ].mins = center - halfSize;
+			bounds[ i ].maxs = center + halfSize;
+		}
+	}
+};
+
+static volatile float g_sink;
+
+/*
+====================================================
+TimeOps
+
+Runs func, which does opsPerCall operations, until a trial takes long
+enough to time, and returns the operations per ns of the fastest trial
+====================================================
+*/
+template < typename func_t >
+static double TimeOps( func_t func, const int opsPerCall ) {
+	typedef std::chrono::high_resolution_clock clock_t;
+
+	int calls = 1;
+	while ( true ) {
+		const clock_t::time_point start = clock_t::now();
+		for ( int i = 0; i < calls; i++ ) {
+			func();
+		}
+		const double ns = (double)std::chrono::duration_cast< std::chrono::nanoseconds >( clock_t::now() - start ).count();
+		if ( ns >= MIN_TRIAL_NS || calls >= ( 1 << 20 ) ) {
+			break;
+		}
+		calls *= 2;
+	}
+
+	double bestNS = DBL_MAX;
+	for ( int trial = 0; trial < NUM_TRIALS; trial++ ) {
+		const clock_t::time_point start = clock_t::now();
+		for ( int i = 0; i < calls; i++ ) {
+			func();
+		}
+		const double ns = (double)std::chrono::duration_cast< std::chrono::nanoseconds >( clock_t::now() - start ).count();
+		bestNS = std::min( bestNS, ns );
+	}
+	return (double)calls * opsPerCall / std::max( bestNS, 1.0 );
+}
+
+/*
+========================================================================================================
+
+Double precision references
+
+========================================================================================================
+*/
+
+struct dvec3_t {
+	double x, y, z;
+};
+
+struct dquat_t {
+	double w, x, y, z;
+};
+
+static dvec3_t ToDouble( const Vec3 & v ) {
+	dvec3_t r = { v.x, v.y, v.z };
+	return r;
+}
+
+static dquat_t ToDouble( const Quat & q ) {
+	dquat_t r = { q.w, q.x, q.y, q.z };
+	return r;
+}
+
+static dquat_t Mul( const dquat_t & a, const dquat_t & b ) {
+	dquat_t r;
+	r.w = a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z;
+	r.x = a.x * b.w + a.w * b.x + a.y * b.z - a.z * b.y;
+	r.y = a.y * b.w + a.w * b.y + a.z * b.x - a.x * b.z;
+	r.z = a.z * b.w + a.w * b.z + a.x * b.y - a.y * b.x;
+	return r;
+}
+
+static dvec3_t Rotate( const dquat_t & q, const dvec3_t & v ) {
+	const double invLengthSqr = 1.0 / ( q.w * q.w + q.x * q.x + q.y * q.y + q.z * q.z );
+	const dquat_t inv = { q.w * invLengthSqr, -q.x * invLengthSqr, -q.y * invLengthSqr, -q.z * invLengthSqr };
+	const dquat_t p = { 0.0, v.x, v.y, v.z };
+	const dquat_t r = Mul( Mul( q, p ), inv );
+	dvec3_t out = { r.x, r.y, r.z };
+	return out;
+}
+
+// Row major 4x4, rows[ r * 4 + c ]
+static void ToDouble( const Mat4 & m, double * out ) {
+	for ( int r = 0; r < 4; r++ ) {
+		for ( int c = 0; c < 4; c++ ) {
+			out[ r * 4 + c ] = m.rows[ r ][ c ];
+		}
+	}
+}
+
+// Gauss-Jordan with partial pivoting
+static void InverseDouble( const double * m, double * inv ) {
+	double a[ 4 ][ 8 ];
+	for ( int r = 0; r < 4; r++ ) {
+		for ( int c = 0; c < 4; c++ ) {
+			a[ r ][ c ] = m[ r * 4 + c ];
+			a[ r ][ c + 4 ] = ( r == c ) ? 1.0 : 0.0;
+		}
+	}
+
+	for ( int c = 0; c < 4; c++ ) {
+		int pivot = c;
+		for ( int r = c + 1; r < 4; r++ ) {
+			if ( fabs( a[ r ][ c ] ) > fabs( a[ pivot ][ c ] ) ) {
+				pivot = r;
+			}
+		}
+		for ( int k = 0; k < 8; k++ ) {
+			std::swap( a[ c ][ k ], a[ pivot ][ k ] );
+		}
+
+		const double invPivot = 1.0 / a[ c ][ c ];
+		for ( int k = 0; k < 8; k++ ) {
+			a[ c ][ k ] *= invPivot;
+		}
+		for ( int r = 0; r < 4; r++ ) {
+			if ( r == c ) {
+				continue;
+			}
+			const double s = a[ r ][ c ];
+			for ( int k = 0; k < 8; k++ ) {
+				a[ r ][ k ] -= s * a[ c ][ k ];
+			}
+		}
+	}
+
+	for ( int r = 0; r < 4; r++ ) {
+		for ( int c = 0; c < 4; c++ ) {
+			inv[ r * 4 + c ] = a[ r ][ c + 4 ];
+		}
+	}
+}
+
+/*
+========================================================================================================
+
+Cases
+
+========================================================================================================
+*/
+
+static caseResult_t Case_Vec3Dot( const benchInputs_t & in ) {
+	caseResult_t result;
+	result.name = "vec3_dot";
+
+	std::vector< float > out( NUM_INPUTS );
+	result.opsPerNS = TimeOps( [ & ]() {
+		for ( int i = 0; i < NUM_INPUTS; i++ ) {
+			out[ i ] = in.vecA[ i ].Dot( in.vecB[ i ] );
+		}
+		g_sink = out[ NUM_INPUTS - 1 ];
+	}, NUM_INPUTS );
+
+	for ( int i = 0; i < NUM_INPUTS; i++ ) {
+		const dvec3_t a = ToDouble( in.vecA[ i ] );
+		const dvec3_t b = ToDouble( in.vecB[ i ] );
+		const double terms[ 3 ] = { a.x * b.x, a.y * b.y, a.z * b.z };
+		const double magnitude = std::max( std::max( fabs( terms[ 0 ] ), fabs( terms[ 1 ] ) ), fabs( terms[ 2 ] ) );
+
+		// Second component carries the size of the terms, the sum can cancel to zero
+		const float res[ 2 ] = { out[ i ], (float)magnitude };
+		const double ref[ 2 ] = { terms[ 0 ] + terms[ 1 ] + terms[ 2 ], magnitude };
+		result.error.Add( res, ref, 2 );
+	}
+	return result;
+}
+
+static caseResult_t Case_Vec3Cross( const benchInputs_t & in ) {
+	caseResult_t result;
+	result.name = "vec3_cross";
+
+	std::vector< Vec3 > out( NUM_INPUTS );
+	result.opsPerNS = TimeOps( [ & ]() {
+		for ( int i = 0; i < NUM_INPUTS; i++ ) {
+			out[ i ] = in.vecA[ i ].Cross( in.vecB[ i ] );
+		}
+		g_sink = out[ NUM_INPUTS - 1 ].x;
+	}, NUM_INPUTS );
+
+	for ( int i = 0; i < NUM_INPUTS; i++ ) {
+		const dvec3_t a = ToDouble( in.vecA[ i ] );
+		const dvec3_t b = ToDouble( in.vecB[ i ] );
+		const double terms[ 6 ] = { a.y * b.z, a.z * b.y, a.z * b.x, a.x * b.z, a.x * b.y, a.y * b.x };
+		double magnitude = 0.0;
+		for ( int k = 0; k < 6; k++ ) {
+			magnitude = std::max( magnitude, fabs( terms[ k ] ) );
+		}
+
+		// Fourth component carries the size of the terms, the differences can cancel to zero
+		const float res[ 4 ] = { out[ i ].x, out[ i ].y, out[ i ].z, (float)magnitude };
+		const double ref[ 4 ] = { terms[ 0 ] - terms[ 1 ], terms[ 2 ] - terms[ 3 ], terms[ 4 ] - terms[ 5 ], magnitude };
+		result.error.Add( res, ref, 4 );
+	}
+	return result;
+}
+
+static caseResult_t Case_Vec3Normalize( const benchInputs_t & in ) {
+	caseResult_t result;
+	result.name = "vec3_normalize";
+
+	std::vector< Vec3 > out( NUM_INPUTS );
+	result.opsPerNS = TimeOps( [ & ]() {
+		for ( int i = 0; i < NUM_INPUTS; i++ ) {
+			out[ i ] = in.vecA[ i ];
+			out[ i ].Normalize();
+		}
+		g_sink = out[ NUM_INPUTS - 1 ].x;
+	}, NUM_INPUTS );
+
+	for ( int i = 0; i < NUM_INPUTS; i++ ) {
+		const dvec3_t a = ToDouble( in.vecA[ i ] );
+		const double length = sqrt( a.x * a.x + a.y * a.y + a.z * a.z );
+		const double ref[ 3 ] = { a.x / length, a.y / length, a.z / length };
+		result.error.Add( out[ i ].ToPtr(), ref, 3 );
+	}
+	return result;
+}
+
+template < mathAccuracy_t accuracy >
+static caseResult_t Case_Vec3NormalizeAccuracy( const benchInputs_t & in ) {
+	caseResult_t result;
+	result.name = ( accuracy == MATH_ACCURACY_FAST ) ? "vec3_normalize_fast" : "vec3_normalize_precise";
+
+	std::vector< Vec3 > out( NUM_INPUTS );
+	result.opsPerNS = TimeOps( [ & ]() {
+		for ( int i = 0; i < NUM_INPUTS; i++ ) {
+			out[ i ] = in.vecA[ i ];
+			out[ i ].Normalize< accuracy >();
+		}
+		g_sink = out[ NUM_INPUTS - 1 ].x;
+	}, NUM_INPUTS );
+
+	for ( int i = 0; i < NUM_INPUTS; i++ ) {
+		const dvec3_t a = ToDouble( in.vecA[ i ] );
+		const double length = sqrt( a.x * a.x + a.y * a.y + a.z * a.z );
+		const double ref[ 3 ] = { a.x / length, a.y / length, a.z / length };
+		result.error.Add( out[ i ].ToPtr(), ref, 3 );
+	}
+	return result;
+}
+
+template < mathAccuracy_t accuracy >
+static caseResult_t Case_RSqrt( const benchInputs_t & in ) {
+	caseResult_t result;
+	result.name = ( accuracy == MATH_ACCURACY_FAST ) ? "rsqrt_fast" : "rsqrt_precise";
+
+	std::vector< float > src( NUM_INPUTS );
+	for ( int i = 0; i < NUM_INPUTS; i++ ) {
+		src[ i ] = in.vecA[ i ].GetLengthSqr() + 1e-3f;
+	}
+
+	std::vector< float > out( NUM_INPUTS );
+	result.opsPerNS = TimeOps( [ & ]() {
+		for ( int i = 0; i < NUM_INPUTS; i++ ) {
+			out[ i ] = MathFunctions< accuracy >::RSqrt( src[ i ] );
+		}
+		g_sink = out[ NUM_INPUTS - 1 ];
+	}, NUM_INPUTS );
+
+	for ( int i = 0; i < NUM_INPUTS; i++ ) {
+		const double ref = 1.0 / sqrt( (double)src[ i ] );
+		result.error.Add( &out[ i ], &ref, 1 );
+	}
+	return result;
+}
+
+template < mathAccuracy_t accuracy >
+static caseResult_t Case_SinCos( const benchInputs_t & in ) {
+	caseResult_t result;
+	result.name = ( accuracy == MATH_ACCURACY_FAST ) ? "sincos_fast" : "sincos_precise";
+
+	// Angles over a few turns either way, like yaw and animation phases
+	std::vector< float > src( NUM_INPUTS );
+	for ( int i = 0; i < NUM_INPUTS; i++ ) {
+		src[ i ] = in.vecA[ i ].x * 2.0f;
+	}
+
+	std::vector< float > out( NUM_INPUTS * 2 );
+	result.opsPerNS = TimeOps( [ & ]() {
+		for ( int i = 0; i < NUM_INPUTS; i++ ) {
+			MathFunctions< accuracy >::SinCos( src[ i ], out[ i * 2 + 0 ], out[ i * 2 + 1 ] );
+		}
+		g_sink = out[ 0 ];
+	}, NUM_INPUTS );
+
+	for ( int i = 0; i < NUM_INPUTS; i++ ) {
+		const double ref[ 2 ] = { sin( (double)src[ i ] ), cos( (double)src[ i ] ) };
+		result.error.Add( out.data() + i * 2, ref, 2 );
+	}
+	return result;
+}
+
+// The fast path four at a time, the way batched callers use it
+static caseResult_t Case_SinCosFastX4( const benchInputs_t & in ) {
+	caseResult_t result;
+	result.name = "sincos_fast_x4";
+
+	std::vector< float > src( NUM_INPUTS );
+	for ( int i = 0; i < NUM_INPUTS; i++ ) {
+		src[ i ] = in.vecA[ i ].x * 2.0f;
+	}
+
+	std::vector< float > sinOut( NUM_INPUTS );
+	std::vector< float > cosOut( NUM_INPUTS );
+	result.opsPerNS = TimeOps( [ & ]() {
+		for ( int i = 0; i < NUM_INPUTS; i += 4 ) {
+			simd4f_t s, c;
+			SIMD_SinCosFast( SIMD_LoadUnaligned( src.data() + i ), s, c );
+			SIMD_StoreUnaligned( sinOut.data() + i, s );
+			SIMD_StoreUnaligned( cosOut.data() + i, c );
+		}
+		g_sink = sinOut[ 0 ];
+	}, NUM_INPUTS );
+
+	for ( int i = 0; i < NUM_INPUTS; i++ ) {
+		const float res[ 2 ] = { sinOut[ i ], cosOut[ i ] };
+		const double ref[ 2 ] = { sin( (double)src[ i ] ), cos( (double)src[ i ] ) };
+		result.error.Add( res, ref, 2 );
+	}
+	return result;
+}
+
+static caseResult_t Case_Vec4Dot( const benchInputs_t & in ) {
+	caseResult_t result;
+	result.name = "vec4_dot";
+
+	std::vector< float > out( NUM_INPUTS );
+	result.opsPerNS = TimeOps( [ & ]() {
+		for ( int i = 0; i < NUM_INPUTS; i++ ) {
+			out[ i ] = in.vec4s[ i ].Dot( in.vec4s[ NUM_INPUTS - 1 - i ] );
+		}
+		g_sink = out[ NUM_INPUTS - 1 ];
+	}, NUM_INPUTS );
+
+	for ( int i = 0; i < NUM_INPUTS; i++ ) {
+		const Vec4 & a = in.vec4s[ i ];
+		const Vec4 & b = in.vec4s[ NUM_INPUTS - 1 - i ];
+		double sum = 0.0;
+		double magnitude = 0.0;
+		for ( int k = 0; k < 4; k++ ) {
+			sum += (double)a[ k ] * (double)b[ k ];
+			magnitude = std::max( magnitude, fabs( (double)a[ k ] * (double)b[ k ] ) );
+		}
+		// Second component carries the size of the terms, the sum can cancel to zero
+		const float res[ 2 ] = { out[ i ], (float)magnitude };
+		const double ref[ 2 ] = { sum, magnitude };
+		result.error.Add( res, ref, 2 );
+	}
+	return result;
+}
+
+static caseResult_t Case_QuatMul( const benchInputs_t & in ) {
+	caseResult_t result;
+	result.name = "quat_mul";
+
+	std::vector< Quat > out( NUM_INPUTS );
+	result.opsPerNS = TimeOps( [ & ]() {
+		for ( int i = 0; i < NUM_INPUTS; i++ ) {
+			out[ i ] = in.quatA[ i ] * in.quatB[ i ];
+		}
+		g_sink = out[ NUM_INPUTS - 1 ].w;
+	}, NUM_INPUTS );
+
+	for ( int i = 0; i < NUM_INPUTS; i++ ) {
+		const dquat_t r = Mul( ToDouble( in.quatA[ i ] ), ToDouble( in.quatB[ i ] ) );
+		const double ref[ 4 ] = { r.w, r.x, r.y, r.z };
+		const float res[ 4 ] = { out[ i ].w, out[ i ].x, out[ i ].y, out[ i ].z };
+		result.error.Add( res, ref, 4 );
+	}
+	return result;
+}
+
+static caseResult_t Case_QuatRotate( const benchInputs_t & in ) {
+	caseResult_t result;
+	result.name = "quat_rotate_point";
+
+	std::vector< Vec3 > out( NUM_INPUTS );
+	result.opsPerNS = TimeOps( [ & ]() {
+		for ( int i = 0; i < NUM_INPUTS; i++ ) {
+			out[ i ] = in.quatA[ i ].RotatePoint( in.vecA[ i ] );
+		}
+		g_sink = out[ NUM_INPUTS - 1 ].x;
+	}, NUM_INPUTS );
+
+	for ( int i = 0; i < NUM_INPUTS; i++ ) {
+		const dvec3_t r = Rotate( ToDouble( in.quatA[ i ] ), ToDouble( in.vecA[ i ] ) );
+		const double ref[ 3 ] = { r.x, r.y, r.z };
+		result.error.Add( out[ i ].ToPtr(), ref, 3 );
+	}
+	return result;
+}
+
+static caseResult_t Case_Mat4MulVec4( const benchInputs_t & in ) {
+	caseResult_t result;
+	result.name = "mat4_mul_vec4";
+
+	std::vector< Vec4 > out( NUM_INPUTS );
+	result.opsPerNS = TimeOps( [ & ]() {
+		for ( int i = 0; i < NUM_INPUTS; i++ ) {
+			out[ i ] = in.general[ i ] * in.vec4s[ i ];
+		}
+		g_sink = out[ NUM_INPUTS - 1 ].x;
+	}, NUM_INPUTS );
+
+	for ( int i = 0; i < NUM_INPUTS; i++ ) {
+		double m[ 16 ];
+		ToDouble( in.general[ i ], m );
+		double ref[ 4 ];
+		for ( int r = 0; r < 4; r++ ) {
+			ref[ r ] = 0.0;
+			for ( int c = 0; c < 4; c++ ) {
+				ref[ r ] += m[ r * 4 + c ] * in.vec4s[ i ][ c ];
+			}
+		}
+		result.error.Add( out[ i ].ToPtr(), ref, 4 );
+	}
+	return result;
+}
+
+static caseResult_t Case_Mat4MulMat4( const benchInputs_t & in ) {
+	caseResult_t result;
+	result.name = "mat4_mul_mat4";
+
+	std::vector< Mat4 > out( NUM_INPUTS );
+	result.opsPerNS = TimeOps( [ & ]() {
+		for ( int i = 0; i < NUM_INPUTS; i++ ) {
+			out[ i ] = in.general[ i ] * in.affine[ i ];
+		}
+		g_sink = out[ NUM_INPUTS - 1 ].rows[ 0 ].x;
+	}, NUM_INPUTS );
+
+	for ( int i = 0; i < NUM_INPUTS; i++ ) {
+		double a[ 16 ];
+		double b[ 16 ];
+		ToDouble( in.general[ i ], a );
+		ToDouble( in.affine[ i ], b );
+		double ref[ 16 ];
+		for ( int r = 0; r < 4; r++ ) {
+			for ( int c = 0; c < 4; c++ ) {
+				ref[ r * 4 + c ] = 0.0;
+				for ( int k = 0; k < 4; k++ ) {
+					ref[ r * 4 + c ] += a[ r * 4 + k ] * b[ k * 4 + c ];
+				}
+			}
+		}
+		result.error.Add( out[ i ].ToPtr(), ref, 16 );
+	}
+	return result;
+}
+
+enum inverseKind_t {
+	INVERSE_GENERAL,
+	INVERSE_AFFINE,
+	INVERSE_ORTHONORMAL,
+};
+
+static caseResult_t Case_Mat4Inverse( const benchInputs_t & in, const inverseKind_t kind ) {
+	static const char * names[] = { "mat4_inverse", "mat4_inverse_affine", "mat4_inverse_orthonormal" };
+	caseResult_t result;
+	result.name = names[ kind ];
+	const std::vector< Mat4 > & src = ( kind == INVERSE_GENERAL ) ? in.general : ( ( kind == INVERSE_AFFINE ) ? in.affine : in.orthonormal );
+
+	std::vector< Mat4 > out( NUM_INPUTS );
+	result.opsPerNS = TimeOps( [ & ]() {
+		for ( int i = 0; i < NUM_INPUTS; i++ ) {
+			if ( kind == INVERSE_GENERAL ) {
+				out[ i ] = src[ i ].Inverse();
+			} else if ( kind == INVERSE_AFFINE ) {
+				out[ i ] = src[ i ].InverseAffine();
+			} else {
+				out[ i ] = src[ i ].InverseOrthonormal();
+			}
+		}
+		g_sink = out[ NUM_INPUTS - 1 ].rows[ 0 ].x;
+	}, NUM_INPUTS );
+
+	for ( int i = 0; i < NUM_INPUTS; i++ ) {
+		double m[ 16 ];
+		double ref[ 16 ];
+		ToDouble( src[ i ], m );
+		InverseDouble( m, ref );
+		result.error.Add( out[ i ].ToPtr(), ref, 16 );
+	}
+	return result;
+}
+
+static caseResult_t Case_BuildMatrices( const benchInputs_t & in ) {
+	caseResult_t result;
+	result.name = "build_matrices";
+
+	transformsSoA_t transforms;
+	transforms.Resize( NUM_INPUTS );
+	for ( int i = 0; i < NUM_INPUTS; i++ ) {
+		transforms.Set( i, in.vecA[ i ], in.quatA[ i ], in.scales[ i ] );
+	}
+
+	std::vector< float > out( NUM_INPUTS * 16 );
+	result.opsPerNS = TimeOps( [ & ]() {
+		BuildMatrices( transforms, 0, NUM_INPUTS, out.data(), sizeof( float ) * 16 );
+		g_sink = out[ 0 ];
+	}, NUM_INPUTS );
+
+	for ( int i = 0; i < NUM_INPUTS; i++ ) {
+		const dquat_t q = ToDouble( in.quatA[ i ] );
+		const dvec3_t axes[ 3 ] = { { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 1 } };
+		const double scale[ 3 ] = { in.scales[ i ].x, in.scales[ i ].y, in.scales[ i ].z };
+
+		// Column major, like the shaders read it
+		double ref[ 16 ];
+		for ( int c = 0; c < 3; c++ ) {
+			const dvec3_t col = Rotate( q, axes[ c ] );
+			ref[ c * 4 + 0 ] = col.x * scale[ c ];
+			ref[ c * 4 + 1 ] = col.y * scale[ c ];
+			ref[ c * 4 + 2 ] = col.z * scale[ c ];
+			ref[ c * 4 + 3 ] = 0.0;
+		}
+		ref[ 12 ] = in.vecA[ i ].x;
+		ref[ 13 ] = in.vecA[ i ].y;
+		ref[ 14 ] = in.vecA[ i ].z;
+		ref[ 15 ] = 1.0;
+		result.error.Add( out.data() + i * 16, ref, 16 );
+	}
+	return result;
+}
+
+/*
+====================================================
+Case_LCP
+
+Gauss-Seidel on 12x12 systems shaped like a constraint's J M^-1 J^T,
+with the same iteration count in double as the reference
+====================================================
+*/
+static const int LCP_SIZE = 12;
+static const int NUM_LCP_SYSTEMS = 256;
+
+static void BuildLCPSystem( benchRandom_t & random, double * A, double * b ) {
+	double J[ LCP_SIZE * LCP_SIZE ];
+	for ( int i = 0; i < LCP_SIZE * LCP_SIZE; i++ ) {
+		J[ i ] = random.Float( -1, 1 );
+	}
+	for ( int r = 0; r < LCP_SIZE; r++ ) {
+		for ( int c = 0; c < LCP_SIZE; c++ ) {
+			double sum = ( r == c ) ? 1.0 : 0.0;
+			for ( int k = 0; k < LCP_SIZE; k++ ) {
+				sum += J[ r * LCP_SIZE + k ] * J[ c * LCP_SIZE + k ];
+			}
+			A[ r * LCP_SIZE + c ] = (float)sum;
+		}
+		b[ r ] = random.Float( -5, 5 );
+	}
+}
+
+static caseResult_t Case_LCP( const bool isFixed ) {
+	caseResult_t result;
+	result.name = isFixed ? "lcp_gauss_seidel_fixed" : "lcp_gauss_seidel";
+
+	benchRandom_t random( 11 );
+	std::vector< double > As( NUM_LCP_SYSTEMS * LCP_SIZE * LCP_SIZE );
+	std::vector< double > bs( NUM_LCP_SYSTEMS * LCP_SIZE );
+	std::vector< MatN > dynamicA( NUM_LCP_SYSTEMS, MatN( LCP_SIZE ) );
+	std::vector< VecN > dynamicB( NUM_LCP_SYSTEMS, VecN( LCP_SIZE ) );
+	std::vector< Mat< LCP_SIZE, LCP_SIZE > > fixedA( NUM_LCP_SYSTEMS );
+	std::vector< Vec< LCP_SIZE > > fixedB( NUM_LCP_SYSTEMS );
+	for ( int s = 0; s < NUM_LCP_SYSTEMS; s++ ) {
+		double * A = As.data() + s * LCP_SIZE * LCP_SIZE;
+		double * b = bs.data() + s * LCP_SIZE;
+		BuildLCPSystem( random, A, b );
+		for ( int r = 0; r < LCP_SIZE; r++ ) {
+			for ( int c = 0; c < LCP_SIZE; c++ ) {
+				dynamicA[ s ].rows[ r ][ c ] = (float)A[ r * LCP_SIZE + c ];
+				fixedA[ s ].rows[ r ][ c ] = (float)A[ r * LCP_SIZE + c ];
+			}
+			dynamicB[ s ][ r ] = (float)b[ r ];
+			fixedB[ s ][ r ] = (float)b[ r ];
+		}
+	}
+
+	std::vector< float > out( NUM_LCP_SYSTEMS * LCP_SIZE );
+	result.opsPerNS = TimeOps( [ & ]() {
+		for ( int s = 0; s < NUM_LCP_SYSTEMS; s++ ) {
+			float * x = out.data() + s * LCP_SIZE;
+			if ( isFixed ) {
+				const Vec< LCP_SIZE > solution = LCP_GaussSeidel( fixedA[ s ], fixedB[ s ] );
+				memcpy( x, solution.data, sizeof( float ) * LCP_SIZE );
+			} else {
+				const VecN solution = LCP_GaussSeidel( dynamicA[ s ], dynamicB[ s ] );
+				memcpy( x, solution.data, sizeof( float ) * LCP_SIZE );
+			}
+		}
+		g_sink = out[ 0 ];
+	}, NUM_LCP_SYSTEMS );
+
+	for ( int s = 0; s < NUM_LCP_SYSTEMS; s++ ) {
+		const double * A = As.data() + s * LCP_SIZE * LCP_SIZE;
+		const double * b = bs.data() + s * LCP_SIZE;
+		double x[ LCP_SIZE ] = {};
+		for ( int iter = 0; iter < LCP_SIZE; iter++ ) {
+			for ( int i = 0; i < LCP_SIZE; i++ ) {
+				double dot = 0.0;
+				for ( int k = 0; k < LCP_SIZE; k++ ) {
+					dot += A[ i * LCP_SIZE + k ] * x[ k ];
+				}
+				x[ i ] += ( b[ i ] - dot ) / A[ i * LCP_SIZE + i ];
+			}
+		}
+		result.error.Add( out.data() + s * LCP_SIZE, x, LCP_SIZE );
+	}
+	return result;
+}
+
+/*
+====================================================
+Case_LCPChain
+
+A chain of bodies with three rows between neighbours, the shape of the
+systems the sparse rows are for.  The dense case assembles J W J^T
+first, both are checked against the dense sweep in double.
+====================================================
+*/
+static const int LCP_CHAIN_BODIES = 32;
+
+static void BuildLCPChain( std::vector< lcpRow_t > & rows, std::vector< lcpBody_t > & bodies ) {
+	benchRandom_t random( 17 );
+
+	bodies.resize( LCP_CHAIN_BODIES );
+	for ( int b = 0; b < LCP_CHAIN_BODIES; b++ ) {
+		bodies[ b ].invMass = random.Float( 0.5f, 2.0f );
+		bodies[ b ].invInertia.Zero();
+		for ( int k = 0; k < 3; k++ ) {
+			bodies[ b ].invInertia.rows[ k ][ k ] = random.Float( 1.0f, 4.0f );
+		}
+	}
+
+	// The first body hangs from the world
+	rows.clear();
+	for ( int b = 0; b < LCP_CHAIN_BODIES; b++ ) {
+		for ( int axis = 0; axis < 3; axis++ ) {
+			lcpRow_t row;
+			row.bodyA = b - 1;
+			row.bodyB = b;
+			const Vec3 r = random.Vector( -0.5f, 0.5f );
+			Vec3 n( 0.0f );
+			n[ axis ] = 1.0f;
+			const Vec3 rxn = r.Cross( n );
+			row.jacobian[ 0 ] = -n.x;
+			row.jacobian[ 1 ] = -n.y;
+			row.jacobian[ 2 ] = -n.z;
+			row.jacobian[ 3 ] = -rxn.x;
+			row.jacobian[ 4 ] = -rxn.y;
+			row.jacobian[ 5 ] = -rxn.z;
+			row.jacobian[ 6 ] = n.x;
+			row.jacobian[ 7 ] = n.y;
+			row.jacobian[ 8 ] = n.z;
+			row.jacobian[ 9 ] = rxn.x;
+			row.jacobian[ 10 ] = rxn.y;
+			row.jacobian[ 11 ] = rxn.z;
+			row.rhs = random.Float( -1.0f, 1.0f );
+			row.lambdaMin = -FLT_MAX;
+			row.lambdaMax = FLT_MAX;
+			rows.push_back( row );
+		}
+	}
+}
+
+// J W J^T in double, row major
+static void AssembleLCPChain( const std::vector< lcpRow_t > & rows, const std::vector< lcpBody_t > & bodies, std::vector< double > & A ) {
+	const int num = (int)rows.size();
+	A.assign( num * num, 0.0 );
+	for ( int i = 0; i < num; i++ ) {
+		for ( int j = 0; j < num; j++ ) {
+			const int bodiesI[ 2 ] = { rows[ i ].bodyA, rows[ i ].bodyB };
+			const int bodiesJ[ 2 ] = { rows[ j ].bodyA, rows[ j ].bodyB };
+			double sum = 0.0;
+			for ( int si = 0; si < 2; si++ ) {
+				for ( int sj = 0; sj < 2; sj++ ) {
+					if ( bodiesI[ si ] < 0 || bodiesI[ si ] != bodiesJ[ sj ] ) {
+						continue;
+					}
+					const lcpBody_t & body = bodies[ bodiesI[ si ] ];
+					const float * Ji = rows[ i ].jacobian + si * 6;
+					const float * Jj = rows[ j ].jacobian + sj * 6;
+					for ( int k = 0; k < 3; k++ ) {
+						sum += (double)Ji[ k ] * body.invMass * Jj[ k ];
+					}
+					for ( int r = 0; r < 3; r++ ) {
+						for ( int c = 0; c < 3; c++ ) {
+							sum += (double)Ji[ 3 + r ] * body.invInertia.rows[ r ][ c ] * Jj[ 3 + c ];
+						}
+					}
+				}
+			}
+			A[ i * num + j ] = sum;
+		}
+	}
+}
+
+static caseResult_t Case_LCPChain( const bool isSparse ) {
+	caseResult_t result;
+	result.name = isSparse ? "lcp_chain_sparse" : "lcp_chain_dense";
+
+	std::vector< lcpRow_t > rows;
+	std::vector< lcpBody_t > bodies;
+	BuildLCPChain( rows, bodies );
+	const int num = (int)rows.size();
+
+	std::vector< double > A;
+	AssembleLCPChain( rows, bodies, A );
+
+	VecN lambda;
+	result.opsPerNS = TimeOps( [ & ]() {
+		if ( isSparse ) {
+			lambda = LCP_GaussSeidel( rows.data(), num, bodies.data(), (int)bodies.size(), num );
+		} else {
+			// Assembly is part of the cost of the dense path
+			MatN denseA( num );
+			VecN b( num );
+			for ( int i = 0; i < num; i++ ) {
+				for ( int j = 0; j < num; j++ ) {
+					denseA.rows[ i ][ j ] = (float)A[ i * num + j ];
+				}
+				b[ i ] = rows[ i ].rhs;
+			}
+			lambda = LCP_GaussSeidel( denseA, b );
+		}
+		g_sink = lambda[ 0 ];
+	}, 1 );
+
+	std::vector< double > x( num, 0.0 );
+	for ( int iter = 0; iter < num; iter++ ) {
+		for ( int i = 0; i < num; i++ ) {
+			double dot = 0.0;
+			for ( int k = 0; k < num; k++ ) {
+				dot += A[ i * num + k ] * x[ k ];
+			}
+			x[ i ] += ( rows[ i ].rhs - dot ) / A[ i * num + i ];
+		}
+	}
+	result.error.Add( lambda.data, x.data(), num );
+	return result;
+}
+
+/*
+====================================================
+Case_MatMN
+
+The two products every constraint does per solve: J M^-1 J^T with a
+4x12 Jacobian, and J^T lambda
+====================================================
+*/
+static caseResult_t Case_MatMN( const bool isTransposeMultiply ) {
+	caseResult_t result;
+	result.name = isTransposeMultiply ? "matmn_transpose_multiply" : "matmn_jmjt";
+
+	const int ROWS = 4;
+	const int COLS = 12;
+	const int NUM_SYSTEMS = 256;
+
+	benchRandom_t random( 13 );
+	std::vector< MatMN > J( NUM_SYSTEMS, MatMN( ROWS, COLS ) );
+	std::vector< MatMN > invMass( NUM_SYSTEMS, MatMN( COLS, COLS ) );
+	std::vector< VecN > lambda( NUM_SYSTEMS, VecN( ROWS ) );
+	for ( int s = 0; s < NUM_SYSTEMS; s++ ) {
+		for ( int r = 0; r < ROWS; r++ ) {
+			for ( int c = 0; c < COLS; c++ ) {
+				J[ s ].rows[ r ][ c ] = random.Float( -1, 1 );
+			}
+			lambda[ s ][ r ] = random.Float( -10, 10 );
+		}
+		invMass[ s ].Zero();
+		for ( int r = 0; r < COLS; r++ ) {
+			for ( int c = r; c < COLS; c++ ) {
+				const float v = ( r == c ) ? random.Float( 0.5f, 2.0f ) : random.Float( -0.2f, 0.2f );
+				invMass[ s ].rows[ r ][ c ] = v;
+				invMass[ s ].rows[ c ][ r ] = v;
+			}
+		}
+	}
+
+	const int outSize = isTransposeMultiply ? COLS : ROWS * ROWS;
+	std::vector< float > out( NUM_SYSTEMS * outSize );
+	MatMN JM;
+	MatMN JMJt;
+	VecN impulses;
+	result.opsPerNS = TimeOps( [ & ]() {
+		for ( int s = 0; s < NUM_SYSTEMS; s++ ) {
+			float * dst = out.data() + s * outSize;
+			if ( isTransposeMultiply ) {
+				J[ s ].TransposeMultiply( lambda[ s ], impulses );
+				memcpy( dst, impulses.data, sizeof( float ) * COLS );
+			} else {
+				J[ s ].Multiply( invMass[ s ], JM );
+				JM.MultiplyTranspose( J[ s ], JMJt );
+				for ( int r = 0; r < ROWS; r++ ) {
+					memcpy( dst + r * ROWS, JMJt.rows[ r ].data, sizeof( float ) * ROWS );
+				}
+			}
+		}
+		g_sink = out[ 0 ];
+	}, NUM_SYSTEMS );
+
+	for ( int s = 0; s < NUM_SYSTEMS; s++ ) {
+		std::vector< double > ref( outSize, 0.0 );
+		if ( isTransposeMultiply ) {
+			for ( int c = 0; c < COLS; c++ ) {
+				for ( int r = 0; r < ROWS; r++ ) {
+					ref[ c ] += (double)J[ s ].rows[ r ][ c ] * lambda[ s ][ r ];
+				}
+			}
+		} else {
+			double jm[ ROWS ][ COLS ] = {};
+			for ( int r = 0; r < ROWS; r++ ) {
+				for ( int c = 0; c < COLS; c++ ) {
+					for ( int k = 0; k < COLS; k++ ) {
+						jm[ r ][ c ] += (double)J[ s ].rows[ r ][ k ] * invMass[ s ].rows[ k ][ c ];
+					}
+				}
+			}
+			for ( int r = 0; r < ROWS; r++ ) {
+				for ( int c = 0; c < ROWS; c++ ) {
+					for ( int k = 0; k < COLS; k++ ) {
+						ref[ r * ROWS + c ] += jm[ r ][ k ] * J[ s ].rows[ c ][ k ];
+					}
+				}
+			}
+		}
+		result.error.Add( out.data() + s * outSize, ref.data(), outSize );
+	}
+	return result;
+}
+
+static caseResult_t Case_BoundsExpand( const benchInputs_t & in ) {
+	caseResult_t result;
+	result.name = "bounds_expand";
+
+	const int POINTS_PER_BOUNDS = 32;
+	const int NUM_BOUNDS = NUM_INPUTS / POINTS_PER_BOUNDS;
+
+	std::vector< Bounds > out( NUM_BOUNDS );
+	result.opsPerNS = TimeOps( [ & ]() {
+		for ( int i = 0; i < NUM_BOUNDS; i++ ) {
+			out[ i ].Clear();
+			out[ i ].Expand( in.vecA.data() + i * POINTS_PER_BOUNDS, POINTS_PER_BOUNDS );
+		}
+		g_sink = out[ 0 ].mins.x;
+	}, NUM_INPUTS );
+
+	for ( int i = 0; i < NUM_BOUNDS; i++ ) {
+		double ref[ 6 ] = { DBL_MAX, DBL_MAX, DBL_MAX, -DBL_MAX, -DBL_MAX, -DBL_MAX };
+		for ( int p = 0; p < POINTS_PER_BOUNDS; p++ ) {
+			const Vec3 & pt = in.vecA[ i * POINTS_PER_BOUNDS + p ];
+			for ( int k = 0; k < 3; k++ ) {
+				ref[ k ] = std::min( ref[ k ], (double)pt[ k ] );
+				ref[ k + 3 ] = std::max( ref[ k + 3 ], (double)pt[ k ] );
+			}
+		}
+		const float res[ 6 ] = { out[ i ].mins.x, out[ i ].mins.y, out[ i ].mins.z, out[ i ].maxs.x, out[ i ].maxs.y, out[ i ].maxs.z };
+		result.error.Add( res, ref, 6 );
+	}
+	return result;
+}
+
+static caseResult_t Case_BoundsTransform( const benchInputs_t & in ) {
+	caseResult_t result;
+	result.name = "bounds_transform";
+
+	std::vector< Bounds > out( NUM_INPUTS );
+	result.opsPerNS = TimeOps( [ & ]() {
+		for ( int i = 0; i < NUM_INPUTS; i++ ) {
+			out[ i ] = TransformBounds( in.bounds[ i ], in.affine[ i ] );
+		}
+		g_sink = out[ NUM_INPUTS - 1 ].mins.x;
+	}, NUM_INPUTS );
+
+	for ( int i = 0; i < NUM_INPUTS; i++ ) {
+		double m[ 16 ];
+		ToDouble( in.affine[ i ], m );
+
+		double ref[ 6 ] = { DBL_MAX, DBL_MAX, DBL_MAX, -DBL_MAX, -DBL_MAX, -DBL_MAX };
+		for ( int corner = 0; corner < 8; corner++ ) {
+			const double pt[ 3 ] = {
+				( corner & 1 ) ? in.bounds[ i ].maxs.x : in.bounds[ i ].mins.x,
+				( corner & 2 ) ? in.bounds[ i ].maxs.y : in.bounds[ i ].mins.y,
+				( corner & 4 ) ? in.bounds[ i ].maxs.z : in.bounds[ i ].mins.z
+			};
+			for ( int r = 0; r < 3; r++ ) {
+				const double v = m[ r * 4 + 0 ] * pt[ 0 ] + m[ r * 4 + 1 ] * pt[ 1 ] + m[ r * 4 + 2 ] * pt[ 2 ] + m[ r * 4 + 3 ];
+				ref[ r ] = std::min( ref[ r ], v );
+				ref[ r + 3 ] = std::max( ref[ r + 3 ], v );
+			}
+		}
+		const float res[ 6 ] = { out[ i ].mins.x, out[ i ].mins.y, out[ i ].mins.z, out[ i ].maxs.x, out[ i ].maxs.y, out[ i ].maxs.z };
+		result.error.Add( res, ref, 6 );
+	}
+	return result;
+}
+
+static caseResult_t Case_BoundsIntersect( const benchInputs_t & in ) {
+	caseResult_t result;
+	result.name = "bounds_intersect_1vsN";
+
+	boundsSoA_t soa;
+	soa.Resize( NUM_INPUTS );
+	for ( int i = 0; i < NUM_INPUTS; i++ ) {
+		soa.Set( i, in.bounds[ i ] );
+	}
+
+	const int NUM_QUERIES = 16;
+	std::vector< int > hits( NUM_INPUTS );
+	std::vector< int > numHits( NUM_QUERIES );
+	result.opsPerNS = TimeOps( [ & ]() {
+		for ( int q = 0; q < NUM_QUERIES; q++ ) {
+			numHits[ q ] = IntersectBounds( in.bounds[ q ], soa, 0, NUM_INPUTS, hits.data() );
+		}
+		g_sink = (float)numHits[ 0 ];
+	}, NUM_QUERIES * NUM_INPUTS );
+
+	for ( int q = 0; q < NUM_QUERIES; q++ ) {
+		std::vector< bool > isHit( NUM_INPUTS, false );
+		const int num = IntersectBounds( in.bounds[ q ], soa, 0, NUM_INPUTS, hits.data() );
+		for ( int h = 0; h < num; h++ ) {
+			isHit[ hits[ h ] ] = true;
+		}
+
+		const Bounds & a = in.bounds[ q ];
+		for ( int i = 0; i < NUM_INPUTS; i++ ) {
+			const Bounds & b = in.bounds[ i ];
+			bool ref = true;
+			for ( int k = 0; k < 3; k++ ) {
+				ref = ref && ( (double)b.mins[ k ] <= (double)a.maxs[ k ] ) && ( (double)a.mins[ k ] <= (double)b.maxs[ k ] );
+			}
+			result.error.AddBool( isHit[ i ], ref );
+		}
+	}
+	return result;
+}
+
+/*
+====================================================
+g_benchCases
+====================================================
+*/
+struct benchCase_t {
+	const char * name;
+	caseResult_t ( *run )( const benchInputs_t & in );
+};
+
+static caseResult_t Case_Mat4InverseGeneral( const benchInputs_t & in ) { return Case_Mat4Inverse( in, INVERSE_GENERAL ); }
+static caseResult_t Case_Mat4InverseAffine( const benchInputs_t & in ) { return Case_Mat4Inverse( in, INVERSE_AFFINE ); }
+static caseResult_t Case_Mat4InverseOrthonormal( const benchInputs_t & in ) { return Case_Mat4Inverse( in, INVERSE_ORTHONORMAL ); }
+static caseResult_t Case_LCPDynamic( const benchInputs_t & ) { return Case_LCP( false ); }
+static caseResult_t Case_LCPFixed( const benchInputs_t & ) { return Case_LCP( true ); }
+static caseResult_t Case_LCPChainDense( const benchInputs_t & ) { return Case_LCPChain( false ); }
+static caseResult_t Case_LCPChainSparse( const benchInputs_t & ) { return Case_LCPChain( true ); }
+static caseResult_t Case_MatMNJMJt( const benchInputs_t & ) { return Case_MatMN( false ); }
+static caseResult_t Case_MatMNTransposeMultiply( const benchInputs_t & ) { return Case_MatMN( true ); }
+
+static const benchCase_t g_benchCases[] = {
+	{ "vec3_dot", Case_Vec3Dot },
+	{ "vec3_cross", Case_Vec3Cross },
+	{ "vec3_normalize", Case_Vec3Normalize },
+	{ "vec3_normalize_precise", Case_Vec3NormalizeAccuracy< MATH_ACCURACY_PRECISE > },
+	{ "vec3_normalize_fast", Case_Vec3NormalizeAccuracy< MATH_ACCURACY_FAST > },
+	{ "rsqrt_precise", Case_RSqrt< MATH_ACCURACY_PRECISE > },
+	{ "rsqrt_fast", Case_RSqrt< MATH_ACCURACY_FAST > },
+	{ "sincos_precise", Case_SinCos< MATH_ACCURACY_PRECISE > },
+	{ "sincos_fast", Case_SinCos< MATH_ACCURACY_FAST > },
+	{ "sincos_fast_x4", Case_SinCosFastX4 },
+	{ "vec4_dot", Case_Vec4Dot },
+	{ "quat_mul", Case_QuatMul },
+	{ "quat_rotate_point", Case_QuatRotate },
+	{ "mat4_mul_vec4", Case_Mat4MulVec4 },
+	{ "mat4_mul_mat4", Case_Mat4MulMat4 },
+	{ "mat4_inverse", Case_Mat4InverseGeneral },
+	{ "mat4_inverse_affine", Case_Mat4InverseAffine },
+	{ "mat4_inverse_orthonormal", Case_Mat4InverseOrthonormal },
+	{ "build_matrices", Case_BuildMatrices },
+	{ "lcp_gauss_seidel", Case_LCPDynamic },
+	{ "lcp_gauss_seidel_fixed", Case_LCPFixed },
+	{ "lcp_chain_dense", Case_LCPChainDense },
+	{ "lcp_chain_sparse", Case_LCPChainSparse },
+	{ "matmn_jmjt", Case_MatMNJMJt },
+	{ "matmn_transpose_multiply", Case_MatMNTransposeMultiply },
+	{ "bounds_expand", Case_BoundsExpand },
+	{ "bounds_transform", Case_BoundsTransform },
+	{ "bounds_intersect_1vsN", Case_BoundsIntersect },
+};
+static const int NUM_BENCH_CASES = sizeof( g_benchCases ) / sizeof( g_benchCases[ 0 ] );
+
+/*
+====================================================
+GetBackendName
+====================================================
+*/
+static const char * GetBackendName() {
+#if defined( MATH_SIMD_SSE )
+	return "sse";
+#elif defined( MATH_SIMD_NEON )
+	return "neon";
+#else
+	return "scalar";
+#endif
+}
+
+/*
+====================================================
+PrintTable
+====================================================
+*/
+static void PrintTable( const std::vector< caseResult_t > & results ) {
+	printf( "backend: %s\n", GetBackendName() );
+	printf( "%-26s %10s %10s %10s %10s %10s\n", "case", "ops/ns", "ns/op", "max ulp", "max rel", "mean rel" );
+	for ( int i = 0; i < results.size(); i++ ) {
+		const caseResult_t & result = results[ i ];
+		printf( "%-26s %10.4f %10.3f %10.1f %10.2e %10.2e\n", result.name, result.opsPerNS, 1.0 / result.opsPerNS,
+			result.error.maxUlp, result.error.maxRel, result.error.MeanRel() );
+	}
+}
+
+/*
+====================================================
+WriteJSON
+====================================================
+*/
+static void WriteJSON( FILE * file, const std::vector< caseResult_t > & results, const char * label ) {
+	fprintf( file, "{\n" );
+	fprintf( file, "  \"label\": \"%s\",\n", label );
+	fprintf( file, "  \"backend\": \"%s\",\n", GetBackendName() );
+	fprintf( file, "  \"cases\": [\n" );
+	for ( int i = 0; i < results.size(); i++ ) {
+		const caseResult_t & result = results[ i ];
+		fprintf( file, "    { \"name\": \"%s\", \"ops_per_ns\": %.6f, \"max_ulp\": %.2f, \"max_rel\": %.4e, \"mean_rel\": %.4e }%s\n",
+			result.name, result.opsPerNS, result.error.maxUlp, result.error.maxRel, result.error.MeanRel(), ( i + 1 < results.size() ) ? "," : "" );
+	}
+	fprintf( file, "  ]\n" );
+	fprintf( file, "}\n" );
+}
+
+/*
+====================================================
+WriteDump
+
+Every result of every case, in the order the cases ran
+====================================================
+*/
+static bool WriteDump( const char * path, const std::vector< caseResult_t > & results ) {
+	FILE * file = fopen( path, "wb" );
+	if ( NULL == file ) {
+		return false;
+	}
+
+	const int numCases = (int)results.size();
+	fwrite( &numCases, sizeof( int ), 1, file );
+	for ( int i = 0; i < numCases; i++ ) {
+		const errorStats_t & error = results[ i ].error;
+		const int nameLength = (int)strlen( results[ i ].name );
+		const int numResults = (int)error.sizes.size();
+		const int numValues = (int)error.values.size();
+
+		fwrite( &nameLength, sizeof( int ), 1, file );
+		fwrite( results[ i ].name, 1, nameLength, file );
+		fwrite( &numResults, sizeof( int ), 1, file );
+		fwrite( error.sizes.data(), sizeof( int ), numResults, file );
+		fwrite( error.magnitudes.data(), sizeof( double ), numResults, file );
+		fwrite( &numValues, sizeof( int ), 1, file );
+		fwrite( error.values.data(), sizeof( float ), numValues, file );
+	}
+	fclose( file );
+	return true;
+}
+
+/*
+====================================================
+dumpedCase_t
+====================================================
+*/
+struct dumpedCase_t {
+	std::string name;
+	errorStats_t error;
+};
+
+/*
+====================================================
+ReadDump
+====================================================
+*/
+static bool ReadDump( const char * path, std::vector< dumpedCase_t > & cases ) {
+	FILE * file = fopen( path, "rb" );
+	if ( NULL == file ) {
+		return false;
+	}
+
+	bool isValid = true;
+	int numCases = 0;
+	isValid = isValid && ( 1 == fread( &numCases, sizeof( int ), 1, file ) );
+	for ( int i = 0; isValid && i < numCases; i++ ) {
+		dumpedCase_t dumped;
+		int nameLength = 0;
+		int numResults = 0;
+		int numValues = 0;
+
+		isValid = isValid && ( 1 == fread( &nameLength, sizeof( int ), 1, file ) ) && nameLength > 0 && nameLength < 256;
+		if ( isValid ) {
+			dumped.name.resize( nameLength );
+			isValid = ( nameLength == (int)fread( &dumped.name[ 0 ], 1, nameLength, file ) );
+		}
+		isValid = isValid && ( 1 == fread( &numResults, sizeof( int ), 1, file ) ) && numResults >= 0;
+		if ( isValid ) {
+			dumped.error.sizes.resize( numResults );
+			dumped.error.magnitudes.resize( numResults );
+			isValid = ( numResults == (int)fread( dumped.error.sizes.data(), sizeof( int ), numResults, file ) );
+			isValid = isValid && ( numResults == (int)fread( dumped.error.magnitudes.data(), sizeof( double ), numResults, file ) );
+		}
+		isValid = isValid && ( 1 == fread( &numValues, sizeof( int ), 1, file ) ) && numValues >= 0;
+		if ( isValid ) {
+			dumped.error.values.resize( numValues );
+			isValid = ( numValues == (int)fread( dumped.error.values.data(), sizeof( float ), numValues, file ) );
+		}
+		cases.push_back( dumped );
+	}
+	fclose( file );
+	return isValid;
+}
+
+/*
+====================================================
+GetBackendTolerance
+
+How far apart, relative to the size of the result, two backends may be.
+Both round differently and sum in a different order, the fast paths use
+the hardware estimates where the target has them and the iterative
+solvers carry that difference through every iteration
+====================================================
+*/
+static double GetBackendTolerance( const char * name ) {
+	if ( NULL != strstr( name, "lcp_" ) ) {
+		return 1.0e-4;
+	}
+	if ( NULL != strstr( name, "_fast" ) ) {
+		return 1.0e-4;
+	}
+	return 1.0e-6;
+}
+
+/*
+====================================================
+CompareBackends
+
+Checks each result of this run against the same result from a dump,
+returns false when any case is further apart than its tolerance
+====================================================
+*/
+static bool CompareBackends( const std::vector< caseResult_t > & results, const std::vector< dumpedCase_t > & dumped ) {
+	bool isMatch = true;
+
+	printf( "%-26s %10s %10s %10s\n", "case", "max ulp", "max rel", "limit" );
+	for ( int i = 0; i < results.size(); i++ ) {
+		const caseResult_t & result = results[ i ];
+
+		const dumpedCase_t * other = NULL;
+		for ( int d = 0; d < dumped.size(); d++ ) {
+			if ( dumped[ d ].name == result.name ) {
+				other = &dumped[ d ];
+			}
+		}
+		if ( NULL == other ) {
+			printf( "%-26s missing from the dump\n", result.name );
+			isMatch = false;
+			continue;
+		}
+
+		const errorStats_t & a = result.error;
+		const errorStats_t & b = other->error;
+		if ( a.sizes != b.sizes ) {
+			printf( "%-26s different number of results\n", result.name );
+			isMatch = false;
+			continue;
+		}
+
+		double maxUlp = 0.0;
+		double maxRel = 0.0;
+		int offset = 0;
+		for ( int r = 0; r < a.sizes.size(); r++ ) {
+			const double magnitude = std::max( a.magnitudes[ r ], b.magnitudes[ r ] );
+			const float mag = (float)magnitude;
+			const double ulp = (double)nextafterf( mag, FLT_MAX ) - (double)mag;
+
+			double error = 0.0;
+			for ( int k = 0; k < a.sizes[ r ]; k++ ) {
+				error = std::max( error, fabs( (double)a.values[ offset + k ] - (double)b.values[ offset + k ] ) );
+			}
+			offset += a.sizes[ r ];
+
+			// NaN on one side only never compares, count it as completely wrong
+			if ( error != error ) {
+				error = magnitude;
+			}
+			maxUlp = std::max( maxUlp, error / ulp );
+			maxRel = std::max( maxRel, error / magnitude );
+		}
+
+		const double tolerance = GetBackendTolerance( result.name );
+		const bool isCaseMatch = ( maxRel <= tolerance );
+		printf( "%-26s %10.1f %10.2e %10.2e%s\n", result.name, maxUlp, maxRel, tolerance, isCaseMatch ? "" : "  FAILED" );
+		isMatch = isMatch && isCaseMatch;
+	}
+	return isMatch;
+}
+
+/*
+====================================================
+main
+====================================================
+*/
+int main( int argc, char * argv[] ) {
+	const char * caseName = NULL;
+	const char * jsonPath = NULL;
+	const char * label = "";
+	const char * dumpPath = NULL;
+	const char * comparePath = NULL;
+
+	for ( int i = 1; i < argc; i++ ) {
+		const bool hasValue = ( i + 1 < argc );
+		if ( 0 == strcmp( argv[ i ], "--case" ) && hasValue ) {
+			caseName = argv[ ++i ];
+		} else if ( 0 == strcmp( argv[ i ], "--json" ) && hasValue ) {
+			jsonPath = argv[ ++i ];
+		} else if ( 0 == strcmp( argv[ i ], "--label" ) && hasValue ) {
+			label = argv[ ++i ];
+		} else if ( 0 == strcmp( argv[ i ], "--dump" ) && hasValue ) {
+			dumpPath = argv[ ++i ];
+		} else if ( 0 == strcmp( argv[ i ], "--compare" ) && hasValue ) {
+			comparePath = argv[ ++i ];
+		} else {
+			printf( "usage: math_bench [--case name] [--json file|-] [--label text] [--dump file] [--compare file]\n" );
+			printf( "cases:" );
+			for ( int c = 0; c < NUM_BENCH_CASES; c++ ) {
+				printf( " %s", g_benchCases[ c ].name );
+			}
+			printf( "\n" );
+			return 1;
+		}
+	}
+
+	benchInputs_t inputs;
+	inputs.Build();
+
+	std::vector< caseResult_t > results;
+	for ( int i = 0; i < NUM_BENCH_CASES; i++ ) {
+		if ( NULL != caseName && 0 != strcmp( caseName, g_benchCases[ i ].name ) ) {
+			continue;
+		}
+		results.push_back( g_benchCases[ i ].run( inputs ) );
+	}
+
+	if ( results.empty() ) {
+		printf( "Unknown case: %s\n", caseName );
+		return 1;
+	}
+
+	const bool jsonToStdout = ( NULL != jsonPath && 0 == strcmp( jsonPath, "-" ) );
+	if ( !jsonToStdout ) {
+		PrintTable( results );
+	}
+
+	if ( NULL != jsonPath ) {
+		FILE * file = jsonToStdout ? stdout : fopen( jsonPath, "w" );
+		if ( NULL == file ) {
+			printf( "Failed to open %s\n", jsonPath );
+			return 1;
+		}
+		WriteJSON( file, results, label );
+		if ( !jsonToStdout ) {
+			fclose( file );
+		}
+	}
+
+	if ( NULL != dumpPath && !WriteDump( dumpPath, results ) ) {
+		printf( "Failed to write %s\n", dumpPath );
+		return 1;
+	}
+
+	if ( NULL != comparePath ) {
+		std::vector< dumpedCase_t > dumped;
+		if ( !ReadDump( comparePath, dumped ) ) {
+			printf( "Failed to read %s\n", comparePath );
+			return 1;
+		}
+		if ( !CompareBackends( results, dumped ) ) {
+			printf( "Backends disagree\n" );
+			return 1;
+		}
+	}
+	return 0;
+}
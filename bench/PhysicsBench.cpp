@@ -0,0 +1,671 @@
+//
+//  PhysicsBench.cpp
+//
+#include "Scene.h"
+#include "Physics/CharacterController.h"
+#include "Physics/GJK.h"
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+/*
+========================================================================================================
+
+physics_bench
+
+Steps a set of standard stress scenes with a fixed time step and no window, and reports
+how long each phase of Scene::Update took.  The JSON output is meant to be kept per commit
+so regressions show up as a diff.  --check runs the character controller checks instead
+and returns non zero if one of them fails, ctest runs it.
+
+	physics_bench [--frames N] [--warmup N] [--scene name] [--json file|-] [--label text] [--check]
+
+========================================================================================================
+*/
+
+static const float BENCH_DT = 1.0f / 60.0f;
+
+/*
+====================================================
+benchRandom_t
+
+Small deterministic generator, so every run builds the exact same scenes
+====================================================
+*/
+struct benchRandom_t {
+	unsigned int state;
+
+	explicit benchRandom_t( const unsigned int seed ) : state( seed ) {}
+
+	float Float( const float lo, const float hi ) {
+		state = state * 1664525u + 1013904223u;
+		const float t = float( state >> 8 ) / float( 1 << 24 );
+		return lo + ( hi - lo ) * t;
+	}
+};
+
+/*
+====================================================
+AddBody
+====================================================
+*/
+static Body * AddBody( Scene & scene, Shape * shape, const Vec3 & pos, const float invMass, const Quat & orient = Quat( 0, 0, 0, 1 ) ) {
+	Body body;
+	body.m_position = pos;
+	body.m_orientation = orient;
+	body.m_shape = shape;
+	body.m_invMass = invMass;
+	body.m_elasticity = 0.1f;
+	body.m_friction = 0.6f;
+	scene.m_bodies.push_back( body );
+	return &scene.m_bodies.back();
+}
+
+/*
+====================================================
+MakeBox
+====================================================
+*/
+static Shape * MakeBox( const Vec3 & halfExtents ) {
+	Vec3 pts[ 8 ];
+	for ( int i = 0; i < 8; i++ ) {
+		pts[ i ].x = ( i & 1 ) ? halfExtents.x : -halfExtents.x;
+		pts[ i ].y = ( i & 2 ) ? halfExtents.y : -halfExtents.y;
+		pts[ i ].z = ( i & 4 ) ? halfExtents.z : -halfExtents.z;
+	}
+	return new ShapeBox( pts, 8 );
+}
+
+/*
+====================================================
+AddGround
+====================================================
+*/
+static void AddGround( Scene & scene, const float halfSize ) {
+	AddBody( scene, MakeBox( Vec3( halfSize, halfSize, 1.0f ) ), Vec3( 0, 0, -1.0f ), 0.0f );
+}
+
+/*
+====================================================
+BuildPyramids
+
+Boxes stacked into pyramids, mostly resting contacts
+====================================================
+*/
+static void BuildPyramids( Scene & scene ) {
+	const int numPyramids = 4;
+	const int baseSize = 10;
+	scene.m_bodies.reserve( 1 + numPyramids * baseSize * ( baseSize + 1 ) / 2 );
+
+	AddGround( scene, 50.0f );
+	for ( int p = 0; p < numPyramids; p++ ) {
+		const float y = ( p - numPyramids / 2 ) * 4.0f;
+		for ( int row = 0; row < baseSize; row++ ) {
+			const int count = baseSize - row;
+			for ( int i = 0; i < count; i++ ) {
+				const float x = ( i - ( count - 1 ) * 0.5f ) * 1.05f;
+				const float z = 0.5f + row * 1.0f;
+				AddBody( scene, MakeBox( Vec3( 0.5f ) ), Vec3( x, y, z ), 1.0f );
+			}
+		}
+	}
+}
+
+/*
+====================================================
+BuildSphereRain
+
+Spheres dropped from random heights over a wide area, mostly broadphase and narrowphase.
+A few small fast spheres are fired at the ground with speculative contacts on, they would
+tunnel through it without them.
+====================================================
+*/
+static void BuildSphereRain( Scene & scene ) {
+	const int side = 100;
+	const int numFast = 8;
+	scene.m_bodies.reserve( 1 + side * side + numFast );
+
+	benchRandom_t random( 1 );
+	AddGround( scene, 110.0f );
+	for ( int j = 0; j < side; j++ ) {
+		for ( int i = 0; i < side; i++ ) {
+			Vec3 pos;
+			pos.x = ( i - side / 2 ) * 2.0f + random.Float( -0.4f, 0.4f );
+			pos.y = ( j - side / 2 ) * 2.0f + random.Float( -0.4f, 0.4f );
+			pos.z = random.Float( 1.0f, 20.0f );
+			AddBody( scene, new ShapeSphere( 0.5f ), pos, 1.0f );
+		}
+	}
+
+	for ( int i = 0; i < numFast; i++ ) {
+		Body * body = AddBody( scene, new ShapeSphere( 0.1f ), Vec3( ( i - numFast / 2 ) * 25.0f + 1.0f, 1.0f, 10.0f ), 1.0f );
+		body->m_linearVelocity = Vec3( 0, 0, -100.0f );
+		body->m_useSpeculativeContacts = true;
+	}
+}
+
+/*
+====================================================
+BuildHingeChains
+
+Chains hanging from the world and solved by an Articulation each
+====================================================
+*/
+static void BuildHingeChains( Scene & scene ) {
+	const int numChains = 8;
+	const int numLinks = 20;
+	scene.m_bodies.reserve( 1 + numChains * numLinks );
+
+	Body * anchor = AddBody( scene, MakeBox( Vec3( 10.0f, 1.0f, 0.5f ) ), Vec3( 0, 0, 30.0f ), 0.0f );
+	for ( int c = 0; c < numChains; c++ ) {
+		Articulation * articulation = new Articulation;
+
+		// Start the links off to the side so the chain swings, with gaps
+		// between them since linked bodies still collide
+		const Vec3 top = Vec3( ( c - numChains / 2 ) * 2.0f, 1.1f, 29.4f );
+		Body * parent = anchor;
+		for ( int i = 0; i < numLinks; i++ ) {
+			const Vec3 joint = top + Vec3( 0, i * 1.0f, 0 );
+			Body * link = AddBody( scene, MakeBox( Vec3( 0.1f, 0.45f, 0.1f ) ), joint + Vec3( 0, 0.5f, 0 ), 1.0f );
+			articulation->AddJoint( Articulation::JOINT_HINGE, parent, link, joint, Vec3( 1, 0, 0 ) );
+			parent = link;
+		}
+		articulation->Build();
+		scene.m_articulations.push_back( articulation );
+	}
+}
+
+/*
+====================================================
+BuildConvexDebris
+
+Random convex hulls piling up, mostly GJK and EPA
+====================================================
+*/
+static void BuildConvexDebris( Scene & scene ) {
+	const int side = 8;
+	const int layers = 4;
+	scene.m_bodies.reserve( 1 + side * side * layers );
+
+	benchRandom_t random( 7 );
+	AddGround( scene, 30.0f );
+	for ( int k = 0; k < layers; k++ ) {
+		for ( int j = 0; j < side; j++ ) {
+			for ( int i = 0; i < side; i++ ) {
+				Vec3 pts[ 12 ];
+				for ( int p = 0; p < 12; p++ ) {
+					pts[ p ] = Vec3( random.Float( -0.6f, 0.6f ), random.Float( -0.6f, 0.6f ), random.Float( -0.4f, 0.4f ) );
+				}
+				const Vec3 pos( ( i - side / 2 ) * 1.6f, ( j - side / 2 ) * 1.6f, 1.0f + k * 1.6f );
+				Quat orient( Vec3( random.Float( -1, 1 ), random.Float( -1, 1 ), 1.0f ), random.Float( 0, 3.0f ) );
+				AddBody( scene, new ShapeConvex( pts, 12 ), pos, 1.0f, orient );
+			}
+		}
+	}
+}
+
+/*
+====================================================
+AddJointHinge
+====================================================
+*/
+static void AddJointHinge( Scene & scene, Body * bodyA, Body * bodyB, const Vec3 & worldAnchor, const Vec3 & worldAxis ) {
+	ConstraintHingeQuatLimited * joint = new ConstraintHingeQuatLimited();
+	joint->m_bodyA = bodyA;
+	joint->m_bodyB = bodyB;
+	joint->m_anchorA = bodyA->WorldSpaceToBodySpace( worldAnchor );
+	joint->m_anchorB = bodyB->WorldSpaceToBodySpace( worldAnchor );
+	joint->m_axisA = bodyA->m_orientation.Inverse().RotatePoint( worldAxis );
+	joint->m_axisB = bodyB->m_orientation.Inverse().RotatePoint( worldAxis );
+	joint->m_q0 = bodyA->m_orientation.Inverse() * bodyB->m_orientation;
+	scene.m_constraints.push_back( joint );
+}
+
+/*
+====================================================
+AddJointSwing
+====================================================
+*/
+static void AddJointSwing( Scene & scene, Body * bodyA, Body * bodyB, const Vec3 & worldAnchor, const Vec3 & worldAxis ) {
+	ConstraintConstantVelocityLimited * joint = new ConstraintConstantVelocityLimited();
+	joint->m_bodyA = bodyA;
+	joint->m_bodyB = bodyB;
+	joint->m_anchorA = bodyA->WorldSpaceToBodySpace( worldAnchor );
+	joint->m_anchorB = bodyB->WorldSpaceToBodySpace( worldAnchor );
+	joint->m_axisA = bodyA->m_orientation.Inverse().RotatePoint( worldAxis );
+	joint->m_axisB = bodyB->m_orientation.Inverse().RotatePoint( worldAxis );
+	joint->m_q0 = bodyA->m_orientation.Inverse() * bodyB->m_orientation;
+	scene.m_constraints.push_back( joint );
+}
+
+/*
+====================================================
+AddRagdoll
+
+Ten boxes held together by limited joints, like the ragdoll in the book
+====================================================
+*/
+static void AddRagdoll( Scene & scene, const Vec3 & offset ) {
+	const Vec3 torsoHalf( 0.25f, 0.15f, 0.4f );
+	const Vec3 limbHalf( 0.08f, 0.08f, 0.25f );
+	const Vec3 headHalf( 0.15f, 0.15f, 0.15f );
+
+	Body * torso = AddBody( scene, MakeBox( torsoHalf ), offset + Vec3( 0, 0, 1.5f ), 0.5f );
+	Body * head = AddBody( scene, MakeBox( headHalf ), offset + Vec3( 0, 0, 2.17f ), 2.0f );
+	AddJointSwing( scene, torso, head, offset + Vec3( 0, 0, 1.95f ), Vec3( 0, 0, 1 ) );
+
+	// Limbs are kept apart from each other and the torso, there is no collision filtering
+	for ( int side = -1; side <= 1; side += 2 ) {
+		const float ax = side * 0.35f;
+		Body * upperArm = AddBody( scene, MakeBox( limbHalf ), offset + Vec3( ax, 0, 1.6f ), 2.0f );
+		Body * lowerArm = AddBody( scene, MakeBox( limbHalf ), offset + Vec3( ax, 0, 1.04f ), 2.0f );
+		AddJointSwing( scene, torso, upperArm, offset + Vec3( ax, 0, 1.85f ), Vec3( 0, 0, -1 ) );
+		AddJointHinge( scene, upperArm, lowerArm, offset + Vec3( ax, 0, 1.32f ), Vec3( 1, 0, 0 ) );
+
+		const float lx = side * 0.14f;
+		Body * upperLeg = AddBody( scene, MakeBox( limbHalf ), offset + Vec3( lx, 0, 0.79f ), 1.5f );
+		Body * lowerLeg = AddBody( scene, MakeBox( limbHalf ), offset + Vec3( lx, 0, 0.25f ), 1.5f );
+		AddJointSwing( scene, torso, upperLeg, offset + Vec3( lx, 0, 1.06f ), Vec3( 0, 0, -1 ) );
+		AddJointHinge( scene, upperLeg, lowerLeg, offset + Vec3( lx, 0, 0.52f ), Vec3( 1, 0, 0 ) );
+	}
+}
+
+/*
+====================================================
+BuildRagdollPile
+
+Ragdolls dropped on top of each other, contacts and iterative joints together
+====================================================
+*/
+static void BuildRagdollPile( Scene & scene ) {
+	const int side = 3;
+	const int layers = 4;
+	scene.m_bodies.reserve( 1 + side * side * layers * 10 );
+
+	AddGround( scene, 30.0f );
+	for ( int k = 0; k < layers; k++ ) {
+		for ( int j = 0; j < side; j++ ) {
+			for ( int i = 0; i < side; i++ ) {
+				AddRagdoll( scene, Vec3( ( i - 1 ) * 0.6f + k * 0.2f, ( j - 1 ) * 0.5f, 0.1f + k * 2.5f ) );
+			}
+		}
+	}
+}
+
+/*
+====================================================
+benchScene_t
+====================================================
+*/
+struct benchScene_t {
+	const char * name;
+	void ( *build )( Scene & scene );
+};
+
+static const benchScene_t g_benchScenes[] = {
+	{ "pyramid_stacks",	BuildPyramids },
+	{ "sphere_rain",	BuildSphereRain },
+	{ "hinge_chains",	BuildHingeChains },
+	{ "convex_debris",	BuildConvexDebris },
+	{ "ragdoll_pile",	BuildRagdollPile },
+};
+static const int NUM_BENCH_SCENES = sizeof( g_benchScenes ) / sizeof( g_benchScenes[ 0 ] );
+
+/*
+====================================================
+phaseStats_t
+====================================================
+*/
+struct phaseStats_t {
+	float mean;
+	float min;
+	float p50;
+	float p90;
+	float p99;
+	float max;
+};
+
+/*
+====================================================
+Percentile
+
+Nearest rank percentile of already sorted samples
+====================================================
+*/
+static float Percentile( const std::vector< float > & sorted, const float percent ) {
+	int rank = (int)ceilf( percent * 0.01f * sorted.size() ) - 1;
+	rank = std::max( 0, std::min( rank, (int)sorted.size() - 1 ) );
+	return sorted[ rank ];
+}
+
+/*
+====================================================
+CalculateStats
+====================================================
+*/
+static phaseStats_t CalculateStats( std::vector< float > samples ) {
+	phaseStats_t stats = {};
+	if ( samples.empty() ) {
+		return stats;
+	}
+
+	std::sort( samples.begin(), samples.end() );
+	double sum = 0.0;
+	for ( int i = 0; i < samples.size(); i++ ) {
+		sum += samples[ i ];
+	}
+	stats.mean = float( sum / samples.size() );
+	stats.min = samples.front();
+	stats.p50 = Percentile( samples, 50.0f );
+	stats.p90 = Percentile( samples, 90.0f );
+	stats.p99 = Percentile( samples, 99.0f );
+	stats.max = samples.back();
+	return stats;
+}
+
+/*
+====================================================
+sceneResult_t
+====================================================
+*/
+enum benchPhase_t {
+	PHASE_BROADPHASE,
+	PHASE_NARROWPHASE,
+	PHASE_SOLVE,
+	PHASE_INTEGRATE,
+	PHASE_TOTAL,
+	NUM_PHASES,
+};
+
+static const char * g_phaseNames[ NUM_PHASES ] = { "broadphase", "narrowphase", "solve", "integrate", "total" };
+
+struct sceneResult_t {
+	const char * name;
+	int numBodies;
+	int numConstraints;
+	float buildMS;
+	phaseStats_t phases[ NUM_PHASES ];
+	float maxSpeed;		// fastest body at the end, a quick check that the scene did not explode
+};
+
+/*
+====================================================
+RunScene
+====================================================
+*/
+static sceneResult_t RunScene( const benchScene_t & benchScene, const int warmupFrames, const int numFrames ) {
+	typedef std::chrono::steady_clock benchClock_t;
+
+	sceneResult_t result = {};
+	result.name = benchScene.name;
+
+	Scene scene;
+	const benchClock_t::time_point buildStart = benchClock_t::now();
+	benchScene.build( scene );
+	result.buildMS = std::chrono::duration< float, std::milli >( benchClock_t::now() - buildStart ).count();
+	result.numBodies = (int)scene.m_bodies.size();
+	result.numConstraints = (int)scene.m_constraints.size();
+	for ( int i = 0; i < scene.m_articulations.size(); i++ ) {
+		result.numConstraints += scene.m_articulations[ i ]->GetNumJoints();
+	}
+
+	std::vector< float > samples[ NUM_PHASES ];
+	for ( int i = 0; i < NUM_PHASES; i++ ) {
+		samples[ i ].reserve( numFrames );
+	}
+
+	for ( int frame = 0; frame < warmupFrames + numFrames; frame++ ) {
+		scene.Update( BENCH_DT );
+		if ( frame < warmupFrames ) {
+			continue;
+		}
+
+		const sceneTimings_t & timings = scene.m_timings;
+		samples[ PHASE_BROADPHASE ].push_back( timings.broadphase );
+		samples[ PHASE_NARROWPHASE ].push_back( timings.narrowphase );
+		samples[ PHASE_SOLVE ].push_back( timings.solve );
+		samples[ PHASE_INTEGRATE ].push_back( timings.integrate );
+		samples[ PHASE_TOTAL ].push_back( timings.broadphase + timings.narrowphase + timings.solve + timings.integrate );
+	}
+
+	for ( int i = 0; i < NUM_PHASES; i++ ) {
+		result.phases[ i ] = CalculateStats( samples[ i ] );
+	}
+	for ( int i = 0; i < scene.m_bodies.size(); i++ ) {
+		result.maxSpeed = std::max( result.maxSpeed, scene.m_bodies[ i ].m_linearVelocity.GetMagnitude() );
+	}
+	return result;
+}
+
+/*
+====================================================
+PrintTable
+====================================================
+*/
+static void PrintTable( const std::vector< sceneResult_t > & results ) {
+	for ( int i = 0; i < results.size(); i++ ) {
+		const sceneResult_t & result = results[ i ];
+		printf( "%s: %d bodies, %d joints, build %.1f ms, max speed %.2f\n", result.name, result.numBodies, result.numConstraints, result.buildMS, result.maxSpeed );
+		printf( "    %-12s %9s %9s %9s %9s %9s %9s\n", "phase (ms)", "mean", "min", "p50", "p90", "p99", "max" );
+		for ( int p = 0; p < NUM_PHASES; p++ ) {
+			const phaseStats_t & s = result.phases[ p ];
+			printf( "    %-12s %9.3f %9.3f %9.3f %9.3f %9.3f %9.3f\n", g_phaseNames[ p ], s.mean, s.min, s.p50, s.p90, s.p99, s.max );
+		}
+	}
+}
+
+/*
+====================================================
+WriteJSON
+====================================================
+*/
+static void WriteJSON( FILE * file, const std::vector< sceneResult_t > & results, const char * label, const int warmupFrames, const int numFrames ) {
+	fprintf( file, "{\n" );
+	fprintf( file, "  \"label\": \"%s\",\n", label );
+	fprintf( file, "  \"dt\": %g,\n", BENCH_DT );
+	fprintf( file, "  \"warmup\": %d,\n", warmupFrames );
+	fprintf( file, "  \"frames\": %d,\n", numFrames );
+	fprintf( file, "  \"scenes\": [\n" );
+	for ( int i = 0; i < results.size(); i++ ) {
+		const sceneResult_t & result = results[ i ];
+		fprintf( file, "    {\n" );
+		fprintf( file, "      \"name\": \"%s\",\n", result.name );
+		fprintf( file, "      \"bodies\": %d,\n", result.numBodies );
+		fprintf( file, "      \"joints\": %d,\n", result.numConstraints );
+		fprintf( file, "      \"build_ms\": %.4f,\n", result.buildMS );
+		fprintf( file, "      \"max_speed\": %.4f,\n", result.maxSpeed );
+		fprintf( file, "      \"phases_ms\": {\n" );
+		for ( int p = 0; p < NUM_PHASES; p++ ) {
+			const phaseStats_t & s = result.phases[ p ];
+			fprintf( file, "        \"%s\": { \"mean\": %.4f, \"min\": %.4f, \"p50\": %.4f, \"p90\": %.4f, \"p99\": %.4f, \"max\": %.4f }%s\n",
+				g_phaseNames[ p ], s.mean, s.min, s.p50, s.p90, s.p99, s.max, ( p + 1 < NUM_PHASES ) ? "," : "" );
+		}
+		fprintf( file, "      }\n" );
+		fprintf( file, "    }%s\n", ( i + 1 < results.size() ) ? "," : "" );
+	}
+	fprintf( file, "  ]\n" );
+	fprintf( file, "}\n" );
+}
+
+/*
+====================================================
+CapsuleGap
+
+Distance between the surfaces of a character and a body,
+negative while they overlap
+====================================================
+*/
+static float CapsuleGap( const CharacterController & cc, const Body & body ) {
+	const Vec3 axis( 0.0f, 0.0f, cc.GetHalfHeight() );
+	Vec3 ptSeg;
+	Vec3 ptBody;
+	GJK_ClosestPoints( cc.m_position - axis, cc.m_position + axis, &body, ptSeg, ptBody );
+	const float dist = ( ptSeg - ptBody ).GetMagnitude();
+	return ( dist < 1e-6f ) ? -1.0f : dist - cc.m_radius;
+}
+
+/*
+====================================================
+CheckBodyPushedIntoCharacter
+
+A character stands on the ground and a box is then moved
+into it, the next move has to leave the character outside
+of the box.  Tried with the character's axis inside the box
+and with only its surface overlapping.
+====================================================
+*/
+static bool CheckBodyPushedIntoCharacter( const float boxOffset ) {
+	std::vector< Body > bodies( 2 );
+	bodies[ 0 ].m_shape = MakeBox( Vec3( 10.0f, 10.0f, 1.0f ) );
+	bodies[ 0 ].m_position = Vec3( 0.0f, 0.0f, -1.0f );
+	bodies[ 0 ].m_invMass = 0.0f;
+	bodies[ 1 ].m_shape = MakeBox( Vec3( 0.5f ) );
+	bodies[ 1 ].m_position = Vec3( 5.0f, 0.0f, 0.5f );
+
+	castWorld_t world = {};
+	world.bodies = bodies.data();
+	world.numBodies = (int)bodies.size();
+
+	CharacterController cc;
+	cc.m_position = Vec3( 0.0f, 0.0f, 0.5f * cc.m_height + cc.m_skinWidth );
+	const Vec3 still( 0.0f );
+	for ( int i = 0; i < 4; i++ ) {
+		MoveCharacters( world, &cc, &still, 1 );
+	}
+	const bool wasGrounded = cc.m_isGrounded;
+
+	bodies[ 1 ].m_position = Vec3( boxOffset, 0.0f, 0.5f );
+	MoveCharacters( world, &cc, &still, 1 );
+
+	const float gap = CapsuleGap( cc, bodies[ 1 ] );
+	const bool passed = wasGrounded && gap > -1e-3f;
+	printf( "%s: box moved to %.2f from a standing character, gap %.4f%s\n", passed ? "ok" : "FAILED", boxOffset, gap, wasGrounded ? "" : ", never stood on the ground" );
+
+	for ( Body & body : bodies ) {
+		delete body.m_shape;
+	}
+	return passed;
+}
+
+/*
+====================================================
+CheckCharactersPushedTogether
+
+Two characters that start inside each other end up apart
+====================================================
+*/
+static bool CheckCharactersPushedTogether() {
+	Body ground;
+	ground.m_shape = MakeBox( Vec3( 10.0f, 10.0f, 1.0f ) );
+	ground.m_position = Vec3( 0.0f, 0.0f, -1.0f );
+	ground.m_invMass = 0.0f;
+
+	castWorld_t world = {};
+	world.bodies = &ground;
+	world.numBodies = 1;
+
+	CharacterController characters[ 2 ];
+	characters[ 0 ].m_position = Vec3( 0.0f, 0.0f, 0.5f * characters[ 0 ].m_height + characters[ 0 ].m_skinWidth );
+	characters[ 1 ].m_position = characters[ 0 ].m_position + Vec3( 0.2f, 0.1f, 0.0f );
+	const Vec3 still[ 2 ] = { Vec3( 0.0f ), Vec3( 0.0f ) };
+	MoveCharacters( world, characters, still, 2 );
+
+	Vec3 offset = characters[ 1 ].m_position - characters[ 0 ].m_position;
+	offset.z = 0.0f;
+	const float gap = offset.GetMagnitude() - characters[ 0 ].m_radius - characters[ 1 ].m_radius;
+	const bool passed = gap > -1e-3f;
+	printf( "%s: two characters inside each other, gap %.4f\n", passed ? "ok" : "FAILED", gap );
+
+	delete ground.m_shape;
+	return passed;
+}
+
+/*
+====================================================
+RunChecks
+====================================================
+*/
+static int RunChecks() {
+	bool passed = true;
+	passed &= CheckBodyPushedIntoCharacter( 0.2f );
+	passed &= CheckBodyPushedIntoCharacter( 0.7f );
+	passed &= CheckCharactersPushedTogether();
+	if ( !passed ) {
+		printf( "Character checks failed\n" );
+		return 1;
+	}
+	return 0;
+}
+
+/*
+====================================================
+main
+====================================================
+*/
+int main( int argc, char * argv[] ) {
+	int numFrames = 300;
+	int warmupFrames = 30;
+	const char * sceneName = NULL;
+	const char * jsonPath = NULL;
+	const char * label = "";
+
+	for ( int i = 1; i < argc; i++ ) {
+		const bool hasValue = ( i + 1 < argc );
+		if ( 0 == strcmp( argv[ i ], "--frames" ) && hasValue ) {
+			numFrames = std::max( 1, atoi( argv[ ++i ] ) );
+		} else if ( 0 == strcmp( argv[ i ], "--warmup" ) && hasValue ) {
+			warmupFrames = std::max( 0, atoi( argv[ ++i ] ) );
+		} else if ( 0 == strcmp( argv[ i ], "--scene" ) && hasValue ) {
+			sceneName = argv[ ++i ];
+		} else if ( 0 == strcmp( argv[ i ], "--json" ) && hasValue ) {
+			jsonPath = argv[ ++i ];
+		} else if ( 0 == strcmp( argv[ i ], "--label" ) && hasValue ) {
+			label = argv[ ++i ];
+		} else if ( 0 == strcmp( argv[ i ], "--check" ) ) {
+			return RunChecks();
+		} else {
+			printf( "usage: physics_bench [--frames N] [--warmup N] [--scene name] [--json file|-] [--label text] [--check]\n" );
+			printf( "scenes:" );
+			for ( int s = 0; s < NUM_BENCH_SCENES; s++ ) {
+				printf( " %s", g_benchScenes[ s ].name );
+			}
+			printf( "\n" );
+			return 1;
+		}
+	}
+
+	std::vector< sceneResult_t > results;
+	for ( int i = 0; i < NUM_BENCH_SCENES; i++ ) {
+		if ( NULL != sceneName && 0 != strcmp( sceneName, g_benchScenes[ i ].name ) ) {
+			continue;
+		}
+		results.push_back( RunScene( g_benchScenes[ i ], warmupFrames, numFrames ) );
+	}
+	if ( results.empty() ) {
+		printf( "Unknown scene: %s\n", sceneName );
+		return 1;
+	}
+
+	const bool jsonToStdout = ( NULL != jsonPath && 0 == strcmp( jsonPath, "-" ) );
+	if ( !jsonToStdout ) {
+		PrintTable( results );
+	}
+
+	if ( NULL != jsonPath ) {
+		FILE * file = jsonToStdout ? stdout : fopen( jsonPath, "w" );
+		if ( NULL == file ) {
+			printf( "Failed to open %s\n", jsonPath );
+			return 1;
+		}
+		WriteJSON( file, results, label, warmupFrames, numFrames );
+		if ( !jsonToStdout ) {
+			fclose( file );
+		}
+	}
+	return 0;
+}
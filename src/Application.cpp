@@ -11,8 +11,10 @@
 
 #include <assert.h>
 #include "Fileio.h"
+#include "Parallel.h"
 #include "application.h"
 
+#include "RHI/DebugDraw.h"
 #include "RHI/OffscreenRenderer.h"
 
 #include "Scene.h"
@@ -116,16 +118,14 @@ void Application::Initialize()
         {
             meshPart.MakeVBO(&m_deviceContext);
         }*/
-        ElecNeko::Mesh *mesh = new ElecNeko::Mesh();
-        mesh->LoadFromFile(&m_deviceContext, "lost_empire");
-        mesh->MakeUBO(&m_deviceContext);
-        for (auto& meshPart : mesh->m_meshParts)
-        {
-            meshPart.MakeVBO(&m_deviceContext);
-        }
-        m_meshes.emplace_back(mesh);
+        // The level streams in on the loader threads, UpdateStreaming adds it once it's uploaded
+        ElecNeko::g_textureManager.Initialize(&m_deviceContext);
+        m_assetStreamer.Start(&m_deviceContext, 2);
+        m_pendingMeshes.push_back(m_assetStreamer.LoadMesh(new ElecNeko::Mesh(), "lost_empire"));
     }
 
+    m_character.m_position = m_cameraPosition - Vec3(0, 0, m_eyeHeight);
+
     m_mousePosition = Vec2(0, 0);
     m_cameraPositionTheta = acosf(-1.0f) / 2.0f;
     m_cameraPositionPhi = 0;
@@ -421,6 +421,16 @@ Application::Cleanup
 */
 void Application::Cleanup()
 {
+    // Waits for the loader threads and any upload still in flight
+    m_assetStreamer.Stop();
+    for (const ElecNeko::assetHandle_t handle : m_pendingMeshes)
+    {
+        ElecNeko::Mesh *mesh = m_assetStreamer.GetMesh(handle);
+        mesh->Cleanup(&m_deviceContext);
+        delete mesh;
+    }
+    m_pendingMeshes.clear();
+
     CleanupOffscreen(&m_deviceContext);
 
     m_copyShader.Cleanup(&m_deviceContext);
@@ -450,9 +460,13 @@ void Application::Cleanup()
     for (auto& mesh : m_meshes)
     {
         mesh->Cleanup(&m_deviceContext);
+        delete mesh;
     }
     m_meshes.clear();
 
+    // Every mesh has released its textures, the ones still cached go now
+    ElecNeko::g_textureManager.Cleanup(&m_deviceContext);
+
     // Delete Uniform Buffer Memory
     m_uniformBuffer.Cleanup(&m_deviceContext);
 
@@ -570,9 +584,14 @@ void Application::MouseMoved(float x, float y)
     float yawRad = ElecNeko::Radians(m_cameraYaw);
     float pitchRad = ElecNeko::Radians(m_cameraPitch);
 
-    m_cameraFront = Vec3(cos(pitchRad) * cos(yawRad), cos(pitchRad) * sin(yawRad), sin(pitchRad)).Normalize();
-    m_cameraRight = m_cameraFront.Cross(Vec3(0, 0, 1)).Normalize();
-    m_cameraUp = m_cameraRight.Cross(m_cameraFront).Normalize();
+    typedef MathFunctions<MATH_ACCURACY_CAMERA> cameraMath;
+    float sinYaw, cosYaw, sinPitch, cosPitch;
+    cameraMath::SinCos(yawRad, sinYaw, cosYaw);
+    cameraMath::SinCos(pitchRad, sinPitch, cosPitch);
+
+    m_cameraFront = Vec3(cosPitch * cosYaw, cosPitch * sinYaw, sinPitch).Normalize<MATH_ACCURACY_CAMERA>();
+    m_cameraRight = m_cameraFront.Cross(Vec3(0, 0, 1)).Normalize<MATH_ACCURACY_CAMERA>();
+    m_cameraUp = m_cameraRight.Cross(m_cameraFront).Normalize<MATH_ACCURACY_CAMERA>();
 }
 
 void Application::MouseButtonCallback(GLFWwindow *window, int button, int action, int mods)
@@ -636,7 +655,10 @@ void Application::Keyboard(int key, int scancode, int action, int modifiers)
 {
     if (GLFW_KEY_R == key && GLFW_RELEASE == action)
     {
+        // Reset puts the origin back, keep the camera where it is in the world
+        const Vec3d origin = m_scene->m_origin;
         m_scene->Reset();
+        MoveLocalFrame((origin - m_scene->m_origin).ToVec3());
     }
     if (GLFW_KEY_T == key && GLFW_RELEASE == action)
     {
@@ -646,6 +668,13 @@ void Application::Keyboard(int key, int scancode, int action, int modifiers)
     {
         m_stepFrame = m_isPaused && !m_stepFrame;
     }
+    if (GLFW_KEY_F == key && GLFW_RELEASE == action)
+    {
+        m_isWalking = !m_isWalking;
+        m_character.m_position = m_cameraPosition - Vec3(0, 0, m_eyeHeight);
+        m_character.m_isGrounded = false;
+        m_fallSpeed = 0.0f;
+    }
     if (key == GLFW_KEY_ESCAPE && (GLFW_PRESS == action))
     {
         glfwSetWindowShouldClose(m_glfwWindow, GLFW_TRUE);
@@ -656,6 +685,63 @@ void Application::ProcessKeyboard(float deltaTime)
 {
     float velocity = m_cameraMoveSpeed * deltaTime;
 
+    if (m_isWalking)
+    {
+        // Don't fall through the level while it is still streaming in
+        if (m_scene->m_staticGeometry.IsEmpty() && !m_pendingMeshes.empty())
+        {
+            return;
+        }
+
+        // Large hitches would turn into huge casts, keep the step bounded
+        if (deltaTime > 0.05f)
+        {
+            deltaTime = 0.05f;
+        }
+        velocity = m_cameraMoveSpeed * deltaTime;
+
+        Vec3 front(m_cameraFront.x, m_cameraFront.y, 0);
+        Vec3 right(m_cameraRight.x, m_cameraRight.y, 0);
+        if (front.GetLengthSqr() > 1e-6f)
+            front.Normalize();
+        if (right.GetLengthSqr() > 1e-6f)
+            right.Normalize();
+
+        Vec3 move(0, 0, 0);
+        if (glfwGetKey(m_glfwWindow, GLFW_KEY_W) == GLFW_PRESS)
+            move += front;
+        if (glfwGetKey(m_glfwWindow, GLFW_KEY_S) == GLFW_PRESS)
+            move -= front;
+        if (glfwGetKey(m_glfwWindow, GLFW_KEY_A) == GLFW_PRESS)
+            move -= right;
+        if (glfwGetKey(m_glfwWindow, GLFW_KEY_D) == GLFW_PRESS)
+            move += right;
+        if (move.GetLengthSqr() > 1e-6f)
+            move.Normalize();
+
+        if (m_character.m_isGrounded)
+        {
+            m_fallSpeed = 0.0f;
+            if (glfwGetKey(m_glfwWindow, GLFW_KEY_SPACE) == GLFW_PRESS)
+                m_fallSpeed = -5.0f;
+        }
+        m_fallSpeed += 9.8f * deltaTime;
+
+        Vec3 displacement = move * velocity;
+        displacement.z -= m_fallSpeed * deltaTime;
+
+        const float startZ = m_character.m_position.z;
+        const castWorld_t world = {&m_scene->m_staticGeometry, m_scene->m_bodies.data(), (int) m_scene->m_bodies.size()};
+        MoveCharacters(world, &m_character, &displacement, 1);
+
+        // Bumping a ceiling stops the jump
+        if (m_fallSpeed < 0.0f && m_character.m_position.z - startZ < displacement.z * 0.5f)
+            m_fallSpeed = 0.0f;
+
+        m_cameraPosition = m_character.m_position + Vec3(0, 0, m_eyeHeight);
+        return;
+    }
+
     if (glfwGetKey(m_glfwWindow, GLFW_KEY_W) == GLFW_PRESS)
         m_cameraPosition += m_cameraFront * velocity;
     if (glfwGetKey(m_glfwWindow, GLFW_KEY_S) == GLFW_PRESS)
@@ -806,8 +892,17 @@ void Application::UpdateUniforms()
             camera.matProj.PerspectiveVulkan(fovy, aspect, zNear, zFar);
             camera.matProj = camera.matProj.Transpose();
 
+            // The fov of the projection is horizontal, so it spreads over the width
+            m_lodPixelsPerUnit = 0.5f * (float) windowWidth / tanf(ElecNeko::Radians(fovy * 0.5f));
+
             // camera.matView.LookAt(camPos, camLookAt, camUp);
-            camera.matView.LookAt(m_cameraPosition, m_cameraPosition + m_cameraFront, m_cameraUp);
+            // Rendering is camera relative, the camera sits at the origin and
+            // every model matrix holds its offset from the camera.  MouseMoved
+            // keeps the basis orthonormal, so the view is the inverse of the
+            // camera's frame with right, up and back as its axes
+            Mat4 cameraFrame;
+            cameraFrame.Orient(Vec3(0.0f), m_cameraRight, m_cameraFront * -1.0f);
+            camera.matView = cameraFrame.InverseOrthonormal();
             camera.matView = camera.matView.Transpose();
 
             // Update the uniform buffer for the camera matrices
@@ -823,11 +918,13 @@ void Application::UpdateUniforms()
         // Update the uniform buffer with the shadow camera information
         //
         {
-            Vec3 camPos = Vec3(1, 1, 1) * 75.0f;
-            Vec3 camLookAt = Vec3(0, 0, 0);
+            // Centered on the scene origin, so it follows the camera from sector to sector
+            Vec3 camPos = Vec3(1, 1, 1) * 75.0f - m_cameraPosition;
+            Vec3 camLookAt = Vec3(0, 0, 0) - m_cameraPosition;
             Vec3 camUp = Vec3(0, 0, 1);
-            Vec3 tmp = camPos.Cross(camUp);
-            camUp = tmp.Cross(camPos);
+            const Vec3 camDir = camPos - camLookAt;
+            Vec3 tmp = camDir.Cross(camUp);
+            camUp = tmp.Cross(camDir);
             camUp.Normalize();
 
             extern FrameBuffer g_shadowFrameBuffer;
@@ -844,7 +941,12 @@ void Application::UpdateUniforms()
             camera.matProj.OrthoVulkan(xmin, xmax, ymin, ymax, zNear, zFar);
             camera.matProj = camera.matProj.Transpose();
 
-            camera.matView.LookAt(camPos, camLookAt, camUp);
+            // Same frame as the camera, camUp is already perpendicular to camDir
+            Vec3 camBack = camDir;
+            camBack.Normalize();
+            Mat4 shadowFrame;
+            shadowFrame.Orient(camPos, camUp.Cross(camBack), camBack);
+            camera.matView = shadowFrame.InverseOrthonormal();
             camera.matView = camera.matView.Transpose();
 
             // Update the uniform buffer for the camera matrices
@@ -857,35 +959,124 @@ void Application::UpdateUniforms()
         }
 
         //
-        //	Update the uniform buffer with the body positions/orientations
+        //	Update the uniform buffer with the body positions/orientations,
+        //	gathered into arrays so the matrices are built four at a time on
+        //	the worker threads and written straight into the mapped buffer
         //
-        //for (int i = 0; i < m_scene->m_bodies.size(); i++)
-        //{
-        //    Body &body = m_scene->m_bodies[i];
+        {
+            const uint32_t matrixStride = (uint32_t) m_deviceContext.GetAligendUniformByteOffset(sizeof(Mat4));
+            const VkDeviceSize bufferSize = m_uniformBuffer.m_vkBufferSize;
+            const int maxBodies = (bufferSize > uboByteOffset) ? (int) ((bufferSize - uboByteOffset) / matrixStride) : 0;
+            const int numBodies = std::min(std::min((int) m_scene->m_bodies.size(), (int) m_models.size()), maxBodies);
 
-        //    Vec3 fwd = body.m_orientation.RotatePoint(Vec3(1, 0, 0));
-        //    Vec3 up = body.m_orientation.RotatePoint(Vec3(0, 0, 1));
+            m_bodyTransforms.Resize(numBodies);
+            for (int i = 0; i < numBodies; i++)
+            {
+                const Body &body = m_scene->m_bodies[i];
+                m_bodyTransforms.Set(i, body.m_position - m_cameraPosition, body.m_orientation, Vec3(1.0f));
+            }
 
-        //    Mat4 matOrient;
-        //    matOrient.Orient(body.m_position, fwd, up);
-        //    matOrient = matOrient.Transpose();
+            unsigned char *dst = mappedData + uboByteOffset;
+            ParallelFor(numBodies, 1024, [&](int begin, int end) {
+                BuildMatrices(m_bodyTransforms, begin, end, dst, matrixStride);
+            });
 
-        //    // Update the uniform buffer with the orientation of this body
-        //    memcpy(mappedData + uboByteOffset, matOrient.ToPtr(), sizeof(matOrient));
+            for (int i = 0; i < numBodies; i++)
+            {
+                const Body &body = m_scene->m_bodies[i];
 
-        //    RenderModel renderModel;
-        //    renderModel.model = m_models[i];
-        //    renderModel.uboByteOffset = uboByteOffset;
-        //    renderModel.uboByteSize = sizeof(matOrient);
-        //    renderModel.pos = body.m_position;
-        //    renderModel.orient = body.m_orientation;
-        //    m_renderModels.push_back(renderModel);
+                RenderModel renderModel;
+                renderModel.model = m_models[i];
+                renderModel.uboByteOffset = uboByteOffset;
+                renderModel.uboByteSize = sizeof(Mat4);
+                renderModel.pos = body.m_position;
+                renderModel.orient = body.m_orientation;
+                m_renderModels.push_back(renderModel);
 
-        //    uboByteOffset += m_deviceContext.GetAligendUniformByteOffset(sizeof(matOrient));
-        //}
+                uboByteOffset += matrixStride;
+            }
+        }
 
         m_uniformBuffer.UnmapBuffer(&m_deviceContext);
     }
+
+    //
+    //	The meshes are placed in double, their matrices only change when the camera moves
+    //
+    const Vec3d cameraWorldPosition = m_scene->GetWorldPosition(m_cameraPosition);
+    for (int i = 0; i < (int) m_meshes.size(); i++)
+    {
+        m_meshes[i]->UpdateUBO(&m_deviceContext, cameraWorldPosition);
+    }
+}
+
+/*
+====================================================
+Application::MoveLocalFrame
+
+The camera and the character live in the scene's frame, move them
+along with everything else when the origin is rebased
+====================================================
+*/
+void Application::MoveLocalFrame(const Vec3 &offset)
+{
+    if (offset == Vec3(0.0f))
+    {
+        return;
+    }
+    m_cameraPosition += offset;
+    m_character.m_position += offset;
+}
+
+/*
+====================================================
+Application::UpdateStreaming
+====================================================
+*/
+void Application::UpdateStreaming()
+{
+    // Failed loads never become ready, so the states are checked every frame rather than only when Pump made progress
+    m_assetStreamer.Pump();
+
+    for (int i = (int) m_pendingMeshes.size() - 1; i >= 0; i--)
+    {
+        const ElecNeko::assetState_t state = m_assetStreamer.GetState(m_pendingMeshes[i]);
+        if (state == ElecNeko::ASSET_STATE_FAILED)
+        {
+            // Dropped from the level, walking stops waiting for it
+            printf("ERROR: A level mesh failed to stream and is left out of the scene\n");
+            ElecNeko::Mesh *mesh = m_assetStreamer.GetMesh(m_pendingMeshes[i]);
+            m_pendingMeshes.erase(m_pendingMeshes.begin() + i);
+            mesh->Cleanup(&m_deviceContext);
+            delete mesh;
+            continue;
+        }
+        if (state != ElecNeko::ASSET_STATE_READY)
+        {
+            continue;
+        }
+
+        ElecNeko::Mesh *mesh = m_assetStreamer.GetMesh(m_pendingMeshes[i]);
+        m_pendingMeshes.erase(m_pendingMeshes.begin() + i);
+        mesh->MakeUBO(&m_deviceContext);
+        m_meshes.push_back(mesh);
+
+        // The level is static, so its collision is baked once in world space
+        std::vector<Vec3> worldVerts;
+        for (auto &meshPart : mesh->m_meshParts)
+        {
+            worldVerts.resize(meshPart.m_vertices.size());
+            for (size_t v = 0; v < meshPart.m_vertices.size(); v++)
+            {
+                const float *xyz = meshPart.m_vertices[v].position;
+                const Vec3 scaled(xyz[0] * mesh->scale.x, xyz[1] * mesh->scale.y, xyz[2] * mesh->scale.z);
+                worldVerts[v] = m_scene->GetLocalPosition(mesh->pos) + mesh->rot.RotatePoint(scaled);
+            }
+            m_scene->m_staticGeometry.AddTriangles(worldVerts.data(), (int) worldVerts.size(), meshPart.m_indices.data(),
+                                                   (int) meshPart.m_indices.size());
+        }
+        m_scene->m_staticGeometry.Build();
+    }
 }
 
 /*
@@ -914,8 +1105,29 @@ void Application::DrawFrame()
         totalTime = 0.0f;
     }
 
+    UpdateStreaming();
     ProcessKeyboard(deltaTime.count());
+    MoveLocalFrame(m_scene->RebaseOrigin(m_cameraPosition));
     UpdateUniforms();
+
+    //
+    //	Gather the debug lines, they are uploaded and drawn inside DrawOffscreen
+    //
+    extern DebugDraw g_debugDraw;
+    g_debugDraw.Clear();
+    g_debugDraw.SetViewOrigin(m_cameraPosition);
+    if (m_drawContacts)
+    {
+        g_debugDraw.AddContacts(m_scene->m_manifolds);
+    }
+    if (m_drawBounds)
+    {
+        g_debugDraw.AddBodyBounds(m_scene->m_bodies.data(), (int) m_scene->m_bodies.size());
+    }
+    if (m_drawConstraints)
+    {
+        g_debugDraw.AddConstraints(m_scene->m_constraints.data(), (int) m_scene->m_constraints.size());
+    }
     //
     //	Begin the render frame
     //
@@ -923,7 +1135,7 @@ void Application::DrawFrame()
 
     // Draw everything in an offscreen buffer
     //DrawOffscreen(&m_deviceContext, imageIndex, &m_uniformBuffer, m_renderModels.data(), (int) m_renderModels.size());
-    ElecNeko::DrawOffscreen(&m_deviceContext, imageIndex, &m_uniformBuffer, m_meshes);
+    ElecNeko::DrawOffscreen(&m_deviceContext, imageIndex, &m_uniformBuffer, m_meshes, m_lodPixelsPerUnit);
     //
     //	Draw the offscreen framebuffer to the swap chain frame buffer
     //
@@ -951,6 +1163,10 @@ void Application::DrawFrame()
         ImGui::Begin("Settings");
         ImGui::Text(m_deviceContext.m_physicalDevices[m_deviceContext.m_deviceIndex].m_vkDeviceProperties.deviceName);
         ImGui::Text("FPS: %.1f", fps);
+        ImGui::Checkbox("Contacts", &m_drawContacts);
+        ImGui::Checkbox("Bounds", &m_drawBounds);
+        ImGui::Checkbox("Constraints", &m_drawConstraints);
+        ImGui::Text("Debug lines: %d", g_debugDraw.GetNumLines());
         ImGui::End();
 
         ImGui::Render();
@@ -6,10 +6,22 @@
 #include <stdlib.h>
 #include <assert.h>
 #include <string.h>
+#include <stdint.h>
 
 #include <direct.h>
 #define GetCurrentDir _getcwd
 
+#ifdef _WIN32
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
 static char g_ApplicationDirectory[ FILENAME_MAX ];
 static bool g_WasInitialized = false;
 
@@ -139,4 +151,135 @@ bool SaveFileData( const char * fileNameLocal, const void * data, unsigned int s
 	fclose( file );
 	printf( "Write file was success %s\n", fileName );
 	return true;
-}
\ No newline at end of file
+}
+
+/*
+====================================================
+HashData
+
+64 bit hash over 8 bytes a step, in the spirit of xxhash.  Good enough
+to tell changed files apart, not for anything adversarial.
+====================================================
+*/
+static uint64_t RotateLeft( const uint64_t x, const int bits ) {
+	return ( x << bits ) | ( x >> ( 64 - bits ) );
+}
+
+uint64_t HashData( const void * data, size_t size, uint64_t seed ) {
+	const uint64_t prime1 = 0x9E3779B185EBCA87ULL;
+	const uint64_t prime2 = 0xC2B2AE3D27D4EB4FULL;
+	const uint64_t prime3 = 0x165667B19E3779F9ULL;
+
+	const unsigned char * bytes = (const unsigned char *)data;
+	uint64_t hash = seed ^ ( (uint64_t)size * prime1 );
+
+	while ( size >= 8 ) {
+		uint64_t word;
+		memcpy( &word, bytes, 8 );
+		hash ^= RotateLeft( word * prime2, 31 ) * prime1;
+		hash = RotateLeft( hash, 27 ) * prime1 + prime3;
+		bytes += 8;
+		size -= 8;
+	}
+	while ( size > 0 ) {
+		hash ^= (uint64_t)( *bytes ) * prime3;
+		hash = RotateLeft( hash, 11 ) * prime1;
+		bytes++;
+		size--;
+	}
+
+	hash ^= hash >> 33;
+	hash *= prime2;
+	hash ^= hash >> 29;
+	hash *= prime3;
+	hash ^= hash >> 32;
+	return hash;
+}
+
+/*
+====================================================
+MappedFile::Open
+====================================================
+*/
+bool MappedFile::Open( const char * fileName ) {
+	Close();
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA( fileName, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL );
+	if ( INVALID_HANDLE_VALUE == file ) {
+		return false;
+	}
+
+	LARGE_INTEGER size;
+	if ( !GetFileSizeEx( file, &size ) || 0 == size.QuadPart ) {
+		// Empty files can't be mapped
+		CloseHandle( file );
+		return false;
+	}
+
+	HANDLE mapping = CreateFileMappingA( file, NULL, PAGE_READONLY, 0, 0, NULL );
+	if ( NULL == mapping ) {
+		CloseHandle( file );
+		return false;
+	}
+
+	void * data = MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+	if ( NULL == data ) {
+		CloseHandle( mapping );
+		CloseHandle( file );
+		return false;
+	}
+
+	m_file = file;
+	m_mapping = mapping;
+	m_size = (size_t)size.QuadPart;
+#else
+	const int file = open( fileName, O_RDONLY );
+	if ( file < 0 ) {
+		return false;
+	}
+
+	struct stat info;
+	if ( fstat( file, &info ) != 0 || 0 == info.st_size ) {
+		close( file );
+		return false;
+	}
+
+	void * data = mmap( NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, file, 0 );
+	if ( MAP_FAILED == data ) {
+		close( file );
+		return false;
+	}
+
+	m_file = (void *)(intptr_t)file;
+	m_size = (size_t)info.st_size;
+#endif
+
+	m_data = (const unsigned char *)data;
+	return true;
+}
+
+/*
+====================================================
+MappedFile::Close
+====================================================
+*/
+void MappedFile::Close() {
+	if ( NULL == m_data ) {
+		return;
+	}
+
+#ifdef _WIN32
+	UnmapViewOfFile( m_data );
+	CloseHandle( (HANDLE)m_mapping );
+	CloseHandle( (HANDLE)m_file );
+#else
+	munmap( (void *)m_data, m_size );
+	close( (int)(intptr_t)m_file );
+#endif
+
+	m_data = NULL;
+	m_size = 0;
+	m_file = NULL;
+	m_mapping = NULL;
+}
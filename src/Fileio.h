@@ -2,6 +2,42 @@
 //	Fileio.h
 //
 #pragma once
+#include <stddef.h>
+#include <stdint.h>
 
 bool GetFileData( const char * fileName, unsigned char ** data, unsigned int & size );
-bool SaveFileData( const char * fileName, const void * data, unsigned int size );
\ No newline at end of file
+bool SaveFileData( const char * fileName, const void * data, unsigned int size );
+
+// Feed the previous hash back in as the seed to hash several blocks together
+uint64_t HashData( const void * data, size_t size, uint64_t seed = 0 );
+
+/*
+====================================================
+MappedFile
+
+Read only view of a whole file through the os file mapping, nothing is
+copied until the pages are touched.  Paths are used as given, like the
+loaders do, not relative to the application directory.
+====================================================
+*/
+class MappedFile {
+public:
+	MappedFile() : m_data( NULL ), m_size( 0 ), m_file( NULL ), m_mapping( NULL ) {}
+	~MappedFile() { Close(); }
+
+	MappedFile( const MappedFile & rhs ) = delete;
+	MappedFile & operator = ( const MappedFile & rhs ) = delete;
+
+	bool Open( const char * fileName );
+	void Close();
+
+	bool IsOpen() const { return NULL != m_data; }
+	const unsigned char * GetData() const { return m_data; }
+	size_t GetSize() const { return m_size; }
+
+private:
+	const unsigned char * m_data;
+	size_t m_size;
+	void * m_file;		// file handle, or the descriptor on posix
+	void * m_mapping;
+};
@@ -0,0 +1,221 @@
+#include "AssetStreamer.h"
+#include "Mesh.h"
+
+#include <cassert>
+
+namespace ElecNeko
+{
+    bool AssetStreamer::Start(DeviceContext *device, const int numThreads)
+    {
+        assert(m_threads.empty());
+        m_device = device;
+        m_quit = false;
+
+        VkFenceCreateInfo fenceInfo = {};
+        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        if (VK_SUCCESS != vkCreateFence(m_device->m_vkDevice, &fenceInfo, nullptr, &m_vkFence))
+        {
+            printf("ERROR: Failed to create the asset upload fence\n");
+            assert(0);
+            return false;
+        }
+
+        for (int i = 0; i < numThreads; i++)
+        {
+            m_threads.emplace_back(&AssetStreamer::LoaderThread, this);
+        }
+        return true;
+    }
+
+    void AssetStreamer::Stop()
+    {
+        if (m_device == nullptr)
+        {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_quit = true;
+            m_queue.clear();
+        }
+        m_wake.notify_all();
+        for (std::thread &thread : m_threads)
+        {
+            thread.join();
+        }
+        m_threads.clear();
+
+        if (m_vkCommandBuffer != VK_NULL_HANDLE)
+        {
+            vkWaitForFences(m_device->m_vkDevice, 1, &m_vkFence, VK_TRUE, UINT64_MAX);
+            RetireUpload();
+        }
+        vkDestroyFence(m_device->m_vkDevice, m_vkFence, nullptr);
+        m_vkFence = VK_NULL_HANDLE;
+        m_device = nullptr;
+    }
+
+    assetHandle_t AssetStreamer::LoadMesh(Mesh *mesh, const std::string &name)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        request_t request;
+        request.mesh = mesh;
+        request.name = name;
+        request.state = ASSET_STATE_QUEUED;
+        m_requests.push_back(request);
+
+        const assetHandle_t handle = static_cast<assetHandle_t>(m_requests.size() - 1);
+        m_queue.push_back(handle);
+        m_wake.notify_one();
+        return handle;
+    }
+
+    assetState_t AssetStreamer::GetState(const assetHandle_t handle)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        assert(handle >= 0 && handle < static_cast<int>(m_requests.size()));
+        return m_requests[handle].state;
+    }
+
+    Mesh *AssetStreamer::GetMesh(const assetHandle_t handle)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        assert(handle >= 0 && handle < static_cast<int>(m_requests.size()));
+        return m_requests[handle].mesh;
+    }
+
+    void AssetStreamer::LoaderThread()
+    {
+        while (true)
+        {
+            assetHandle_t handle;
+            Mesh *mesh;
+            std::string name;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wake.wait(lock, [this]() { return m_quit || !m_queue.empty(); });
+                if (m_quit)
+                {
+                    return;
+                }
+
+                handle = m_queue.front();
+                m_queue.pop_front();
+                m_requests[handle].state = ASSET_STATE_LOADING;
+                mesh = m_requests[handle].mesh;
+                name = m_requests[handle].name;
+            }
+
+            // The slow part runs unlocked, nobody else touches this mesh until it is loaded
+            const bool result = mesh->LoadData(name);
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (result)
+            {
+                m_requests[handle].state = ASSET_STATE_LOADED;
+                m_loaded.push_back(handle);
+            }
+            else
+            {
+                printf("Failed to stream mesh: %s\n", name.c_str());
+                m_requests[handle].state = ASSET_STATE_FAILED;
+            }
+        }
+    }
+
+    int AssetStreamer::RetireUpload()
+    {
+        for (Buffer &stagingBuffer : m_stagingBuffers)
+        {
+            stagingBuffer.Cleanup(m_device);
+        }
+        m_stagingBuffers.clear();
+
+        vkFreeCommandBuffers(m_device->m_vkDevice, m_device->m_vkCommandPool, 1, &m_vkCommandBuffer);
+        m_vkCommandBuffer = VK_NULL_HANDLE;
+        vkResetFences(m_device->m_vkDevice, 1, &m_vkFence);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const assetHandle_t handle : m_uploading)
+        {
+            m_requests[handle].state = ASSET_STATE_READY;
+        }
+        for (const assetHandle_t handle : m_failedUploads)
+        {
+            m_requests[handle].state = ASSET_STATE_FAILED;
+        }
+
+        const int numReady = static_cast<int>(m_uploading.size());
+        m_uploading.clear();
+        m_failedUploads.clear();
+        return numReady;
+    }
+
+    int AssetStreamer::Pump()
+    {
+        // Only one batch is in flight, the next one waits until the gpu is done with it
+        int numReady = 0;
+        if (m_vkCommandBuffer != VK_NULL_HANDLE)
+        {
+            if (VK_SUCCESS != vkGetFenceStatus(m_device->m_vkDevice, m_vkFence))
+            {
+                return 0;
+            }
+            numReady = RetireUpload();
+        }
+
+        std::vector<Mesh *> meshes;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_uploading.swap(m_loaded);
+            for (const assetHandle_t handle : m_uploading)
+            {
+                m_requests[handle].state = ASSET_STATE_UPLOADING;
+                meshes.push_back(m_requests[handle].mesh);
+            }
+        }
+        if (m_uploading.empty())
+        {
+            return numReady;
+        }
+
+        // Vertex and index buffers are host visible, only the textures go through the command buffer.
+        // A mesh whose buffers can't be made isn't drawable, it stays in the batch until the gpu is
+        // done with its textures and is then marked failed instead of ready.
+        m_vkCommandBuffer = m_device->CreateCommandBuffer(VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+        std::vector<assetHandle_t> uploaded;
+        for (size_t i = 0; i < meshes.size(); i++)
+        {
+            Mesh *mesh = meshes[i];
+            mesh->UploadTextures(m_device, m_vkCommandBuffer, m_stagingBuffers);
+
+            bool result = true;
+            for (MeshPart &meshPart : mesh->m_meshParts)
+            {
+                result = meshPart.MakeVBO(m_device) && result;
+            }
+
+            if (result)
+            {
+                uploaded.push_back(m_uploading[i]);
+            }
+            else
+            {
+                printf("Failed to upload mesh: %s\n", m_requests[m_uploading[i]].name.c_str());
+                m_failedUploads.push_back(m_uploading[i]);
+            }
+        }
+        m_uploading.swap(uploaded);
+        vkEndCommandBuffer(m_vkCommandBuffer);
+
+        VkSubmitInfo submitInfo = {};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &m_vkCommandBuffer;
+        vkQueueSubmit(m_device->m_vkGraphicsQueue, 1, &submitInfo, m_vkFence);
+
+        return numReady;
+    }
+}
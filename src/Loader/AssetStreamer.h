@@ -0,0 +1,89 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "RHI/Buffer.h"
+
+namespace ElecNeko
+{
+    class Mesh;
+
+    typedef int assetHandle_t;
+    const assetHandle_t INVALID_ASSET_HANDLE = -1;
+
+    enum assetState_t
+    {
+        ASSET_STATE_QUEUED,    // waiting for a loader thread
+        ASSET_STATE_LOADING,   // file io, parsing and decoding on a loader thread
+        ASSET_STATE_LOADED,    // waiting for the next Pump to record its upload
+        ASSET_STATE_UPLOADING, // in the batch the gpu is copying
+        ASSET_STATE_READY,     // drawable
+        ASSET_STATE_FAILED,
+    };
+
+    /*
+    ====================================================
+    AssetStreamer
+
+    Loads assets on background threads.  A request returns a handle right
+    away, a loader thread does the file io, parsing and decoding, and
+    Pump, called once a frame on the main thread, records the uploads of
+    everything that finished since the last call into one command buffer.
+    The batch is submitted with a fence that later Pumps poll, nothing
+    waits on the gpu.  The mesh passed in belongs to the streamer until
+    its state is ready or failed, don't touch it before that.
+    ====================================================
+    */
+    class AssetStreamer
+    {
+    public:
+        AssetStreamer() : m_device(nullptr), m_quit(false), m_vkFence(VK_NULL_HANDLE), m_vkCommandBuffer(VK_NULL_HANDLE) {}
+        ~AssetStreamer() { Stop(); }
+
+        bool Start(DeviceContext *device, const int numThreads);
+        void Stop(); // waits for the loader threads and the upload in flight, queued requests are dropped
+
+        // Requests and Pump are for the main thread
+        assetHandle_t LoadMesh(Mesh *mesh, const std::string &name);
+        assetState_t GetState(const assetHandle_t handle);
+        Mesh *GetMesh(const assetHandle_t handle);
+
+        int Pump(); // returns how many assets became ready, uploads that fail become failed
+
+    private:
+        void LoaderThread();
+        int RetireUpload();
+
+        struct request_t
+        {
+            Mesh *mesh;
+            std::string name;
+            assetState_t state;
+        };
+
+        DeviceContext *m_device;
+
+        // Everything below is shared with the loader threads and guarded by m_mutex,
+        // except the upload batch which only the main thread touches
+        std::mutex m_mutex;
+        std::condition_variable m_wake;
+        std::vector<std::thread> m_threads;
+        bool m_quit;
+
+        std::deque<request_t> m_requests; // indexed by handle, a deque so growing it keeps the references
+        std::deque<assetHandle_t> m_queue;
+        std::vector<assetHandle_t> m_loaded;
+
+        // The batch in flight
+        VkFence m_vkFence;
+        VkCommandBuffer m_vkCommandBuffer;
+        std::vector<assetHandle_t> m_uploading;
+        std::vector<assetHandle_t> m_failedUploads; // in the batch too, marked failed once the gpu is done with it
+        std::vector<Buffer> m_stagingBuffers;
+    };
+}
@@ -3,48 +3,169 @@
 #include "Mesh.h"
 
 #include <unordered_map>
+#include <algorithm>
 #include <cassert>
+#include <cstring>
+#include <cmath>
 
 #include "tiny_obj_loader.h"
 
+#include "MeshCache.h"
+#include "MeshOptimizer.h"
+#include "../Parallel.h"
+#include "../Math/Transforms.h"
+#include "../Math/FastMath.h"
+
 namespace ElecNeko
 {
+    static uint16_t QuantizeUnorm16(const float value)
+    {
+        const float scaled = value * 65535.0f + 0.5f;
+        if (!(scaled > 0.0f))
+        {
+            return 0;
+        }
+        return (scaled >= 65535.0f) ? 65535 : static_cast<uint16_t>(scaled);
+    }
+
+    static int16_t QuantizeSnorm16(const float value)
+    {
+        const float clamped = (value < -1.0f) ? -1.0f : ((value > 1.0f) ? 1.0f : value);
+        return static_cast<int16_t>(lrintf(clamped * 32767.0f));
+    }
+
+    // Projects the unit normal onto the octahedron |x| + |y| + |z| = 1 and folds
+    // the lower half over the diagonals, so two values cover the whole sphere
+    static void EncodeOctahedral(const float *normal, int16_t *encoded)
+    {
+        const float length = fabsf(normal[0]) + fabsf(normal[1]) + fabsf(normal[2]);
+        if (length <= 0.0f)
+        {
+            encoded[0] = encoded[1] = 0; // +z
+            return;
+        }
+
+        float x = normal[0] / length;
+        float y = normal[1] / length;
+        if (normal[2] < 0.0f)
+        {
+            const float foldX = (1.0f - fabsf(y)) * ((x >= 0.0f) ? 1.0f : -1.0f);
+            const float foldY = (1.0f - fabsf(x)) * ((y >= 0.0f) ? 1.0f : -1.0f);
+            x = foldX;
+            y = foldY;
+        }
+        encoded[0] = QuantizeSnorm16(x);
+        encoded[1] = QuantizeSnorm16(y);
+    }
+
+    void MeshPart::Quantize(const Bounds &bounds)
+    {
+        // Positions use the bounds passed in, so parts that share an edge land on the same grid
+        const float posMins[3] = {bounds.mins.x, bounds.mins.y, bounds.mins.z};
+        const float posExtents[3] = {bounds.WidthX(), bounds.WidthY(), bounds.WidthZ()};
+
+        float uvMins[2] = {0.0f, 0.0f};
+        float uvMaxs[2] = {0.0f, 0.0f};
+        if (!m_vertices.empty())
+        {
+            uvMins[0] = uvMaxs[0] = m_vertices[0].uv[0];
+            uvMins[1] = uvMaxs[1] = m_vertices[0].uv[1];
+        }
+        for (const VVertex &vertex : m_vertices)
+        {
+            for (int k = 0; k < 2; k++)
+            {
+                uvMins[k] = std::min(uvMins[k], vertex.uv[k]);
+                uvMaxs[k] = std::max(uvMaxs[k], vertex.uv[k]);
+            }
+        }
+        const float uvExtents[2] = {uvMaxs[0] - uvMins[0], uvMaxs[1] - uvMins[1]};
+
+        float posInvExtents[3];
+        for (int k = 0; k < 3; k++)
+        {
+            posInvExtents[k] = (posExtents[k] > 0.0f) ? 1.0f / posExtents[k] : 0.0f;
+            m_uniforms.posScale[k] = posExtents[k];
+            m_uniforms.posBias[k] = posMins[k];
+        }
+        m_uniforms.posScale[3] = 0.0f;
+        m_uniforms.posBias[3] = 1.0f;
+
+        float uvInvExtents[2];
+        for (int k = 0; k < 2; k++)
+        {
+            uvInvExtents[k] = (uvExtents[k] > 0.0f) ? 1.0f / uvExtents[k] : 0.0f;
+            m_uniforms.uvScaleBias[k] = uvExtents[k];
+            m_uniforms.uvScaleBias[2 + k] = uvMins[k];
+        }
+
+        m_packedVertices.resize(m_vertices.size());
+        for (size_t i = 0; i < m_vertices.size(); i++)
+        {
+            const VVertex &vertex = m_vertices[i];
+            VVertexPacked &packed = m_packedVertices[i];
+            for (int k = 0; k < 3; k++)
+            {
+                packed.position[k] = QuantizeUnorm16((vertex.position[k] - posMins[k]) * posInvExtents[k]);
+            }
+            packed.position[3] = 0;
+            for (int k = 0; k < 2; k++)
+            {
+                packed.uv[k] = QuantizeUnorm16((vertex.uv[k] - uvMins[k]) * uvInvExtents[k]);
+            }
+            EncodeOctahedral(vertex.normal, packed.normal);
+        }
+    }
+
     bool MeshPart::MakeVBO(DeviceContext* device) 
     { 
         // VkCommandBuffer cmdBuffer = device->m_vkCommandBuffers[0];
         if (m_vertices.empty())
             return true;
 
-        int bufferSize = static_cast<int>(sizeof(VVertex) * m_vertices.size());
-        if (!m_vertexBuffer.Allocate(device, m_vertices.data(), bufferSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT))
+        if (m_packedVertices.size() != m_vertices.size())
         {
-            printf("Failed to allocate vertex buffer!\n");
-            assert(0);
-            return false;
+            m_bounds.Clear();
+            for (const VVertex &vertex : m_vertices)
+            {
+                m_bounds.Expand(Vec3(vertex.position[0], vertex.position[1], vertex.position[2]));
+            }
+            Quantize(m_bounds);
         }
 
-        bufferSize = static_cast<int>(sizeof(uint32_t) * m_indices.size());
-        if (!m_indexBuffer.Allocate(device, m_indices.data(), bufferSize, VK_BUFFER_USAGE_INDEX_BUFFER_BIT))
+        int bufferSize = static_cast<int>(sizeof(VVertexPacked) * m_packedVertices.size());
+        if (!m_vertexBuffer.Allocate(device, m_packedVertices.data(), bufferSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT))
         {
-            printf("Failed to allocate index buffer!\n");
+            printf("Failed to allocate vertex buffer!\n");
             assert(0);
             return false;
         }
+        std::vector<VVertexPacked>().swap(m_packedVertices);
 
-        int hasTex[2] = {0, 0};
-
-        if (albTexIndex > -1)
+        // The coarser levels go after the full one in the same buffer
+        std::vector<uint32_t> allIndices;
+        const uint32_t *indices = m_indices.data();
+        if (!m_lodIndices.empty())
         {
-            hasTex[0] = 1;
+            allIndices.reserve(m_indices.size() + m_lodIndices.size());
+            allIndices.insert(allIndices.end(), m_indices.begin(), m_indices.end());
+            allIndices.insert(allIndices.end(), m_lodIndices.begin(), m_lodIndices.end());
+            indices = allIndices.data();
         }
 
-        if (norTexIndex > -1)
+        bufferSize = static_cast<int>(sizeof(uint32_t) * (m_indices.size() + m_lodIndices.size()));
+        if (!m_indexBuffer.Allocate(device, indices, bufferSize, VK_BUFFER_USAGE_INDEX_BUFFER_BIT))
         {
-            hasTex[1] = 1;
+            printf("Failed to allocate index buffer!\n");
+            assert(0);
+            return false;
         }
-        
-        bufferSize = static_cast<int>(sizeof(int) * 2);
-        if (!m_uniformBuffer.Allocate(device, hasTex, bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT))
+
+        m_uniforms.hasAlbedoMap = (albTexIndex > -1) ? 1 : 0;
+        m_uniforms.hasNormalMap = (norTexIndex > -1) ? 1 : 0;
+
+        bufferSize = static_cast<int>(sizeof(m_uniforms));
+        if (!m_uniformBuffer.Allocate(device, &m_uniforms, bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT))
         {
             printf("Failed to allocate mesh part's uniform buffer!\n");
             assert(0);
@@ -67,7 +188,7 @@ namespace ElecNeko
         m_uniformBuffer.Cleanup(device);
     }
 
-    void MeshPart::DrawIndexed(VkCommandBuffer vkCommandBuffer)
+    void MeshPart::DrawIndexed(VkCommandBuffer vkCommandBuffer, const int lod)
     {
         // bind the model
         VkBuffer vertexBuffers[] = {m_vertexBuffer.m_vkBuffer};
@@ -76,14 +197,159 @@ namespace ElecNeko
         vkCmdBindIndexBuffer(vkCommandBuffer, m_indexBuffer.m_vkBuffer, 0, VK_INDEX_TYPE_UINT32);
 
         // issue draw command
+        if (lod > 0 && lod < (int) m_lods.size())
+        {
+            vkCmdDrawIndexed(vkCommandBuffer, m_lods[lod].numIndices, 1, m_lods[lod].firstIndex, 0, 0);
+            return;
+        }
         vkCmdDrawIndexed(vkCommandBuffer, static_cast<uint32_t>(m_indices.size()), 1, 0, 0, 0);
     }
 
+    int MeshPart::DrawMeshlets(VkCommandBuffer vkCommandBuffer, const Vec3 &viewPos)
+    {
+        VkBuffer vertexBuffers[] = {m_vertexBuffer.m_vkBuffer};
+        VkDeviceSize offsets[] = {0};
+        vkCmdBindVertexBuffers(vkCommandBuffer, 0, 1, vertexBuffers, offsets);
+        vkCmdBindIndexBuffer(vkCommandBuffer, m_indexBuffer.m_vkBuffer, 0, VK_INDEX_TYPE_UINT32);
+
+        // The meshlets are consecutive ranges of m_indices, so a run of visible ones is one draw
+        int numDraws = 0;
+        uint32_t runStart = 0;
+        uint32_t runCount = 0;
+        for (const meshlet_t &meshlet : m_meshlets)
+        {
+            if (IsMeshletBackFacing(meshlet, viewPos))
+            {
+                continue;
+            }
+            if (runCount > 0 && runStart + runCount == meshlet.firstIndex)
+            {
+                runCount += 3 * meshlet.numTriangles;
+                continue;
+            }
+            if (runCount > 0)
+            {
+                vkCmdDrawIndexed(vkCommandBuffer, runCount, 1, runStart, 0, 0);
+                numDraws++;
+            }
+            runStart = meshlet.firstIndex;
+            runCount = 3 * meshlet.numTriangles;
+        }
+        if (runCount > 0)
+        {
+            vkCmdDrawIndexed(vkCommandBuffer, runCount, 1, runStart, 0, 0);
+            numDraws++;
+        }
+        return numDraws;
+    }
+
     bool Mesh::LoadFromFile(DeviceContext *device, const std::string &name)
     { 
-        std::string inputFile = "../res/models/" + name + "/" + name + ".obj";
+        if (!LoadData(name))
+        {
+            return false;
+        }
+
+        std::vector<Buffer> stagingBuffers;
+        VkCommandBuffer cmdBuffer = device->CreateCommandBuffer(VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+        UploadTextures(device, cmdBuffer, stagingBuffers);
+        device->FlushCommandBuffer(cmdBuffer, device->m_vkGraphicsQueue);
+
+        for (Buffer &stagingBuffer : stagingBuffers)
+        {
+            stagingBuffer.Cleanup(device);
+        }
+        return true;
+    }
+
+    bool Mesh::LoadData(const std::string &name)
+    {
+        const std::string modelPath = "../res/models/" + name + "/";
+        const std::string inputFile = modelPath + name + ".obj";
+        const std::string cacheFile = modelPath + name + ".meshcache";
+
+        uint64_t sourceHash = 0;
+        if (!HashMeshSource(inputFile, modelPath, sourceHash))
+        {
+            printf("Failed to read mesh: %s\n", inputFile.c_str());
+            return false;
+        }
+
+        // Parsing the text is slow, only done when the baked cache is missing or stale
+        std::vector<std::string> albedoNames;
+        std::vector<std::string> normalNames;
+        if (!ReadMeshCache(cacheFile, sourceHash, *this, albedoNames, normalNames))
+        {
+            if (!LoadFromObj(inputFile, modelPath, albedoNames, normalNames))
+            {
+                return false;
+            }
+            WriteMeshCache(cacheFile, sourceHash, *this, albedoNames, normalNames);
+        }
+
+        albedoMaps.resize(albedoNames.size());
+        for (size_t i = 0; i < albedoNames.size(); i++)
+        {
+            albedoMaps[i] = g_textureManager.Acquire(modelPath + albedoNames[i], TEXTURE_USAGE_ALBEDO);
+        }
+        normalMaps.resize(normalNames.size());
+        for (size_t i = 0; i < normalNames.size(); i++)
+        {
+            normalMaps[i] = g_textureManager.Acquire(modelPath + normalNames[i], TEXTURE_USAGE_NORMAL);
+        }
+
+        // Parts whose texture failed to load draw without it
+        for (MeshPart &meshPart : m_meshParts)
+        {
+            if (meshPart.albTexIndex >= 0 && albedoMaps[meshPart.albTexIndex] == INVALID_TEXTURE_HANDLE)
+            {
+                meshPart.albTexIndex = -1;
+            }
+            if (meshPart.norTexIndex >= 0 && normalMaps[meshPart.norTexIndex] == INVALID_TEXTURE_HANDLE)
+            {
+                meshPart.norTexIndex = -1;
+            }
+        }
+
+        Quantize();
+        return true;
+    }
+
+    void Mesh::UploadTextures(DeviceContext *device, VkCommandBuffer cmdBuffer, std::vector<Buffer> &stagingBuffers)
+    {
+        // Textures another mesh already uploaded are skipped
+        for (const textureHandle_t handle : albedoMaps)
+        {
+            g_textureManager.Upload(device, handle, cmdBuffer, stagingBuffers);
+        }
+        for (const textureHandle_t handle : normalMaps)
+        {
+            g_textureManager.Upload(device, handle, cmdBuffer, stagingBuffers);
+        }
+
+        // A texture without an image can't be bound, its parts draw without it like after a failed load
+        auto isUploaded = [](const textureHandle_t handle) {
+            const Texture *texture = g_textureManager.GetTexture(handle);
+            return texture != nullptr && texture->isLoaded;
+        };
+        for (MeshPart &meshPart : m_meshParts)
+        {
+            if (meshPart.albTexIndex >= 0 && !isUploaded(albedoMaps[meshPart.albTexIndex]))
+            {
+                meshPart.albTexIndex = -1;
+            }
+            if (meshPart.norTexIndex >= 0 && !isUploaded(normalMaps[meshPart.norTexIndex]))
+            {
+                meshPart.norTexIndex = -1;
+            }
+        }
+    }
+
+    bool Mesh::LoadFromObj(const std::string &inputFile, const std::string &mtlPath, std::vector<std::string> &albedoNames,
+                           std::vector<std::string> &normalNames)
+    {
         tinyobj::ObjReaderConfig readerConfig;
-        readerConfig.mtl_search_path = "../res/models/" + name + "/";
+        readerConfig.mtl_search_path = mtlPath;
 
         tinyobj::ObjReader reader;
 
@@ -105,145 +371,266 @@ namespace ElecNeko
         auto &shapes = reader.GetShapes();
         auto &materials = reader.GetMaterials();
 
-        std::string texPath = readerConfig.mtl_search_path;
-
+        m_meshParts.clear();
         m_meshParts.resize(materials.size() + 1);
 
         std::unordered_map<std::string, int32_t> matAlbTex;
         std::unordered_map<std::string, int32_t> matNorTex;
-        
+
+        // Textures shared between materials are only loaded once
+        auto findOrAdd = [](std::unordered_map<std::string, int32_t> &map, std::vector<std::string> &names, const std::string &texName) {
+            auto it = map.find(texName);
+            if (it != map.end())
+            {
+                return it->second;
+            }
+            const int32_t index = static_cast<int32_t>(names.size());
+            map[texName] = index;
+            names.push_back(texName);
+            return index;
+        };
+
         for (size_t i = 0; i < materials.size(); i++)
         {
             // read albedo map
             if (materials[i].diffuse_texname != "")
             {
-                // if albedo map has been loaded
-                if (matAlbTex.find(materials[i].diffuse_texname) != matAlbTex.end())
-                {
-                    m_meshParts[i + 1].albTexIndex = matAlbTex[materials[i].diffuse_texname];
-                }
-                else
-                {
-                    m_meshParts[i + 1].albTexIndex = albedoMaps.size();
-                    matAlbTex[materials[i].diffuse_texname] = albedoMaps.size();
-
-                    albedoMaps.emplace_back();
-                    albedoMaps.back().LoadTexture(device, texPath + materials[i].diffuse_texname);
-                }
+                m_meshParts[i + 1].albTexIndex = findOrAdd(matAlbTex, albedoNames, materials[i].diffuse_texname);
             }
             //read normal map
             if (materials[i].normal_texname != "")
             {
-                // normalMaps[i].LoadTexture(device, texPath + materials[i].normal_texname);
-                if (matNorTex.find(materials[i].normal_texname) != matNorTex.end())
-                {
-                    m_meshParts[i + 1].norTexIndex = matNorTex[materials[i].normal_texname];
-                }
-                else
-                {
-                    m_meshParts[i + 1].norTexIndex = normalMaps.size();
-                    matNorTex[materials[i].normal_texname] = normalMaps.size();
-
-                    normalMaps.emplace_back();
-                    normalMaps.back().LoadTexture(device, texPath + materials[i].normal_texname);
-                }
+                m_meshParts[i + 1].norTexIndex = findOrAdd(matNorTex, normalNames, materials[i].normal_texname);
             }
             else if (materials[i].bump_texname != "")
             {
-                if (matNorTex.find(materials[i].bump_texname) != matNorTex.end())
-                {
-                    m_meshParts[i + 1].norTexIndex = matNorTex[materials[i].bump_texname];
-                }
-                else
-                {
-                    m_meshParts[i + 1].norTexIndex = normalMaps.size();
-                    matNorTex[materials[i].bump_texname] = normalMaps.size();
-
-                    normalMaps.emplace_back();
-                    normalMaps.back().LoadTexture(device, texPath + materials[i].bump_texname);
-                }
+                m_meshParts[i + 1].norTexIndex = findOrAdd(matNorTex, normalNames, materials[i].bump_texname);
             }
         }
 
-        std::vector<std::unordered_map<VVertex, uint32_t, VVertexHash>> mapVec;
-        mapVec.resize(materials.size() + 1);
-
-        for (const auto& shape : shapes)
+        //
+        //	Gather the faces of each part in file order, so every part can be
+        //	triangulated and deduplicated on its own worker
+        //
+        struct faceRef_t
+        {
+            const tinyobj::index_t *indices;
+            int ngon;
+        };
+        const int numParts = static_cast<int>(m_meshParts.size());
+        std::vector<std::vector<faceRef_t>> partFaces(numParts);
+        std::vector<size_t> partCorners(numParts, 0);
+
+        for (const auto &shape : shapes)
         {
             size_t indexOffset = 0;
             for (size_t n = 0; n < shape.mesh.num_face_vertices.size(); n++)
             {
-                auto ngon = shape.mesh.num_face_vertices[n];
-                auto material_id = shape.mesh.material_ids[n];
+                const int ngon = shape.mesh.num_face_vertices[n];
+                const int partIndex = shape.mesh.material_ids[n] + 1;
+
+                faceRef_t face;
+                face.indices = shape.mesh.indices.data() + indexOffset;
+                face.ngon = ngon;
+                partFaces[partIndex].push_back(face);
+                if (ngon > 2)
+                {
+                    partCorners[partIndex] += 3 * (ngon - 2);
+                }
+
+                indexOffset += ngon;
+            }
+        }
 
-                size_t partIndex = static_cast<size_t>(material_id + 1);
+        auto makeVertex = [&attrib](const tinyobj::index_t &index) {
+            VVertex vertex;
 
-                std::vector<VVertex> faceVerts;
+            vertex.position[0] = attrib.vertices[3 * index.vertex_index + 0];
+            vertex.position[1] = attrib.vertices[3 * index.vertex_index + 1];
+            vertex.position[2] = attrib.vertices[3 * index.vertex_index + 2];
 
-                for (size_t f = 0; f < ngon; f++)
-                {
-                    const auto &index = shape.mesh.indices[indexOffset + f];
+            if (index.texcoord_index >= 0)
+            {
+                vertex.uv[0] = attrib.texcoords[2 * index.texcoord_index + 0];
+                vertex.uv[1] = 1.f - attrib.texcoords[2 * index.texcoord_index + 1];
+            }
+            else
+            {
+                vertex.uv[0] = vertex.uv[1] = 0.f;
+            }
+            if (index.normal_index >= 0)
+            {
+                vertex.normal[0] = attrib.normals[3 * index.normal_index + 0];
+                vertex.normal[1] = attrib.normals[3 * index.normal_index + 1];
+                vertex.normal[2] = attrib.normals[3 * index.normal_index + 2];
+            }
+            else
+            {
+                vertex.normal[0] = 0.f;
+                vertex.normal[1] = 0.f;
+                vertex.normal[2] = 1.f;
+            }
+            return vertex;
+        };
+
+        // The biggest parts go first so they don't end up last on one worker
+        std::vector<int> partOrder(numParts);
+        for (int i = 0; i < numParts; i++)
+        {
+            partOrder[i] = i;
+        }
+        std::sort(partOrder.begin(), partOrder.end(), [&partCorners](const int a, const int b) { return partCorners[a] > partCorners[b]; });
 
-                    VVertex vertex;
+        // Each part is optimized for the vertex cache on the same worker, see MeshOptimizer.h
+        std::vector<meshOptStats_t> partStats(numParts, meshOptStats_t());
+        ParallelFor(numParts, 1, [&](int begin, int end) {
+            for (int p = begin; p < end; p++)
+            {
+                const int partIndex = partOrder[p];
+                const size_t numCorners = partCorners[partIndex];
+                MeshPart &part = m_meshParts[partIndex];
+                if (numCorners == 0)
+                {
+                    continue;
+                }
 
-                    vertex.position[0] = attrib.vertices[3 * index.vertex_index + 0];
-                    vertex.position[1] = attrib.vertices[3 * index.vertex_index + 1];
-                    vertex.position[2] = attrib.vertices[3 * index.vertex_index + 2];
+                part.m_vertices.reserve(numCorners);
+                part.m_indices.reserve(numCorners);
 
-                    if (index.texcoord_index >= 0)
-                    {
-                        vertex.uv[0] = attrib.texcoords[2 * index.texcoord_index + 0];
-                        vertex.uv[1] = 1.f - attrib.texcoords[2 * index.texcoord_index + 1];
-                    }
-                    else
+                // Open addressing with linear probing, at most half full so probes stay short.
+                // Slots hold the index of the vertex in the part, so there is one hash per corner.
+                size_t capacity = 16;
+                while (capacity < numCorners * 2)
+                {
+                    capacity *= 2;
+                }
+                const size_t mask = capacity - 1;
+                const uint32_t emptySlot = 0xFFFFFFFF;
+                std::vector<uint32_t> table(capacity, emptySlot);
+                VVertexHash hasher;
+
+                auto addCorner = [&](const VVertex &vertex) {
+                    size_t slot = hasher(vertex) & mask;
+                    while (table[slot] != emptySlot)
                     {
-                        vertex.uv[0] = vertex.uv[1] = 0.f;
+                        const uint32_t index = table[slot];
+                        if (part.m_vertices[index] == vertex)
+                        {
+                            part.m_indices.push_back(index);
+                            return;
+                        }
+                        slot = (slot + 1) & mask;
                     }
-                    if (index.normal_index >= 0)
+
+                    const uint32_t newIndex = static_cast<uint32_t>(part.m_vertices.size());
+                    table[slot] = newIndex;
+                    part.m_vertices.push_back(vertex);
+                    part.m_indices.push_back(newIndex);
+                };
+
+                // triangulate non-triangle faces as a fan around the first corner
+                for (const faceRef_t &face : partFaces[partIndex])
+                {
+                    if (face.ngon < 3)
                     {
-                        vertex.normal[0] = attrib.normals[3 * index.normal_index + 0];
-                        vertex.normal[1] = attrib.normals[3 * index.normal_index + 1];
-                        vertex.normal[2] = attrib.normals[3 * index.normal_index + 2];
+                        continue;
                     }
-                    else
+
+                    const VVertex first = makeVertex(face.indices[0]);
+                    VVertex prev = makeVertex(face.indices[1]);
+                    for (int v = 1; v < face.ngon - 1; v++)
                     {
-                        vertex.normal[0] = 0.f;
-                        vertex.normal[1] = 0.f;
-                        vertex.normal[2] = 1.f;
+                        const VVertex next = makeVertex(face.indices[v + 1]);
+                        addCorner(first);
+                        addCorner(prev);
+                        addCorner(next);
+                        prev = next;
                     }
-
-                    // m_meshParts[material_id + 1].m_vertices.emplace_back(vertex);
-                    // m_meshParts[material_id + 1].m_indices.emplace_back(m_meshParts[material_id + 1].m_indices.size());
-                    faceVerts.push_back(vertex);
                 }
 
-                // triangulate non-triangle face
-                for (int v = 1; v < ngon - 1; v++)
-                {
-                    VVertex triVerts[3] = {faceVerts[0], faceVerts[v], faceVerts[v + 1]};
+                OptimizeMesh(part.m_vertices, part.m_indices, partStats[partIndex]);
+                BuildMeshLods(part.m_vertices, part.m_indices, part.m_lodIndices, part.m_lods);
+                BuildMeshlets(part.m_vertices, part.m_indices, part.m_meshlets, part.m_meshletVertices, part.m_meshletTriangles);
+            }
+        });
 
-                    for (int k = 0; k < 3; k++)
-                    {
-                        VVertex &vv = triVerts[k];
-                        auto &mpMap = mapVec[partIndex];
+        meshOptStats_t stats = {};
+        for (const meshOptStats_t &partStat : partStats)
+        {
+            stats.numTriangles += partStat.numTriangles;
+            stats.missesBefore += partStat.missesBefore;
+            stats.missesAfter += partStat.missesAfter;
+        }
+        printf("Optimized %s: %llu triangles, ACMR %.3f -> %.3f\n", inputFile.c_str(), (unsigned long long) stats.numTriangles,
+               stats.GetACMRBefore(), stats.GetACMRAfter());
+        return true;
+    }
 
-                        if (mpMap.find(vv) == mpMap.end())
-                        {
-                            uint32_t newIndex = static_cast<uint32_t>(m_meshParts[partIndex].m_vertices.size());
-                            mpMap[vv] = newIndex;
-                            m_meshParts[partIndex].m_vertices.push_back(vv);
-                            m_meshParts[partIndex].m_indices.push_back(newIndex);
-                        }
-                        else
-                        {
-                            m_meshParts[partIndex].m_indices.push_back(mpMap[vv]);
-                        }
-                    }
-                }
+    void Mesh::Quantize()
+    {
+        // One position grid for the whole mesh, bounds per part would open cracks where two materials meet
+        Bounds bounds;
+        for (MeshPart &part : m_meshParts)
+        {
+            part.m_bounds.Clear();
+            for (const VVertex &vertex : part.m_vertices)
+            {
+                part.m_bounds.Expand(Vec3(vertex.position[0], vertex.position[1], vertex.position[2]));
+            }
+            if (!part.m_vertices.empty())
+            {
+                bounds.Expand(part.m_bounds);
+            }
+        }
 
-                indexOffset += ngon;
+        for (MeshPart &part : m_meshParts)
+        {
+            part.Quantize(bounds);
+        }
+    }
+
+    int Mesh::SelectLod(const int partIndex, const float pixelsPerUnit) const
+    {
+        const MeshPart &part = m_meshParts[partIndex];
+        if (part.m_lods.size() <= 1)
+        {
+            return 0;
+        }
+
+        // The distance to the bounding sphere of the part, the camera sits at uboOrigin
+        const Vec3 center = (part.m_bounds.mins + part.m_bounds.maxs) * 0.5f;
+        const float radius = (part.m_bounds.maxs - part.m_bounds.mins).GetMagnitude() * 0.5f;
+        const float maxScale = std::max(std::max(scale.x, scale.y), scale.z);
+        const Vec3 scaledCenter(center.x * scale.x, center.y * scale.y, center.z * scale.z);
+        const Vec3 offset = (pos - uboOrigin).ToVec3() + rot.RotatePoint(scaledCenter);
+        const float distance = MathFunctions<MATH_ACCURACY_LOD>::Sqrt(offset.GetLengthSqr()) - radius * maxScale;
+        if (distance <= 0.0f)
+        {
+            return 0;
+        }
+
+        const float pixelsPerError = pixelsPerUnit * maxScale / distance;
+        for (int lod = (int) part.m_lods.size() - 1; lod > 0; lod--)
+        {
+            if (part.m_lods[lod].error * pixelsPerError <= MESH_LOD_PIXEL_ERROR)
+            {
+                return lod;
             }
         }
+        return 0;
+    }
+
+    bool Mesh::GetLocalViewPosition(Vec3 &viewPos) const
+    {
+        const float maxScale = std::max(std::max(scale.x, scale.y), scale.z);
+        const float minScale = std::min(std::min(scale.x, scale.y), scale.z);
+        if (minScale <= 0.0f || maxScale - minScale > 1e-3f * maxScale)
+        {
+            return false;
+        }
+
+        // Undo the model matrix, the camera sits at uboOrigin
+        viewPos = rot.Inverse().RotatePoint((uboOrigin - pos).ToVec3()) / scale.x;
         return true;
     }
 
@@ -251,16 +638,8 @@ namespace ElecNeko
     {
         // VkCommandBuffer cmdBuffer = device->m_vkCommandBuffers[0];
 
-        Vec3 fwd = rot.RotatePoint(Vec3(1, 0, 0));
-        Vec3 up = rot.RotatePoint(Vec3(0, 0, 1));
-
         Mat4 matOrient;
-        matOrient.Orient(pos, fwd, up);
-
-        Mat4 S = Mat4::Scaling(scale);
-        matOrient = matOrient * S;
-
-        matOrient = matOrient.Transpose();
+        BuildMatrix((pos - uboOrigin).ToVec3(), rot, scale, matOrient.ToPtr());
 
         int bufferSize = sizeof(matOrient);
         if (!uniformBuffer.Allocate(device, matOrient.ToPtr(), bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT))
@@ -274,6 +653,23 @@ namespace ElecNeko
         return true;
     }
 
+    void Mesh::UpdateUBO(DeviceContext *device, const Vec3d &viewOrigin)
+    {
+        if (!isUBO || viewOrigin == uboOrigin)
+        {
+            return;
+        }
+        uboOrigin = viewOrigin;
+
+        // The difference is taken in double, only the offset from the view is rounded to float
+        Mat4 matOrient;
+        BuildMatrix((pos - uboOrigin).ToVec3(), rot, scale, matOrient.ToPtr());
+
+        void *mapped = uniformBuffer.MapBuffer(device);
+        std::memcpy(mapped, matOrient.ToPtr(), sizeof(matOrient));
+        uniformBuffer.UnmapBuffer(device);
+    }
+
     void Mesh::Cleanup(DeviceContext* device)
     {
         for (auto& meshparts : m_meshParts)
@@ -281,6 +677,17 @@ namespace ElecNeko
             meshparts.Cleanup(device);
         }
 
+        for (const textureHandle_t handle : albedoMaps)
+        {
+            g_textureManager.Release(device, handle);
+        }
+        for (const textureHandle_t handle : normalMaps)
+        {
+            g_textureManager.Release(device, handle);
+        }
+        albedoMaps.clear();
+        normalMaps.clear();
+
         if (!isUBO)
         {
             return;
@@ -1,53 +1,25 @@
 #pragma once
 
-#include "Texture.h"
+#include "TextureManager.h"
+#include "MeshSimplifier.h"
+#include "Meshlet.h"
 
 #include "Math/Vector.h"
 #include "Math/Quat.h"
+#include "Math/Bounds.h"
 
 #include <vector>
 #include <array>
 
 namespace ElecNeko
 {
+    // Full precision vertex, used while baking and for the collision
     struct VVertex
     {
         float position[3];
         float uv[2];
         float normal[3];
 
-        static VkVertexInputBindingDescription GetBindingDescription()
-        {
-            VkVertexInputBindingDescription bindingDescription{};
-            bindingDescription.binding = 0;
-            bindingDescription.stride = sizeof(VVertex);
-            bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-
-            return bindingDescription;
-        }
-
-        static std::array<VkVertexInputAttributeDescription, 3> GetAttributeDescriptions()
-        {
-            std::array<VkVertexInputAttributeDescription, 3> attributeDescriptions = {};
-
-            attributeDescriptions[0].binding = 0;
-            attributeDescriptions[0].location = 0;
-            attributeDescriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
-            attributeDescriptions[0].offset = offsetof(VVertex, position);
-
-            attributeDescriptions[1].binding = 0;
-            attributeDescriptions[1].location = 1;
-            attributeDescriptions[1].format = VK_FORMAT_R32G32_SFLOAT;
-            attributeDescriptions[1].offset = offsetof(VVertex, uv);
-
-            attributeDescriptions[2].binding = 0;
-            attributeDescriptions[2].location = 2;
-            attributeDescriptions[2].format = VK_FORMAT_R32G32B32_SFLOAT;
-            attributeDescriptions[2].offset = offsetof(VVertex, normal);
-
-            return attributeDescriptions;
-        }
-
         bool operator==(const VVertex& other)const
         {
             return position[0] == other.position[0] && position[1] == other.position[1] && position[2] == other.position[2] && uv[0] == other.uv[0] &&
@@ -82,21 +54,102 @@ namespace ElecNeko
         }
     };
 
+    /*
+    ====================================================
+    VVertexPacked
+
+    The vertex as the gpu reads it, 16 bytes instead of the 32 of VVertex.
+    Positions and uvs are 16 bit unorms against bounds that are passed to
+    the shaders in meshPartUniforms_t, normals are octahedral encoded into
+    two snorms.  The vertex shaders undo it, see meshShadowed.vert.
+    ====================================================
+    */
+    struct VVertexPacked
+    {
+        uint16_t position[4]; // w is padding
+        uint16_t uv[2];
+        int16_t normal[2];
+
+        static VkVertexInputBindingDescription GetBindingDescription()
+        {
+            VkVertexInputBindingDescription bindingDescription{};
+            bindingDescription.binding = 0;
+            bindingDescription.stride = sizeof(VVertexPacked);
+            bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+            return bindingDescription;
+        }
+
+        static std::array<VkVertexInputAttributeDescription, 3> GetAttributeDescriptions()
+        {
+            std::array<VkVertexInputAttributeDescription, 3> attributeDescriptions = {};
+
+            attributeDescriptions[0].binding = 0;
+            attributeDescriptions[0].location = 0;
+            attributeDescriptions[0].format = VK_FORMAT_R16G16B16A16_UNORM;
+            attributeDescriptions[0].offset = offsetof(VVertexPacked, position);
+
+            attributeDescriptions[1].binding = 0;
+            attributeDescriptions[1].location = 1;
+            attributeDescriptions[1].format = VK_FORMAT_R16G16_UNORM;
+            attributeDescriptions[1].offset = offsetof(VVertexPacked, uv);
+
+            attributeDescriptions[2].binding = 0;
+            attributeDescriptions[2].location = 2;
+            attributeDescriptions[2].format = VK_FORMAT_R16G16_SNORM;
+            attributeDescriptions[2].offset = offsetof(VVertexPacked, normal);
+
+            return attributeDescriptions;
+        }
+    };
+
+    // Per part uniforms, std140, matches uboPart in meshShadowed.vert and shadow2.vert
+    struct meshPartUniforms_t
+    {
+        float posScale[4];   // position = posBias + posScale * unorm
+        float posBias[4];
+        float uvScaleBias[4]; // uv = zw + xy * unorm
+        int hasAlbedoMap;
+        int hasNormalMap;
+        int pad[2];
+    };
+
+    const float MESH_LOD_PIXEL_ERROR = 1.0f;
+
     class MeshPart
     {
     public:
-        MeshPart() : m_isVBO(false) ,albTexIndex(-1),norTexIndex(-1) {}
+        MeshPart() : m_isVBO(false) ,albTexIndex(-1),norTexIndex(-1), m_uniforms() {}
         ~MeshPart() = default;
 
-        bool MakeVBO(DeviceContext *device);
+        // Packs m_vertices against the position bounds, no device work so it runs on the loader threads
+        void Quantize(const Bounds &bounds);
+
+        bool MakeVBO(DeviceContext *device); // quantizes against its own bounds if Quantize wasn't called
 
         void Cleanup(DeviceContext *device);
 
-        void DrawIndexed(VkCommandBuffer vkCommandBUffer);
+        void DrawIndexed(VkCommandBuffer vkCommandBUffer, const int lod = 0);
+        // The full detail level without its back facing meshlets, viewPos is in the part's space.
+        // Neighbouring meshlets that survive share a draw, returns the number of draws.
+        int DrawMeshlets(VkCommandBuffer vkCommandBuffer, const Vec3 &viewPos);
 
     public:
         std::vector<VVertex> m_vertices;
         std::vector<uint32_t> m_indices;
+        std::vector<VVertexPacked> m_packedVertices; // freed once it is in m_vertexBuffer
+        meshPartUniforms_t m_uniforms;
+        Bounds m_bounds;
+
+        // Levels of detail over the same vertices, level 0 is m_indices.
+        // The other levels follow it in m_indexBuffer, see MeshSimplifier.h
+        std::vector<uint32_t> m_lodIndices;
+        std::vector<meshLod_t> m_lods;
+
+        // Clusters of the full detail level, see Meshlet.h
+        std::vector<meshlet_t> m_meshlets;
+        std::vector<uint32_t> m_meshletVertices;
+        std::vector<uint8_t> m_meshletTriangles;
 
         int32_t albTexIndex;
         int32_t norTexIndex;
@@ -111,24 +164,44 @@ namespace ElecNeko
     class Mesh
     {
     public:
-        Mesh() : pos(Vec3(0.f, 0.f, 0.f)), rot(Vec3(1.f, 0.f, 0.f), 3.14f / 2.f), scale(Vec3(1.f, 1.f, 1.f)), isUBO(false) {}
-        Mesh(const Vec3 &Pos, const Quat &Rot, const Vec3 &Scale) : pos(Pos), rot(Rot), scale(Scale), isUBO(false) {}
+        Mesh() : pos(0.0, 0.0, 0.0), rot(Vec3(1.f, 0.f, 0.f), 3.14f / 2.f), scale(Vec3(1.f, 1.f, 1.f)), isUBO(false) {}
+        Mesh(const Vec3d &Pos, const Quat &Rot, const Vec3 &Scale) : pos(Pos), rot(Rot), scale(Scale), isUBO(false) {}
         ~Mesh() = default;
 
-        bool LoadFromFile(DeviceContext *device, const std::string &name);
+        bool LoadFromFile(DeviceContext *device, const std::string &name); // from the mesh cache, baking it first if needed
+
+        // LoadFromFile in two steps, LoadData has no device work and is safe on any thread.
+        // UploadTextures records the copies into cmdBuffer and adds a staging buffer per texture.
+        bool LoadData(const std::string &name);
+        void UploadTextures(DeviceContext *device, VkCommandBuffer cmdBuffer, std::vector<Buffer> &stagingBuffers);
+        void Quantize(); // every part against the bounds of the whole mesh, called by LoadData
         bool MakeUBO(DeviceContext *device);
+        void UpdateUBO(DeviceContext *device, const Vec3d &viewOrigin); // rewrites the matrix relative to viewOrigin
+
+        // Coarsest level of the part whose error stays under MESH_LOD_PIXEL_ERROR, seen from uboOrigin.
+        // pixelsPerUnit is the size in pixels of one unit at distance one.
+        int SelectLod(const int partIndex, const float pixelsPerUnit) const;
+
+        // uboOrigin in the space of the vertices, false when a non uniform scale would skew the meshlet cones
+        bool GetLocalViewPosition(Vec3 &viewPos) const;
 
         void Cleanup(DeviceContext *device);
+
+    private:
+        bool LoadFromObj(const std::string &inputFile, const std::string &mtlPath, std::vector<std::string> &albedoNames,
+                         std::vector<std::string> &normalNames);
+
     public:
         std::vector<MeshPart> m_meshParts;
-        std::vector<Texture> albedoMaps;
-        std::vector<Texture> normalMaps;
+        std::vector<textureHandle_t> albedoMaps; // shared through g_textureManager, released by Cleanup
+        std::vector<textureHandle_t> normalMaps;
 
         Buffer uniformBuffer;
 
-        Vec3 pos;
+        Vec3d pos; // world position, the matrix in uniformBuffer is relative to uboOrigin
         Quat rot;
         Vec3 scale;
         bool isUBO;
+        Vec3d uboOrigin;
     };
 }
@@ -0,0 +1,278 @@
+#include "MeshCache.h"
+#include "Mesh.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include "../Fileio.h"
+
+namespace ElecNeko
+{
+    static uint64_t AlignOffset(const uint64_t offset)
+    {
+        return (offset + MESH_CACHE_ALIGNMENT - 1) & ~(uint64_t) (MESH_CACHE_ALIGNMENT - 1);
+    }
+
+    bool HashMeshSource(const std::string &objFile, const std::string &mtlDir, uint64_t &hash)
+    {
+        MappedFile obj;
+        if (!obj.Open(objFile.c_str()))
+        {
+            return false;
+        }
+        hash = HashData(obj.GetData(), obj.GetSize());
+
+        // Material libraries change the textures, so they are part of the source
+        const char *text = (const char *) obj.GetData();
+        const char *end = text + obj.GetSize();
+        for (const char *line = text; line < end;)
+        {
+            const char *lineEnd = (const char *) memchr(line, '\n', end - line);
+            if (lineEnd == nullptr)
+            {
+                lineEnd = end;
+            }
+
+            if (lineEnd - line > 7 && strncmp(line, "mtllib", 6) == 0 && (line[6] == ' ' || line[6] == '\t'))
+            {
+                const char *name = line + 7;
+                while (name < lineEnd)
+                {
+                    while (name < lineEnd && (*name == ' ' || *name == '\t' || *name == '\r'))
+                    {
+                        name++;
+                    }
+                    const char *nameEnd = name;
+                    while (nameEnd < lineEnd && *nameEnd != ' ' && *nameEnd != '\t' && *nameEnd != '\r')
+                    {
+                        nameEnd++;
+                    }
+                    if (nameEnd == name)
+                    {
+                        break;
+                    }
+
+                    // A missing library still counts, so adding it later invalidates the cache
+                    const std::string mtlFile = mtlDir + std::string(name, nameEnd);
+                    hash = HashData(mtlFile.data(), mtlFile.size(), hash);
+
+                    MappedFile mtl;
+                    if (mtl.Open(mtlFile.c_str()))
+                    {
+                        hash = HashData(mtl.GetData(), mtl.GetSize(), hash);
+                    }
+                    name = nameEnd;
+                }
+            }
+
+            line = lineEnd + 1;
+        }
+        return true;
+    }
+
+    bool ReadMeshCache(const std::string &fileName, const uint64_t sourceHash, Mesh &mesh,
+                       std::vector<std::string> &albedoNames, std::vector<std::string> &normalNames)
+    {
+        MappedFile file;
+        if (!file.Open(fileName.c_str()) || file.GetSize() < sizeof(meshCacheHeader_t))
+        {
+            return false;
+        }
+
+        const unsigned char *data = file.GetData();
+        const uint64_t size = file.GetSize();
+
+        meshCacheHeader_t header;
+        memcpy(&header, data, sizeof(header));
+        if (header.magic != MESH_CACHE_MAGIC || header.version != MESH_CACHE_VERSION || header.sourceHash != sourceHash ||
+            header.vertexSize != sizeof(VVertex) || header.fileSize != size)
+        {
+            return false;
+        }
+
+        const uint64_t numTextures = (uint64_t) header.numAlbedoMaps + header.numNormalMaps;
+        const uint64_t tablesSize = sizeof(meshCacheHeader_t) + header.numParts * sizeof(meshCachePart_t) + numTextures * sizeof(meshCacheTexture_t);
+        if (tablesSize > size)
+        {
+            return false;
+        }
+
+        // Check the whole table before touching the mesh, a truncated file is just stale
+        const meshCachePart_t *parts = (const meshCachePart_t *) (data + sizeof(meshCacheHeader_t));
+        for (uint32_t i = 0; i < header.numParts; i++)
+        {
+            const meshCachePart_t &part = parts[i];
+            if (part.verticesOffset > size || part.numVertices * (uint64_t) sizeof(VVertex) > size - part.verticesOffset ||
+                part.indicesOffset > size || part.numIndices * (uint64_t) sizeof(uint32_t) > size - part.indicesOffset ||
+                part.lodIndicesOffset > size || part.numLodIndices * (uint64_t) sizeof(uint32_t) > size - part.lodIndicesOffset ||
+                part.meshletsOffset > size || part.numMeshlets * (uint64_t) sizeof(meshlet_t) > size - part.meshletsOffset ||
+                part.meshletVerticesOffset > size || part.numMeshletVertices * (uint64_t) sizeof(uint32_t) > size - part.meshletVerticesOffset ||
+                part.meshletTrianglesOffset > size || (part.numMeshlets > 0 ? part.numIndices : 0) > size - part.meshletTrianglesOffset ||
+                part.numLods > MESH_MAX_LODS)
+            {
+                return false;
+            }
+            for (uint32_t lod = 0; lod < part.numLods; lod++)
+            {
+                if ((uint64_t) part.lods[lod].firstIndex + part.lods[lod].numIndices > (uint64_t) part.numIndices + part.numLodIndices)
+                {
+                    return false;
+                }
+            }
+            const meshlet_t *meshlets = (const meshlet_t *) (data + part.meshletsOffset);
+            for (uint32_t m = 0; m < part.numMeshlets; m++)
+            {
+                if ((uint64_t) meshlets[m].firstIndex + 3 * (uint64_t) meshlets[m].numTriangles > part.numIndices ||
+                    (uint64_t) meshlets[m].firstVertex + meshlets[m].numVertices > part.numMeshletVertices)
+                {
+                    return false;
+                }
+            }
+        }
+
+        const meshCacheTexture_t *textures = (const meshCacheTexture_t *) (parts + header.numParts);
+        albedoNames.resize(header.numAlbedoMaps);
+        normalNames.resize(header.numNormalMaps);
+        for (uint32_t i = 0; i < header.numAlbedoMaps; i++)
+        {
+            albedoNames[i].assign(textures[i].name, strnlen(textures[i].name, MESH_CACHE_MAX_NAME));
+        }
+        for (uint32_t i = 0; i < header.numNormalMaps; i++)
+        {
+            const meshCacheTexture_t &texture = textures[header.numAlbedoMaps + i];
+            normalNames[i].assign(texture.name, strnlen(texture.name, MESH_CACHE_MAX_NAME));
+        }
+
+        mesh.m_meshParts.resize(header.numParts);
+        for (uint32_t i = 0; i < header.numParts; i++)
+        {
+            const meshCachePart_t &part = parts[i];
+            MeshPart &meshPart = mesh.m_meshParts[i];
+
+            const VVertex *vertices = (const VVertex *) (data + part.verticesOffset);
+            const uint32_t *indices = (const uint32_t *) (data + part.indicesOffset);
+            meshPart.m_vertices.assign(vertices, vertices + part.numVertices);
+            const uint32_t *lodIndices = (const uint32_t *) (data + part.lodIndicesOffset);
+            meshPart.m_indices.assign(indices, indices + part.numIndices);
+            meshPart.m_lodIndices.assign(lodIndices, lodIndices + part.numLodIndices);
+            meshPart.m_lods.assign(part.lods, part.lods + part.numLods);
+
+            const meshlet_t *meshlets = (const meshlet_t *) (data + part.meshletsOffset);
+            const uint32_t *meshletVertices = (const uint32_t *) (data + part.meshletVerticesOffset);
+            const uint8_t *meshletTriangles = data + part.meshletTrianglesOffset;
+            meshPart.m_meshlets.assign(meshlets, meshlets + part.numMeshlets);
+            meshPart.m_meshletVertices.assign(meshletVertices, meshletVertices + part.numMeshletVertices);
+            meshPart.m_meshletTriangles.assign(meshletTriangles, meshletTriangles + (part.numMeshlets > 0 ? part.numIndices : 0));
+            meshPart.albTexIndex = part.albTexIndex;
+            meshPart.norTexIndex = part.norTexIndex;
+        }
+        return true;
+    }
+
+    bool WriteMeshCache(const std::string &fileName, const uint64_t sourceHash, const Mesh &mesh,
+                        const std::vector<std::string> &albedoNames, const std::vector<std::string> &normalNames)
+    {
+        const uint32_t numParts = (uint32_t) mesh.m_meshParts.size();
+        const uint32_t numTextures = (uint32_t) (albedoNames.size() + normalNames.size());
+
+        meshCacheHeader_t header;
+        header.magic = MESH_CACHE_MAGIC;
+        header.version = MESH_CACHE_VERSION;
+        header.sourceHash = sourceHash;
+        header.vertexSize = sizeof(VVertex);
+        header.numParts = numParts;
+        header.numAlbedoMaps = (uint32_t) albedoNames.size();
+        header.numNormalMaps = (uint32_t) normalNames.size();
+
+        // Lay out the blobs after the tables
+        std::vector<meshCachePart_t> parts(numParts);
+        uint64_t offset = sizeof(meshCacheHeader_t) + numParts * sizeof(meshCachePart_t) + numTextures * sizeof(meshCacheTexture_t);
+        for (uint32_t i = 0; i < numParts; i++)
+        {
+            const MeshPart &meshPart = mesh.m_meshParts[i];
+            meshCachePart_t &part = parts[i];
+            part.numVertices = (uint32_t) meshPart.m_vertices.size();
+            part.numIndices = (uint32_t) meshPart.m_indices.size();
+            part.numLodIndices = (uint32_t) meshPart.m_lodIndices.size();
+            part.numLods = (uint32_t) std::min(meshPart.m_lods.size(), (size_t) MESH_MAX_LODS);
+            part.numMeshlets = (uint32_t) meshPart.m_meshlets.size();
+            part.numMeshletVertices = (uint32_t) meshPart.m_meshletVertices.size();
+            memset(part.lods, 0, sizeof(part.lods));
+            std::copy(meshPart.m_lods.begin(), meshPart.m_lods.begin() + part.numLods, part.lods);
+            part.albTexIndex = meshPart.albTexIndex;
+            part.norTexIndex = meshPart.norTexIndex;
+
+            offset = AlignOffset(offset);
+            part.verticesOffset = offset;
+            offset += part.numVertices * sizeof(VVertex);
+
+            offset = AlignOffset(offset);
+            part.indicesOffset = offset;
+            offset += part.numIndices * sizeof(uint32_t);
+
+            offset = AlignOffset(offset);
+            part.lodIndicesOffset = offset;
+            offset += part.numLodIndices * sizeof(uint32_t);
+
+            offset = AlignOffset(offset);
+            part.meshletsOffset = offset;
+            offset += part.numMeshlets * sizeof(meshlet_t);
+
+            offset = AlignOffset(offset);
+            part.meshletVerticesOffset = offset;
+            offset += part.numMeshletVertices * sizeof(uint32_t);
+
+            offset = AlignOffset(offset);
+            part.meshletTrianglesOffset = offset;
+            offset += meshPart.m_meshletTriangles.size();
+        }
+        header.fileSize = offset;
+
+        std::vector<unsigned char> data(offset, 0);
+        unsigned char *dst = data.data();
+        memcpy(dst, &header, sizeof(header));
+        dst += sizeof(header);
+        memcpy(dst, parts.data(), numParts * sizeof(meshCachePart_t));
+        dst += numParts * sizeof(meshCachePart_t);
+
+        for (uint32_t i = 0; i < numTextures; i++)
+        {
+            const std::string &name = (i < albedoNames.size()) ? albedoNames[i] : normalNames[i - albedoNames.size()];
+            if (name.size() >= MESH_CACHE_MAX_NAME)
+            {
+                printf("Texture name too long for the mesh cache: %s\n", name.c_str());
+                return false;
+            }
+            memcpy(dst, name.c_str(), name.size());
+            dst += sizeof(meshCacheTexture_t);
+        }
+
+        for (uint32_t i = 0; i < numParts; i++)
+        {
+            const MeshPart &meshPart = mesh.m_meshParts[i];
+            memcpy(data.data() + parts[i].verticesOffset, meshPart.m_vertices.data(), meshPart.m_vertices.size() * sizeof(VVertex));
+            memcpy(data.data() + parts[i].indicesOffset, meshPart.m_indices.data(), meshPart.m_indices.size() * sizeof(uint32_t));
+            memcpy(data.data() + parts[i].lodIndicesOffset, meshPart.m_lodIndices.data(), meshPart.m_lodIndices.size() * sizeof(uint32_t));
+            memcpy(data.data() + parts[i].meshletsOffset, meshPart.m_meshlets.data(), meshPart.m_meshlets.size() * sizeof(meshlet_t));
+            memcpy(data.data() + parts[i].meshletVerticesOffset, meshPart.m_meshletVertices.data(), meshPart.m_meshletVertices.size() * sizeof(uint32_t));
+            memcpy(data.data() + parts[i].meshletTrianglesOffset, meshPart.m_meshletTriangles.data(), meshPart.m_meshletTriangles.size());
+        }
+
+        // Written here rather than through SaveFileData, which isn't safe to call from the loader threads
+        FILE *file = fopen(fileName.c_str(), "wb");
+        if (file == nullptr)
+        {
+            printf("Failed to open mesh cache for writing: %s\n", fileName.c_str());
+            return false;
+        }
+        const bool result = fwrite(data.data(), 1, data.size(), file) == data.size();
+        fclose(file);
+        if (!result)
+        {
+            printf("Failed to write mesh cache: %s\n", fileName.c_str());
+            remove(fileName.c_str());
+        }
+        return result;
+    }
+}
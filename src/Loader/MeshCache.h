@@ -0,0 +1,84 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "MeshSimplifier.h"
+#include "Meshlet.h"
+
+namespace ElecNeko
+{
+    class Mesh;
+
+    /*
+    ====================================================
+    Mesh cache
+
+    Binary bake of a loaded OBJ, written next to it on the first load and
+    memory mapped after that.  The layout is
+
+        meshCacheHeader_t
+        meshCachePart_t      [numParts]
+        meshCacheTexture_t   [numAlbedoMaps + numNormalMaps]
+        vertex, index, lod index, meshlet, meshlet vertex and meshlet triangle
+        blobs of every part, each aligned to MESH_CACHE_ALIGNMENT
+
+    so the blobs are copied into the vertex and index buffers as they are.
+    The hash of the OBJ and its MTL files is stored in the header, a
+    changed source, version or vertex layout makes the cache stale.
+    ====================================================
+    */
+    const uint32_t MESH_CACHE_MAGIC = 0x434D4E45; // "ENMC"
+    const uint32_t MESH_CACHE_VERSION = 4; // 2: indices and vertices are optimized, see MeshOptimizer.h
+                                           // 3: levels of detail, see MeshSimplifier.h
+                                           // 4: meshlets, see Meshlet.h
+    const uint32_t MESH_CACHE_ALIGNMENT = 64;
+    const int MESH_CACHE_MAX_NAME = 256;
+
+    struct meshCacheHeader_t
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t sourceHash;
+        uint64_t fileSize;
+        uint32_t vertexSize;
+        uint32_t numParts;
+        uint32_t numAlbedoMaps;
+        uint32_t numNormalMaps;
+    };
+
+    struct meshCachePart_t
+    {
+        uint64_t verticesOffset;
+        uint64_t indicesOffset;
+        uint64_t lodIndicesOffset;
+        uint64_t meshletsOffset;
+        uint64_t meshletVerticesOffset;
+        uint64_t meshletTrianglesOffset; // one uint8_t per index
+        uint32_t numVertices;
+        uint32_t numIndices;
+        uint32_t numLodIndices;
+        uint32_t numLods;
+        uint32_t numMeshlets;
+        uint32_t numMeshletVertices;
+        int32_t albTexIndex;
+        int32_t norTexIndex;
+        meshLod_t lods[MESH_MAX_LODS];
+    };
+
+    struct meshCacheTexture_t
+    {
+        char name[MESH_CACHE_MAX_NAME]; // relative to the model's directory
+    };
+
+    // Hash of the OBJ and every MTL it references, false if the OBJ can't be read
+    bool HashMeshSource(const std::string &objFile, const std::string &mtlDir, uint64_t &hash);
+
+    // Fills the parts of the mesh and the texture names, false if the cache is missing or stale
+    bool ReadMeshCache(const std::string &fileName, const uint64_t sourceHash, Mesh &mesh,
+                       std::vector<std::string> &albedoNames, std::vector<std::string> &normalNames);
+
+    bool WriteMeshCache(const std::string &fileName, const uint64_t sourceHash, const Mesh &mesh,
+                        const std::vector<std::string> &albedoNames, const std::vector<std::string> &normalNames);
+}
@@ -0,0 +1,450 @@
+#include "MeshOptimizer.h"
+#include "Mesh.h"
+
+#include <algorithm>
+#include <cassert>
+#include <math.h>
+
+namespace ElecNeko
+{
+    /*
+    ====================================================
+    FIFO cache simulation
+
+    A vertex is in the cache while fewer than cacheSize misses happened
+    since it was loaded, so the cache is one timestamp per vertex.
+    ====================================================
+    */
+    struct fifoCache_t
+    {
+        std::vector<uint32_t> loadTime;
+        uint32_t time;
+        uint32_t cacheSize;
+
+        fifoCache_t(const int numVertices, const int size) : loadTime(numVertices, 0), time(size + 1), cacheSize(size) {}
+
+        int Access(const uint32_t vertex)
+        {
+            if (time - loadTime[vertex] > cacheSize)
+            {
+                loadTime[vertex] = time++;
+                return 1;
+            }
+            return 0;
+        }
+
+        void Reset() { time += cacheSize + 1; }
+    };
+
+    uint64_t CountCacheMisses(const uint32_t *indices, const int numIndices, const int numVertices, const int cacheSize)
+    {
+        fifoCache_t cache(numVertices, cacheSize);
+        uint64_t misses = 0;
+        for (int i = 0; i < numIndices; i++)
+        {
+            misses += cache.Access(indices[i]);
+        }
+        return misses;
+    }
+
+    /*
+    ====================================================
+    OptimizeVertexCache
+
+    Tom Forsyth's linear speed vertex cache optimisation.  Every vertex
+    scores by its position in a simulated LRU cache, with the last
+    triangle's vertices scored a bit lower so strips don't wind back on
+    themselves, plus a bonus for vertices with few triangles left so
+    no lonely triangles are left behind.  The next triangle is the best
+    scoring one touching the cache, only when there is none the next
+    unused triangle in input order is taken.
+    ====================================================
+    */
+    static const int FORSYTH_CACHE_SIZE = 32;
+    static const int FORSYTH_MAX_VALENCE = 32;
+
+    struct forsythTables_t
+    {
+        float cacheScore[FORSYTH_CACHE_SIZE];
+        float valenceScore[FORSYTH_MAX_VALENCE + 1];
+
+        forsythTables_t()
+        {
+            for (int i = 0; i < FORSYTH_CACHE_SIZE; i++)
+            {
+                if (i < 3)
+                {
+                    cacheScore[i] = 0.75f;
+                }
+                else
+                {
+                    const float scale = 1.0f - (float) (i - 3) / (float) (FORSYTH_CACHE_SIZE - 3);
+                    cacheScore[i] = powf(scale, 1.5f);
+                }
+            }
+            valenceScore[0] = 0.0f;
+            for (int i = 1; i <= FORSYTH_MAX_VALENCE; i++)
+            {
+                valenceScore[i] = 2.0f / sqrtf((float) i);
+            }
+        }
+
+        float VertexScore(const int cachePos, const int remaining) const
+        {
+            if (remaining == 0)
+            {
+                return -1.0f;
+            }
+            const float score = (cachePos >= 0) ? cacheScore[cachePos] : 0.0f;
+            return score + valenceScore[std::min(remaining, FORSYTH_MAX_VALENCE)];
+        }
+    };
+
+    void OptimizeVertexCache(uint32_t *dst, const uint32_t *indices, const int numIndices, const int numVertices)
+    {
+        assert(dst != indices);
+        static const forsythTables_t tables;
+
+        const int numTris = numIndices / 3;
+        if (numTris == 0)
+        {
+            return;
+        }
+
+        // Triangles around every vertex, the live ones are kept at the front of each list
+        std::vector<int> remaining(numVertices, 0);
+        for (int i = 0; i < numTris * 3; i++)
+        {
+            remaining[indices[i]]++;
+        }
+        std::vector<int> adjacencyOffset(numVertices + 1, 0);
+        for (int v = 0; v < numVertices; v++)
+        {
+            adjacencyOffset[v + 1] = adjacencyOffset[v] + remaining[v];
+        }
+        std::vector<int> adjacency(numTris * 3);
+        {
+            std::vector<int> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+            for (int t = 0; t < numTris; t++)
+            {
+                for (int k = 0; k < 3; k++)
+                {
+                    adjacency[fill[indices[t * 3 + k]]++] = t;
+                }
+            }
+        }
+
+        std::vector<int> cachePos(numVertices, -1);
+        std::vector<float> vertexScore(numVertices);
+        for (int v = 0; v < numVertices; v++)
+        {
+            vertexScore[v] = tables.VertexScore(-1, remaining[v]);
+        }
+
+        std::vector<float> triScore(numTris);
+        std::vector<bool> emitted(numTris, false);
+        int bestTri = 0;
+        for (int t = 0; t < numTris; t++)
+        {
+            triScore[t] = vertexScore[indices[t * 3 + 0]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+            if (triScore[t] > triScore[bestTri])
+            {
+                bestTri = t;
+            }
+        }
+
+        int cache[FORSYTH_CACHE_SIZE + 3];
+        int cacheCount = 0;
+        int nextInput = 0;
+
+        for (int out = 0; out < numTris; out++)
+        {
+            if (bestTri < 0)
+            {
+                // Nothing in the cache has triangles left, carry on in input order
+                while (emitted[nextInput])
+                {
+                    nextInput++;
+                }
+                bestTri = nextInput;
+            }
+
+            const uint32_t *tri = indices + bestTri * 3;
+            dst[out * 3 + 0] = tri[0];
+            dst[out * 3 + 1] = tri[1];
+            dst[out * 3 + 2] = tri[2];
+            emitted[bestTri] = true;
+
+            // Take the triangle out of its vertices' live lists
+            for (int k = 0; k < 3; k++)
+            {
+                const uint32_t v = tri[k];
+                int *list = adjacency.data() + adjacencyOffset[v];
+                for (int i = 0; i < remaining[v]; i++)
+                {
+                    if (list[i] == bestTri)
+                    {
+                        std::swap(list[i], list[remaining[v] - 1]);
+                        break;
+                    }
+                }
+                remaining[v]--;
+            }
+
+            // The triangle's vertices move to the front, the rest shift back
+            int newCache[FORSYTH_CACHE_SIZE + 3];
+            int newCount = 0;
+            for (int k = 0; k < 3; k++)
+            {
+                newCache[newCount++] = (int) tri[k];
+            }
+            for (int i = 0; i < cacheCount; i++)
+            {
+                const int v = cache[i];
+                if (v != (int) tri[0] && v != (int) tri[1] && v != (int) tri[2])
+                {
+                    newCache[newCount++] = v;
+                }
+            }
+
+            // Rescore everything that moved, including what fell out, and pick the best triangle among them
+            bestTri = -1;
+            float bestScore = -1.0f;
+            for (int i = 0; i < newCount; i++)
+            {
+                const int v = newCache[i];
+                cachePos[v] = (i < FORSYTH_CACHE_SIZE) ? i : -1;
+
+                const float score = tables.VertexScore(cachePos[v], remaining[v]);
+                const float delta = score - vertexScore[v];
+                vertexScore[v] = score;
+
+                const int *list = adjacency.data() + adjacencyOffset[v];
+                for (int j = 0; j < remaining[v]; j++)
+                {
+                    const int t = list[j];
+                    triScore[t] += delta;
+                    if (i < FORSYTH_CACHE_SIZE && triScore[t] > bestScore)
+                    {
+                        bestScore = triScore[t];
+                        bestTri = t;
+                    }
+                }
+            }
+
+            cacheCount = std::min(newCount, FORSYTH_CACHE_SIZE);
+            std::copy(newCache, newCache + cacheCount, cache);
+        }
+    }
+
+    /*
+    ====================================================
+    OptimizeOverdraw
+
+    Cuts the cache ordered triangles into clusters.  Hard boundaries are
+    where the cache runs dry anyway, soft ones are placed as soon as a
+    cluster drawn with a cold cache gets within threshold of the ACMR of
+    the whole hard cluster, so reordering them costs little.  Clusters
+    are then sorted by how much their average normal points away from the
+    mesh center, outside first.
+    ====================================================
+    */
+    void OptimizeOverdraw(uint32_t *dst, const uint32_t *indices, const int numIndices, const VVertex *vertices, const int numVertices,
+                          const float threshold)
+    {
+        assert(dst != indices);
+        const int numTris = numIndices / 3;
+        if (numTris == 0)
+        {
+            return;
+        }
+
+        // Hard boundaries, triangles that miss on all three vertices
+        std::vector<int> hardClusters;
+        {
+            fifoCache_t cache(numVertices, MESH_OPT_CACHE_SIZE);
+            for (int t = 0; t < numTris; t++)
+            {
+                int misses = 0;
+                for (int k = 0; k < 3; k++)
+                {
+                    misses += cache.Access(indices[t * 3 + k]);
+                }
+                if (t == 0 || misses == 3)
+                {
+                    hardClusters.push_back(t);
+                }
+            }
+        }
+        hardClusters.push_back(numTris);
+
+        // Soft boundaries inside each hard cluster
+        std::vector<int> clusters;
+        {
+            fifoCache_t cache(numVertices, MESH_OPT_CACHE_SIZE);
+            for (size_t c = 0; c + 1 < hardClusters.size(); c++)
+            {
+                const int start = hardClusters[c];
+                const int end = hardClusters[c + 1];
+
+                cache.Reset();
+                int clusterMisses = 0;
+                for (int i = start * 3; i < end * 3; i++)
+                {
+                    clusterMisses += cache.Access(indices[i]);
+                }
+                const float clusterThreshold = threshold * (float) clusterMisses / (float) (end - start);
+
+                clusters.push_back(start);
+                cache.Reset();
+                int runningMisses = 0;
+                int runningTris = 0;
+                for (int t = start; t < end; t++)
+                {
+                    for (int k = 0; k < 3; k++)
+                    {
+                        runningMisses += cache.Access(indices[t * 3 + k]);
+                    }
+                    runningTris++;
+
+                    if ((float) runningMisses / (float) runningTris <= clusterThreshold && t + 1 < end)
+                    {
+                        clusters.push_back(t + 1);
+                        cache.Reset();
+                        runningMisses = 0;
+                        runningTris = 0;
+                    }
+                }
+            }
+        }
+        clusters.push_back(numTris);
+        const int numClusters = (int) clusters.size() - 1;
+
+        // Area weighted centroid of the mesh, then of each cluster with its summed normal
+        Vec3 meshCenter(0.0f);
+        float meshArea = 0.0f;
+        std::vector<Vec3> clusterCenter(numClusters, Vec3(0.0f));
+        std::vector<Vec3> clusterNormal(numClusters, Vec3(0.0f));
+        std::vector<float> clusterArea(numClusters, 0.0f);
+        for (int c = 0; c < numClusters; c++)
+        {
+            for (int t = clusters[c]; t < clusters[c + 1]; t++)
+            {
+                const Vec3 a(vertices[indices[t * 3 + 0]].position);
+                const Vec3 b(vertices[indices[t * 3 + 1]].position);
+                const Vec3 d(vertices[indices[t * 3 + 2]].position);
+
+                const Vec3 normal = (b - a).Cross(d - a);
+                const float area = normal.GetMagnitude();
+                const Vec3 center = (a + b + d) * (1.0f / 3.0f);
+
+                clusterCenter[c] += center * area;
+                clusterNormal[c] += normal;
+                clusterArea[c] += area;
+            }
+            meshCenter += clusterCenter[c];
+            meshArea += clusterArea[c];
+        }
+        if (meshArea > 0.0f)
+        {
+            meshCenter /= meshArea;
+        }
+
+        std::vector<float> clusterKey(numClusters, 0.0f);
+        for (int c = 0; c < numClusters; c++)
+        {
+            if (clusterArea[c] <= 0.0f || clusterNormal[c].GetLengthSqr() <= 0.0f)
+            {
+                continue;
+            }
+            const Vec3 center = clusterCenter[c] / clusterArea[c];
+            Vec3 normal = clusterNormal[c];
+            normal.Normalize();
+            clusterKey[c] = (center - meshCenter).Dot(normal);
+        }
+
+        std::vector<int> order(numClusters);
+        for (int c = 0; c < numClusters; c++)
+        {
+            order[c] = c;
+        }
+        std::stable_sort(order.begin(), order.end(), [&clusterKey](const int a, const int b) { return clusterKey[a] > clusterKey[b]; });
+
+        int out = 0;
+        for (const int c : order)
+        {
+            for (int i = clusters[c] * 3; i < clusters[c + 1] * 3; i++)
+            {
+                dst[out++] = indices[i];
+            }
+        }
+    }
+
+    /*
+    ====================================================
+    OptimizeVertexFetch
+    ====================================================
+    */
+    void OptimizeVertexFetch(std::vector<VVertex> &vertices, std::vector<uint32_t> &indices)
+    {
+        const uint32_t unused = 0xFFFFFFFF;
+        std::vector<uint32_t> remap(vertices.size(), unused);
+        std::vector<VVertex> sorted;
+        sorted.reserve(vertices.size());
+
+        for (uint32_t &index : indices)
+        {
+            if (remap[index] == unused)
+            {
+                remap[index] = (uint32_t) sorted.size();
+                sorted.push_back(vertices[index]);
+            }
+            index = remap[index];
+        }
+
+        // Vertices no triangle uses are dropped
+        vertices.swap(sorted);
+    }
+
+    /*
+    ====================================================
+    OptimizeMesh
+    ====================================================
+    */
+    void OptimizeMesh(std::vector<VVertex> &vertices, std::vector<uint32_t> &indices, meshOptStats_t &stats)
+    {
+        const int numIndices = (int) indices.size() / 3 * 3;
+        const int numVertices = (int) vertices.size();
+        if (numIndices == 0)
+        {
+            return;
+        }
+
+        const uint64_t missesBefore = CountCacheMisses(indices.data(), numIndices, numVertices);
+        const float overdrawThreshold = 1.05f; // overdraw may give back up to 5% of the cache efficiency
+
+        // Exporters often write well ordered meshes already, each pass is only kept if it doesn't lose
+        std::vector<uint32_t> cacheOrder(numIndices);
+        OptimizeVertexCache(cacheOrder.data(), indices.data(), numIndices, numVertices);
+        uint64_t cacheMisses = CountCacheMisses(cacheOrder.data(), numIndices, numVertices);
+        if (cacheMisses > missesBefore)
+        {
+            cacheOrder.assign(indices.begin(), indices.begin() + numIndices);
+            cacheMisses = missesBefore;
+        }
+
+        std::vector<uint32_t> drawOrder(numIndices);
+        OptimizeOverdraw(drawOrder.data(), cacheOrder.data(), numIndices, vertices.data(), numVertices, overdrawThreshold);
+        if ((float) CountCacheMisses(drawOrder.data(), numIndices, numVertices) > overdrawThreshold * (float) cacheMisses)
+        {
+            drawOrder.swap(cacheOrder);
+        }
+
+        indices.assign(drawOrder.begin(), drawOrder.end());
+        OptimizeVertexFetch(vertices, indices);
+
+        stats.numTriangles += numIndices / 3;
+        stats.missesBefore += missesBefore;
+        stats.missesAfter += CountCacheMisses(indices.data(), numIndices, (int) vertices.size());
+    }
+}
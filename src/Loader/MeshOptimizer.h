@@ -0,0 +1,51 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+namespace ElecNeko
+{
+    struct VVertex;
+
+    /*
+    ====================================================
+    Mesh optimizer
+
+    Reorders the triangles and vertices of an indexed triangle list for
+    the gpu, in three passes:
+
+        vertex cache    Forsyth's greedy ordering, triangles that reuse
+                        recently used vertices go first
+        overdraw        splits that order into clusters that each keep the
+                        cache efficiency, then draws the outward facing
+                        clusters first so they occlude the rest
+        vertex fetch    renumbers the vertices in first use order, so the
+                        vertex buffer is read front to back
+
+    ACMR, the average number of vertex shader invocations per triangle,
+    is measured with a FIFO cache of MESH_OPT_CACHE_SIZE entries.
+    0.5 is the best a regular grid can do, 3 means no reuse at all.
+    ====================================================
+    */
+    const int MESH_OPT_CACHE_SIZE = 32;
+
+    struct meshOptStats_t
+    {
+        uint64_t numTriangles;
+        uint64_t missesBefore;
+        uint64_t missesAfter;
+
+        float GetACMRBefore() const { return numTriangles ? (float) missesBefore / (float) numTriangles : 0.0f; }
+        float GetACMRAfter() const { return numTriangles ? (float) missesAfter / (float) numTriangles : 0.0f; }
+    };
+
+    // Number of vertex cache misses drawing the indices in order
+    uint64_t CountCacheMisses(const uint32_t *indices, const int numIndices, const int numVertices, const int cacheSize = MESH_OPT_CACHE_SIZE);
+
+    void OptimizeVertexCache(uint32_t *dst, const uint32_t *indices, const int numIndices, const int numVertices);
+    void OptimizeOverdraw(uint32_t *dst, const uint32_t *indices, const int numIndices, const VVertex *vertices, const int numVertices, const float threshold);
+    void OptimizeVertexFetch(std::vector<VVertex> &vertices, std::vector<uint32_t> &indices);
+
+    // All three passes in place, the stats are accumulated so several parts can share them
+    void OptimizeMesh(std::vector<VVertex> &vertices, std::vector<uint32_t> &indices, meshOptStats_t &stats);
+}
@@ -0,0 +1,524 @@
+#include "MeshSimplifier.h"
+#include "MeshOptimizer.h"
+#include "Mesh.h"
+
+#include <algorithm>
+#include <math.h>
+#include <unordered_set>
+
+namespace ElecNeko
+{
+    static const float SIMPLIFY_BORDER_WEIGHT = 10.0f;      // border and seam planes per squared edge length
+    static const float SIMPLIFY_MAX_ERROR_FRACTION = 0.05f; // of the bounds diagonal
+    static const float SIMPLIFY_MIN_REDUCTION = 0.8f;       // a level keeping more of the one before ends the chain
+    static const float SIMPLIFY_MIN_FLIP_COS = 0.25f;       // a triangle that turns further than this is a fold over
+
+    /*
+    ====================================================
+    quadric_t
+
+    Sum of squared distances to weighted planes, the upper half of the
+    symmetric 4x4 matrix of Garland and Heckbert.  Error divides by the
+    total weight, so it is the mean squared distance to the planes.
+    ====================================================
+    */
+    struct quadric_t
+    {
+        double a2, ab, ac, ad;
+        double b2, bc, bd;
+        double c2, cd;
+        double d2;
+        double weight;
+
+        quadric_t() : a2(0), ab(0), ac(0), ad(0), b2(0), bc(0), bd(0), c2(0), cd(0), d2(0), weight(0) {}
+
+        void AddPlane(const Vec3 &normal, const float dist, const double w)
+        {
+            const double a = normal.x;
+            const double b = normal.y;
+            const double c = normal.z;
+            const double d = dist;
+            a2 += w * a * a;
+            ab += w * a * b;
+            ac += w * a * c;
+            ad += w * a * d;
+            b2 += w * b * b;
+            bc += w * b * c;
+            bd += w * b * d;
+            c2 += w * c * c;
+            cd += w * c * d;
+            d2 += w * d * d;
+            weight += w;
+        }
+
+        void Add(const quadric_t &rhs)
+        {
+            a2 += rhs.a2;
+            ab += rhs.ab;
+            ac += rhs.ac;
+            ad += rhs.ad;
+            b2 += rhs.b2;
+            bc += rhs.bc;
+            bd += rhs.bd;
+            c2 += rhs.c2;
+            cd += rhs.cd;
+            d2 += rhs.d2;
+            weight += rhs.weight;
+        }
+
+        double Error(const float *pos) const
+        {
+            if (weight <= 0.0)
+            {
+                return 0.0;
+            }
+            const double x = pos[0];
+            const double y = pos[1];
+            const double z = pos[2];
+            const double error = a2 * x * x + b2 * y * y + c2 * z * z + 2.0 * (ab * x * y + ac * x * z + bc * y * z) +
+                                 2.0 * (ad * x + bd * y + cd * z) + d2;
+            return std::max(error, 0.0) / weight;
+        }
+    };
+
+    struct collapse_t
+    {
+        uint32_t from; // positions, see posId in SimplifyMesh
+        uint32_t to;
+        double error;
+    };
+
+    static uint64_t EdgeKey(const uint32_t a, const uint32_t b)
+    {
+        return ((uint64_t) a << 32) | b;
+    }
+
+    static Vec3 GetPosition(const VVertex &vertex)
+    {
+        return Vec3(vertex.position[0], vertex.position[1], vertex.position[2]);
+    }
+
+    static bool SamePosition(const VVertex &a, const VVertex &b)
+    {
+        return a.position[0] == b.position[0] && a.position[1] == b.position[1] && a.position[2] == b.position[2];
+    }
+
+    /*
+    ====================================================
+    simplifyState_t
+
+    Everything SimplifyMesh keeps across its passes.  Positions are
+    identified by the first vertex that has them, posId, and the vertices
+    sharing one, its wedges, are linked in a ring through nextWedge.
+    ====================================================
+    */
+    struct simplifyState_t
+    {
+        const VVertex *vertices;
+        std::vector<uint32_t> posId;
+        std::vector<uint32_t> nextWedge;
+        std::vector<quadric_t> quadrics;          // by position
+        std::vector<uint8_t> onBorder;            // by position
+        std::unordered_set<uint64_t> borderEdges; // position pairs, both ways round
+
+        // Triangles of every vertex, rebuilt each pass
+        std::vector<uint32_t> triOffsets;
+        std::vector<uint32_t> triList;
+
+        // The vertex at position 'to' that shares a triangle with the wedge, false if there isn't
+        // exactly one.  A wedge that is in no triangle anymore needs none and gets itself.
+        bool FindPartner(const std::vector<uint32_t> &indices, const uint32_t wedge, const uint32_t to, uint32_t &partner) const
+        {
+            const uint32_t none = 0xFFFFFFFF;
+            partner = none;
+            for (uint32_t i = triOffsets[wedge]; i < triOffsets[wedge + 1]; i++)
+            {
+                const uint32_t *tri = &indices[3 * triList[i]];
+                for (int k = 0; k < 3; k++)
+                {
+                    if (posId[tri[k]] != to)
+                    {
+                        continue;
+                    }
+                    if (partner != none && partner != tri[k])
+                    {
+                        return false;
+                    }
+                    partner = tri[k];
+                }
+            }
+
+            if (partner == none)
+            {
+                partner = wedge;
+                return triOffsets[wedge] == triOffsets[wedge + 1];
+            }
+            return true;
+        }
+
+        bool CanCollapse(const std::vector<uint32_t> &indices, const uint32_t from, const uint32_t to) const
+        {
+            // Borders and seams only shorten along themselves
+            if (onBorder[from] && borderEdges.count(EdgeKey(from, to)) == 0)
+            {
+                return false;
+            }
+
+            uint32_t wedge = from;
+            do
+            {
+                uint32_t partner;
+                if (!FindPartner(indices, wedge, to, partner))
+                {
+                    return false;
+                }
+                wedge = nextWedge[wedge];
+            } while (wedge != from);
+            return true;
+        }
+    };
+
+    void SimplifyMesh(std::vector<uint32_t> &dst, const uint32_t *indices, const int numIndices, const VVertex *vertices, const int numVertices,
+                      const int targetIndexCount, const float targetError, float &resultError)
+    {
+        resultError = 0.0f;
+
+        simplifyState_t state;
+        state.vertices = vertices;
+
+        //
+        //	Group the vertices by position
+        //
+        std::vector<uint32_t> sorted(numVertices);
+        for (int i = 0; i < numVertices; i++)
+        {
+            sorted[i] = i;
+        }
+        std::sort(sorted.begin(), sorted.end(), [vertices](const uint32_t a, const uint32_t b) {
+            const float *pa = vertices[a].position;
+            const float *pb = vertices[b].position;
+            if (pa[0] != pb[0])
+            {
+                return pa[0] < pb[0];
+            }
+            if (pa[1] != pb[1])
+            {
+                return pa[1] < pb[1];
+            }
+            return pa[2] < pb[2];
+        });
+
+        state.posId.resize(numVertices);
+        state.nextWedge.resize(numVertices);
+        for (int i = 0; i < numVertices;)
+        {
+            int end = i + 1;
+            while (end < numVertices && SamePosition(vertices[sorted[i]], vertices[sorted[end]]))
+            {
+                end++;
+            }
+            for (int k = i; k < end; k++)
+            {
+                state.posId[sorted[k]] = sorted[i];
+                state.nextWedge[sorted[k]] = sorted[(k + 1 < end) ? k + 1 : i];
+            }
+            i = end;
+        }
+        const std::vector<uint32_t> &posId = state.posId;
+
+        // Triangles that are already degenerate would only confuse the border detection
+        dst.clear();
+        dst.reserve(numIndices);
+        for (int i = 0; i + 2 < numIndices; i += 3)
+        {
+            const uint32_t p0 = posId[indices[i + 0]];
+            const uint32_t p1 = posId[indices[i + 1]];
+            const uint32_t p2 = posId[indices[i + 2]];
+            if (p0 != p1 && p1 != p2 && p2 != p0)
+            {
+                dst.insert(dst.end(), indices + i, indices + i + 3);
+            }
+        }
+
+        //
+        //	Quadrics of the triangle planes, plus a plane through every border and seam
+        //	edge that stands on its triangle.  A half edge without its twin among the
+        //	vertices is on a border, one without its twin among the wedges is on a seam.
+        //
+        state.quadrics.resize(numVertices);
+        state.onBorder.assign(numVertices, 0);
+
+        std::unordered_set<uint64_t> halfEdges;
+        halfEdges.reserve(dst.size());
+        for (size_t i = 0; i < dst.size(); i += 3)
+        {
+            for (int k = 0; k < 3; k++)
+            {
+                halfEdges.insert(EdgeKey(dst[i + k], dst[i + (k + 1) % 3]));
+            }
+        }
+
+        for (size_t i = 0; i < dst.size(); i += 3)
+        {
+            const uint32_t *tri = &dst[i];
+            const Vec3 p0 = GetPosition(vertices[tri[0]]);
+            const Vec3 p1 = GetPosition(vertices[tri[1]]);
+            const Vec3 p2 = GetPosition(vertices[tri[2]]);
+
+            Vec3 normal = (p1 - p0).Cross(p2 - p0);
+            const float doubleArea = normal.GetMagnitude();
+            if (doubleArea <= 0.0f)
+            {
+                continue;
+            }
+            normal /= doubleArea;
+
+            for (int k = 0; k < 3; k++)
+            {
+                state.quadrics[posId[tri[k]]].AddPlane(normal, -normal.Dot(p0), 0.5 * doubleArea);
+            }
+
+            for (int k = 0; k < 3; k++)
+            {
+                const uint32_t a = tri[k];
+                const uint32_t b = tri[(k + 1) % 3];
+                if (halfEdges.count(EdgeKey(b, a)) != 0)
+                {
+                    continue;
+                }
+
+                const Vec3 pa = GetPosition(vertices[a]);
+                const Vec3 edge = GetPosition(vertices[b]) - pa;
+                const float lengthSqr = edge.Dot(edge);
+                Vec3 borderNormal = edge.Cross(normal);
+                if (lengthSqr <= 0.0f || borderNormal.GetMagnitude() <= 0.0f)
+                {
+                    continue;
+                }
+                borderNormal.Normalize();
+
+                const double w = SIMPLIFY_BORDER_WEIGHT * lengthSqr;
+                state.quadrics[posId[a]].AddPlane(borderNormal, -borderNormal.Dot(pa), w);
+                state.quadrics[posId[b]].AddPlane(borderNormal, -borderNormal.Dot(pa), w);
+                state.onBorder[posId[a]] = 1;
+                state.onBorder[posId[b]] = 1;
+                state.borderEdges.insert(EdgeKey(posId[a], posId[b]));
+                state.borderEdges.insert(EdgeKey(posId[b], posId[a]));
+            }
+        }
+
+        //
+        //	Collapse in passes, the cheapest first.  A collapse locks its positions and
+        //	every position around the one that moves, so the checks of a pass all see
+        //	the mesh as it was at its start.
+        //
+        const double maxError = (double) targetError * targetError;
+        double acceptedError = 0.0;
+
+        std::vector<uint32_t> remap(numVertices);
+        std::vector<uint8_t> locked(numVertices);
+        std::vector<collapse_t> collapses;
+
+        while ((int) dst.size() > targetIndexCount)
+        {
+            const int numTris = (int) dst.size() / 3;
+
+            state.triOffsets.assign(numVertices + 1, 0);
+            for (size_t i = 0; i < dst.size(); i++)
+            {
+                state.triOffsets[dst[i] + 1]++;
+            }
+            for (int i = 0; i < numVertices; i++)
+            {
+                state.triOffsets[i + 1] += state.triOffsets[i];
+            }
+            state.triList.resize(dst.size());
+            {
+                std::vector<uint32_t> cursor(state.triOffsets.begin(), state.triOffsets.end() - 1);
+                for (size_t i = 0; i < dst.size(); i++)
+                {
+                    state.triList[cursor[dst[i]]++] = (uint32_t) (i / 3);
+                }
+            }
+
+            collapses.clear();
+            for (size_t i = 0; i < dst.size(); i += 3)
+            {
+                for (int k = 0; k < 3; k++)
+                {
+                    const uint32_t a = posId[dst[i + k]];
+                    const uint32_t b = posId[dst[i + (k + 1) % 3]];
+
+                    quadric_t quadric = state.quadrics[a];
+                    quadric.Add(state.quadrics[b]);
+
+                    if (state.CanCollapse(dst, a, b))
+                    {
+                        collapse_t collapse = {a, b, quadric.Error(vertices[b].position)};
+                        collapses.push_back(collapse);
+                    }
+                    if (state.CanCollapse(dst, b, a))
+                    {
+                        collapse_t collapse = {b, a, quadric.Error(vertices[a].position)};
+                        collapses.push_back(collapse);
+                    }
+                }
+            }
+            std::sort(collapses.begin(), collapses.end(), [](const collapse_t &a, const collapse_t &b) { return a.error < b.error; });
+
+            for (int i = 0; i < numVertices; i++)
+            {
+                remap[i] = i;
+            }
+            std::fill(locked.begin(), locked.end(), 0);
+
+            const int targetTris = targetIndexCount / 3;
+            int trisLeft = numTris;
+            int numApplied = 0;
+            for (const collapse_t &collapse : collapses)
+            {
+                if (collapse.error > maxError || trisLeft <= targetTris)
+                {
+                    break;
+                }
+                if (locked[collapse.from] || locked[collapse.to])
+                {
+                    continue;
+                }
+
+                // Moving the position mustn't fold a remaining triangle over
+                const Vec3 target = GetPosition(vertices[collapse.to]);
+                int removed = 0;
+                bool flips = false;
+                uint32_t wedge = collapse.from;
+                do
+                {
+                    for (uint32_t t = state.triOffsets[wedge]; t < state.triOffsets[wedge + 1] && !flips; t++)
+                    {
+                        const uint32_t *tri = &dst[3 * state.triList[t]];
+                        if (posId[tri[0]] == collapse.to || posId[tri[1]] == collapse.to || posId[tri[2]] == collapse.to)
+                        {
+                            removed++;
+                            continue;
+                        }
+
+                        Vec3 before[3];
+                        Vec3 after[3];
+                        for (int k = 0; k < 3; k++)
+                        {
+                            before[k] = GetPosition(vertices[tri[k]]);
+                            after[k] = (posId[tri[k]] == collapse.from) ? target : before[k];
+                        }
+                        const Vec3 normalBefore = (before[1] - before[0]).Cross(before[2] - before[0]);
+                        const Vec3 normalAfter = (after[1] - after[0]).Cross(after[2] - after[0]);
+                        flips = normalBefore.Dot(normalAfter) < SIMPLIFY_MIN_FLIP_COS * normalBefore.GetMagnitude() * normalAfter.GetMagnitude();
+                    }
+                    wedge = state.nextWedge[wedge];
+                } while (wedge != collapse.from && !flips);
+
+                if (flips)
+                {
+                    continue;
+                }
+
+                do
+                {
+                    uint32_t partner;
+                    state.FindPartner(dst, wedge, collapse.to, partner);
+                    remap[wedge] = partner;
+
+                    for (uint32_t t = state.triOffsets[wedge]; t < state.triOffsets[wedge + 1]; t++)
+                    {
+                        const uint32_t *tri = &dst[3 * state.triList[t]];
+                        locked[posId[tri[0]]] = 1;
+                        locked[posId[tri[1]]] = 1;
+                        locked[posId[tri[2]]] = 1;
+                    }
+                    wedge = state.nextWedge[wedge];
+                } while (wedge != collapse.from);
+
+                state.quadrics[collapse.to].Add(state.quadrics[collapse.from]);
+                locked[collapse.from] = 1;
+                locked[collapse.to] = 1;
+
+                trisLeft -= removed;
+                acceptedError = std::max(acceptedError, collapse.error);
+                numApplied++;
+            }
+
+            if (numApplied == 0)
+            {
+                break;
+            }
+
+            // Apply the pass and drop the triangles that collapsed
+            size_t numKept = 0;
+            for (size_t i = 0; i < dst.size(); i += 3)
+            {
+                const uint32_t i0 = remap[dst[i + 0]];
+                const uint32_t i1 = remap[dst[i + 1]];
+                const uint32_t i2 = remap[dst[i + 2]];
+                if (posId[i0] == posId[i1] || posId[i1] == posId[i2] || posId[i2] == posId[i0])
+                {
+                    continue;
+                }
+                dst[numKept++] = i0;
+                dst[numKept++] = i1;
+                dst[numKept++] = i2;
+            }
+            dst.resize(numKept);
+        }
+
+        resultError = (float) sqrt(acceptedError);
+    }
+
+    void BuildMeshLods(const std::vector<VVertex> &vertices, const std::vector<uint32_t> &indices, std::vector<uint32_t> &lodIndices,
+                       std::vector<meshLod_t> &lods)
+    {
+        lods.clear();
+        meshLod_t full = {0, (uint32_t) indices.size(), 0.0f};
+        lods.push_back(full);
+        if (indices.empty())
+        {
+            return;
+        }
+
+        // Past a few percent of the part the silhouette is gone, simplifying further isn't worth it
+        Bounds bounds;
+        for (const VVertex &vertex : vertices)
+        {
+            bounds.Expand(GetPosition(vertex));
+        }
+        const float maxError = SIMPLIFY_MAX_ERROR_FRACTION * (bounds.maxs - bounds.mins).GetMagnitude();
+
+        std::vector<uint32_t> source(indices);
+        std::vector<uint32_t> simplified;
+        std::vector<uint32_t> optimized;
+        float error = 0.0f;
+        for (int level = 1; level < MESH_MAX_LODS; level++)
+        {
+            const int targetIndexCount = (int) (source.size() / 6) * 3;
+            float levelError = 0.0f;
+            SimplifyMesh(simplified, source.data(), (int) source.size(), vertices.data(), (int) vertices.size(), targetIndexCount, maxError, levelError);
+            if (simplified.empty() || (float) simplified.size() > SIMPLIFY_MIN_REDUCTION * (float) source.size())
+            {
+                break;
+            }
+
+            // Each level is simplified from the one before, so their errors add up
+            error += levelError;
+
+            optimized.resize(simplified.size());
+            OptimizeVertexCache(optimized.data(), simplified.data(), (int) simplified.size(), (int) vertices.size());
+
+            meshLod_t lod;
+            lod.firstIndex = (uint32_t) (indices.size() + lodIndices.size());
+            lod.numIndices = (uint32_t) optimized.size();
+            lod.error = error;
+            lods.push_back(lod);
+            lodIndices.insert(lodIndices.end(), optimized.begin(), optimized.end());
+
+            source.swap(simplified);
+        }
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+namespace ElecNeko
+{
+    struct VVertex;
+
+    /*
+    ====================================================
+    Mesh simplifier
+
+    Garland and Heckbert's quadric error edge collapse.  Every vertex
+    collapses onto one of its neighbours rather than a new position, so
+    a simplified mesh is only a new index list over the same vertices and
+    the levels of detail of a part share its vertex buffer.
+
+    Vertices with the same position but different uvs or normals are
+    collapsed together, each onto the neighbour on its own side of the
+    seam, and a collapse that can't do that is skipped, so seams stay
+    where they are.  Border and seam edges add a plane through the edge to
+    the quadrics, so they stay straight.
+
+    The error is the weighted mean distance of the collapsed vertices to
+    the planes of the triangles they came from, in the units of the mesh.
+    ====================================================
+    */
+    const int MESH_MAX_LODS = 4; // including the full detail one
+
+    struct meshLod_t
+    {
+        uint32_t firstIndex; // into the part's index buffer
+        uint32_t numIndices;
+        float error;
+    };
+
+    // Indices of a simplified mesh with at most targetIndexCount indices, or as close as the
+    // collapses under targetError get to it.  resultError is the largest error accepted.
+    void SimplifyMesh(std::vector<uint32_t> &dst, const uint32_t *indices, const int numIndices, const VVertex *vertices, const int numVertices,
+                      const int targetIndexCount, const float targetError, float &resultError);
+
+    // Levels 1 and up, each about half the triangles of the one before, appended to lodIndices.
+    // lods gets the full detail level first, the chain stops early when a level barely simplifies.
+    void BuildMeshLods(const std::vector<VVertex> &vertices, const std::vector<uint32_t> &indices, std::vector<uint32_t> &lodIndices,
+                       std::vector<meshLod_t> &lods);
+}
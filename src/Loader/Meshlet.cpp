@@ -0,0 +1,186 @@
+#include "Meshlet.h"
+#include "Mesh.h"
+
+#include <algorithm>
+#include <math.h>
+
+#include "../Math/FastMath.h"
+
+namespace ElecNeko
+{
+    static const float MESHLET_MIN_CONE_DOT = 0.1f; // wider cones are never worth testing
+
+    static Vec3 GetPosition(const VVertex &vertex)
+    {
+        return Vec3(vertex.position[0], vertex.position[1], vertex.position[2]);
+    }
+
+    static void StoreVec3(const Vec3 &v, float *dst)
+    {
+        dst[0] = v.x;
+        dst[1] = v.y;
+        dst[2] = v.z;
+    }
+
+    /*
+    ====================================================
+    ComputeMeshletBounds
+
+    The sphere is centered on the box, loose but cheap.  The cone axis is
+    the mean of the triangle normals, its apex is pulled back along the
+    axis until every triangle plane is in front of it, see Meshlet.h.
+    ====================================================
+    */
+    static void ComputeMeshletBounds(meshlet_t &meshlet, const std::vector<VVertex> &vertices, const std::vector<uint32_t> &indices,
+                                     const std::vector<uint32_t> &meshletVertices)
+    {
+        Bounds bounds;
+        for (uint32_t v = 0; v < meshlet.numVertices; v++)
+        {
+            bounds.Expand(GetPosition(vertices[meshletVertices[meshlet.firstVertex + v]]));
+        }
+        const Vec3 center = (bounds.mins + bounds.maxs) * 0.5f;
+        float radiusSqr = 0.0f;
+        for (uint32_t v = 0; v < meshlet.numVertices; v++)
+        {
+            radiusSqr = std::max(radiusSqr, (GetPosition(vertices[meshletVertices[meshlet.firstVertex + v]]) - center).GetLengthSqr());
+        }
+        StoreVec3(center, meshlet.center);
+        meshlet.radius = sqrtf(radiusSqr);
+        StoreVec3(bounds.mins, meshlet.mins);
+        StoreVec3(bounds.maxs, meshlet.maxs);
+
+        // Unit normals, the degenerate triangles can face any way
+        Vec3 normals[MESHLET_MAX_TRIANGLES];
+        Vec3 corners[MESHLET_MAX_TRIANGLES];
+        int numNormals = 0;
+        Vec3 axis(0.0f);
+        for (uint32_t t = 0; t < meshlet.numTriangles; t++)
+        {
+            const uint32_t *tri = &indices[meshlet.firstIndex + 3 * t];
+            const Vec3 p0 = GetPosition(vertices[tri[0]]);
+            Vec3 normal = (GetPosition(vertices[tri[1]]) - p0).Cross(GetPosition(vertices[tri[2]]) - p0);
+            const float length = normal.GetMagnitude();
+            if (length <= 0.0f)
+            {
+                continue;
+            }
+            normal /= length;
+            normals[numNormals] = normal;
+            corners[numNormals] = p0;
+            numNormals++;
+            axis += normal;
+        }
+
+        StoreVec3(Vec3(0.0f), meshlet.coneApex);
+        StoreVec3(Vec3(0.0f, 0.0f, 1.0f), meshlet.coneAxis);
+        meshlet.coneCutoff = 1.0f;
+
+        const float axisLength = axis.GetMagnitude();
+        if (numNormals == 0 || axisLength <= 0.0f)
+        {
+            return;
+        }
+        axis /= axisLength;
+
+        float minDot = 1.0f;
+        for (int i = 0; i < numNormals; i++)
+        {
+            minDot = std::min(minDot, normals[i].Dot(axis));
+        }
+        if (minDot <= MESHLET_MIN_CONE_DOT)
+        {
+            return;
+        }
+
+        float maxT = 0.0f;
+        for (int i = 0; i < numNormals; i++)
+        {
+            // Where the axis through the center crosses the plane of the triangle
+            const float t = (center - corners[i]).Dot(normals[i]) / axis.Dot(normals[i]);
+            maxT = std::max(maxT, t);
+        }
+
+        StoreVec3(center - axis * maxT, meshlet.coneApex);
+        StoreVec3(axis, meshlet.coneAxis);
+        meshlet.coneCutoff = sqrtf(1.0f - minDot * minDot);
+    }
+
+    void BuildMeshlets(const std::vector<VVertex> &vertices, const std::vector<uint32_t> &indices, std::vector<meshlet_t> &meshlets,
+                       std::vector<uint32_t> &meshletVertices, std::vector<uint8_t> &meshletTriangles)
+    {
+        meshlets.clear();
+        meshletVertices.clear();
+        meshletTriangles.clear();
+        meshletTriangles.reserve(indices.size());
+
+        // Where each vertex is in the meshlet being filled
+        const uint8_t unused = 0xFF;
+        std::vector<uint8_t> localIndex(vertices.size(), unused);
+
+        meshlet_t meshlet = {};
+        auto finish = [&](const uint32_t nextIndex) {
+            ComputeMeshletBounds(meshlet, vertices, indices, meshletVertices);
+            meshlets.push_back(meshlet);
+
+            for (uint32_t v = 0; v < meshlet.numVertices; v++)
+            {
+                localIndex[meshletVertices[meshlet.firstVertex + v]] = unused;
+            }
+            meshlet = meshlet_t();
+            meshlet.firstIndex = nextIndex;
+            meshlet.firstVertex = (uint32_t) meshletVertices.size();
+        };
+
+        // The triangles stay in draw order, which the vertex cache pass already made local
+        for (size_t i = 0; i + 2 < indices.size(); i += 3)
+        {
+            const uint32_t *tri = &indices[i];
+            int numNew = 0;
+            for (int k = 0; k < 3; k++)
+            {
+                const bool repeated = (k > 0 && tri[k] == tri[0]) || (k > 1 && tri[k] == tri[1]);
+                if (localIndex[tri[k]] == unused && !repeated)
+                {
+                    numNew++;
+                }
+            }
+
+            if (meshlet.numVertices + numNew > MESHLET_MAX_VERTICES || meshlet.numTriangles + 1 > MESHLET_MAX_TRIANGLES)
+            {
+                finish((uint32_t) i);
+            }
+
+            for (int k = 0; k < 3; k++)
+            {
+                if (localIndex[tri[k]] == unused)
+                {
+                    localIndex[tri[k]] = (uint8_t) meshlet.numVertices++;
+                    meshletVertices.push_back(tri[k]);
+                }
+                meshletTriangles.push_back(localIndex[tri[k]]);
+            }
+            meshlet.numTriangles++;
+        }
+
+        if (meshlet.numTriangles > 0)
+        {
+            finish((uint32_t) indices.size());
+        }
+    }
+
+    bool IsMeshletBackFacing(const meshlet_t &meshlet, const Vec3 &viewPos)
+    {
+        if (meshlet.coneCutoff >= 1.0f)
+        {
+            return false;
+        }
+
+        // Inside the cone behind the apex: dot( normalize( apex - view ), axis ) >= cutoff
+        const Vec3 apex(meshlet.coneApex[0], meshlet.coneApex[1], meshlet.coneApex[2]);
+        const Vec3 axis(meshlet.coneAxis[0], meshlet.coneAxis[1], meshlet.coneAxis[2]);
+        const Vec3 dir = apex - viewPos;
+        const float distance = MathFunctions<MATH_ACCURACY_CULLING>::Sqrt(dir.GetLengthSqr());
+        return dir.Dot(axis) >= meshlet.coneCutoff * distance;
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+class Vec3;
+
+namespace ElecNeko
+{
+    struct VVertex;
+
+    /*
+    ====================================================
+    Meshlets
+
+    Small clusters of a part's full detail triangles, at most
+    MESHLET_MAX_VERTICES vertices and MESHLET_MAX_TRIANGLES triangles, the
+    sizes mesh shaders like.  They are cut from the index list in the
+    order it is drawn, so every meshlet is also a range of m_indices and
+    the ones that survive culling can be drawn from the index buffer as
+    it is.
+
+    For mesh shaders each meshlet also has its own vertex list, indices
+    into the part's vertices, and its triangles as three uint8 indices
+    into that list.  The triangles line up with m_indices, the local
+    triangle of m_indices[i] is meshletTriangles[i].
+
+    The cone holds every triangle normal of the meshlet, it is entirely
+    back facing from anywhere inside the cone behind its apex.
+    ====================================================
+    */
+    const int MESHLET_MAX_VERTICES = 64;
+    const int MESHLET_MAX_TRIANGLES = 124;
+
+    struct meshlet_t
+    {
+        uint32_t firstIndex; // into m_indices, three per triangle
+        uint32_t numTriangles;
+        uint32_t firstVertex; // into the meshlet vertex list
+        uint32_t numVertices;
+
+        float center[3]; // bounding sphere
+        float radius;
+        float mins[3];
+        float maxs[3];
+
+        float coneApex[3];
+        float coneAxis[3];
+        float coneCutoff; // sine of the half angle, 1 when the normals spread too far to ever cull
+    };
+
+    void BuildMeshlets(const std::vector<VVertex> &vertices, const std::vector<uint32_t> &indices, std::vector<meshlet_t> &meshlets,
+                       std::vector<uint32_t> &meshletVertices, std::vector<uint8_t> &meshletTriangles);
+
+    // True when every triangle of the meshlet faces away from viewPos, in the meshlet's space
+    bool IsMeshletBackFacing(const meshlet_t &meshlet, const Vec3 &viewPos);
+}
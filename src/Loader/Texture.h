@@ -8,6 +8,8 @@
 
 #include "RHI/Image.h"
 #include "RHI/Buffer.h"
+#include "TextureCache.h"
+#include "../Fileio.h"
 
 #include "stb_image.h"
 
@@ -16,11 +18,22 @@ namespace ElecNeko
     class Texture
     {
     public:
-        Texture() : width(0), height(0), components(0), isLoaded(false) {}
+        Texture() : width(0), height(0), components(0), isLoaded(false), format(VK_FORMAT_R8G8B8A8_UNORM) {}
         Texture(const std::string &texName, unsigned char *data, int w, int h, int c);
         ~Texture() = default;
 
-        bool LoadTexture(DeviceContext *device, const std::string &filename);
+        bool LoadTexture(DeviceContext *device, const std::string &filename, const textureUsage_t usage = TEXTURE_USAGE_ALBEDO);
+
+        // LoadTexture in two steps, Decode has no device work and is safe on any thread.
+        // Upload records the copy and the mip chain into cmdBuffer, stagingBuffer must live until it
+        // has executed.  The pixels are released once they are in stagingBuffer.
+        //
+        // Decode reads the block compressed bake of the image, see TextureCache.h, and only decodes
+        // and compresses the source when the bake is missing or stale.  Without bake the source is
+        // decoded to RGBA8, for devices that can't sample the bake format.
+        bool Decode(const std::string &filename, const textureUsage_t usage = TEXTURE_USAGE_ALBEDO, const bool bake = true);
+        bool Decode(const std::string &filename, const textureUsage_t usage, const MappedFile &source, const uint64_t sourceHash, const bool bake);
+        bool Upload(DeviceContext *device, VkCommandBuffer cmdBuffer, Buffer &stagingBuffer);
 
     public:
         int height;
@@ -30,75 +43,156 @@ namespace ElecNeko
         std::vector<uint8_t> texData;
         std::string name;
 
+        // Every level is in texData when levels isn't empty, otherwise it is RGBA8 and the mips are blitted
+        VkFormat format;
+        std::vector<textureLevel_t> levels;
+
         Image m_image;
     };
 
-    inline Texture::Texture(const std::string &texName, unsigned char *data, int w, int h, int c) : name(std::move(texName)), width(w), height(h), components(c)
+    inline Texture::Texture(const std::string &texName, unsigned char *data, int w, int h, int c) : name(std::move(texName)), width(w), height(h), components(c), format(VK_FORMAT_R8G8B8A8_UNORM)
     {
         texData.resize(w * h * c);
         std::copy_n(data, w * h * c, texData.begin());
     }
 
-    inline bool Texture::LoadTexture(DeviceContext * device, const std::string &filename)
+    inline bool Texture::LoadTexture(DeviceContext * device, const std::string &filename, const textureUsage_t usage)
+    {
+        if (!Decode(filename, usage, Image::SupportsSampling(device, GetTextureBakeFormat(usage))))
+        {
+            return false;
+        }
+
+        Buffer stagingBuffer;
+        VkCommandBuffer cmdBuffer = device->CreateCommandBuffer(VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+        const bool result = Upload(device, cmdBuffer, stagingBuffer);
+        device->FlushCommandBuffer(cmdBuffer, device->m_vkGraphicsQueue);
+        if (result)
+        {
+            stagingBuffer.Cleanup(device);
+        }
+
+        return result;
+    }
+
+    inline bool Texture::Decode(const std::string &filename, const textureUsage_t usage, const bool bake)
+    {
+        MappedFile source;
+        if (!source.Open(filename.c_str()))
+        {
+            std::cerr << "Failed to load texture: " << filename << std::endl;
+            return false;
+        }
+        return Decode(filename, usage, source, HashData(source.GetData(), source.GetSize()), bake);
+    }
+
+    inline bool Texture::Decode(const std::string &filename, const textureUsage_t usage, const MappedFile &source, const uint64_t sourceHash,
+                                const bool bake)
     {
         name = filename;
         components = 4;
-        uint8_t *pixels = stbi_load(filename.c_str(), &width, &height, nullptr, components);
+        levels.clear();
 
-        VkDeviceSize imageSize = width * height * components;
+        const std::string cacheFile = filename + ".texcache";
+        if (bake && ReadTextureCache(cacheFile, sourceHash, usage, format, width, height, texData, levels))
+        {
+            return true;
+        }
 
+        uint8_t *pixels = stbi_load_from_memory(source.GetData(), static_cast<int>(source.GetSize()), &width, &height, nullptr, components);
         if (!pixels)
         {
             std::cerr << "Failed to load texture: " << name << std::endl;
             return false;
         }
 
-        texData.assign(pixels, pixels + imageSize);
+        texData.clear();
+        format = GetTextureBakeFormat(usage);
+        if (bake && CompressTexture(pixels, width, height, format, usage, texData, levels))
+        {
+            WriteTextureCache(cacheFile, sourceHash, usage, format, width, height, texData, levels);
+        }
+        else
+        {
+            VkDeviceSize imageSize = width * height * components;
+            format = VK_FORMAT_R8G8B8A8_UNORM;
+            levels.clear();
+            texData.assign(pixels, pixels + imageSize);
+        }
+        stbi_image_free(pixels);
+        return true;
+    }
+
+    inline bool Texture::Upload(DeviceContext *device, VkCommandBuffer cmdBuffer, Buffer &stagingBuffer)
+    {
+        if (texData.empty())
+        {
+            return false;
+        }
 
+        const bool isBaked = !levels.empty();
         {
             Image::CreateParms_t parms{};
             parms.usageFlags = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
-            parms.format = VK_FORMAT_R8G8B8A8_UNORM;
+            parms.format = format;
             parms.width = width;
             parms.height = height;
             parms.depth = 1;
+            parms.mipLevels = 1;
+            if (isBaked)
+            {
+                parms.mipLevels = static_cast<int>(levels.size());
+            }
+            else if (Image::SupportsLinearBlit(device, parms.format))
+            {
+                parms.usageFlags |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+                parms.mipLevels = Image::GetNumMipLevels(width, height);
+            }
 
             if (!m_image.Create(device, parms))
             {
                 std::cerr << "Failed to create Vulkan image for texture: " << name << std::endl;
-                stbi_image_free(pixels);
                 return false;
             }
         }
 
-        Buffer stagingBuffer;
-        stagingBuffer.Allocate(device, texData.data(), static_cast<int>(imageSize), VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
+        stagingBuffer.Allocate(device, texData.data(), static_cast<int>(texData.size()), VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
 
-        VkCommandBuffer cmdBuffer = device->CreateCommandBuffer(VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+        // The GPU has its own copy now, the CPU one would only sit there for the life of the texture
+        std::vector<uint8_t>().swap(texData);
 
         m_image.TransitionLayout(cmdBuffer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
 
         {
-            VkBufferImageCopy region = {};
-            region.bufferOffset = 0;
-            region.bufferRowLength = 0;
-            region.bufferImageHeight = 0;
-            region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-            region.imageSubresource.mipLevel = 0;
-            region.imageSubresource.baseArrayLayer = 0;
-            region.imageSubresource.layerCount = 1;
-            region.imageOffset = {0, 0, 0};
-            region.imageExtent = {static_cast<uint32_t>(width), static_cast<uint32_t>(height), 1};
-
-            vkCmdCopyBufferToImage(cmdBuffer, stagingBuffer.m_vkBuffer, m_image.m_vkImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
-        }
-
-        m_image.TransitionLayout(cmdBuffer, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+            // The baked levels are copied as they are, otherwise only the first one
+            const int numRegions = isBaked ? static_cast<int>(levels.size()) : 1;
+            std::vector<VkBufferImageCopy> regions(numRegions);
+            for (int i = 0; i < numRegions; i++)
+            {
+                VkBufferImageCopy &region = regions[i];
+                region = {};
+                region.bufferOffset = isBaked ? levels[i].offset : 0;
+                region.bufferRowLength = 0;
+                region.bufferImageHeight = 0;
+                region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+                region.imageSubresource.mipLevel = i;
+                region.imageSubresource.baseArrayLayer = 0;
+                region.imageSubresource.layerCount = 1;
+                region.imageOffset = {0, 0, 0};
+                region.imageExtent = {static_cast<uint32_t>(std::max(1, width >> i)), static_cast<uint32_t>(std::max(1, height >> i)), 1};
+            }
 
-        device->FlushCommandBuffer(cmdBuffer, device->m_vkGraphicsQueue);
+            vkCmdCopyBufferToImage(cmdBuffer, stagingBuffer.m_vkBuffer, m_image.m_vkImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, numRegions, regions.data());
+        }
 
-        stagingBuffer.Cleanup(device);
-        stbi_image_free(pixels);
+        if (isBaked)
+        {
+            m_image.TransitionLayout(cmdBuffer, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        }
+        else
+        {
+            m_image.GenerateMipmaps(cmdBuffer);
+        }
 
         isLoaded = true;
         return true;
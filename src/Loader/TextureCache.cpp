@@ -0,0 +1,132 @@
+#include "TextureCache.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include "RHI/Image.h"
+#include "../Fileio.h"
+
+namespace ElecNeko
+{
+    static uint64_t AlignOffset(const uint64_t offset)
+    {
+        return (offset + TEXTURE_CACHE_ALIGNMENT - 1) & ~(uint64_t) (TEXTURE_CACHE_ALIGNMENT - 1);
+    }
+
+    static uint64_t GetLevelSize(const VkFormat format, const int width, const int height, const int level)
+    {
+        const uint64_t levelWidth = std::max(1, width >> level);
+        const uint64_t levelHeight = std::max(1, height >> level);
+        return ((levelWidth + 3) / 4) * ((levelHeight + 3) / 4) * Image::GetBlockBytes(format);
+    }
+
+    bool ReadTextureCache(const std::string &fileName, const uint64_t sourceHash, const textureUsage_t usage, VkFormat &format, int &width,
+                          int &height, std::vector<uint8_t> &data, std::vector<textureLevel_t> &levels)
+    {
+        MappedFile file;
+        if (!file.Open(fileName.c_str()) || file.GetSize() < sizeof(textureCacheHeader_t))
+        {
+            return false;
+        }
+
+        const unsigned char *fileData = file.GetData();
+        const uint64_t size = file.GetSize();
+
+        textureCacheHeader_t header;
+        memcpy(&header, fileData, sizeof(header));
+        if (header.magic != TEXTURE_CACHE_MAGIC || header.version != TEXTURE_CACHE_VERSION || header.sourceHash != sourceHash ||
+            header.usage != (uint32_t) usage || header.vkFormat != (uint32_t) GetTextureBakeFormat(usage) || header.fileSize != size)
+        {
+            return false;
+        }
+
+        // The whole chain or nothing, the sampler reaches every level
+        if (header.width == 0 || header.height == 0 || header.width > 65536 || header.height > 65536 ||
+            header.numLevels != (uint32_t) Image::GetNumMipLevels(header.width, header.height) || header.numLevels > TEXTURE_CACHE_MAX_LEVELS ||
+            sizeof(textureCacheHeader_t) + header.numLevels * sizeof(textureLevel_t) > size)
+        {
+            return false;
+        }
+
+        const VkFormat cacheFormat = (VkFormat) header.vkFormat;
+        const textureLevel_t *cacheLevels = (const textureLevel_t *) (fileData + sizeof(textureCacheHeader_t));
+        uint64_t totalSize = 0;
+        for (uint32_t i = 0; i < header.numLevels; i++)
+        {
+            const textureLevel_t &level = cacheLevels[i];
+            if (level.size != GetLevelSize(cacheFormat, header.width, header.height, i) || level.offset > size || level.size > size - level.offset)
+            {
+                return false;
+            }
+            totalSize += level.size;
+        }
+
+        format = cacheFormat;
+        width = (int) header.width;
+        height = (int) header.height;
+        data.resize(totalSize);
+        levels.resize(header.numLevels);
+        uint64_t offset = 0;
+        for (uint32_t i = 0; i < header.numLevels; i++)
+        {
+            levels[i].offset = offset;
+            levels[i].size = cacheLevels[i].size;
+            memcpy(data.data() + offset, fileData + cacheLevels[i].offset, cacheLevels[i].size);
+            offset += cacheLevels[i].size;
+        }
+        return true;
+    }
+
+    bool WriteTextureCache(const std::string &fileName, const uint64_t sourceHash, const textureUsage_t usage, const VkFormat format,
+                           const int width, const int height, const std::vector<uint8_t> &data, const std::vector<textureLevel_t> &levels)
+    {
+        const uint32_t numLevels = (uint32_t) levels.size();
+
+        textureCacheHeader_t header;
+        header.magic = TEXTURE_CACHE_MAGIC;
+        header.version = TEXTURE_CACHE_VERSION;
+        header.sourceHash = sourceHash;
+        header.vkFormat = (uint32_t) format;
+        header.usage = (uint32_t) usage;
+        header.width = (uint32_t) width;
+        header.height = (uint32_t) height;
+        header.numLevels = numLevels;
+        header.pad = 0;
+
+        std::vector<textureLevel_t> cacheLevels(numLevels);
+        uint64_t offset = sizeof(textureCacheHeader_t) + numLevels * sizeof(textureLevel_t);
+        for (uint32_t i = 0; i < numLevels; i++)
+        {
+            offset = AlignOffset(offset);
+            cacheLevels[i].offset = offset;
+            cacheLevels[i].size = levels[i].size;
+            offset += levels[i].size;
+        }
+        header.fileSize = offset;
+
+        std::vector<unsigned char> fileData(offset, 0);
+        memcpy(fileData.data(), &header, sizeof(header));
+        memcpy(fileData.data() + sizeof(header), cacheLevels.data(), numLevels * sizeof(textureLevel_t));
+        for (uint32_t i = 0; i < numLevels; i++)
+        {
+            memcpy(fileData.data() + cacheLevels[i].offset, data.data() + levels[i].offset, levels[i].size);
+        }
+
+        // Written here rather than through SaveFileData, which isn't safe to call from the loader threads
+        FILE *file = fopen(fileName.c_str(), "wb");
+        if (file == nullptr)
+        {
+            printf("Failed to open texture cache for writing: %s\n", fileName.c_str());
+            return false;
+        }
+        const bool result = fwrite(fileData.data(), 1, fileData.size(), file) == fileData.size();
+        fclose(file);
+        if (!result)
+        {
+            printf("Failed to write texture cache: %s\n", fileName.c_str());
+            remove(fileName.c_str());
+        }
+        return result;
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "TextureCompressor.h"
+
+namespace ElecNeko
+{
+    /*
+    ====================================================
+    Texture cache
+
+    A block compressed bake of a source image with its whole mip chain,
+    written next to it as <image>.texcache on the first load.  Laid out
+    after KTX2, a header with the Vulkan format and a level index, so the
+    levels are copied into the image as they are and nothing is decoded.
+
+        textureCacheHeader_t
+        textureLevel_t       [numLevels], largest first
+        level data, each level aligned to TEXTURE_CACHE_ALIGNMENT
+
+    The hash of the source image is stored in the header, a changed
+    source, version, usage or bake format makes the cache stale.
+    ====================================================
+    */
+    const uint32_t TEXTURE_CACHE_MAGIC = 0x58544E45; // "ENTX"
+    const uint32_t TEXTURE_CACHE_VERSION = 1;
+    const uint32_t TEXTURE_CACHE_ALIGNMENT = 16;
+    const int TEXTURE_CACHE_MAX_LEVELS = 16;
+
+    struct textureCacheHeader_t
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t sourceHash;
+        uint64_t fileSize;
+        uint32_t vkFormat;
+        uint32_t usage;
+        uint32_t width;
+        uint32_t height;
+        uint32_t numLevels;
+        uint32_t pad;
+    };
+
+    // data gets every level, levels where each one is in data
+    bool ReadTextureCache(const std::string &fileName, const uint64_t sourceHash, const textureUsage_t usage, VkFormat &format, int &width,
+                          int &height, std::vector<uint8_t> &data, std::vector<textureLevel_t> &levels);
+
+    bool WriteTextureCache(const std::string &fileName, const uint64_t sourceHash, const textureUsage_t usage, const VkFormat format,
+                           const int width, const int height, const std::vector<uint8_t> &data, const std::vector<textureLevel_t> &levels);
+}
@@ -0,0 +1,844 @@
+#include "TextureCompressor.h"
+
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+
+#include "RHI/Image.h"
+#include "../Parallel.h"
+
+namespace ElecNeko
+{
+    // Bc7 palette weights, out of 64
+    static const int BC7_WEIGHTS2[4] = {0, 21, 43, 64};
+    static const int BC7_WEIGHTS4[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+    struct texelBlock_t
+    {
+        float texels[16][4];
+    };
+
+    static void LoadBlock(const uint8_t *rgba, const int width, const int height, const int blockX, const int blockY, texelBlock_t &block)
+    {
+        // Blocks past the edge of small levels repeat the last row and column
+        for (int y = 0; y < 4; y++)
+        {
+            const int srcY = std::min(blockY * 4 + y, height - 1);
+            for (int x = 0; x < 4; x++)
+            {
+                const int srcX = std::min(blockX * 4 + x, width - 1);
+                const uint8_t *src = rgba + 4 * ((size_t) srcY * width + srcX);
+                for (int c = 0; c < 4; c++)
+                {
+                    block.texels[y * 4 + x][c] = src[c];
+                }
+            }
+        }
+    }
+
+    /*
+    ====================================================
+    GetPrincipalAxis
+
+    Mean of the first numChannels channels and the direction they vary
+    the most along, from a few power iterations on the covariance.
+    ====================================================
+    */
+    static void GetPrincipalAxis(const texelBlock_t &block, const int numChannels, float mean[4], float axis[4])
+    {
+        for (int c = 0; c < 4; c++)
+        {
+            mean[c] = 0.0f;
+            axis[c] = 0.0f;
+        }
+        for (int i = 0; i < 16; i++)
+        {
+            for (int c = 0; c < numChannels; c++)
+            {
+                mean[c] += block.texels[i][c];
+            }
+        }
+        for (int c = 0; c < numChannels; c++)
+        {
+            mean[c] /= 16.0f;
+        }
+
+        float covariance[4][4] = {};
+        for (int i = 0; i < 16; i++)
+        {
+            float d[4];
+            for (int c = 0; c < numChannels; c++)
+            {
+                d[c] = block.texels[i][c] - mean[c];
+            }
+            for (int r = 0; r < numChannels; r++)
+            {
+                for (int c = 0; c < numChannels; c++)
+                {
+                    covariance[r][c] += d[r] * d[c];
+                }
+            }
+        }
+
+        // Start from the channel with the largest spread, it is never orthogonal to the answer
+        int start = 0;
+        for (int c = 1; c < numChannels; c++)
+        {
+            if (covariance[c][c] > covariance[start][start])
+            {
+                start = c;
+            }
+        }
+        for (int c = 0; c < numChannels; c++)
+        {
+            axis[c] = covariance[start][c];
+        }
+
+        for (int iteration = 0; iteration < 8; iteration++)
+        {
+            float next[4] = {};
+            float largest = 0.0f;
+            for (int r = 0; r < numChannels; r++)
+            {
+                for (int c = 0; c < numChannels; c++)
+                {
+                    next[r] += covariance[r][c] * axis[c];
+                }
+                largest = std::max(largest, fabsf(next[r]));
+            }
+            if (largest <= 0.0f)
+            {
+                break;
+            }
+            for (int c = 0; c < numChannels; c++)
+            {
+                axis[c] = next[c] / largest;
+            }
+        }
+
+        float lengthSqr = 0.0f;
+        for (int c = 0; c < numChannels; c++)
+        {
+            lengthSqr += axis[c] * axis[c];
+        }
+        if (lengthSqr <= 0.0f)
+        {
+            // Flat block, any direction will do
+            for (int c = 0; c < numChannels; c++)
+            {
+                axis[c] = 1.0f;
+            }
+            lengthSqr = (float) numChannels;
+        }
+        const float invLength = 1.0f / sqrtf(lengthSqr);
+        for (int c = 0; c < numChannels; c++)
+        {
+            axis[c] *= invLength;
+        }
+    }
+
+    // Endpoints at the extremes of the block's projection onto its principal axis
+    static void GetAxisEndpoints(const texelBlock_t &block, const int numChannels, float e0[4], float e1[4])
+    {
+        float mean[4];
+        float axis[4];
+        GetPrincipalAxis(block, numChannels, mean, axis);
+
+        float minT = 0.0f;
+        float maxT = 0.0f;
+        for (int i = 0; i < 16; i++)
+        {
+            float t = 0.0f;
+            for (int c = 0; c < numChannels; c++)
+            {
+                t += (block.texels[i][c] - mean[c]) * axis[c];
+            }
+            minT = std::min(minT, t);
+            maxT = std::max(maxT, t);
+        }
+        for (int c = 0; c < numChannels; c++)
+        {
+            e0[c] = std::clamp(mean[c] + axis[c] * maxT, 0.0f, 255.0f);
+            e1[c] = std::clamp(mean[c] + axis[c] * minT, 0.0f, 255.0f);
+        }
+    }
+
+    /*
+    ====================================================
+    RefineEndpoints
+
+    Least squares endpoints for the chosen indices, weights[i] is how much
+    of e0 texel i gets.  Leaves the endpoints alone when every texel uses
+    the same weight.
+    ====================================================
+    */
+    static bool RefineEndpoints(const texelBlock_t &block, const int numChannels, const float weights[16], float e0[4], float e1[4])
+    {
+        float aa = 0.0f;
+        float ab = 0.0f;
+        float bb = 0.0f;
+        float ax[4] = {};
+        float bx[4] = {};
+        for (int i = 0; i < 16; i++)
+        {
+            const float a = weights[i];
+            const float b = 1.0f - a;
+            aa += a * a;
+            ab += a * b;
+            bb += b * b;
+            for (int c = 0; c < numChannels; c++)
+            {
+                ax[c] += a * block.texels[i][c];
+                bx[c] += b * block.texels[i][c];
+            }
+        }
+
+        const float det = aa * bb - ab * ab;
+        if (fabsf(det) < 1e-6f)
+        {
+            return false;
+        }
+        const float invDet = 1.0f / det;
+        for (int c = 0; c < numChannels; c++)
+        {
+            e0[c] = std::clamp((bb * ax[c] - ab * bx[c]) * invDet, 0.0f, 255.0f);
+            e1[c] = std::clamp((aa * bx[c] - ab * ax[c]) * invDet, 0.0f, 255.0f);
+        }
+        return true;
+    }
+
+    /*
+    ====================================================
+    BC1 color block
+
+    Always four colors, c0 > c1, which is also how BC3 reads its color
+    block.  A block of one color has c0 == c1, which BC1 reads as three
+    colors and black, so its indices all point at c0.
+    ====================================================
+    */
+    static uint16_t PackRgb565(const float color[4])
+    {
+        const int r = (int) (color[0] * 31.0f / 255.0f + 0.5f);
+        const int g = (int) (color[1] * 63.0f / 255.0f + 0.5f);
+        const int b = (int) (color[2] * 31.0f / 255.0f + 0.5f);
+        return (uint16_t) ((r << 11) | (g << 5) | b);
+    }
+
+    static void UnpackRgb565(const uint16_t packed, int color[3])
+    {
+        const int r = (packed >> 11) & 31;
+        const int g = (packed >> 5) & 63;
+        const int b = packed & 31;
+        color[0] = (r << 3) | (r >> 2);
+        color[1] = (g << 2) | (g >> 4);
+        color[2] = (b << 3) | (b >> 2);
+    }
+
+    // Indices of the nearest palette color, returns the squared error
+    static float SelectColorIndices(const texelBlock_t &block, const uint16_t c0, const uint16_t c1, uint8_t indices[16])
+    {
+        int palette[4][3];
+        UnpackRgb565(c0, palette[0]);
+        UnpackRgb565(c1, palette[1]);
+        for (int c = 0; c < 3; c++)
+        {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+
+        float error = 0.0f;
+        for (int i = 0; i < 16; i++)
+        {
+            float best = 1e30f;
+            for (int k = 0; k < 4; k++)
+            {
+                float distance = 0.0f;
+                for (int c = 0; c < 3; c++)
+                {
+                    const float d = block.texels[i][c] - (float) palette[k][c];
+                    distance += d * d;
+                }
+                if (distance < best)
+                {
+                    best = distance;
+                    indices[i] = (uint8_t) k;
+                }
+            }
+            error += best;
+        }
+        return error;
+    }
+
+    static void EncodeColorBlock(const texelBlock_t &block, uint8_t *dst)
+    {
+        float e0[4];
+        float e1[4];
+        GetAxisEndpoints(block, 3, e0, e1);
+
+        uint16_t c0 = PackRgb565(e0);
+        uint16_t c1 = PackRgb565(e1);
+        uint8_t indices[16];
+        float error = SelectColorIndices(block, c0, c1, indices);
+
+        static const float weightOfC0[4] = {1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f};
+        float weights[16];
+        for (int i = 0; i < 16; i++)
+        {
+            weights[i] = weightOfC0[indices[i]];
+        }
+        if (RefineEndpoints(block, 3, weights, e0, e1))
+        {
+            const uint16_t refined0 = PackRgb565(e0);
+            const uint16_t refined1 = PackRgb565(e1);
+            uint8_t refinedIndices[16];
+            const float refinedError = SelectColorIndices(block, refined0, refined1, refinedIndices);
+            if (refinedError < error)
+            {
+                c0 = refined0;
+                c1 = refined1;
+                memcpy(indices, refinedIndices, sizeof(indices));
+            }
+        }
+
+        if (c0 < c1)
+        {
+            // Swapping the endpoints swaps 0 with 1 and 2 with 3
+            std::swap(c0, c1);
+            for (int i = 0; i < 16; i++)
+            {
+                indices[i] ^= 1;
+            }
+        }
+        else if (c0 == c1)
+        {
+            memset(indices, 0, sizeof(indices));
+        }
+
+        uint32_t bits = 0;
+        for (int i = 0; i < 16; i++)
+        {
+            bits |= (uint32_t) indices[i] << (2 * i);
+        }
+        dst[0] = (uint8_t) c0;
+        dst[1] = (uint8_t) (c0 >> 8);
+        dst[2] = (uint8_t) c1;
+        dst[3] = (uint8_t) (c1 >> 8);
+        memcpy(dst + 4, &bits, sizeof(bits));
+    }
+
+    /*
+    ====================================================
+    BC4 channel block
+
+    a0 > a1 for the eight value mode, index 0 is a0, 1 is a1 and 2 to 7
+    step from a0 to a1.
+    ====================================================
+    */
+    static void EncodeChannelBlock(const texelBlock_t &block, const int channel, uint8_t *dst)
+    {
+        float minValue = 255.0f;
+        float maxValue = 0.0f;
+        for (int i = 0; i < 16; i++)
+        {
+            minValue = std::min(minValue, block.texels[i][channel]);
+            maxValue = std::max(maxValue, block.texels[i][channel]);
+        }
+
+        const int a0 = (int) (maxValue + 0.5f);
+        const int a1 = (int) (minValue + 0.5f);
+        int palette[8];
+        palette[0] = a0;
+        palette[1] = a1;
+        for (int k = 2; k < 8; k++)
+        {
+            palette[k] = ((8 - k) * a0 + (k - 1) * a1) / 7;
+        }
+
+        uint64_t bits = 0;
+        if (a0 > a1)
+        {
+            for (int i = 0; i < 16; i++)
+            {
+                int index = 0;
+                float best = 1e30f;
+                for (int k = 0; k < 8; k++)
+                {
+                    const float distance = fabsf(block.texels[i][channel] - (float) palette[k]);
+                    if (distance < best)
+                    {
+                        best = distance;
+                        index = k;
+                    }
+                }
+                bits |= (uint64_t) index << (3 * i);
+            }
+        }
+
+        dst[0] = (uint8_t) a0;
+        dst[1] = (uint8_t) a1;
+        for (int i = 0; i < 6; i++)
+        {
+            dst[2 + i] = (uint8_t) (bits >> (8 * i));
+        }
+    }
+
+    /*
+    ====================================================
+    BC7 modes 5 and 6
+
+    Mode 6 is one RGBA line, each endpoint is seven bits a channel and a
+    p bit shared by its four channels, the eight bit value is
+    ( color << 1 ) | p, with four bit indices.  Mode 5 fits the color and
+    the alpha separately, seven bit color and eight bit alpha endpoints
+    with two bit indices each, which follows cutout edges mode 6 can't.
+    Every block is encoded both ways and keeps the smaller error.
+
+    Texel 0 is the anchor, its index has an implied zero top bit, so the
+    endpoints are swapped when it would need one.
+    ====================================================
+    */
+    static void QuantizeBc7Endpoint(const float endpoint[4], int color[4], int &pBit)
+    {
+        float bestError = 1e30f;
+        for (int p = 0; p < 2; p++)
+        {
+            int candidate[4];
+            float error = 0.0f;
+            for (int c = 0; c < 4; c++)
+            {
+                candidate[c] = std::clamp((int) ((endpoint[c] - (float) p) * 0.5f + 0.5f), 0, 127);
+                const float d = (float) ((candidate[c] << 1) | p) - endpoint[c];
+                error += d * d;
+            }
+            if (error < bestError)
+            {
+                bestError = error;
+                pBit = p;
+                memcpy(color, candidate, sizeof(candidate));
+            }
+        }
+    }
+
+    static float SelectBc7Indices(const texelBlock_t &block, const int color0[4], const int p0, const int color1[4], const int p1, uint8_t indices[16])
+    {
+        int palette[16][4];
+        for (int c = 0; c < 4; c++)
+        {
+            const int v0 = (color0[c] << 1) | p0;
+            const int v1 = (color1[c] << 1) | p1;
+            for (int k = 0; k < 16; k++)
+            {
+                palette[k][c] = ((64 - BC7_WEIGHTS4[k]) * v0 + BC7_WEIGHTS4[k] * v1 + 32) >> 6;
+            }
+        }
+
+        float error = 0.0f;
+        for (int i = 0; i < 16; i++)
+        {
+            float best = 1e30f;
+            for (int k = 0; k < 16; k++)
+            {
+                float distance = 0.0f;
+                for (int c = 0; c < 4; c++)
+                {
+                    const float d = block.texels[i][c] - (float) palette[k][c];
+                    distance += d * d;
+                }
+                if (distance < best)
+                {
+                    best = distance;
+                    indices[i] = (uint8_t) k;
+                }
+            }
+            error += best;
+        }
+        return error;
+    }
+
+    static void WriteBits(uint8_t *dst, int &bitOffset, const uint32_t value, const int numBits)
+    {
+        for (int i = 0; i < numBits; i++, bitOffset++)
+        {
+            if (value & (1u << i))
+            {
+                dst[bitOffset >> 3] |= (uint8_t) (1u << (bitOffset & 7));
+            }
+        }
+    }
+
+    static float EncodeBc7Mode6(const texelBlock_t &block, uint8_t *dst)
+    {
+        float e0[4];
+        float e1[4];
+        GetAxisEndpoints(block, 4, e0, e1);
+
+        int color0[4];
+        int color1[4];
+        int p0 = 0;
+        int p1 = 0;
+        QuantizeBc7Endpoint(e0, color0, p0);
+        QuantizeBc7Endpoint(e1, color1, p1);
+        uint8_t indices[16];
+        float error = SelectBc7Indices(block, color0, p0, color1, p1, indices);
+
+        float weights[16];
+        for (int i = 0; i < 16; i++)
+        {
+            weights[i] = 1.0f - (float) BC7_WEIGHTS4[indices[i]] / 64.0f;
+        }
+        if (RefineEndpoints(block, 4, weights, e0, e1))
+        {
+            int refined0[4];
+            int refined1[4];
+            int refinedP0 = 0;
+            int refinedP1 = 0;
+            QuantizeBc7Endpoint(e0, refined0, refinedP0);
+            QuantizeBc7Endpoint(e1, refined1, refinedP1);
+            uint8_t refinedIndices[16];
+            const float refinedError = SelectBc7Indices(block, refined0, refinedP0, refined1, refinedP1, refinedIndices);
+            if (refinedError < error)
+            {
+                memcpy(color0, refined0, sizeof(color0));
+                memcpy(color1, refined1, sizeof(color1));
+                p0 = refinedP0;
+                p1 = refinedP1;
+                memcpy(indices, refinedIndices, sizeof(indices));
+                error = refinedError;
+            }
+        }
+
+        if (indices[0] & 8)
+        {
+            std::swap(color0, color1);
+            std::swap(p0, p1);
+            for (int i = 0; i < 16; i++)
+            {
+                indices[i] = (uint8_t) (15 - indices[i]);
+            }
+        }
+
+        memset(dst, 0, 16);
+        int bitOffset = 0;
+        WriteBits(dst, bitOffset, 1u << 6, 7); // mode 6
+        for (int c = 0; c < 4; c++)
+        {
+            WriteBits(dst, bitOffset, (uint32_t) color0[c], 7);
+            WriteBits(dst, bitOffset, (uint32_t) color1[c], 7);
+        }
+        WriteBits(dst, bitOffset, (uint32_t) p0, 1);
+        WriteBits(dst, bitOffset, (uint32_t) p1, 1);
+        WriteBits(dst, bitOffset, indices[0], 3);
+        for (int i = 1; i < 16; i++)
+        {
+            WriteBits(dst, bitOffset, indices[i], 4);
+        }
+        return error;
+    }
+
+    static int ExpandBc7Color(const int color)
+    {
+        return (color << 1) | (color >> 6);
+    }
+
+    static float SelectBc7Mode5Indices(const texelBlock_t &block, const int color0[3], const int color1[3], uint8_t indices[16])
+    {
+        int palette[4][3];
+        for (int c = 0; c < 3; c++)
+        {
+            const int v0 = ExpandBc7Color(color0[c]);
+            const int v1 = ExpandBc7Color(color1[c]);
+            for (int k = 0; k < 4; k++)
+            {
+                palette[k][c] = ((64 - BC7_WEIGHTS2[k]) * v0 + BC7_WEIGHTS2[k] * v1 + 32) >> 6;
+            }
+        }
+
+        float error = 0.0f;
+        for (int i = 0; i < 16; i++)
+        {
+            float best = 1e30f;
+            for (int k = 0; k < 4; k++)
+            {
+                float distance = 0.0f;
+                for (int c = 0; c < 3; c++)
+                {
+                    const float d = block.texels[i][c] - (float) palette[k][c];
+                    distance += d * d;
+                }
+                if (distance < best)
+                {
+                    best = distance;
+                    indices[i] = (uint8_t) k;
+                }
+            }
+            error += best;
+        }
+        return error;
+    }
+
+    static void QuantizeBc7Color(const float endpoint[4], int color[3])
+    {
+        for (int c = 0; c < 3; c++)
+        {
+            color[c] = std::clamp((int) (endpoint[c] * 127.0f / 255.0f + 0.5f), 0, 127);
+        }
+    }
+
+    static float EncodeBc7Mode5(const texelBlock_t &block, uint8_t *dst)
+    {
+        float e0[4];
+        float e1[4];
+        GetAxisEndpoints(block, 3, e0, e1);
+
+        int color0[3];
+        int color1[3];
+        QuantizeBc7Color(e0, color0);
+        QuantizeBc7Color(e1, color1);
+        uint8_t colorIndices[16];
+        float colorError = SelectBc7Mode5Indices(block, color0, color1, colorIndices);
+
+        float weights[16];
+        for (int i = 0; i < 16; i++)
+        {
+            weights[i] = 1.0f - (float) BC7_WEIGHTS2[colorIndices[i]] / 64.0f;
+        }
+        if (RefineEndpoints(block, 3, weights, e0, e1))
+        {
+            int refined0[3];
+            int refined1[3];
+            QuantizeBc7Color(e0, refined0);
+            QuantizeBc7Color(e1, refined1);
+            uint8_t refinedIndices[16];
+            const float refinedError = SelectBc7Mode5Indices(block, refined0, refined1, refinedIndices);
+            if (refinedError < colorError)
+            {
+                memcpy(color0, refined0, sizeof(color0));
+                memcpy(color1, refined1, sizeof(color1));
+                memcpy(colorIndices, refinedIndices, sizeof(colorIndices));
+                colorError = refinedError;
+            }
+        }
+
+        // Alpha is one channel, its range is the line
+        int alpha0 = 0;
+        int alpha1 = 255;
+        for (int i = 0; i < 16; i++)
+        {
+            alpha0 = std::max(alpha0, (int) (block.texels[i][3] + 0.5f));
+            alpha1 = std::min(alpha1, (int) (block.texels[i][3] + 0.5f));
+        }
+        uint8_t alphaIndices[16];
+        float alphaError = 0.0f;
+        for (int i = 0; i < 16; i++)
+        {
+            float best = 1e30f;
+            for (int k = 0; k < 4; k++)
+            {
+                const float value = (float) (((64 - BC7_WEIGHTS2[k]) * alpha0 + BC7_WEIGHTS2[k] * alpha1 + 32) >> 6);
+                const float d = block.texels[i][3] - value;
+                if (d * d < best)
+                {
+                    best = d * d;
+                    alphaIndices[i] = (uint8_t) k;
+                }
+            }
+            alphaError += best;
+        }
+
+        if (colorIndices[0] & 2)
+        {
+            std::swap(color0, color1);
+            for (int i = 0; i < 16; i++)
+            {
+                colorIndices[i] = (uint8_t) (3 - colorIndices[i]);
+            }
+        }
+        if (alphaIndices[0] & 2)
+        {
+            std::swap(alpha0, alpha1);
+            for (int i = 0; i < 16; i++)
+            {
+                alphaIndices[i] = (uint8_t) (3 - alphaIndices[i]);
+            }
+        }
+
+        memset(dst, 0, 16);
+        int bitOffset = 0;
+        WriteBits(dst, bitOffset, 1u << 5, 6); // mode 5
+        WriteBits(dst, bitOffset, 0, 2);       // no channel rotation
+        for (int c = 0; c < 3; c++)
+        {
+            WriteBits(dst, bitOffset, (uint32_t) color0[c], 7);
+            WriteBits(dst, bitOffset, (uint32_t) color1[c], 7);
+        }
+        WriteBits(dst, bitOffset, (uint32_t) alpha0, 8);
+        WriteBits(dst, bitOffset, (uint32_t) alpha1, 8);
+        WriteBits(dst, bitOffset, colorIndices[0], 1);
+        for (int i = 1; i < 16; i++)
+        {
+            WriteBits(dst, bitOffset, colorIndices[i], 2);
+        }
+        WriteBits(dst, bitOffset, alphaIndices[0], 1);
+        for (int i = 1; i < 16; i++)
+        {
+            WriteBits(dst, bitOffset, alphaIndices[i], 2);
+        }
+        return colorError + alphaError;
+    }
+
+    static void EncodeBc7Block(const texelBlock_t &block, uint8_t *dst)
+    {
+        const float error = EncodeBc7Mode6(block, dst);
+        if (error <= 0.0f)
+        {
+            return;
+        }
+
+        uint8_t mode5[16];
+        if (EncodeBc7Mode5(block, mode5) < error)
+        {
+            memcpy(dst, mode5, sizeof(mode5));
+        }
+    }
+
+    static void EncodeBlock(const texelBlock_t &block, const VkFormat format, uint8_t *dst)
+    {
+        switch (format)
+        {
+        case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+            EncodeColorBlock(block, dst);
+            break;
+        case VK_FORMAT_BC3_UNORM_BLOCK:
+            EncodeChannelBlock(block, 3, dst);
+            EncodeColorBlock(block, dst + 8);
+            break;
+        case VK_FORMAT_BC5_UNORM_BLOCK:
+            EncodeChannelBlock(block, 0, dst);
+            EncodeChannelBlock(block, 1, dst + 8);
+            break;
+        case VK_FORMAT_BC7_UNORM_BLOCK:
+            EncodeBc7Block(block, dst);
+            break;
+        default:
+            break;
+        }
+    }
+
+    /*
+    ====================================================
+    DownsampleLevel
+
+    2x2 box filter, odd sizes drop their last row or column.  Normals are
+    averaged as unit vectors and renormalized, so a level that averages
+    out bumps points straight up rather than getting shorter.
+    ====================================================
+    */
+    static void DownsampleLevel(const std::vector<uint8_t> &src, const int width, const int height, const textureUsage_t usage,
+                                std::vector<uint8_t> &dst, const int dstWidth, const int dstHeight)
+    {
+        dst.resize((size_t) dstWidth * dstHeight * 4);
+        for (int y = 0; y < dstHeight; y++)
+        {
+            for (int x = 0; x < dstWidth; x++)
+            {
+                float sum[4] = {};
+                for (int dy = 0; dy < 2; dy++)
+                {
+                    const int srcY = std::min(2 * y + dy, height - 1);
+                    for (int dx = 0; dx < 2; dx++)
+                    {
+                        const int srcX = std::min(2 * x + dx, width - 1);
+                        const uint8_t *texel = &src[4 * ((size_t) srcY * width + srcX)];
+                        for (int c = 0; c < 4; c++)
+                        {
+                            sum[c] += (usage == TEXTURE_USAGE_NORMAL && c < 3) ? texel[c] / 127.5f - 1.0f : (float) texel[c];
+                        }
+                    }
+                }
+
+                uint8_t *out = &dst[4 * ((size_t) y * dstWidth + x)];
+                if (usage == TEXTURE_USAGE_NORMAL)
+                {
+                    float length = sqrtf(sum[0] * sum[0] + sum[1] * sum[1] + sum[2] * sum[2]);
+                    if (length <= 0.0f)
+                    {
+                        sum[0] = sum[1] = 0.0f;
+                        sum[2] = length = 1.0f;
+                    }
+                    for (int c = 0; c < 3; c++)
+                    {
+                        out[c] = (uint8_t) std::clamp((sum[c] / length + 1.0f) * 127.5f + 0.5f, 0.0f, 255.0f);
+                    }
+                    out[3] = (uint8_t) (sum[3] * 0.25f + 0.5f);
+                }
+                else
+                {
+                    for (int c = 0; c < 4; c++)
+                    {
+                        out[c] = (uint8_t) (sum[c] * 0.25f + 0.5f);
+                    }
+                }
+            }
+        }
+    }
+
+    VkFormat GetTextureBakeFormat(const textureUsage_t usage)
+    {
+        return (usage == TEXTURE_USAGE_NORMAL) ? VK_FORMAT_BC5_UNORM_BLOCK : VK_FORMAT_BC7_UNORM_BLOCK;
+    }
+
+    bool CompressTexture(const uint8_t *rgba, const int width, const int height, const VkFormat format, const textureUsage_t usage,
+                         std::vector<uint8_t> &data, std::vector<textureLevel_t> &levels)
+    {
+        const int blockBytes = Image::GetBlockBytes(format);
+        if (blockBytes == 0 || width <= 0 || height <= 0)
+        {
+            return false;
+        }
+
+        std::vector<uint8_t> level(rgba, rgba + (size_t) width * height * 4);
+        std::vector<uint8_t> nextLevel;
+        int levelWidth = width;
+        int levelHeight = height;
+
+        const int numLevels = Image::GetNumMipLevels(width, height);
+        for (int i = 0; i < numLevels; i++)
+        {
+            const int blocksX = (levelWidth + 3) / 4;
+            const int blocksY = (levelHeight + 3) / 4;
+
+            textureLevel_t entry;
+            entry.offset = data.size();
+            entry.size = (uint64_t) blocksX * blocksY * blockBytes;
+            levels.push_back(entry);
+            data.resize(data.size() + entry.size);
+
+            uint8_t *dst = data.data() + entry.offset;
+            const uint8_t *src = level.data();
+            const int srcWidth = levelWidth;
+            const int srcHeight = levelHeight;
+            ParallelFor(blocksY, 4, [&](int begin, int end) {
+                texelBlock_t block;
+                for (int by = begin; by < end; by++)
+                {
+                    for (int bx = 0; bx < blocksX; bx++)
+                    {
+                        LoadBlock(src, srcWidth, srcHeight, bx, by, block);
+                        EncodeBlock(block, format, dst + ((size_t) by * blocksX + bx) * blockBytes);
+                    }
+                }
+            });
+
+            if (i + 1 < numLevels)
+            {
+                const int nextWidth = std::max(1, levelWidth / 2);
+                const int nextHeight = std::max(1, levelHeight / 2);
+                DownsampleLevel(level, levelWidth, levelHeight, usage, nextLevel, nextWidth, nextHeight);
+                level.swap(nextLevel);
+                levelWidth = nextWidth;
+                levelHeight = nextHeight;
+            }
+        }
+        return true;
+    }
+}
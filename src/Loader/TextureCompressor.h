@@ -0,0 +1,52 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+namespace ElecNeko
+{
+    enum textureUsage_t
+    {
+        TEXTURE_USAGE_ALBEDO,
+        TEXTURE_USAGE_NORMAL,
+        TEXTURE_USAGE_NUM,
+    };
+
+    // Where a mip level is in the texture data, like a KTX2 level index entry
+    struct textureLevel_t
+    {
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    /*
+    ====================================================
+    Texture compressor
+
+    Block compression of RGBA8 images for the texture cache.  Every 4x4
+    block is fit with the principal axis of its colors, the ends of the
+    axis are the endpoints, they get one least squares refinement once the
+    indices are known.
+
+        BC1  opaque color, 8 bytes a block
+        BC3  color and a BC4 alpha block, 16 bytes
+        BC5  two BC4 blocks for the x and y of a normal, 16 bytes
+        BC7  modes 5 and 6 only, a single subset with the alpha fit on its
+             own or along with the color, 16 bytes
+
+    Albedo is baked to BC7 and normal maps to BC5, a shader sampling a
+    normal map rebuilds z from x and y.  BC1 and BC3 are there for
+    textures where size matters more than quality.  A device that can't
+    sample the bake format gets the source as RGBA8 instead, see
+    TextureManager::Initialize.
+    ====================================================
+    */
+    VkFormat GetTextureBakeFormat(const textureUsage_t usage);
+
+    // Every mip level of the image, down to 1x1, compressed to format and appended to data.
+    // Normal map levels are averaged as vectors and renormalized.
+    bool CompressTexture(const uint8_t *rgba, const int width, const int height, const VkFormat format, const textureUsage_t usage,
+                         std::vector<uint8_t> &data, std::vector<textureLevel_t> &levels);
+}
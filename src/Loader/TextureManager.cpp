@@ -0,0 +1,304 @@
+#include "TextureManager.h"
+
+#include <algorithm>
+#include <cassert>
+#include <filesystem>
+
+namespace ElecNeko
+{
+    TextureManager g_textureManager;
+
+    // The same file reached through different relative paths is one texture
+    static std::string GetPathKey(const std::string &filename, const textureUsage_t usage)
+    {
+        std::error_code error;
+        std::filesystem::path path = std::filesystem::weakly_canonical(std::filesystem::path(filename), error);
+        std::string key = error ? filename : path.generic_string();
+        key += (usage == TEXTURE_USAGE_NORMAL) ? "|normal" : "|albedo";
+        return key;
+    }
+
+    void TextureManager::Initialize(DeviceContext *device)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (int i = 0; i < TEXTURE_USAGE_NUM; i++)
+        {
+            const VkFormat format = GetTextureBakeFormat(static_cast<textureUsage_t>(i));
+            m_useBake[i] = Image::SupportsSampling(device, format);
+            if (!m_useBake[i])
+            {
+                std::cerr << "The device can't sample texture bake format " << format << ", those textures are loaded uncompressed" << std::endl;
+            }
+        }
+    }
+
+    textureHandle_t TextureManager::Acquire(const std::string &filename, const textureUsage_t usage)
+    {
+        MappedFile source;
+        if (!source.Open(filename.c_str()))
+        {
+            std::cerr << "Failed to load texture: " << filename << std::endl;
+            return INVALID_TEXTURE_HANDLE;
+        }
+        const uint64_t sourceHash = HashData(source.GetData(), source.GetSize());
+        const uint64_t contentKey = HashData(&usage, sizeof(usage), sourceHash);
+        const std::string pathKey = GetPathKey(filename, usage);
+
+        textureHandle_t handle = INVALID_TEXTURE_HANDLE;
+        entry_t *decoding = nullptr;
+        bool bake = true;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            bake = m_useBake[usage];
+
+            // The path is checked first, a copy of the same image elsewhere is found by its contents
+            auto path = m_paths.find(pathKey);
+            if (path != m_paths.end() && m_entries[path->second].sourceHash == sourceHash)
+            {
+                handle = path->second;
+            }
+            else
+            {
+                auto content = m_contents.find(contentKey);
+                if (content != m_contents.end())
+                {
+                    handle = content->second;
+                    m_paths[pathKey] = handle;
+                }
+            }
+
+            if (handle != INVALID_TEXTURE_HANDLE)
+            {
+                entry_t &entry = m_entries[handle];
+                entry.refCount++;
+                m_decoded.wait(lock, [&entry] { return entry.isDecoded; });
+                if (!entry.isFailed)
+                {
+                    return handle;
+                }
+                if (--entry.refCount == 0)
+                {
+                    FreeEntry(handle);
+                }
+                return INVALID_TEXTURE_HANDLE;
+            }
+
+            if (!m_freeHandles.empty())
+            {
+                handle = m_freeHandles.back();
+                m_freeHandles.pop_back();
+            }
+            else
+            {
+                handle = static_cast<textureHandle_t>(m_entries.size());
+                m_entries.emplace_back();
+            }
+
+            entry_t &entry = m_entries[handle];
+            entry.texture = Texture();
+            entry.contentKey = contentKey;
+            entry.sourceHash = sourceHash;
+            entry.refCount = 1;
+            entry.isDecoded = false;
+            entry.isFailed = false;
+            entry.lastRelease = 0;
+            entry.residentBytes = 0;
+            m_paths[pathKey] = handle;
+            m_contents[contentKey] = handle;
+            decoding = &entry;
+        }
+
+        // Other threads asking for this texture wait on m_decoded, the entry stays where it is
+        const bool result = decoding->texture.Decode(filename, usage, source, sourceHash, bake);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            decoding->isDecoded = true;
+            if (!result)
+            {
+                // Waiters let go of their references, the last one frees the slot
+                decoding->isFailed = true;
+                UnlinkEntry(handle);
+                if (--decoding->refCount == 0)
+                {
+                    FreeEntry(handle);
+                }
+            }
+        }
+        m_decoded.notify_all();
+
+        return result ? handle : INVALID_TEXTURE_HANDLE;
+    }
+
+    void TextureManager::Release(DeviceContext *device, const textureHandle_t handle)
+    {
+        if (handle == INVALID_TEXTURE_HANDLE)
+        {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            entry_t &entry = m_entries[handle];
+            assert(entry.refCount > 0);
+            if (--entry.refCount > 0)
+            {
+                return;
+            }
+            entry.lastRelease = ++m_releaseCount;
+
+            // Never uploaded, keeping the pixels around isn't worth it
+            if (!entry.texture.isLoaded)
+            {
+                FreeEntry(handle);
+                return;
+            }
+        }
+        Evict(device);
+    }
+
+    void TextureManager::Upload(DeviceContext *device, const textureHandle_t handle, VkCommandBuffer cmdBuffer, std::vector<Buffer> &stagingBuffers)
+    {
+        Texture *texture = GetTexture(handle);
+        if (texture == nullptr || texture->isLoaded)
+        {
+            return;
+        }
+
+        Buffer stagingBuffer;
+        if (!texture->Upload(device, cmdBuffer, stagingBuffer))
+        {
+            return;
+        }
+        stagingBuffers.push_back(stagingBuffer);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_entries[handle].residentBytes = texture->m_image.m_vkMemorySize;
+            m_residentBytes += texture->m_image.m_vkMemorySize;
+        }
+        Evict(device);
+    }
+
+    Texture *TextureManager::GetTexture(const textureHandle_t handle)
+    {
+        if (handle == INVALID_TEXTURE_HANDLE)
+        {
+            return nullptr;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        assert(handle >= 0 && handle < static_cast<int>(m_entries.size()));
+        return &m_entries[handle].texture;
+    }
+
+    void TextureManager::SetBudget(DeviceContext *device, const uint64_t budget)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_budget = budget;
+        }
+        Evict(device);
+    }
+
+    uint64_t TextureManager::GetResidentBytes()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_residentBytes;
+    }
+
+    void TextureManager::Cleanup(DeviceContext *device)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (entry_t &entry : m_entries)
+        {
+            assert(entry.refCount == 0);
+            if (entry.texture.isLoaded)
+            {
+                entry.texture.m_image.Cleanup(device);
+            }
+        }
+        m_entries.clear();
+        m_freeHandles.clear();
+        m_paths.clear();
+        m_contents.clear();
+        m_residentBytes = 0;
+    }
+
+    // Called with m_mutex locked, later requests won't find the entry
+    void TextureManager::UnlinkEntry(const textureHandle_t handle)
+    {
+        auto content = m_contents.find(m_entries[handle].contentKey);
+        if (content != m_contents.end() && content->second == handle)
+        {
+            m_contents.erase(content);
+        }
+
+        // Paths of copies found by their contents point here too
+        for (auto it = m_paths.begin(); it != m_paths.end();)
+        {
+            it = (it->second == handle) ? m_paths.erase(it) : std::next(it);
+        }
+    }
+
+    // Called with m_mutex locked, the entry must not be referenced
+    void TextureManager::FreeEntry(const textureHandle_t handle)
+    {
+        entry_t &entry = m_entries[handle];
+        UnlinkEntry(handle);
+
+        m_residentBytes -= entry.residentBytes;
+        entry.texture = Texture();
+        entry.residentBytes = 0;
+        entry.isDecoded = false;
+        m_freeHandles.push_back(handle);
+    }
+
+    /*
+    ====================================================
+    TextureManager::Evict
+
+    Destroys unreferenced textures, least recently released first, until
+    the resident ones fit the budget.  Their last mesh was already done on
+    the gpu when it released them.
+    ====================================================
+    */
+    void TextureManager::Evict(DeviceContext *device)
+    {
+        std::vector<Image> images;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_residentBytes <= m_budget)
+            {
+                return;
+            }
+
+            std::vector<textureHandle_t> unused;
+            for (int i = 0; i < static_cast<int>(m_entries.size()); i++)
+            {
+                const entry_t &entry = m_entries[i];
+                if (entry.refCount == 0 && entry.texture.isLoaded)
+                {
+                    unused.push_back(i);
+                }
+            }
+            std::sort(unused.begin(), unused.end(),
+                      [this](const textureHandle_t a, const textureHandle_t b) { return m_entries[a].lastRelease < m_entries[b].lastRelease; });
+
+            for (const textureHandle_t handle : unused)
+            {
+                if (m_residentBytes <= m_budget)
+                {
+                    break;
+                }
+                images.push_back(m_entries[handle].texture.m_image);
+                FreeEntry(handle);
+            }
+        }
+
+        for (Image &image : images)
+        {
+            image.Cleanup(device);
+        }
+    }
+}
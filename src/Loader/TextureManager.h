@@ -0,0 +1,100 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Texture.h"
+
+namespace ElecNeko
+{
+    typedef int textureHandle_t;
+    const textureHandle_t INVALID_TEXTURE_HANDLE = -1;
+
+    const uint64_t TEXTURE_MEMORY_BUDGET = 512ull * 1024 * 1024;
+
+    /*
+    ====================================================
+    TextureManager
+
+    Every texture of the process, shared by the meshes that use it.  A
+    texture is found by its canonical path and usage, or by the hash of
+    its contents, so the same atlas is decoded and uploaded once however
+    many meshes and directories reference it.
+
+    Handles are reference counted.  A texture nobody references stays
+    resident for the next mesh that wants it, until the textures on the
+    gpu go over the memory budget, then the least recently released ones
+    are destroyed.  Referenced textures are never evicted, the budget can
+    be exceeded by them.
+
+    Acquire is safe on any thread, it decodes the texture on the calling
+    thread or waits for the thread already decoding it.  The rest is for
+    the main thread, Initialize before anything is acquired.  Release a handle only once the gpu is done with it,
+    like the buffers of the mesh it belongs to.
+    ====================================================
+    */
+    class TextureManager
+    {
+    public:
+        TextureManager() : m_budget(TEXTURE_MEMORY_BUDGET), m_residentBytes(0), m_releaseCount(0)
+        {
+            for (int i = 0; i < TEXTURE_USAGE_NUM; i++)
+            {
+                m_useBake[i] = true;
+            }
+        }
+
+        // Textures whose bake format the device can't sample are decoded to RGBA8 and get gpu mips
+        void Initialize(DeviceContext *device);
+
+        textureHandle_t Acquire(const std::string &filename, const textureUsage_t usage);
+        void Release(DeviceContext *device, const textureHandle_t handle);
+
+        // Records the upload the first time the texture is used, stagingBuffers gets its staging buffer
+        void Upload(DeviceContext *device, const textureHandle_t handle, VkCommandBuffer cmdBuffer, std::vector<Buffer> &stagingBuffers);
+
+        Texture *GetTexture(const textureHandle_t handle);
+
+        void SetBudget(DeviceContext *device, const uint64_t budget);
+        uint64_t GetResidentBytes();
+
+        void Cleanup(DeviceContext *device); // destroys every texture, the handles must all be released
+
+    private:
+        struct entry_t
+        {
+            Texture texture;
+            uint64_t contentKey;
+            uint64_t sourceHash;
+            int refCount;
+            bool isDecoded;
+            bool isFailed;
+            uint64_t lastRelease; // m_releaseCount when the last reference went away
+            uint64_t residentBytes;
+        };
+
+        void UnlinkEntry(const textureHandle_t handle);
+        void FreeEntry(const textureHandle_t handle);
+        void Evict(DeviceContext *device);
+
+        std::mutex m_mutex;
+        std::condition_variable m_decoded;
+
+        std::deque<entry_t> m_entries; // indexed by handle, a deque so growing it keeps the references
+        std::vector<textureHandle_t> m_freeHandles;
+        std::unordered_map<std::string, textureHandle_t> m_paths;
+        std::unordered_map<uint64_t, textureHandle_t> m_contents;
+
+        bool m_useBake[TEXTURE_USAGE_NUM];
+
+        uint64_t m_budget;
+        uint64_t m_residentBytes;
+        uint64_t m_releaseCount;
+    };
+
+    extern TextureManager g_textureManager;
+}
@@ -21,24 +21,45 @@ Bounds::DoesIntersect
 ====================================================
 */
 bool Bounds::DoesIntersect( const Bounds & rhs ) const {
-	if ( maxs.x < rhs.mins.x || maxs.y < rhs.mins.y || maxs.z < rhs.mins.z ) {
-		return false;
-	}
-	if ( rhs.maxs.x < mins.x || rhs.maxs.y < mins.y || rhs.maxs.z < mins.z ) {
-		return false;
-	}
-	return true;
+	// No early outs, every axis is compared and the results are combined with &
+	const bool overlapX = ( rhs.mins.x <= maxs.x ) & ( mins.x <= rhs.maxs.x );
+	const bool overlapY = ( rhs.mins.y <= maxs.y ) & ( mins.y <= rhs.maxs.y );
+	const bool overlapZ = ( rhs.mins.z <= maxs.z ) & ( mins.z <= rhs.maxs.z );
+	return overlapX & overlapY & overlapZ;
 }
 
 /*
 ====================================================
 Bounds::Expand
+
+Keeps a running min and max of four lanes, the points are loaded
+straight out of the array.  The fourth lane of those loads is the next
+point's x and never leaves the registers, the last point is loaded on
+its own so nothing past the end of the array is read.
 ====================================================
 */
 void Bounds::Expand( const Vec3 * pts, const int num ) {
-	for ( int i = 0; i < num; i++ ) {
-		Expand( pts[ i ] );
+	if ( num <= 0 ) {
+		return;
+	}
+
+	simd4f_t lo = SIMD_Set( mins.x, mins.y, mins.z, 0.0f );
+	simd4f_t hi = SIMD_Set( maxs.x, maxs.y, maxs.z, 0.0f );
+	for ( int i = 0; i < num - 1; i++ ) {
+		const simd4f_t pt = SIMD_LoadUnaligned( pts[ i ].ToPtr() );
+		lo = SIMD_Min( pt, lo );
+		hi = SIMD_Max( pt, hi );
 	}
+	const Vec3 & last = pts[ num - 1 ];
+	const simd4f_t pt = SIMD_Set( last.x, last.y, last.z, 0.0f );
+	lo = SIMD_Min( pt, lo );
+	hi = SIMD_Max( pt, hi );
+
+	alignas( 16 ) float tmp[ 4 ];
+	SIMD_Store( tmp, lo );
+	mins = Vec3( tmp[ 0 ], tmp[ 1 ], tmp[ 2 ] );
+	SIMD_Store( tmp, hi );
+	maxs = Vec3( tmp[ 0 ], tmp[ 1 ], tmp[ 2 ] );
 }
 
 /*
@@ -47,25 +68,13 @@ Bounds::Expand
 ====================================================
 */
 void Bounds::Expand( const Vec3 & rhs ) {
-	if ( rhs.x < mins.x ) {
-		mins.x = rhs.x;
-	}
-	if ( rhs.y < mins.y ) {
-		mins.y = rhs.y;
-	}
-	if ( rhs.z < mins.z ) {
-		mins.z = rhs.z;
-	}
+	mins.x = ( rhs.x < mins.x ) ? rhs.x : mins.x;
+	mins.y = ( rhs.y < mins.y ) ? rhs.y : mins.y;
+	mins.z = ( rhs.z < mins.z ) ? rhs.z : mins.z;
 
-	if ( rhs.x > maxs.x ) {
-		maxs.x = rhs.x;
-	}
-	if ( rhs.y > maxs.y ) {
-		maxs.y = rhs.y;
-	}
-	if ( rhs.z > maxs.z ) {
-		maxs.z = rhs.z;
-	}
+	maxs.x = ( rhs.x > maxs.x ) ? rhs.x : maxs.x;
+	maxs.y = ( rhs.y > maxs.y ) ? rhs.y : maxs.y;
+	maxs.z = ( rhs.z > maxs.z ) ? rhs.z : maxs.z;
 }
 
 /*
@@ -76,4 +85,154 @@ Bounds::Expand
 void Bounds::Expand( const Bounds & rhs ) {
 	Expand( rhs.mins );
 	Expand( rhs.maxs );
-}
\ No newline at end of file
+}
+
+/*
+====================================================
+TransformBounds
+====================================================
+*/
+Bounds TransformBounds( const Bounds & bounds, const Mat4 & transform ) {
+	const simd4f_t mins = SIMD_Set( bounds.mins.x, bounds.mins.y, bounds.mins.z, 0.0f );
+	const simd4f_t maxs = SIMD_Set( bounds.maxs.x, bounds.maxs.y, bounds.maxs.z, 0.0f );
+	const simd4f_t half = SIMD_Splat( 0.5f );
+	const simd4f_t center = SIMD_Mul( SIMD_Add( mins, maxs ), half );
+	const simd4f_t extents = SIMD_Mul( SIMD_Sub( maxs, mins ), half );
+
+	// The columns of the transform, col3 is the translation
+	simd4f_t col0 = transform.rows[ 0 ].ToSIMD();
+	simd4f_t col1 = transform.rows[ 1 ].ToSIMD();
+	simd4f_t col2 = transform.rows[ 2 ].ToSIMD();
+	simd4f_t col3 = transform.rows[ 3 ].ToSIMD();
+	SIMD_Transpose( col0, col1, col2, col3 );
+
+	simd4f_t newCenter = col3;
+	newCenter = SIMD_MulAdd( col0, SIMD_SplatLane< 0 >( center ), newCenter );
+	newCenter = SIMD_MulAdd( col1, SIMD_SplatLane< 1 >( center ), newCenter );
+	newCenter = SIMD_MulAdd( col2, SIMD_SplatLane< 2 >( center ), newCenter );
+
+	simd4f_t newExtents = SIMD_Mul( SIMD_Abs( col0 ), SIMD_SplatLane< 0 >( extents ) );
+	newExtents = SIMD_MulAdd( SIMD_Abs( col1 ), SIMD_SplatLane< 1 >( extents ), newExtents );
+	newExtents = SIMD_MulAdd( SIMD_Abs( col2 ), SIMD_SplatLane< 2 >( extents ), newExtents );
+
+	alignas( 16 ) float tmp[ 4 ];
+	Bounds result;
+	SIMD_Store( tmp, SIMD_Sub( newCenter, newExtents ) );
+	result.mins = Vec3( tmp[ 0 ], tmp[ 1 ], tmp[ 2 ] );
+	SIMD_Store( tmp, SIMD_Add( newCenter, newExtents ) );
+	result.maxs = Vec3( tmp[ 0 ], tmp[ 1 ], tmp[ 2 ] );
+	return result;
+}
+
+/*
+====================================================
+TransformBounds
+====================================================
+*/
+Bounds TransformBounds( const Bounds & bounds, const Vec3 & pos, const Quat & orient ) {
+	const Vec3 fwd = orient.RotatePoint( Vec3( 1, 0, 0 ) );
+	const Vec3 up = orient.RotatePoint( Vec3( 0, 0, 1 ) );
+
+	Mat4 transform;
+	transform.Orient( pos, fwd, up );
+	return TransformBounds( bounds, transform );
+}
+
+/*
+====================================================
+boundsSoA_t::Resize
+====================================================
+*/
+void boundsSoA_t::Resize( const int num ) {
+	minX.resize( num );
+	minY.resize( num );
+	minZ.resize( num );
+	maxX.resize( num );
+	maxY.resize( num );
+	maxZ.resize( num );
+}
+
+/*
+====================================================
+boundsSoA_t::Set
+====================================================
+*/
+void boundsSoA_t::Set( const int idx, const Bounds & bounds ) {
+	minX[ idx ] = bounds.mins.x;
+	minY[ idx ] = bounds.mins.y;
+	minZ[ idx ] = bounds.mins.z;
+	maxX[ idx ] = bounds.maxs.x;
+	maxY[ idx ] = bounds.maxs.y;
+	maxZ[ idx ] = bounds.maxs.z;
+}
+
+/*
+====================================================
+boundsSoA_t::Get
+====================================================
+*/
+Bounds boundsSoA_t::Get( const int idx ) const {
+	Bounds bounds;
+	bounds.mins = Vec3( minX[ idx ], minY[ idx ], minZ[ idx ] );
+	bounds.maxs = Vec3( maxX[ idx ], maxY[ idx ], maxZ[ idx ] );
+	return bounds;
+}
+
+/*
+====================================================
+IntersectBounds
+====================================================
+*/
+int IntersectBounds( const Bounds & bounds, const boundsSoA_t & others, const int begin, const int end, int * hits ) {
+	const simd4f_t minX = SIMD_Splat( bounds.mins.x );
+	const simd4f_t minY = SIMD_Splat( bounds.mins.y );
+	const simd4f_t minZ = SIMD_Splat( bounds.mins.z );
+	const simd4f_t maxX = SIMD_Splat( bounds.maxs.x );
+	const simd4f_t maxY = SIMD_Splat( bounds.maxs.y );
+	const simd4f_t maxZ = SIMD_Splat( bounds.maxs.z );
+
+	int numHits = 0;
+	int i = begin;
+	for ( ; i + 4 <= end; i += 4 ) {
+		simd4f_t overlap = SIMD_CmpLE( SIMD_LoadUnaligned( others.minX.data() + i ), maxX );
+		overlap = SIMD_And( overlap, SIMD_CmpLE( minX, SIMD_LoadUnaligned( others.maxX.data() + i ) ) );
+		overlap = SIMD_And( overlap, SIMD_CmpLE( SIMD_LoadUnaligned( others.minY.data() + i ), maxY ) );
+		overlap = SIMD_And( overlap, SIMD_CmpLE( minY, SIMD_LoadUnaligned( others.maxY.data() + i ) ) );
+		overlap = SIMD_And( overlap, SIMD_CmpLE( SIMD_LoadUnaligned( others.minZ.data() + i ), maxZ ) );
+		overlap = SIMD_And( overlap, SIMD_CmpLE( minZ, SIMD_LoadUnaligned( others.maxZ.data() + i ) ) );
+
+		// Write all four and only advance past the ones that hit
+		const int mask = SIMD_MoveMask( overlap );
+		for ( int j = 0; j < 4; j++ ) {
+			hits[ numHits ] = i + j;
+			numHits += ( mask >> j ) & 1;
+		}
+	}
+
+	for ( ; i < end; i++ ) {
+		hits[ numHits ] = i;
+		numHits += bounds.DoesIntersect( others.Get( i ) ) ? 1 : 0;
+	}
+	return numHits;
+}
+
+/*
+====================================================
+IntersectBounds
+====================================================
+*/
+void IntersectBounds( const boundsSoA_t & a, const boundsSoA_t & b, std::vector< boundsPair_t > & pairs ) {
+	const bool isSelf = ( &a == &b );
+	std::vector< int > hits( b.Num() );
+
+	for ( int i = 0; i < a.Num(); i++ ) {
+		const int begin = isSelf ? i + 1 : 0;
+		const int numHits = IntersectBounds( a.Get( i ), b, begin, b.Num(), hits.data() );
+		for ( int j = 0; j < numHits; j++ ) {
+			boundsPair_t pair;
+			pair.a = i;
+			pair.b = hits[ j ];
+			pairs.push_back( pair );
+		}
+	}
+}
@@ -5,6 +5,8 @@
 #include <math.h>
 #include <assert.h>
 #include "Vector.h"
+#include "Matrix.h"
+#include "Quat.h"
 #include <vector>
 
 /*
@@ -32,4 +34,62 @@ public:
 public:
 	Vec3 mins;
 	Vec3 maxs;
-};
\ No newline at end of file
+};
+
+/*
+====================================================
+TransformBounds
+
+Bounds of the box after transforming it, from its center and half
+extents with the absolute value of the rotation part, instead of
+transforming all eight corners.  The Mat4 is the usual row major
+transform with the translation in the fourth column.
+====================================================
+*/
+Bounds TransformBounds( const Bounds & bounds, const Mat4 & transform );
+Bounds TransformBounds( const Bounds & bounds, const Vec3 & pos, const Quat & orient );
+
+/*
+====================================================
+boundsSoA_t
+
+Many bounds, one array per component, for overlap tests that check
+four bounds at a time.
+====================================================
+*/
+struct boundsSoA_t {
+	std::vector< float > minX;
+	std::vector< float > minY;
+	std::vector< float > minZ;
+	std::vector< float > maxX;
+	std::vector< float > maxY;
+	std::vector< float > maxZ;
+
+	int Num() const { return (int)minX.size(); }
+	void Resize( const int num );
+	void Set( const int idx, const Bounds & bounds );
+	Bounds Get( const int idx ) const;
+};
+
+struct boundsPair_t {
+	int a;
+	int b;
+};
+
+/*
+====================================================
+IntersectBounds
+
+1 vs N: writes the index of every bounds in [ begin, end ) of others
+that overlaps bounds to hits, which needs room for end - begin indices,
+and returns how many there are.
+
+N vs N: appends every overlapping pair of a and b to pairs.  When a and
+b are the same object each pair is reported once, with a < b, and
+nothing is tested against itself.
+
+Touching bounds overlap, same as Bounds::DoesIntersect.
+====================================================
+*/
+int IntersectBounds( const Bounds & bounds, const boundsSoA_t & others, const int begin, const int end, int * hits );
+void IntersectBounds( const boundsSoA_t & a, const boundsSoA_t & b, std::vector< boundsPair_t > & pairs );
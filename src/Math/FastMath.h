@@ -0,0 +1,171 @@
+//
+//	FastMath.h
+//
+#pragma once
+#include <math.h>
+#include "SIMD.h"
+
+/*
+====================================================
+Accuracy policy
+
+Each subsystem picks precise (libm) or fast (estimate plus Newton step,
+polynomials) math at compile time through its MATH_ACCURACY_ define,
+and calls MathFunctions< MATH_ACCURACY_... >.  Physics stays precise so
+simulations don't drift, view dependent work that only needs to look
+right defaults to fast.  Any of them can be overridden with -D.
+
+The fast versions are good to a few ulp:
+	SIMD_RSqrtFast		relative error under 1e-6
+	Sin, Cos, SinCos	absolute error under 2e-7 for | x | up to a few thousand
+
+One value at a time only Sin and Cos are faster than libm, as scalar
+polynomials.  The hardware square root and divide are as quick as the
+estimate plus its Newton step once the moves in and out of a register
+are counted, so Sqrt and RSqrt stay libm.  Batches of four should call
+the SIMD_ versions directly, that is where the estimate pays off.
+====================================================
+*/
+enum mathAccuracy_t {
+	MATH_ACCURACY_PRECISE,
+	MATH_ACCURACY_FAST,
+};
+
+#ifndef MATH_ACCURACY_PHYSICS
+	#define MATH_ACCURACY_PHYSICS MATH_ACCURACY_PRECISE
+#endif
+#ifndef MATH_ACCURACY_CAMERA
+	#define MATH_ACCURACY_CAMERA MATH_ACCURACY_FAST
+#endif
+#ifndef MATH_ACCURACY_CULLING
+	#define MATH_ACCURACY_CULLING MATH_ACCURACY_FAST
+#endif
+#ifndef MATH_ACCURACY_LOD
+	#define MATH_ACCURACY_LOD MATH_ACCURACY_FAST
+#endif
+#ifndef MATH_ACCURACY_ANIMATION
+	#define MATH_ACCURACY_ANIMATION MATH_ACCURACY_FAST
+#endif
+
+/*
+====================================================
+SIMD_RSqrtFast
+====================================================
+*/
+inline simd4f_t SIMD_RSqrtFast( const simd4f_t a ) {
+	// y' = y * ( 1.5 - 0.5 * a * y * y )
+	const simd4f_t y = SIMD_RSqrtEstimate( a );
+	const simd4f_t ayy = SIMD_Mul( SIMD_Mul( a, y ), y );
+	return SIMD_Mul( y, SIMD_Sub( SIMD_Splat( 1.5f ), SIMD_Mul( SIMD_Splat( 0.5f ), ayy ) ) );
+}
+
+/*
+====================================================
+SIMD_SinCosFast
+
+Reduces x to r in [ -pi/2, pi/2 ] with x = r + q * pi, in two parts of
+pi so the reduction stays exact for moderate x, then evaluates
+polynomials for sin( r ) and cos( r ) and flips both signs for odd q.
+====================================================
+*/
+inline void SIMD_SinCosFast( const simd4f_t x, simd4f_t & s, simd4f_t & c ) {
+	const simd4f_t q = SIMD_Round( SIMD_Mul( x, SIMD_Splat( 0.318309886f ) ) );
+	simd4f_t r = SIMD_Sub( x, SIMD_Mul( q, SIMD_Splat( 3.140625f ) ) );
+	r = SIMD_Sub( r, SIMD_Mul( q, SIMD_Splat( 9.67653589793e-4f ) ) );
+	const simd4f_t r2 = SIMD_Mul( r, r );
+
+	simd4f_t sinPoly = SIMD_Splat( -2.5052108e-8f );
+	sinPoly = SIMD_MulAdd( sinPoly, r2, SIMD_Splat( 2.7557319e-6f ) );
+	sinPoly = SIMD_MulAdd( sinPoly, r2, SIMD_Splat( -1.98412698e-4f ) );
+	sinPoly = SIMD_MulAdd( sinPoly, r2, SIMD_Splat( 8.33333333e-3f ) );
+	sinPoly = SIMD_MulAdd( sinPoly, r2, SIMD_Splat( -1.66666667e-1f ) );
+	sinPoly = SIMD_MulAdd( SIMD_Mul( sinPoly, r2 ), r, r );
+
+	simd4f_t cosPoly = SIMD_Splat( 2.0876757e-9f );
+	cosPoly = SIMD_MulAdd( cosPoly, r2, SIMD_Splat( -2.7557319e-7f ) );
+	cosPoly = SIMD_MulAdd( cosPoly, r2, SIMD_Splat( 2.4801587e-5f ) );
+	cosPoly = SIMD_MulAdd( cosPoly, r2, SIMD_Splat( -1.38888889e-3f ) );
+	cosPoly = SIMD_MulAdd( cosPoly, r2, SIMD_Splat( 4.16666667e-2f ) );
+	cosPoly = SIMD_MulAdd( cosPoly, r2, SIMD_Splat( -0.5f ) );
+	cosPoly = SIMD_MulAdd( cosPoly, r2, SIMD_Splat( 1.0f ) );
+
+	// q - 2 * round( q / 2 ) is -1, 0 or 1, so this is -1 for odd q and 1 for even q
+	const simd4f_t isOdd = SIMD_Abs( SIMD_Sub( q, SIMD_Mul( SIMD_Splat( 2.0f ), SIMD_Round( SIMD_Mul( q, SIMD_Splat( 0.5f ) ) ) ) ) );
+	const simd4f_t sign = SIMD_Sub( SIMD_Splat( 1.0f ), SIMD_Mul( SIMD_Splat( 2.0f ), isOdd ) );
+
+	s = SIMD_Mul( sinPoly, sign );
+	c = SIMD_Mul( cosPoly, sign );
+}
+
+/*
+====================================================
+SinCosFast
+
+SIMD_SinCosFast on a single float with scalar math, the four lane version
+pays for three lanes nobody reads.  The reduction rounds halves away from
+zero, either way is fine since r stays inside [ -pi/2, pi/2 ].
+====================================================
+*/
+inline void SinCosFast( const float x, float & s, float & c ) {
+	const int q = (int)( x * 0.318309886f + ( ( x >= 0.0f ) ? 0.5f : -0.5f ) );
+	const float qf = (float)q;
+	float r = x - qf * 3.140625f;
+	r = r - qf * 9.67653589793e-4f;
+	const float r2 = r * r;
+
+	float sinPoly = -2.5052108e-8f;
+	sinPoly = sinPoly * r2 + 2.7557319e-6f;
+	sinPoly = sinPoly * r2 + -1.98412698e-4f;
+	sinPoly = sinPoly * r2 + 8.33333333e-3f;
+	sinPoly = sinPoly * r2 + -1.66666667e-1f;
+	sinPoly = sinPoly * r2 * r + r;
+
+	float cosPoly = 2.0876757e-9f;
+	cosPoly = cosPoly * r2 + -2.7557319e-7f;
+	cosPoly = cosPoly * r2 + 2.4801587e-5f;
+	cosPoly = cosPoly * r2 + -1.38888889e-3f;
+	cosPoly = cosPoly * r2 + 4.16666667e-2f;
+	cosPoly = cosPoly * r2 + -0.5f;
+	cosPoly = cosPoly * r2 + 1.0f;
+
+	const float sign = ( q & 1 ) ? -1.0f : 1.0f;
+	s = sinPoly * sign;
+	c = cosPoly * sign;
+}
+
+/*
+====================================================
+MathFunctions
+====================================================
+*/
+template < mathAccuracy_t accuracy >
+struct MathFunctions;
+
+template <>
+struct MathFunctions< MATH_ACCURACY_PRECISE > {
+	static float Sqrt( const float x ) { return sqrtf( x ); }
+	static float RSqrt( const float x ) { return 1.0f / sqrtf( x ); }
+	static float Sin( const float x ) { return sinf( x ); }
+	static float Cos( const float x ) { return cosf( x ); }
+	static void SinCos( const float x, float & s, float & c ) {
+		s = sinf( x );
+		c = cosf( x );
+	}
+};
+
+template <>
+struct MathFunctions< MATH_ACCURACY_FAST > {
+	static float Sqrt( const float x ) { return sqrtf( x ); }
+	static float RSqrt( const float x ) { return 1.0f / sqrtf( x ); }
+	static float Sin( const float x ) {
+		float s, c;
+		SinCos( x, s, c );
+		return s;
+	}
+	static float Cos( const float x ) {
+		float s, c;
+		SinCos( x, s, c );
+		return c;
+	}
+	static void SinCos( const float x, float & s, float & c ) { SinCosFast( x, s, c ); }
+};
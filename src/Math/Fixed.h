@@ -0,0 +1,244 @@
+//
+//	Fixed.h
+//
+#pragma once
+
+/*
+====================================================
+Vec< N, T >
+
+Vector with its size fixed at compile time.  The elements are a plain
+array inside the object and every loop has a constant trip count, so
+the compiler can unroll and vectorize them and nothing is allocated.
+Sums are accumulated in the same order as VecN, the results match it
+bit for bit.
+====================================================
+*/
+template< int DIM, typename T = float >
+class Vec {
+public:
+	static constexpr int N = DIM;
+
+	constexpr Vec() : data() {}
+
+	constexpr T operator[]( const int idx ) const { return data[ idx ]; }
+	constexpr T & operator[]( const int idx ) { return data[ idx ]; }
+
+	constexpr const Vec & operator *= ( const T rhs );
+	constexpr const Vec & operator += ( const Vec & rhs );
+	constexpr const Vec & operator -= ( const Vec & rhs );
+	constexpr Vec operator * ( const T rhs ) const;
+	constexpr Vec operator + ( const Vec & rhs ) const;
+	constexpr Vec operator - ( const Vec & rhs ) const;
+
+	constexpr T Dot( const Vec & rhs ) const;
+	constexpr void Zero();
+
+public:
+	T data[ DIM ];
+};
+
+template< int DIM, typename T >
+constexpr const Vec< DIM, T > & Vec< DIM, T >::operator *= ( const T rhs ) {
+	for ( int i = 0; i < DIM; i++ ) {
+		data[ i ] *= rhs;
+	}
+	return *this;
+}
+
+template< int DIM, typename T >
+constexpr const Vec< DIM, T > & Vec< DIM, T >::operator += ( const Vec & rhs ) {
+	for ( int i = 0; i < DIM; i++ ) {
+		data[ i ] += rhs.data[ i ];
+	}
+	return *this;
+}
+
+template< int DIM, typename T >
+constexpr const Vec< DIM, T > & Vec< DIM, T >::operator -= ( const Vec & rhs ) {
+	for ( int i = 0; i < DIM; i++ ) {
+		data[ i ] -= rhs.data[ i ];
+	}
+	return *this;
+}
+
+template< int DIM, typename T >
+constexpr Vec< DIM, T > Vec< DIM, T >::operator * ( const T rhs ) const {
+	Vec tmp = *this;
+	tmp *= rhs;
+	return tmp;
+}
+
+template< int DIM, typename T >
+constexpr Vec< DIM, T > Vec< DIM, T >::operator + ( const Vec & rhs ) const {
+	Vec tmp = *this;
+	tmp += rhs;
+	return tmp;
+}
+
+template< int DIM, typename T >
+constexpr Vec< DIM, T > Vec< DIM, T >::operator - ( const Vec & rhs ) const {
+	Vec tmp = *this;
+	tmp -= rhs;
+	return tmp;
+}
+
+template< int DIM, typename T >
+constexpr T Vec< DIM, T >::Dot( const Vec & rhs ) const {
+	T sum = T( 0 );
+	for ( int i = 0; i < DIM; i++ ) {
+		sum += data[ i ] * rhs.data[ i ];
+	}
+	return sum;
+}
+
+template< int DIM, typename T >
+constexpr void Vec< DIM, T >::Zero() {
+	for ( int i = 0; i < DIM; i++ ) {
+		data[ i ] = T( 0 );
+	}
+}
+
+/*
+====================================================
+Mat< R, C, T >
+
+R x C matrix with its size fixed at compile time, stored as R rows of
+Vec< C, T >.  The products check their dimensions at compile time.
+====================================================
+*/
+template< int R, int C, typename T = float >
+class Mat {
+public:
+	static constexpr int M = R;	// M rows
+	static constexpr int N = C;	// N columns
+
+	constexpr Mat() : rows() {}
+
+	constexpr void Zero();
+	constexpr void Identity();
+	constexpr Mat< C, R, T > Transpose() const;
+
+	constexpr Vec< R, T > operator * ( const Vec< C, T > & rhs ) const;
+	template< int K >
+	constexpr Mat< R, K, T > operator * ( const Mat< C, K, T > & rhs ) const;
+	constexpr Mat operator * ( const T rhs ) const;
+	constexpr const Mat & operator *= ( const T rhs );
+	constexpr Mat operator + ( const Mat & rhs ) const;
+	constexpr const Mat & operator += ( const Mat & rhs );
+
+	// Products with a transpose, without building the transposed copy
+	constexpr Vec< C, T > TransposeMultiply( const Vec< R, T > & rhs ) const;		// this^T * rhs
+	template< int K >
+	constexpr Mat< R, K, T > MultiplyTranspose( const Mat< K, C, T > & rhs ) const;	// this * rhs^T
+
+public:
+	Vec< C, T > rows[ R ];
+};
+
+template< int R, int C, typename T >
+constexpr void Mat< R, C, T >::Zero() {
+	for ( int m = 0; m < R; m++ ) {
+		rows[ m ].Zero();
+	}
+}
+
+template< int R, int C, typename T >
+constexpr void Mat< R, C, T >::Identity() {
+	static_assert( R == C, "Identity needs a square matrix" );
+	for ( int m = 0; m < R; m++ ) {
+		rows[ m ].Zero();
+		rows[ m ][ m ] = T( 1 );
+	}
+}
+
+template< int R, int C, typename T >
+constexpr Mat< C, R, T > Mat< R, C, T >::Transpose() const {
+	Mat< C, R, T > tmp;
+	for ( int m = 0; m < R; m++ ) {
+		for ( int n = 0; n < C; n++ ) {
+			tmp.rows[ n ][ m ] = rows[ m ][ n ];
+		}
+	}
+	return tmp;
+}
+
+template< int R, int C, typename T >
+constexpr Vec< R, T > Mat< R, C, T >::operator * ( const Vec< C, T > & rhs ) const {
+	Vec< R, T > tmp;
+	for ( int m = 0; m < R; m++ ) {
+		tmp[ m ] = rhs.Dot( rows[ m ] );
+	}
+	return tmp;
+}
+
+template< int R, int C, typename T >
+template< int K >
+constexpr Mat< R, K, T > Mat< R, C, T >::operator * ( const Mat< C, K, T > & rhs ) const {
+	// Walk rhs row by row instead of down its columns
+	Mat< R, K, T > tmp;
+	for ( int m = 0; m < R; m++ ) {
+		for ( int k = 0; k < C; k++ ) {
+			const T a = rows[ m ][ k ];
+			for ( int n = 0; n < K; n++ ) {
+				tmp.rows[ m ][ n ] += a * rhs.rows[ k ][ n ];
+			}
+		}
+	}
+	return tmp;
+}
+
+template< int R, int C, typename T >
+constexpr Mat< R, C, T > Mat< R, C, T >::operator * ( const T rhs ) const {
+	Mat tmp = *this;
+	tmp *= rhs;
+	return tmp;
+}
+
+template< int R, int C, typename T >
+constexpr const Mat< R, C, T > & Mat< R, C, T >::operator *= ( const T rhs ) {
+	for ( int m = 0; m < R; m++ ) {
+		rows[ m ] *= rhs;
+	}
+	return *this;
+}
+
+template< int R, int C, typename T >
+constexpr Mat< R, C, T > Mat< R, C, T >::operator + ( const Mat & rhs ) const {
+	Mat tmp = *this;
+	tmp += rhs;
+	return tmp;
+}
+
+template< int R, int C, typename T >
+constexpr const Mat< R, C, T > & Mat< R, C, T >::operator += ( const Mat & rhs ) {
+	for ( int m = 0; m < R; m++ ) {
+		rows[ m ] += rhs.rows[ m ];
+	}
+	return *this;
+}
+
+template< int R, int C, typename T >
+constexpr Vec< C, T > Mat< R, C, T >::TransposeMultiply( const Vec< R, T > & rhs ) const {
+	Vec< C, T > tmp;
+	for ( int m = 0; m < R; m++ ) {
+		const T s = rhs[ m ];
+		for ( int n = 0; n < C; n++ ) {
+			tmp[ n ] += rows[ m ][ n ] * s;
+		}
+	}
+	return tmp;
+}
+
+template< int R, int C, typename T >
+template< int K >
+constexpr Mat< R, K, T > Mat< R, C, T >::MultiplyTranspose( const Mat< K, C, T > & rhs ) const {
+	// Row by row dot products, the rows of rhs are the columns of its transpose
+	Mat< R, K, T > tmp;
+	for ( int m = 0; m < R; m++ ) {
+		for ( int k = 0; k < K; k++ ) {
+			tmp.rows[ m ][ k ] = rows[ m ].Dot( rhs.rows[ k ] );
+		}
+	}
+	return tmp;
+}
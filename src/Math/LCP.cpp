@@ -2,6 +2,7 @@
 //	LCP.cpp
 //
 #include "LCP.h"
+#include <vector>
 
 /*
 ====================================================
@@ -22,4 +23,97 @@ VecN LCP_GaussSeidel( const MatN & A, const VecN & b ) {
 		}
 	}
 	return x;
-}
\ No newline at end of file
+}
+
+/*
+====================================================
+LCP_GaussSeidel
+
+W J^T of a row lives next to the row, and the body velocities change
+by W J^T dLambda, so the row i update
+
+	dLambda = ( rhs_i - J_i * W J^T lambda ) / ( J_i W J_i^T )
+
+reads only the two bodies of the row.
+====================================================
+*/
+VecN LCP_GaussSeidel( const lcpRow_t * rows, const int numRows, const lcpBody_t * bodies, const int numBodies, const int maxIters ) {
+	struct rowScratch_t {
+		float invMassJt[ 12 ];	// W J^T of the row
+		float invDiagonal;		// 1 / ( J W J^T )
+	};
+	std::vector< rowScratch_t > scratch( numRows );
+	std::vector< float > velocities( numBodies * 6, 0.0f );	// W J^T lambda, linear then angular
+
+	for ( int i = 0; i < numRows; i++ ) {
+		const lcpRow_t & row = rows[ i ];
+		rowScratch_t & s = scratch[ i ];
+
+		const int bodyIdx[ 2 ] = { row.bodyA, row.bodyB };
+		float diagonal = 0.0f;
+		for ( int side = 0; side < 2; side++ ) {
+			const float * J = row.jacobian + side * 6;
+			float * WJt = s.invMassJt + side * 6;
+			if ( bodyIdx[ side ] < 0 ) {
+				for ( int k = 0; k < 6; k++ ) {
+					WJt[ k ] = 0.0f;
+				}
+				continue;
+			}
+
+			const lcpBody_t & body = bodies[ bodyIdx[ side ] ];
+			const Vec3 angular = body.invInertia * Vec3( J[ 3 ], J[ 4 ], J[ 5 ] );
+			WJt[ 0 ] = J[ 0 ] * body.invMass;
+			WJt[ 1 ] = J[ 1 ] * body.invMass;
+			WJt[ 2 ] = J[ 2 ] * body.invMass;
+			WJt[ 3 ] = angular.x;
+			WJt[ 4 ] = angular.y;
+			WJt[ 5 ] = angular.z;
+			for ( int k = 0; k < 6; k++ ) {
+				diagonal += J[ k ] * WJt[ k ];
+			}
+		}
+		s.invDiagonal = ( diagonal > 0.0f ) ? 1.0f / diagonal : 0.0f;
+	}
+
+	VecN lambda( numRows );
+	lambda.Zero();
+
+	for ( int iter = 0; iter < maxIters; iter++ ) {
+		for ( int i = 0; i < numRows; i++ ) {
+			const lcpRow_t & row = rows[ i ];
+			const rowScratch_t & s = scratch[ i ];
+
+			float * velA = ( row.bodyA >= 0 ) ? velocities.data() + row.bodyA * 6 : NULL;
+			float * velB = ( row.bodyB >= 0 ) ? velocities.data() + row.bodyB * 6 : NULL;
+
+			float Jv = 0.0f;
+			if ( NULL != velA ) {
+				for ( int k = 0; k < 6; k++ ) {
+					Jv += row.jacobian[ k ] * velA[ k ];
+				}
+			}
+			if ( NULL != velB ) {
+				for ( int k = 0; k < 6; k++ ) {
+					Jv += row.jacobian[ 6 + k ] * velB[ k ];
+				}
+			}
+
+			const float newLambda = std::max( row.lambdaMin, std::min( row.lambdaMax, lambda[ i ] + ( row.rhs - Jv ) * s.invDiagonal ) );
+			const float dLambda = newLambda - lambda[ i ];
+			lambda[ i ] = newLambda;
+
+			if ( NULL != velA ) {
+				for ( int k = 0; k < 6; k++ ) {
+					velA[ k ] += s.invMassJt[ k ] * dLambda;
+				}
+			}
+			if ( NULL != velB ) {
+				for ( int k = 0; k < 6; k++ ) {
+					velB[ k ] += s.invMassJt[ 6 + k ] * dLambda;
+				}
+			}
+		}
+	}
+	return lambda;
+}
@@ -3,8 +3,10 @@
 //
 #pragma once
 #include <algorithm>
+#include <float.h>
 #include "Matrix.h"
 #include "Vector.h"
+#include "Fixed.h"
 
 #define PI 3.14159265358979323846f
 /*
@@ -14,6 +16,73 @@ LCP_GaussSeidel
 */
 VecN LCP_GaussSeidel(const MatN &A, const VecN &b);
 
+// Same iteration for systems whose size is known at compile time
+template <int N>
+Vec<N> LCP_GaussSeidel(const Mat<N, N> &A, const Vec<N> &b)
+{
+    Vec<N> x;
+
+    for (int iter = 0; iter < N; iter++)
+    {
+        for (int i = 0; i < N; i++)
+        {
+            float dx = (b[i] - A.rows[i].Dot(x)) / A.rows[i][i];
+            if (dx * 0.0f == dx * 0.0f)
+            {
+                x[i] = x[i] + dx;
+            }
+        }
+    }
+    return x;
+}
+
+/*
+====================================================
+lcpRow_t
+
+One constraint row in sparse block form.  A row only touches the two
+bodies it connects, so it keeps their indices and its 1x12 block of the
+Jacobian ( linear A, angular A, linear B, angular B ) instead of a full
+row of J.  A body index of -1 is the world, its part of the row is
+ignored.
+====================================================
+*/
+struct lcpRow_t
+{
+    int bodyA;
+    int bodyB;
+    float jacobian[12];
+    float rhs;
+    float lambdaMin; // projected Gauss-Seidel, -FLT_MAX / FLT_MAX for an equality row
+    float lambdaMax;
+};
+
+/*
+====================================================
+lcpBody_t
+
+The inverse mass matrix block of one body, in world space
+====================================================
+*/
+struct lcpBody_t
+{
+    float invMass;
+    Mat3 invInertia;
+};
+
+/*
+====================================================
+LCP_GaussSeidel
+
+Solves ( J W J^T ) lambda = rhs for the rows without forming J W J^T.
+It keeps W J^T lambda per body, so each row update is a 12 wide dot
+product and a 12 wide add, and memory is O( rows + bodies ) instead of
+O( rows^2 ).  Same sweep as the dense version, with each lambda clamped
+to its row's limits.
+====================================================
+*/
+VecN LCP_GaussSeidel(const lcpRow_t *rows, const int numRows, const lcpBody_t *bodies, const int numBodies, const int maxIters);
+
 namespace ElecNeko
 {
     static inline float Degrees(float radians) { return radians * (180.f / PI); };
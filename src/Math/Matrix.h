@@ -145,9 +145,9 @@ inline void Mat3::Identity() {
 }
 
 inline float Mat3::Trace() const {
-	const float xx = rows[ 0 ][ 0 ] * rows[ 0 ][ 0 ];
-	const float yy = rows[ 1 ][ 1 ] * rows[ 1 ][ 1 ];
-	const float zz = rows[ 2 ][ 2 ] * rows[ 2 ][ 2 ];
+	const float xx = rows[ 0 ][ 0 ];
+	const float yy = rows[ 1 ][ 1 ];
+	const float zz = rows[ 2 ][ 2 ];
 	return ( xx + yy + zz );
 }
 
@@ -169,15 +169,16 @@ inline Mat3 Mat3::Transpose() const {
 }
 
 inline Mat3 Mat3::Inverse() const {
+	// The columns of the adjugate are the cross products of the other two rows
+	const Vec3 c0 = rows[ 1 ].Cross( rows[ 2 ] );
+	const Vec3 c1 = rows[ 2 ].Cross( rows[ 0 ] );
+	const Vec3 c2 = rows[ 0 ].Cross( rows[ 1 ] );
+	const float invDet = 1.0f / rows[ 0 ].Dot( c0 );
+
 	Mat3 inv;
-	for ( int i = 0; i < 3; i++ ) {
-		for ( int j = 0; j < 3; j++ ) {
-			inv.rows[ j ][ i ] = Cofactor( i, j );	// Perform the transpose while calculating the cofactors
-		}
-	}
-	float det = Determinant();
-	float invDet = 1.0f / det;
-	inv *= invDet;
+	inv.rows[ 0 ] = Vec3( c0.x, c1.x, c2.x ) * invDet;
+	inv.rows[ 1 ] = Vec3( c0.y, c1.y, c2.y ) * invDet;
+	inv.rows[ 2 ] = Vec3( c0.z, c1.z, c2.z ) * invDet;
 	return inv;
 }
 
@@ -207,8 +208,8 @@ inline Mat2 Mat3::Minor( const int i, const int j ) const {
 
 inline float Mat3::Cofactor( const int i, const int j ) const {
 	const Mat2 minor = Minor( i, j );
-	const float C = float( pow( -1, i + 1 + j + 1 ) ) * minor.Determinant();
-	return C;
+	const float sign = ( ( i + j ) & 1 ) ? -1.0f : 1.0f;
+	return sign * minor.Determinant();
 }
 
 inline Vec3 Mat3::operator * ( const Vec3 & rhs ) const {
@@ -266,6 +267,8 @@ public:
 	float Determinant() const;
 	Mat4 Transpose() const;
 	Mat4 Inverse() const;
+	Mat4 InverseAffine() const;			// last row must be ( 0, 0, 0, 1 )
+	Mat4 InverseOrthonormal() const;	// rotation and translation only, like view and orient matrices
 	Mat3 Minor( const int i, const int j ) const;
 	float Cofactor( const int i, const int j ) const;
 
@@ -321,10 +324,11 @@ inline Mat4 & Mat4::operator = ( const Mat4 & rhs ) {
 }
 
 inline const Mat4 & Mat4::operator *= ( const float rhs ) {
-	rows[ 0 ] *= rhs;
-	rows[ 1 ] *= rhs;
-	rows[ 2 ] *= rhs;
-	rows[ 3 ] *= rhs;
+	const simd4f_t s = SIMD_Splat( rhs );
+	SIMD_Store( rows[ 0 ].ToPtr(), SIMD_Mul( rows[ 0 ].ToSIMD(), s ) );
+	SIMD_Store( rows[ 1 ].ToPtr(), SIMD_Mul( rows[ 1 ].ToSIMD(), s ) );
+	SIMD_Store( rows[ 2 ].ToPtr(), SIMD_Mul( rows[ 2 ].ToSIMD(), s ) );
+	SIMD_Store( rows[ 3 ].ToPtr(), SIMD_Mul( rows[ 3 ].ToSIMD(), s ) );
 	return *this;
 }
 
@@ -343,46 +347,182 @@ inline void Mat4::Identity() {
 }
 
 inline float Mat4::Trace() const {
-	const float xx = rows[ 0 ][ 0 ] * rows[ 0 ][ 0 ];
-	const float yy = rows[ 1 ][ 1 ] * rows[ 1 ][ 1 ];
-	const float zz = rows[ 2 ][ 2 ] * rows[ 2 ][ 2 ];
-	const float ww = rows[ 3 ][ 3 ] * rows[ 3 ][ 3 ];
+	const float xx = rows[ 0 ][ 0 ];
+	const float yy = rows[ 1 ][ 1 ];
+	const float zz = rows[ 2 ][ 2 ];
+	const float ww = rows[ 3 ][ 3 ];
 	return ( xx + yy + zz + ww );
 }
 
 inline float Mat4::Determinant() const {
-	float det = 0.0f;
-	float sign = 1.0f;
-	for ( int j = 0; j < 4; j++ ) {
-		Mat3 minor = Minor( 0, j );
-
-		det += rows[ 0 ][ j ] * minor.Determinant() * sign;
-		sign = sign * -1.0f;
-	}
-	return det;
+	// Laplace expansion along the top two rows, the 2x2 determinants of
+	// the top rows times the complementary ones of the bottom rows
+	const Vec4 & r0 = rows[ 0 ];
+	const Vec4 & r1 = rows[ 1 ];
+	const Vec4 & r2 = rows[ 2 ];
+	const Vec4 & r3 = rows[ 3 ];
+
+	const float s0 = r0.x * r1.y - r1.x * r0.y;
+	const float s1 = r0.x * r1.z - r1.x * r0.z;
+	const float s2 = r0.x * r1.w - r1.x * r0.w;
+	const float s3 = r0.y * r1.z - r1.y * r0.z;
+	const float s4 = r0.y * r1.w - r1.y * r0.w;
+	const float s5 = r0.z * r1.w - r1.z * r0.w;
+
+	const float c0 = r2.x * r3.y - r3.x * r2.y;
+	const float c1 = r2.x * r3.z - r3.x * r2.z;
+	const float c2 = r2.x * r3.w - r3.x * r2.w;
+	const float c3 = r2.y * r3.z - r3.y * r2.z;
+	const float c4 = r2.y * r3.w - r3.y * r2.w;
+	const float c5 = r2.z * r3.w - r3.z * r2.w;
+
+	return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
 }
 
 inline Mat4 Mat4::Transpose() const {
-	Mat4 transpose;
-	for ( int i = 0; i < 4; i++ ) {
-		for ( int j = 0; j < 4; j++ ) {
-			transpose.rows[ i ][ j ] = rows[ j ][ i ];
-		}
-	}
-	return transpose;
+	simd4f_t r0 = rows[ 0 ].ToSIMD();
+	simd4f_t r1 = rows[ 1 ].ToSIMD();
+	simd4f_t r2 = rows[ 2 ].ToSIMD();
+	simd4f_t r3 = rows[ 3 ].ToSIMD();
+	SIMD_Transpose( r0, r1, r2, r3 );
+	return Mat4( Vec4( r0 ), Vec4( r1 ), Vec4( r2 ), Vec4( r3 ) );
+}
+
+/*
+ 2x2 matrices packed row major in one register ( m00, m01, m10, m11 ),
+ used by the block inverse below
+ */
+inline simd4f_t Mat2_Mul( const simd4f_t a, const simd4f_t b ) {
+	// a * b
+	const simd4f_t lhs = SIMD_Mul( a, SIMD_Shuffle< 0, 3, 0, 3 >( b, b ) );
+	const simd4f_t rhs = SIMD_Mul( SIMD_Shuffle< 1, 0, 3, 2 >( a, a ), SIMD_Shuffle< 2, 1, 2, 1 >( b, b ) );
+	return SIMD_Add( lhs, rhs );
+}
+
+inline simd4f_t Mat2_AdjMul( const simd4f_t a, const simd4f_t b ) {
+	// adj( a ) * b
+	const simd4f_t lhs = SIMD_Mul( SIMD_Shuffle< 3, 3, 0, 0 >( a, a ), b );
+	const simd4f_t rhs = SIMD_Mul( SIMD_Shuffle< 1, 1, 2, 2 >( a, a ), SIMD_Shuffle< 2, 3, 0, 1 >( b, b ) );
+	return SIMD_Sub( lhs, rhs );
+}
+
+inline simd4f_t Mat2_MulAdj( const simd4f_t a, const simd4f_t b ) {
+	// a * adj( b )
+	const simd4f_t lhs = SIMD_Mul( a, SIMD_Shuffle< 3, 0, 3, 0 >( b, b ) );
+	const simd4f_t rhs = SIMD_Mul( SIMD_Shuffle< 1, 0, 3, 2 >( a, a ), SIMD_Shuffle< 2, 1, 2, 1 >( b, b ) );
+	return SIMD_Sub( lhs, rhs );
 }
 
 inline Mat4 Mat4::Inverse() const {
-	Mat4 inv;
-	for ( int i = 0; i < 4; i++ ) {
-		for ( int j = 0; j < 4; j++ ) {
-			inv.rows[ j ][ i ] = Cofactor( i, j );	// Perform the transpose while calculating the cofactors
-		}
-	}
-	float det = Determinant();
-	float invDet = 1.0f / det;
-	inv *= invDet;
-	return inv;
+	// Split into 2x2 blocks
+	//	M = | A B |
+	//	    | C D |
+	// and build the adjugate blockwise from the adjugates of the blocks,
+	// no minors or cofactors.  Singular matrices give inf or nan, like
+	// dividing by the zero determinant did before.
+	const simd4f_t r0 = rows[ 0 ].ToSIMD();
+	const simd4f_t r1 = rows[ 1 ].ToSIMD();
+	const simd4f_t r2 = rows[ 2 ].ToSIMD();
+	const simd4f_t r3 = rows[ 3 ].ToSIMD();
+
+	const simd4f_t A = SIMD_Shuffle< 0, 1, 0, 1 >( r0, r1 );
+	const simd4f_t B = SIMD_Shuffle< 2, 3, 2, 3 >( r0, r1 );
+	const simd4f_t C = SIMD_Shuffle< 0, 1, 0, 1 >( r2, r3 );
+	const simd4f_t D = SIMD_Shuffle< 2, 3, 2, 3 >( r2, r3 );
+
+	// ( |A|, |B|, |C|, |D| )
+	const simd4f_t detSub = SIMD_Sub(
+		SIMD_Mul( SIMD_Shuffle< 0, 2, 0, 2 >( r0, r2 ), SIMD_Shuffle< 1, 3, 1, 3 >( r1, r3 ) ),
+		SIMD_Mul( SIMD_Shuffle< 1, 3, 1, 3 >( r0, r2 ), SIMD_Shuffle< 0, 2, 0, 2 >( r1, r3 ) ) );
+	const simd4f_t detA = SIMD_SplatLane< 0 >( detSub );
+	const simd4f_t detB = SIMD_SplatLane< 1 >( detSub );
+	const simd4f_t detC = SIMD_SplatLane< 2 >( detSub );
+	const simd4f_t detD = SIMD_SplatLane< 3 >( detSub );
+
+	const simd4f_t DC = Mat2_AdjMul( D, C );
+	const simd4f_t AB = Mat2_AdjMul( A, B );
+
+	// Adjugates of the blocks of the inverse, scaled by |M|
+	simd4f_t X = SIMD_Sub( SIMD_Mul( detD, A ), Mat2_Mul( B, DC ) );
+	simd4f_t W = SIMD_Sub( SIMD_Mul( detA, D ), Mat2_Mul( C, AB ) );
+	simd4f_t Y = SIMD_Sub( SIMD_Mul( detB, C ), Mat2_MulAdj( D, AB ) );
+	simd4f_t Z = SIMD_Sub( SIMD_Mul( detC, B ), Mat2_MulAdj( A, DC ) );
+
+	// |M| = |A| |D| + |B| |C| - tr( adj( A ) B adj( D ) C )
+	const float tr = SIMD_HorizontalAdd( SIMD_Mul( AB, SIMD_Shuffle< 0, 2, 1, 3 >( DC, DC ) ) );
+	const simd4f_t detM = SIMD_Sub( SIMD_MulAdd( detA, detD, SIMD_Mul( detB, detC ) ), SIMD_Splat( tr ) );
+
+	// The signs turn the block adjugates back into the blocks
+	const simd4f_t invDet = SIMD_Div( SIMD_Set( 1.0f, -1.0f, -1.0f, 1.0f ), detM );
+	X = SIMD_Mul( X, invDet );
+	Y = SIMD_Mul( Y, invDet );
+	Z = SIMD_Mul( Z, invDet );
+	W = SIMD_Mul( W, invDet );
+
+	// Undo the adjugate swaps while scattering the blocks back into rows
+	return Mat4(
+		Vec4( SIMD_Shuffle< 3, 1, 3, 1 >( X, Y ) ),
+		Vec4( SIMD_Shuffle< 2, 0, 2, 0 >( X, Y ) ),
+		Vec4( SIMD_Shuffle< 3, 1, 3, 1 >( Z, W ) ),
+		Vec4( SIMD_Shuffle< 2, 0, 2, 0 >( Z, W ) ) );
+}
+
+inline Mat4 Mat4::InverseAffine() const {
+	// | L t |^-1   | L^-1  -L^-1 t |
+	// | 0 1 |    = | 0      1      |
+	// With a, b, c the rows of L the columns of L^-1 are b x c, c x a and
+	// a x b over the determinant a . ( b x c ).  The inverse is put
+	// together by columns and transposed once, nothing leaves the registers.
+	const simd4f_t a = rows[ 0 ].ToSIMD();
+	const simd4f_t b = rows[ 1 ].ToSIMD();
+	const simd4f_t c = rows[ 2 ].ToSIMD();
+
+	// The crosses come out in zxy order, the same product in both terms
+	// keeps the translations in the w lanes from leaking into them
+	const simd4f_t aYZX = SIMD_Shuffle< 1, 2, 0, 3 >( a, a );
+	const simd4f_t bYZX = SIMD_Shuffle< 1, 2, 0, 3 >( b, b );
+	const simd4f_t cYZX = SIMD_Shuffle< 1, 2, 0, 3 >( c, c );
+	const simd4f_t bxc = SIMD_Sub( SIMD_Mul( b, cYZX ), SIMD_Mul( bYZX, c ) );
+	const simd4f_t cxa = SIMD_Sub( SIMD_Mul( c, aYZX ), SIMD_Mul( cYZX, a ) );
+	const simd4f_t axb = SIMD_Sub( SIMD_Mul( a, bYZX ), SIMD_Mul( aYZX, b ) );
+
+	// a . ( b x c ), with a in zxy order to match
+	const simd4f_t det = SIMD_Splat( SIMD_HorizontalAdd( SIMD_Mul( SIMD_Shuffle< 2, 0, 1, 3 >( a, a ), bxc ) ) );
+	const simd4f_t invDet = SIMD_Div( SIMD_Splat( 1.0f ), det );
+	simd4f_t c0 = SIMD_Mul( SIMD_Shuffle< 1, 2, 0, 3 >( bxc, bxc ), invDet );
+	simd4f_t c1 = SIMD_Mul( SIMD_Shuffle< 1, 2, 0, 3 >( cxa, cxa ), invDet );
+	simd4f_t c2 = SIMD_Mul( SIMD_Shuffle< 1, 2, 0, 3 >( axb, axb ), invDet );
+
+	// -L^-1 t as the columns of L^-1 weighted by t, w ends up 1
+	simd4f_t c3 = SIMD_Set( 0.0f, 0.0f, 0.0f, 1.0f );
+	c3 = SIMD_Sub( c3, SIMD_Mul( c0, SIMD_SplatLane< 3 >( a ) ) );
+	c3 = SIMD_Sub( c3, SIMD_Mul( c1, SIMD_SplatLane< 3 >( b ) ) );
+	c3 = SIMD_Sub( c3, SIMD_Mul( c2, SIMD_SplatLane< 3 >( c ) ) );
+
+	SIMD_Transpose( c0, c1, c2, c3 );
+	return Mat4( Vec4( c0 ), Vec4( c1 ), Vec4( c2 ), Vec4( c3 ) );
+}
+
+inline Mat4 Mat4::InverseOrthonormal() const {
+	// | R t |^-1   | R^T  -R^T t |
+	// | 0 1 |    = | 0     1     |
+	// The columns of R^T are the rows of R, put the inverse together by
+	// columns like InverseAffine and transpose once
+	const simd4f_t r0 = rows[ 0 ].ToSIMD();
+	const simd4f_t r1 = rows[ 1 ].ToSIMD();
+	const simd4f_t r2 = rows[ 2 ].ToSIMD();
+	const simd4f_t noW = SIMD_Set( 1.0f, 1.0f, 1.0f, 0.0f );
+	simd4f_t c0 = SIMD_Mul( r0, noW );
+	simd4f_t c1 = SIMD_Mul( r1, noW );
+	simd4f_t c2 = SIMD_Mul( r2, noW );
+
+	simd4f_t c3 = SIMD_Set( 0.0f, 0.0f, 0.0f, 1.0f );
+	c3 = SIMD_Sub( c3, SIMD_Mul( c0, SIMD_SplatLane< 3 >( r0 ) ) );
+	c3 = SIMD_Sub( c3, SIMD_Mul( c1, SIMD_SplatLane< 3 >( r1 ) ) );
+	c3 = SIMD_Sub( c3, SIMD_Mul( c2, SIMD_SplatLane< 3 >( r2 ) ) );
+
+	SIMD_Transpose( c0, c1, c2, c3 );
+	return Mat4( Vec4( c0 ), Vec4( c1 ), Vec4( c2 ), Vec4( c3 ) );
 }
 
 inline Mat3 Mat4::Minor( const int i, const int j ) const {
@@ -411,8 +551,8 @@ inline Mat3 Mat4::Minor( const int i, const int j ) const {
 
 inline float Mat4::Cofactor( const int i, const int j ) const {
 	const Mat3 minor = Minor( i, j );
-	const float C = float( pow( -1, i + 1 + j + 1 ) ) * minor.Determinant();
-	return C;
+	const float sign = ( ( i + j ) & 1 ) ? -1.0f : 1.0f;
+	return sign * minor.Determinant();
 }
 
 inline void Mat4::Orient( Vec3 pos, Vec3 fwd, Vec3 up ) {
@@ -513,30 +653,38 @@ inline void Mat4::OrthoVulkan( float xmin, float xmax, float ymin, float ymax, f
 }
 
 inline Vec4 Mat4::operator * ( const Vec4 & rhs ) const {
-	Vec4 tmp;
-	tmp[ 0 ] = rows[ 0 ].Dot( rhs );
-	tmp[ 1 ] = rows[ 1 ].Dot( rhs );
-	tmp[ 2 ] = rows[ 2 ].Dot( rhs );
-	tmp[ 3 ] = rows[ 3 ].Dot( rhs );
-	return tmp;
+	// Multiply every row by the vector, then transpose the products so
+	// the four dot products finish with three vertical adds
+	const simd4f_t v = rhs.ToSIMD();
+	simd4f_t p0 = SIMD_Mul( rows[ 0 ].ToSIMD(), v );
+	simd4f_t p1 = SIMD_Mul( rows[ 1 ].ToSIMD(), v );
+	simd4f_t p2 = SIMD_Mul( rows[ 2 ].ToSIMD(), v );
+	simd4f_t p3 = SIMD_Mul( rows[ 3 ].ToSIMD(), v );
+	SIMD_Transpose( p0, p1, p2, p3 );
+	return Vec4( SIMD_Add( SIMD_Add( p0, p1 ), SIMD_Add( p2, p3 ) ) );
 }
 
 inline Mat4 Mat4::operator * ( const float rhs ) const {
-	Mat4 tmp;
-	tmp.rows[ 0 ] = rows[ 0 ] * rhs;
-	tmp.rows[ 1 ] = rows[ 1 ] * rhs;
-	tmp.rows[ 2 ] = rows[ 2 ] * rhs;
-	tmp.rows[ 3 ] = rows[ 3 ] * rhs;
+	Mat4 tmp( *this );
+	tmp *= rhs;
 	return tmp;
 }
 
 inline Mat4 Mat4::operator * ( const Mat4 & rhs ) const {
+	// Row i of the product is the rows of rhs weighted by the elements of row i
+	const simd4f_t b0 = rhs.rows[ 0 ].ToSIMD();
+	const simd4f_t b1 = rhs.rows[ 1 ].ToSIMD();
+	const simd4f_t b2 = rhs.rows[ 2 ].ToSIMD();
+	const simd4f_t b3 = rhs.rows[ 3 ].ToSIMD();
+
 	Mat4 tmp;
 	for ( int i = 0; i < 4; i++ ) {
-		tmp.rows[ i ].x = rows[ i ].x * rhs.rows[ 0 ].x + rows[ i ].y * rhs.rows[ 1 ].x + rows[ i ].z * rhs.rows[ 2 ].x + rows[ i ].w * rhs.rows[ 3 ].x;
-		tmp.rows[ i ].y = rows[ i ].x * rhs.rows[ 0 ].y + rows[ i ].y * rhs.rows[ 1 ].y + rows[ i ].z * rhs.rows[ 2 ].y + rows[ i ].w * rhs.rows[ 3 ].y;
-		tmp.rows[ i ].z = rows[ i ].x * rhs.rows[ 0 ].z + rows[ i ].y * rhs.rows[ 1 ].z + rows[ i ].z * rhs.rows[ 2 ].z + rows[ i ].w * rhs.rows[ 3 ].z;
-		tmp.rows[ i ].w = rows[ i ].x * rhs.rows[ 0 ].w + rows[ i ].y * rhs.rows[ 1 ].w + rows[ i ].z * rhs.rows[ 2 ].w + rows[ i ].w * rhs.rows[ 3 ].w;
+		const simd4f_t a = rows[ i ].ToSIMD();
+		simd4f_t r = SIMD_Mul( SIMD_SplatLane< 0 >( a ), b0 );
+		r = SIMD_MulAdd( SIMD_SplatLane< 1 >( a ), b1, r );
+		r = SIMD_MulAdd( SIMD_SplatLane< 2 >( a ), b2, r );
+		r = SIMD_MulAdd( SIMD_SplatLane< 3 >( a ), b3, r );
+		SIMD_Store( tmp.rows[ i ].ToPtr(), r );
 	}
 	return tmp;
 }
@@ -557,51 +705,132 @@ inline void Mat4::Scale(const Vec3 &s) { *this = (*this) * Mat4::Scaling(s); }
 /*
 ====================================================
 MatMN
+
+Rows are VecNs, so up to 12 x 12 the whole matrix is stored inline
+and building one never allocates.  Resize and the output parameter
+versions of the products reuse whatever storage is already there.
 ====================================================
 */
 class MatMN {
 public:
-	MatMN() : M( 0 ), N( 0 ) {}
+	static const int INLINE_ROWS = VecN::INLINE_SIZE;
+
+	MatMN() : M( 0 ), N( 0 ), rows( m_inlineRows ), m_rowCapacity( INLINE_ROWS ) {}
 	MatMN( int M, int N );
-	MatMN( const MatMN & rhs ) {
-		*this = rhs;
-	}
-	~MatMN() { delete[] rows; }
+	MatMN( const MatMN & rhs );
+	MatMN( MatMN && rhs ) noexcept;
+	~MatMN() { FreeRows(); }
 
 	const MatMN & operator = ( const MatMN & rhs );
+	const MatMN & operator = ( MatMN && rhs ) noexcept;
 	const MatMN & operator *= ( float rhs );
 	VecN operator * ( const VecN & rhs ) const;
 	MatMN operator * ( const MatMN & rhs ) const;
 	MatMN operator * ( const float rhs ) const;
 
+	void Resize( const int M, const int N );	// keeps the storage if it is large enough, contents are undefined
 	void Zero();
 	MatMN Transpose() const;
 
+	// Products with a transpose, without building the transposed copy
+	VecN TransposeMultiply( const VecN & rhs ) const;		// this^T * rhs
+	MatMN MultiplyTranspose( const MatMN & rhs ) const;	// this * rhs^T
+
+	// Evaluate into a preallocated output, out must not be one of the operands
+	void Multiply( const VecN & rhs, VecN & out ) const;
+	void Multiply( const MatMN & rhs, MatMN & out ) const;
+	void TransposeMultiply( const VecN & rhs, VecN & out ) const;
+	void MultiplyTranspose( const MatMN & rhs, MatMN & out ) const;
+
 public:
 	int		M;	// M rows
 	int		N;	// N columns
 	VecN *	rows;
+
+private:
+	void FreeRows();
+
+	VecN	m_inlineRows[ INLINE_ROWS ];
+	int		m_rowCapacity;
 };
 
-inline MatMN::MatMN( int _M, int _N ) {
-	M = _M;
-	N = _N;
-	rows = new VecN[ M ];
+inline MatMN::MatMN( int _M, int _N ) : M( 0 ), N( 0 ), rows( m_inlineRows ), m_rowCapacity( INLINE_ROWS ) {
+	Resize( _M, _N );
+}
+
+inline MatMN::MatMN( const MatMN & rhs ) : M( 0 ), N( 0 ), rows( m_inlineRows ), m_rowCapacity( INLINE_ROWS ) {
+	*this = rhs;
+}
+
+inline MatMN::MatMN( MatMN && rhs ) noexcept : M( 0 ), N( 0 ), rows( m_inlineRows ), m_rowCapacity( INLINE_ROWS ) {
+	*this = static_cast< MatMN && >( rhs );
+}
+
+inline const MatMN & MatMN::operator = ( const MatMN & rhs ) {
+	if ( this == &rhs ) {
+		return *this;
+	}
+
+	Resize( rhs.M, rhs.N );
 	for ( int m = 0; m < M; m++ ) {
-		rows[ m ] = VecN( N );
+		rows[ m ] = rhs.rows[ m ];
 	}
+	return *this;
 }
 
-inline const MatMN & MatMN::operator = ( const MatMN & rhs ) {
+inline const MatMN & MatMN::operator = ( MatMN && rhs ) noexcept {
+	if ( this == &rhs ) {
+		return *this;
+	}
+
+	if ( rhs.rows != rhs.m_inlineRows ) {
+		// Take over the heap rows
+		FreeRows();
+		M = rhs.M;
+		N = rhs.N;
+		rows = rhs.rows;
+		m_rowCapacity = rhs.m_rowCapacity;
+
+		rhs.M = 0;
+		rhs.N = 0;
+		rhs.rows = rhs.m_inlineRows;
+		rhs.m_rowCapacity = INLINE_ROWS;
+		return *this;
+	}
+
+	// Inline rows always fit, move them one by one so long rows keep their heap blocks
 	M = rhs.M;
 	N = rhs.N;
-	rows = new VecN[ M ];
 	for ( int m = 0; m < M; m++ ) {
-		rows[ m ] = rhs.rows[ m ];
+		rows[ m ] = static_cast< VecN && >( rhs.rows[ m ] );
 	}
+	rhs.M = 0;
+	rhs.N = 0;
 	return *this;
 }
 
+inline void MatMN::Resize( const int _M, const int _N ) {
+	if ( _M > m_rowCapacity ) {
+		FreeRows();
+		rows = new VecN[ _M ];
+		m_rowCapacity = _M;
+	}
+
+	M = _M;
+	N = _N;
+	for ( int m = 0; m < M; m++ ) {
+		rows[ m ].Resize( N );
+	}
+}
+
+inline void MatMN::FreeRows() {
+	if ( rows != m_inlineRows ) {
+		delete[] rows;
+		rows = m_inlineRows;
+		m_rowCapacity = INLINE_ROWS;
+	}
+}
+
 inline const MatMN & MatMN::operator *= ( float rhs ) {
 	for ( int m = 0; m < M; m++ ) {
 		rows[ m ] *= rhs;
@@ -615,37 +844,25 @@ inline VecN MatMN::operator * ( const VecN & rhs ) const {
 		return rhs;
 	}
 
-	VecN tmp( M );
-	for ( int m = 0; m < M; m++ ) {
-		tmp[ m ] = rhs.Dot( rows[ m ] );
-	}
+	VecN tmp;
+	Multiply( rhs, tmp );
 	return tmp;
 }
 
 inline MatMN MatMN::operator * ( const MatMN & rhs ) const {
 	// Check that the incoming matrix of the correct dimension
-	if ( rhs.M != N && rhs.N != M ) {
+	if ( rhs.M != N ) {
 		return rhs;
 	}
 
-	MatMN tranposedRHS = rhs.Transpose();
-
-	MatMN tmp( M, rhs.N );
-	for ( int m = 0; m < M; m++ ) {
-		for ( int n = 0; n < rhs.N; n++ ) {
-			tmp.rows[ m ][ n ] = rows[ m ].Dot( tranposedRHS.rows[ n ] );
-		}
-	}
+	MatMN tmp;
+	Multiply( rhs, tmp );
 	return tmp;
 }
 
 inline MatMN MatMN::operator * ( const float rhs ) const {
 	MatMN tmp = *this;
-	for ( int m = 0; m < M; m++ ) {
-		for ( int n = 0; n < N; n++ ) {
-			tmp.rows[ m ][ n ] *= rhs;
-		}
-	}
+	tmp *= rhs;
 	return tmp;
 }
 
@@ -665,26 +882,93 @@ inline MatMN MatMN::Transpose() const {
 	return tmp;
 }
 
+inline VecN MatMN::TransposeMultiply( const VecN & rhs ) const {
+	VecN tmp;
+	TransposeMultiply( rhs, tmp );
+	return tmp;
+}
+
+inline MatMN MatMN::MultiplyTranspose( const MatMN & rhs ) const {
+	MatMN tmp;
+	MultiplyTranspose( rhs, tmp );
+	return tmp;
+}
+
+inline void MatMN::Multiply( const VecN & rhs, VecN & out ) const {
+	assert( rhs.N == N && &out != &rhs );
+
+	out.Resize( M );
+	for ( int m = 0; m < M; m++ ) {
+		out[ m ] = rhs.Dot( rows[ m ] );
+	}
+}
+
+inline void MatMN::Multiply( const MatMN & rhs, MatMN & out ) const {
+	assert( rhs.M == N && &out != this && &out != &rhs );
+
+	// Walk rhs row by row instead of down its columns
+	out.Resize( M, rhs.N );
+	out.Zero();
+	for ( int m = 0; m < M; m++ ) {
+		VecN & row = out.rows[ m ];
+		for ( int k = 0; k < N; k++ ) {
+			const float a = rows[ m ][ k ];
+			const VecN & rhsRow = rhs.rows[ k ];
+			for ( int n = 0; n < rhs.N; n++ ) {
+				row[ n ] += a * rhsRow[ n ];
+			}
+		}
+	}
+}
+
+inline void MatMN::TransposeMultiply( const VecN & rhs, VecN & out ) const {
+	assert( rhs.N == M && &out != &rhs );
+
+	out.Resize( N );
+	out.Zero();
+	for ( int m = 0; m < M; m++ ) {
+		const float s = rhs[ m ];
+		for ( int n = 0; n < N; n++ ) {
+			out[ n ] += rows[ m ][ n ] * s;
+		}
+	}
+}
+
+inline void MatMN::MultiplyTranspose( const MatMN & rhs, MatMN & out ) const {
+	assert( rhs.N == N && &out != this && &out != &rhs );
+
+	// Row by row dot products, the rows of rhs are the columns of its transpose
+	out.Resize( M, rhs.M );
+	for ( int m = 0; m < M; m++ ) {
+		for ( int k = 0; k < rhs.M; k++ ) {
+			out.rows[ m ][ k ] = rows[ m ].Dot( rhs.rows[ k ] );
+		}
+	}
+}
+
 /*
 ====================================================
 MatN
+
+Square matrix for the LCP solver, stored the same way as MatMN.
 ====================================================
 */
 class MatN {
 public:
-	MatN() : numDimensions( 0 ) {}
+	static const int INLINE_ROWS = VecN::INLINE_SIZE;
+
+	MatN() : numDimensions( 0 ), rows( m_inlineRows ), m_rowCapacity( INLINE_ROWS ) {}
 	MatN( int N );
-	MatN( const MatN & rhs ) {
-		*this = rhs;
-	}
-	MatN( const MatMN & rhs ) {
-		*this = rhs;
-	}
-	~MatN() { delete[] rows; }
+	MatN( const MatN & rhs );
+	MatN( const MatMN & rhs );
+	MatN( MatN && rhs ) noexcept;
+	~MatN() { FreeRows(); }
 
 	const MatN & operator = ( const MatN & rhs );
 	const MatN & operator = ( const MatMN & rhs );
+	const MatN & operator = ( MatN && rhs ) noexcept;
 
+	void Resize( const int N );	// keeps the storage if it is large enough, contents are undefined
 	void Identity();
 	void Zero();
 	void Transpose();
@@ -696,19 +980,36 @@ public:
 public:
 	int		numDimensions;
 	VecN *	rows;
+
+private:
+	void FreeRows();
+
+	VecN	m_inlineRows[ INLINE_ROWS ];
+	int		m_rowCapacity;
 };
 
-inline MatN::MatN( int N ) {
-	numDimensions = N;
-	rows = new VecN[ N ];
-	for ( int i = 0; i < N; i++ ) {
-		rows[ i ] = VecN( N );
-	}
+inline MatN::MatN( int N ) : numDimensions( 0 ), rows( m_inlineRows ), m_rowCapacity( INLINE_ROWS ) {
+	Resize( N );
+}
+
+inline MatN::MatN( const MatN & rhs ) : numDimensions( 0 ), rows( m_inlineRows ), m_rowCapacity( INLINE_ROWS ) {
+	*this = rhs;
+}
+
+inline MatN::MatN( const MatMN & rhs ) : numDimensions( 0 ), rows( m_inlineRows ), m_rowCapacity( INLINE_ROWS ) {
+	*this = rhs;
+}
+
+inline MatN::MatN( MatN && rhs ) noexcept : numDimensions( 0 ), rows( m_inlineRows ), m_rowCapacity( INLINE_ROWS ) {
+	*this = static_cast< MatN && >( rhs );
 }
 
 inline const MatN & MatN::operator = ( const MatN & rhs ) {
-	numDimensions = rhs.numDimensions;
-	rows = new VecN[ numDimensions ];
+	if ( this == &rhs ) {
+		return *this;
+	}
+
+	Resize( rhs.numDimensions );
 	for ( int i = 0; i < numDimensions; i++ ) {
 		rows[ i ] = rhs.rows[ i ];
 	}
@@ -720,14 +1021,59 @@ inline const MatN & MatN::operator = ( const MatMN & rhs ) {
 		return *this;
 	}
 
-	numDimensions = rhs.N;
-	rows = new VecN[ numDimensions ];
+	Resize( rhs.N );
 	for ( int i = 0; i < numDimensions; i++ ) {
 		rows[ i ] = rhs.rows[ i ];
 	}
 	return *this;
 }
 
+inline const MatN & MatN::operator = ( MatN && rhs ) noexcept {
+	if ( this == &rhs ) {
+		return *this;
+	}
+
+	if ( rhs.rows != rhs.m_inlineRows ) {
+		FreeRows();
+		numDimensions = rhs.numDimensions;
+		rows = rhs.rows;
+		m_rowCapacity = rhs.m_rowCapacity;
+
+		rhs.numDimensions = 0;
+		rhs.rows = rhs.m_inlineRows;
+		rhs.m_rowCapacity = INLINE_ROWS;
+		return *this;
+	}
+
+	numDimensions = rhs.numDimensions;
+	for ( int i = 0; i < numDimensions; i++ ) {
+		rows[ i ] = static_cast< VecN && >( rhs.rows[ i ] );
+	}
+	rhs.numDimensions = 0;
+	return *this;
+}
+
+inline void MatN::Resize( const int N ) {
+	if ( N > m_rowCapacity ) {
+		FreeRows();
+		rows = new VecN[ N ];
+		m_rowCapacity = N;
+	}
+
+	numDimensions = N;
+	for ( int i = 0; i < N; i++ ) {
+		rows[ i ].Resize( N );
+	}
+}
+
+inline void MatN::FreeRows() {
+	if ( rows != m_inlineRows ) {
+		delete[] rows;
+		rows = m_inlineRows;
+		m_rowCapacity = INLINE_ROWS;
+	}
+}
+
 inline void MatN::Zero() {
 	for ( int i = 0; i < numDimensions; i++ ) {
 		rows[ i ].Zero();
@@ -742,15 +1088,14 @@ inline void MatN::Identity() {
 }
 
 inline void MatN::Transpose() {
-	MatN tmp( numDimensions );
-
+	// Swap across the diagonal in place
 	for ( int i = 0; i < numDimensions; i++ ) {
-		for ( int j = 0; j < numDimensions; j++ ) {
-			tmp.rows[ i ][ j ] = rows[ j ][ i ];
+		for ( int j = i + 1; j < numDimensions; j++ ) {
+			const float tmp = rows[ i ][ j ];
+			rows[ i ][ j ] = rows[ j ][ i ];
+			rows[ j ][ i ] = tmp;
 		}
 	}
-
-	*this = tmp;
 }
 
 inline void MatN::operator *= ( float rhs ) {
@@ -774,10 +1119,13 @@ inline MatN MatN::operator * ( const MatN & rhs ) {
 	tmp.Zero();
 
 	for ( int i = 0; i < numDimensions; i++ ) {
-		for ( int j = 0; j < numDimensions; j++ ) {
-			tmp.rows[ i ][ j ] += rows[ i ][ j ] * rhs.rows[ j ][ i ];
+		for ( int k = 0; k < numDimensions; k++ ) {
+			const float a = rows[ i ][ k ];
+			for ( int j = 0; j < numDimensions; j++ ) {
+				tmp.rows[ i ][ j ] += a * rhs.rows[ k ][ j ];
+			}
 		}
 	}
 
 	return tmp;
-}
\ No newline at end of file
+}
@@ -8,15 +8,19 @@
 /*
  ================================
  Quat
+
+ Stored w first and 16 byte aligned, the products below work on the
+ four components as one SIMD register in ( w, x, y, z ) order.
  ================================
  */
-class Quat
+class alignas(16) Quat
 {
 public:
     Quat();
     Quat(const Quat &rhs);
     Quat(float X, float Y, float Z, float W);
     Quat(Vec3 n, const float angleRadians);
+    explicit Quat(const simd4f_t &rhs) { SIMD_Store(&w, rhs); }
     const Quat &operator=(const Quat &rhs);
 
     Quat &operator*=(const float &rhs);
@@ -24,6 +28,8 @@ public:
     Quat operator*(const Quat &rhs) const;
 
     void Normalize();
+    template <mathAccuracy_t accuracy>
+    void Normalize(); // Normalize<MATH_ACCURACY_...>(), see FastMath.h
     void Invert();
     Quat Inverse() const;
     float MagnitudeSquared() const;
@@ -36,6 +42,7 @@ public:
     Mat3 ToMat3() const;
     Mat4 ToMat4() const;
     Vec4 ToVec4() const { return Vec4(w, x, y, z); }
+    simd4f_t ToSIMD() const { return SIMD_Load(&w); }
 
 public:
     float w;
@@ -74,10 +81,7 @@ inline const Quat &Quat::operator=(const Quat &rhs)
 
 inline Quat &Quat::operator*=(const float &rhs)
 {
-    x *= rhs;
-    y *= rhs;
-    z *= rhs;
-    w *= rhs;
+    SIMD_Store(&w, SIMD_Mul(ToSIMD(), SIMD_Splat(rhs)));
     return *this;
 }
 
@@ -93,12 +97,21 @@ inline Quat &Quat::operator*=(const Quat &rhs)
 
 inline Quat Quat::operator*(const Quat &rhs) const
 {
-    Quat temp;
-    temp.w = (w * rhs.w) - (x * rhs.x) - (y * rhs.y) - (z * rhs.z);
-    temp.x = (x * rhs.w) + (w * rhs.x) + (y * rhs.z) - (z * rhs.y);
-    temp.y = (y * rhs.w) + (w * rhs.y) + (z * rhs.x) - (x * rhs.z);
-    temp.z = (z * rhs.w) + (w * rhs.z) + (x * rhs.y) - (y * rhs.x);
-    return temp;
+    // Same products as
+    //  w = (w * rhs.w) - (x * rhs.x) - (y * rhs.y) - (z * rhs.z)
+    //  x = (x * rhs.w) + (w * rhs.x) + (y * rhs.z) - (z * rhs.y)
+    //  y = (y * rhs.w) + (w * rhs.y) + (z * rhs.x) - (x * rhs.z)
+    //  z = (z * rhs.w) + (w * rhs.z) + (x * rhs.y) - (y * rhs.x)
+    // grouped by the component of this quaternion, rhs is swizzled and
+    // sign flipped to line up with it
+    const simd4f_t a = ToSIMD();
+    const simd4f_t b = rhs.ToSIMD();
+
+    simd4f_t r = SIMD_Mul(SIMD_SplatLane<0>(a), b);
+    r = SIMD_MulAdd(SIMD_SplatLane<1>(a), SIMD_Negate(SIMD_Swizzle1032(b), true, false, true, false), r);
+    r = SIMD_MulAdd(SIMD_SplatLane<2>(a), SIMD_Negate(SIMD_Swizzle2301(b), true, false, false, true), r);
+    r = SIMD_MulAdd(SIMD_SplatLane<3>(a), SIMD_Negate(SIMD_Swizzle3210(b), true, true, false, false), r);
+    return Quat(r);
 }
 
 inline void Quat::Normalize()
@@ -114,12 +127,24 @@ inline void Quat::Normalize()
     }
 }
 
+template <mathAccuracy_t accuracy>
+inline void Quat::Normalize()
+{
+    float invMag = MathFunctions<accuracy>::RSqrt(MagnitudeSquared());
+
+    if (0.0f * invMag == 0.0f * invMag)
+    {
+        x = x * invMag;
+        y = y * invMag;
+        z = z * invMag;
+        w = w * invMag;
+    }
+}
+
 inline void Quat::Invert()
 {
-    *this *= 1.0f / MagnitudeSquared();
-    x = -x;
-    y = -y;
-    z = -z;
+    const simd4f_t scaled = SIMD_Mul(ToSIMD(), SIMD_Splat(1.0f / MagnitudeSquared()));
+    SIMD_Store(&w, SIMD_Negate(scaled, false, true, true, true));
 }
 
 inline Quat Quat::Inverse() const
@@ -129,15 +154,33 @@ inline Quat Quat::Inverse() const
     return val;
 }
 
-inline float Quat::MagnitudeSquared() const { return ((x * x) + (y * y) + (z * z) + (w * w)); }
+inline float Quat::MagnitudeSquared() const
+{
+    const simd4f_t q = ToSIMD();
+    return SIMD_HorizontalAdd(SIMD_Mul(q, q));
+}
 
 inline float Quat::GetMagnitude() const { return sqrtf(MagnitudeSquared()); }
 
+/*
+ ================================
+ Quat::RotatePoint
+
+ q * v * q^-1 expanded with t = 2 * ( q.xyz x v ), which leaves
+ v + w * t + q.xyz x t.  Plain scalar math, the two quaternion products
+ spend more time shuffling lanes than multiplying.  t is divided by the
+ squared length so the result matches q * v * q^-1 for any length of q.
+ ================================
+ */
 inline Vec3 Quat::RotatePoint(const Vec3 &rhs) const
 {
-    Quat vector(rhs.x, rhs.y, rhs.z, 0.0f);
-    Quat final = *this * vector * Inverse();
-    return Vec3(final.x, final.y, final.z);
+    const float scale = 2.0f / (w * w + x * x + y * y + z * z);
+    const float tx = scale * (y * rhs.z - z * rhs.y);
+    const float ty = scale * (z * rhs.x - x * rhs.z);
+    const float tz = scale * (x * rhs.y - y * rhs.x);
+    return Vec3(rhs.x + w * tx + (y * tz - z * ty),
+                rhs.y + w * ty + (z * tx - x * tz),
+                rhs.z + w * tz + (x * ty - y * tx));
 }
 
 inline bool Quat::IsValid() const
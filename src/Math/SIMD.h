@@ -0,0 +1,341 @@
+//
+//	SIMD.h
+//
+#pragma once
+
+/*
+====================================================
+SIMD backend
+
+Four wide float operations used by Vec4, Quat and Mat4.  The backend
+is picked at compile time from the target:
+
+	MATH_SIMD_SSE		x86 / x64, SSE2 is part of the x64 baseline
+	MATH_SIMD_NEON		arm with neon
+	MATH_SIMD_SCALAR	everything else
+
+Defining MATH_FORCE_SCALAR selects the scalar backend on any target.
+It is the reference the vector backends are checked against, every
+operation does the same math one lane at a time.
+
+SIMD_Load and SIMD_Store are aligned, only pass pointers to 16 byte
+aligned memory (Vec4, Quat and Mat4 rows are declared alignas( 16 )).
+The Unaligned versions take any float pointer.
+====================================================
+*/
+#if !defined( MATH_FORCE_SCALAR ) && ( defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 ) )
+	#define MATH_SIMD_SSE
+	#include <xmmintrin.h>
+	#include <emmintrin.h>
+#elif !defined( MATH_FORCE_SCALAR ) && ( defined( __ARM_NEON ) || defined( __ARM_NEON__ ) || defined( _M_ARM64 ) )
+	#define MATH_SIMD_NEON
+	#include <arm_neon.h>
+#else
+	#define MATH_SIMD_SCALAR
+	#include <math.h>
+#endif
+
+#if defined( MATH_SIMD_SSE )
+typedef __m128 simd4f_t;
+#elif defined( MATH_SIMD_NEON )
+typedef float32x4_t simd4f_t;
+#else
+struct simd4f_t {
+	float v[ 4 ];
+};
+#endif
+
+#if defined( MATH_SIMD_SSE )
+
+inline simd4f_t SIMD_Load( const float * ptr ) { return _mm_load_ps( ptr ); }
+inline void SIMD_Store( float * ptr, const simd4f_t a ) { _mm_store_ps( ptr, a ); }
+inline simd4f_t SIMD_LoadUnaligned( const float * ptr ) { return _mm_loadu_ps( ptr ); }
+inline void SIMD_StoreUnaligned( float * ptr, const simd4f_t a ) { _mm_storeu_ps( ptr, a ); }
+inline simd4f_t SIMD_Set( const float x, const float y, const float z, const float w ) { return _mm_setr_ps( x, y, z, w ); }
+inline simd4f_t SIMD_Splat( const float s ) { return _mm_set1_ps( s ); }
+inline simd4f_t SIMD_Zero() { return _mm_setzero_ps(); }
+
+inline simd4f_t SIMD_Add( const simd4f_t a, const simd4f_t b ) { return _mm_add_ps( a, b ); }
+inline simd4f_t SIMD_Sub( const simd4f_t a, const simd4f_t b ) { return _mm_sub_ps( a, b ); }
+inline simd4f_t SIMD_Mul( const simd4f_t a, const simd4f_t b ) { return _mm_mul_ps( a, b ); }
+inline simd4f_t SIMD_Div( const simd4f_t a, const simd4f_t b ) { return _mm_div_ps( a, b ); }
+
+// a * b + c, kept as a separate multiply and add so every backend rounds the same way
+inline simd4f_t SIMD_MulAdd( const simd4f_t a, const simd4f_t b, const simd4f_t c ) { return _mm_add_ps( _mm_mul_ps( a, b ), c ); }
+
+// Broadcast one lane to all four
+template< int lane >
+inline simd4f_t SIMD_SplatLane( const simd4f_t a ) { return _mm_shuffle_ps( a, a, _MM_SHUFFLE( lane, lane, lane, lane ) ); }
+
+// ( a[ i0 ], a[ i1 ], b[ i2 ], b[ i3 ] )
+template< int i0, int i1, int i2, int i3 >
+inline simd4f_t SIMD_Shuffle( const simd4f_t a, const simd4f_t b ) { return _mm_shuffle_ps( a, b, _MM_SHUFFLE( i3, i2, i1, i0 ) ); }
+
+// Lane swaps used by the quaternion product, named by the source lane of each result lane
+inline simd4f_t SIMD_Swizzle1032( const simd4f_t a ) { return _mm_shuffle_ps( a, a, _MM_SHUFFLE( 2, 3, 0, 1 ) ); }
+inline simd4f_t SIMD_Swizzle2301( const simd4f_t a ) { return _mm_shuffle_ps( a, a, _MM_SHUFFLE( 1, 0, 3, 2 ) ); }
+inline simd4f_t SIMD_Swizzle3210( const simd4f_t a ) { return _mm_shuffle_ps( a, a, _MM_SHUFFLE( 0, 1, 2, 3 ) ); }
+
+// Flips the sign of the lanes whose flag is set
+inline simd4f_t SIMD_Negate( const simd4f_t a, const bool x, const bool y, const bool z, const bool w ) {
+	const simd4f_t mask = _mm_setr_ps( x ? -0.0f : 0.0f, y ? -0.0f : 0.0f, z ? -0.0f : 0.0f, w ? -0.0f : 0.0f );
+	return _mm_xor_ps( a, mask );
+}
+
+// Sum of all four lanes, added as ( x + y ) + ( z + w )
+inline float SIMD_HorizontalAdd( const simd4f_t a ) {
+	const simd4f_t pairs = _mm_add_ps( a, _mm_shuffle_ps( a, a, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+	const simd4f_t sum = _mm_add_ss( pairs, _mm_movehl_ps( pairs, pairs ) );
+	return _mm_cvtss_f32( sum );
+}
+
+inline void SIMD_Transpose( simd4f_t & r0, simd4f_t & r1, simd4f_t & r2, simd4f_t & r3 ) {
+	_MM_TRANSPOSE4_PS( r0, r1, r2, r3 );
+}
+
+inline simd4f_t SIMD_Min( const simd4f_t a, const simd4f_t b ) { return _mm_min_ps( a, b ); }
+inline simd4f_t SIMD_Max( const simd4f_t a, const simd4f_t b ) { return _mm_max_ps( a, b ); }
+inline simd4f_t SIMD_Abs( const simd4f_t a ) { return _mm_andnot_ps( _mm_set1_ps( -0.0f ), a ); }
+
+// Comparisons give a lane mask, all bits set where the test passes
+inline simd4f_t SIMD_CmpLE( const simd4f_t a, const simd4f_t b ) { return _mm_cmple_ps( a, b ); }
+inline simd4f_t SIMD_And( const simd4f_t a, const simd4f_t b ) { return _mm_and_ps( a, b ); }
+
+// One bit per lane of a mask, lane 0 in bit 0
+inline int SIMD_MoveMask( const simd4f_t a ) { return _mm_movemask_ps( a ); }
+
+inline float SIMD_GetX( const simd4f_t a ) { return _mm_cvtss_f32( a ); }
+
+// Round to nearest even, for values that fit an int
+inline simd4f_t SIMD_Round( const simd4f_t a ) { return _mm_cvtepi32_ps( _mm_cvtps_epi32( a ) ); }
+
+// 1 / sqrt( a ) to about 12 bits, refine with a Newton step
+inline simd4f_t SIMD_RSqrtEstimate( const simd4f_t a ) { return _mm_rsqrt_ps( a ); }
+
+#elif defined( MATH_SIMD_NEON )
+
+inline simd4f_t SIMD_Load( const float * ptr ) { return vld1q_f32( ptr ); }
+inline void SIMD_Store( float * ptr, const simd4f_t a ) { vst1q_f32( ptr, a ); }
+inline simd4f_t SIMD_LoadUnaligned( const float * ptr ) { return vld1q_f32( ptr ); }
+inline void SIMD_StoreUnaligned( float * ptr, const simd4f_t a ) { vst1q_f32( ptr, a ); }
+inline simd4f_t SIMD_Set( const float x, const float y, const float z, const float w ) {
+	const float tmp[ 4 ] = { x, y, z, w };
+	return vld1q_f32( tmp );
+}
+inline simd4f_t SIMD_Splat( const float s ) { return vdupq_n_f32( s ); }
+inline simd4f_t SIMD_Zero() { return vdupq_n_f32( 0.0f ); }
+
+inline simd4f_t SIMD_Add( const simd4f_t a, const simd4f_t b ) { return vaddq_f32( a, b ); }
+inline simd4f_t SIMD_Sub( const simd4f_t a, const simd4f_t b ) { return vsubq_f32( a, b ); }
+inline simd4f_t SIMD_Mul( const simd4f_t a, const simd4f_t b ) { return vmulq_f32( a, b ); }
+#if defined( __aarch64__ ) || defined( _M_ARM64 )
+inline simd4f_t SIMD_Div( const simd4f_t a, const simd4f_t b ) { return vdivq_f32( a, b ); }
+#else
+inline simd4f_t SIMD_Div( const simd4f_t a, const simd4f_t b ) {
+	float fa[ 4 ];
+	float fb[ 4 ];
+	vst1q_f32( fa, a );
+	vst1q_f32( fb, b );
+	return SIMD_Set( fa[ 0 ] / fb[ 0 ], fa[ 1 ] / fb[ 1 ], fa[ 2 ] / fb[ 2 ], fa[ 3 ] / fb[ 3 ] );
+}
+#endif
+
+// vmlaq may fuse, keep the multiply and add apart so every backend rounds the same way
+inline simd4f_t SIMD_MulAdd( const simd4f_t a, const simd4f_t b, const simd4f_t c ) { return vaddq_f32( vmulq_f32( a, b ), c ); }
+
+template< int lane >
+inline simd4f_t SIMD_SplatLane( const simd4f_t a ) { return vdupq_n_f32( vgetq_lane_f32( a, lane ) ); }
+
+template< int i0, int i1, int i2, int i3 >
+inline simd4f_t SIMD_Shuffle( const simd4f_t a, const simd4f_t b ) {
+	simd4f_t r = vdupq_n_f32( vgetq_lane_f32( a, i0 ) );
+	r = vsetq_lane_f32( vgetq_lane_f32( a, i1 ), r, 1 );
+	r = vsetq_lane_f32( vgetq_lane_f32( b, i2 ), r, 2 );
+	r = vsetq_lane_f32( vgetq_lane_f32( b, i3 ), r, 3 );
+	return r;
+}
+
+inline simd4f_t SIMD_Swizzle1032( const simd4f_t a ) { return vrev64q_f32( a ); }
+inline simd4f_t SIMD_Swizzle2301( const simd4f_t a ) { return vextq_f32( a, a, 2 ); }
+inline simd4f_t SIMD_Swizzle3210( const simd4f_t a ) { return vrev64q_f32( vextq_f32( a, a, 2 ) ); }
+
+inline simd4f_t SIMD_Negate( const simd4f_t a, const bool x, const bool y, const bool z, const bool w ) {
+	const uint32_t s = 0x80000000u;
+	const uint32_t bits[ 4 ] = { x ? s : 0u, y ? s : 0u, z ? s : 0u, w ? s : 0u };
+	return vreinterpretq_f32_u32( veorq_u32( vreinterpretq_u32_f32( a ), vld1q_u32( bits ) ) );
+}
+
+inline float SIMD_HorizontalAdd( const simd4f_t a ) {
+	const float32x2_t pairs = vpadd_f32( vget_low_f32( a ), vget_high_f32( a ) );	// ( x + y, z + w )
+	return vget_lane_f32( pairs, 0 ) + vget_lane_f32( pairs, 1 );
+}
+
+inline void SIMD_Transpose( simd4f_t & r0, simd4f_t & r1, simd4f_t & r2, simd4f_t & r3 ) {
+	const float32x4x2_t t01 = vtrnq_f32( r0, r1 );
+	const float32x4x2_t t23 = vtrnq_f32( r2, r3 );
+	r0 = vcombine_f32( vget_low_f32( t01.val[ 0 ] ), vget_low_f32( t23.val[ 0 ] ) );
+	r1 = vcombine_f32( vget_low_f32( t01.val[ 1 ] ), vget_low_f32( t23.val[ 1 ] ) );
+	r2 = vcombine_f32( vget_high_f32( t01.val[ 0 ] ), vget_high_f32( t23.val[ 0 ] ) );
+	r3 = vcombine_f32( vget_high_f32( t01.val[ 1 ] ), vget_high_f32( t23.val[ 1 ] ) );
+}
+
+inline simd4f_t SIMD_Min( const simd4f_t a, const simd4f_t b ) { return vminq_f32( a, b ); }
+inline simd4f_t SIMD_Max( const simd4f_t a, const simd4f_t b ) { return vmaxq_f32( a, b ); }
+inline simd4f_t SIMD_Abs( const simd4f_t a ) { return vabsq_f32( a ); }
+
+inline simd4f_t SIMD_CmpLE( const simd4f_t a, const simd4f_t b ) { return vreinterpretq_f32_u32( vcleq_f32( a, b ) ); }
+inline simd4f_t SIMD_And( const simd4f_t a, const simd4f_t b ) {
+	return vreinterpretq_f32_u32( vandq_u32( vreinterpretq_u32_f32( a ), vreinterpretq_u32_f32( b ) ) );
+}
+
+inline int SIMD_MoveMask( const simd4f_t a ) {
+	const uint32x4_t bits = vshrq_n_u32( vreinterpretq_u32_f32( a ), 31 );
+	return (int)( vgetq_lane_u32( bits, 0 ) | ( vgetq_lane_u32( bits, 1 ) << 1 ) | ( vgetq_lane_u32( bits, 2 ) << 2 ) | ( vgetq_lane_u32( bits, 3 ) << 3 ) );
+}
+
+inline float SIMD_GetX( const simd4f_t a ) { return vgetq_lane_f32( a, 0 ); }
+
+#if defined( __aarch64__ ) || defined( _M_ARM64 )
+inline simd4f_t SIMD_Round( const simd4f_t a ) { return vrndnq_f32( a ); }
+#else
+// No round to nearest on 32 bit arm, halves round away from zero here
+inline simd4f_t SIMD_Round( const simd4f_t a ) {
+	const uint32x4_t sign = vandq_u32( vreinterpretq_u32_f32( a ), vdupq_n_u32( 0x80000000u ) );
+	const float32x4_t half = vreinterpretq_f32_u32( vorrq_u32( vreinterpretq_u32_f32( vdupq_n_f32( 0.5f ) ), sign ) );
+	return vcvtq_f32_s32( vcvtq_s32_f32( vaddq_f32( a, half ) ) );
+}
+#endif
+
+// The neon estimate is only 8 bits, one step brings it close to the sse one
+inline simd4f_t SIMD_RSqrtEstimate( const simd4f_t a ) {
+	const float32x4_t y = vrsqrteq_f32( a );
+	return vmulq_f32( y, vrsqrtsq_f32( vmulq_f32( a, y ), y ) );
+}
+
+#else
+
+inline simd4f_t SIMD_Load( const float * ptr ) {
+	simd4f_t r;
+	r.v[ 0 ] = ptr[ 0 ];
+	r.v[ 1 ] = ptr[ 1 ];
+	r.v[ 2 ] = ptr[ 2 ];
+	r.v[ 3 ] = ptr[ 3 ];
+	return r;
+}
+inline void SIMD_Store( float * ptr, const simd4f_t a ) {
+	ptr[ 0 ] = a.v[ 0 ];
+	ptr[ 1 ] = a.v[ 1 ];
+	ptr[ 2 ] = a.v[ 2 ];
+	ptr[ 3 ] = a.v[ 3 ];
+}
+inline simd4f_t SIMD_LoadUnaligned( const float * ptr ) { return SIMD_Load( ptr ); }
+inline void SIMD_StoreUnaligned( float * ptr, const simd4f_t a ) { SIMD_Store( ptr, a ); }
+inline simd4f_t SIMD_Set( const float x, const float y, const float z, const float w ) {
+	simd4f_t r;
+	r.v[ 0 ] = x;
+	r.v[ 1 ] = y;
+	r.v[ 2 ] = z;
+	r.v[ 3 ] = w;
+	return r;
+}
+inline simd4f_t SIMD_Splat( const float s ) { return SIMD_Set( s, s, s, s ); }
+inline simd4f_t SIMD_Zero() { return SIMD_Set( 0.0f, 0.0f, 0.0f, 0.0f ); }
+
+inline simd4f_t SIMD_Add( const simd4f_t a, const simd4f_t b ) { return SIMD_Set( a.v[ 0 ] + b.v[ 0 ], a.v[ 1 ] + b.v[ 1 ], a.v[ 2 ] + b.v[ 2 ], a.v[ 3 ] + b.v[ 3 ] ); }
+inline simd4f_t SIMD_Sub( const simd4f_t a, const simd4f_t b ) { return SIMD_Set( a.v[ 0 ] - b.v[ 0 ], a.v[ 1 ] - b.v[ 1 ], a.v[ 2 ] - b.v[ 2 ], a.v[ 3 ] - b.v[ 3 ] ); }
+inline simd4f_t SIMD_Mul( const simd4f_t a, const simd4f_t b ) { return SIMD_Set( a.v[ 0 ] * b.v[ 0 ], a.v[ 1 ] * b.v[ 1 ], a.v[ 2 ] * b.v[ 2 ], a.v[ 3 ] * b.v[ 3 ] ); }
+inline simd4f_t SIMD_Div( const simd4f_t a, const simd4f_t b ) { return SIMD_Set( a.v[ 0 ] / b.v[ 0 ], a.v[ 1 ] / b.v[ 1 ], a.v[ 2 ] / b.v[ 2 ], a.v[ 3 ] / b.v[ 3 ] ); }
+inline simd4f_t SIMD_MulAdd( const simd4f_t a, const simd4f_t b, const simd4f_t c ) { return SIMD_Add( SIMD_Mul( a, b ), c ); }
+
+template< int lane >
+inline simd4f_t SIMD_SplatLane( const simd4f_t a ) { return SIMD_Splat( a.v[ lane ] ); }
+
+template< int i0, int i1, int i2, int i3 >
+inline simd4f_t SIMD_Shuffle( const simd4f_t a, const simd4f_t b ) { return SIMD_Set( a.v[ i0 ], a.v[ i1 ], b.v[ i2 ], b.v[ i3 ] ); }
+
+inline simd4f_t SIMD_Swizzle1032( const simd4f_t a ) { return SIMD_Set( a.v[ 1 ], a.v[ 0 ], a.v[ 3 ], a.v[ 2 ] ); }
+inline simd4f_t SIMD_Swizzle2301( const simd4f_t a ) { return SIMD_Set( a.v[ 2 ], a.v[ 3 ], a.v[ 0 ], a.v[ 1 ] ); }
+inline simd4f_t SIMD_Swizzle3210( const simd4f_t a ) { return SIMD_Set( a.v[ 3 ], a.v[ 2 ], a.v[ 1 ], a.v[ 0 ] ); }
+
+inline simd4f_t SIMD_Negate( const simd4f_t a, const bool x, const bool y, const bool z, const bool w ) {
+	return SIMD_Set( x ? -a.v[ 0 ] : a.v[ 0 ], y ? -a.v[ 1 ] : a.v[ 1 ], z ? -a.v[ 2 ] : a.v[ 2 ], w ? -a.v[ 3 ] : a.v[ 3 ] );
+}
+
+inline float SIMD_HorizontalAdd( const simd4f_t a ) { return ( a.v[ 0 ] + a.v[ 1 ] ) + ( a.v[ 2 ] + a.v[ 3 ] ); }
+
+inline void SIMD_Transpose( simd4f_t & r0, simd4f_t & r1, simd4f_t & r2, simd4f_t & r3 ) {
+	const simd4f_t c0 = SIMD_Set( r0.v[ 0 ], r1.v[ 0 ], r2.v[ 0 ], r3.v[ 0 ] );
+	const simd4f_t c1 = SIMD_Set( r0.v[ 1 ], r1.v[ 1 ], r2.v[ 1 ], r3.v[ 1 ] );
+	const simd4f_t c2 = SIMD_Set( r0.v[ 2 ], r1.v[ 2 ], r2.v[ 2 ], r3.v[ 2 ] );
+	const simd4f_t c3 = SIMD_Set( r0.v[ 3 ], r1.v[ 3 ], r2.v[ 3 ], r3.v[ 3 ] );
+	r0 = c0;
+	r1 = c1;
+	r2 = c2;
+	r3 = c3;
+}
+
+// Lanes of a comparison mask hold the bit pattern of an all ones integer
+union simdLane_t {
+	float f;
+	unsigned int u;
+};
+
+inline float SIMD_MaskLane( const bool pass ) {
+	simdLane_t lane;
+	lane.u = pass ? 0xffffffffu : 0u;
+	return lane.f;
+}
+
+inline simd4f_t SIMD_Min( const simd4f_t a, const simd4f_t b ) {
+	return SIMD_Set( a.v[ 0 ] < b.v[ 0 ] ? a.v[ 0 ] : b.v[ 0 ], a.v[ 1 ] < b.v[ 1 ] ? a.v[ 1 ] : b.v[ 1 ], a.v[ 2 ] < b.v[ 2 ] ? a.v[ 2 ] : b.v[ 2 ], a.v[ 3 ] < b.v[ 3 ] ? a.v[ 3 ] : b.v[ 3 ] );
+}
+inline simd4f_t SIMD_Max( const simd4f_t a, const simd4f_t b ) {
+	return SIMD_Set( a.v[ 0 ] > b.v[ 0 ] ? a.v[ 0 ] : b.v[ 0 ], a.v[ 1 ] > b.v[ 1 ] ? a.v[ 1 ] : b.v[ 1 ], a.v[ 2 ] > b.v[ 2 ] ? a.v[ 2 ] : b.v[ 2 ], a.v[ 3 ] > b.v[ 3 ] ? a.v[ 3 ] : b.v[ 3 ] );
+}
+inline simd4f_t SIMD_Abs( const simd4f_t a ) { return SIMD_Set( fabsf( a.v[ 0 ] ), fabsf( a.v[ 1 ] ), fabsf( a.v[ 2 ] ), fabsf( a.v[ 3 ] ) ); }
+
+inline simd4f_t SIMD_CmpLE( const simd4f_t a, const simd4f_t b ) {
+	return SIMD_Set( SIMD_MaskLane( a.v[ 0 ] <= b.v[ 0 ] ), SIMD_MaskLane( a.v[ 1 ] <= b.v[ 1 ] ), SIMD_MaskLane( a.v[ 2 ] <= b.v[ 2 ] ), SIMD_MaskLane( a.v[ 3 ] <= b.v[ 3 ] ) );
+}
+inline simd4f_t SIMD_And( const simd4f_t a, const simd4f_t b ) {
+	simd4f_t r;
+	for ( int i = 0; i < 4; i++ ) {
+		simdLane_t la, lb;
+		la.f = a.v[ i ];
+		lb.f = b.v[ i ];
+		la.u &= lb.u;
+		r.v[ i ] = la.f;
+	}
+	return r;
+}
+
+inline int SIMD_MoveMask( const simd4f_t a ) {
+	int mask = 0;
+	for ( int i = 0; i < 4; i++ ) {
+		simdLane_t lane;
+		lane.f = a.v[ i ];
+		mask |= (int)( lane.u >> 31 ) << i;
+	}
+	return mask;
+}
+
+inline float SIMD_GetX( const simd4f_t a ) { return a.v[ 0 ]; }
+
+inline simd4f_t SIMD_Round( const simd4f_t a ) { return SIMD_Set( rintf( a.v[ 0 ] ), rintf( a.v[ 1 ] ), rintf( a.v[ 2 ] ), rintf( a.v[ 3 ] ) ); }
+
+// Integer trick plus two Newton steps, about as close as the sse estimate
+inline simd4f_t SIMD_RSqrtEstimate( const simd4f_t a ) {
+	simd4f_t r;
+	for ( int i = 0; i < 4; i++ ) {
+		simdLane_t lane;
+		lane.f = a.v[ i ];
+		lane.u = 0x5f375a86u - ( lane.u >> 1 );
+		float y = lane.f;
+		y = y * ( 1.5f - 0.5f * a.v[ i ] * y * y );
+		y = y * ( 1.5f - 0.5f * a.v[ i ] * y * y );
+		r.v[ i ] = y;
+	}
+	return r;
+}
+
+#endif
@@ -0,0 +1,170 @@
+//
+//	Transforms.cpp
+//
+#include "Transforms.h"
+
+/*
+====================================================
+transformsSoA_t::Resize
+====================================================
+*/
+void transformsSoA_t::Resize( const int num ) {
+	posX.resize( num );
+	posY.resize( num );
+	posZ.resize( num );
+	quatW.resize( num );
+	quatX.resize( num );
+	quatY.resize( num );
+	quatZ.resize( num );
+	scaleX.resize( num );
+	scaleY.resize( num );
+	scaleZ.resize( num );
+}
+
+/*
+====================================================
+transformsSoA_t::Set
+====================================================
+*/
+void transformsSoA_t::Set( const int idx, const Vec3 & pos, const Quat & orient, const Vec3 & scale ) {
+	posX[ idx ] = pos.x;
+	posY[ idx ] = pos.y;
+	posZ[ idx ] = pos.z;
+	quatW[ idx ] = orient.w;
+	quatX[ idx ] = orient.x;
+	quatY[ idx ] = orient.y;
+	quatZ[ idx ] = orient.z;
+	scaleX[ idx ] = scale.x;
+	scaleY[ idx ] = scale.y;
+	scaleZ[ idx ] = scale.z;
+}
+
+/*
+====================================================
+BuildMatrix
+====================================================
+*/
+void BuildMatrix( const Vec3 & pos, const Quat & q, const Vec3 & scale, float * dst ) {
+	// q v q^-1 as a matrix, dividing by |q|^2 like Quat::Inverse does
+	const float s = 2.0f / ( ( q.w * q.w + q.x * q.x ) + ( q.y * q.y + q.z * q.z ) );
+
+	const float sx = q.x * s;
+	const float sy = q.y * s;
+	const float sz = q.z * s;
+
+	const float xx = q.x * sx;
+	const float yy = q.y * sy;
+	const float zz = q.z * sz;
+	const float xy = q.x * sy;
+	const float xz = q.x * sz;
+	const float yz = q.y * sz;
+	const float wx = q.w * sx;
+	const float wy = q.w * sy;
+	const float wz = q.w * sz;
+
+	dst[ 0 ] = ( 1.0f - ( yy + zz ) ) * scale.x;
+	dst[ 1 ] = ( xy + wz ) * scale.x;
+	dst[ 2 ] = ( xz - wy ) * scale.x;
+	dst[ 3 ] = 0.0f;
+
+	dst[ 4 ] = ( xy - wz ) * scale.y;
+	dst[ 5 ] = ( 1.0f - ( xx + zz ) ) * scale.y;
+	dst[ 6 ] = ( yz + wx ) * scale.y;
+	dst[ 7 ] = 0.0f;
+
+	dst[ 8 ] = ( xz + wy ) * scale.z;
+	dst[ 9 ] = ( yz - wx ) * scale.z;
+	dst[ 10 ] = ( 1.0f - ( xx + yy ) ) * scale.z;
+	dst[ 11 ] = 0.0f;
+
+	dst[ 12 ] = pos.x;
+	dst[ 13 ] = pos.y;
+	dst[ 14 ] = pos.z;
+	dst[ 15 ] = 1.0f;
+}
+
+/*
+====================================================
+BuildMatrices
+====================================================
+*/
+void BuildMatrices( const transformsSoA_t & transforms, const int begin, const int end, void * dst, const int dstStride ) {
+	unsigned char * out = (unsigned char *)dst;
+	const simd4f_t one = SIMD_Splat( 1.0f );
+	const simd4f_t two = SIMD_Splat( 2.0f );
+	const simd4f_t zero = SIMD_Zero();
+
+	int i = begin;
+	for ( ; i + 4 <= end; i += 4 ) {
+		const simd4f_t qw = SIMD_LoadUnaligned( transforms.quatW.data() + i );
+		const simd4f_t qx = SIMD_LoadUnaligned( transforms.quatX.data() + i );
+		const simd4f_t qy = SIMD_LoadUnaligned( transforms.quatY.data() + i );
+		const simd4f_t qz = SIMD_LoadUnaligned( transforms.quatZ.data() + i );
+
+		const simd4f_t lengthSqr = SIMD_Add( SIMD_Add( SIMD_Mul( qw, qw ), SIMD_Mul( qx, qx ) ), SIMD_Add( SIMD_Mul( qy, qy ), SIMD_Mul( qz, qz ) ) );
+		const simd4f_t s = SIMD_Div( two, lengthSqr );
+		const simd4f_t sx = SIMD_Mul( qx, s );
+		const simd4f_t sy = SIMD_Mul( qy, s );
+		const simd4f_t sz = SIMD_Mul( qz, s );
+
+		const simd4f_t xx = SIMD_Mul( qx, sx );
+		const simd4f_t yy = SIMD_Mul( qy, sy );
+		const simd4f_t zz = SIMD_Mul( qz, sz );
+		const simd4f_t xy = SIMD_Mul( qx, sy );
+		const simd4f_t xz = SIMD_Mul( qx, sz );
+		const simd4f_t yz = SIMD_Mul( qy, sz );
+		const simd4f_t wx = SIMD_Mul( qw, sx );
+		const simd4f_t wy = SIMD_Mul( qw, sy );
+		const simd4f_t wz = SIMD_Mul( qw, sz );
+
+		const simd4f_t scaleX = SIMD_LoadUnaligned( transforms.scaleX.data() + i );
+		const simd4f_t scaleY = SIMD_LoadUnaligned( transforms.scaleY.data() + i );
+		const simd4f_t scaleZ = SIMD_LoadUnaligned( transforms.scaleZ.data() + i );
+
+		// Each register holds one matrix entry of four instances, transposing
+		// a group of four turns it into one column of each instance
+		simd4f_t c0[ 4 ] = {
+			SIMD_Mul( SIMD_Sub( one, SIMD_Add( yy, zz ) ), scaleX ),
+			SIMD_Mul( SIMD_Add( xy, wz ), scaleX ),
+			SIMD_Mul( SIMD_Sub( xz, wy ), scaleX ),
+			zero
+		};
+		simd4f_t c1[ 4 ] = {
+			SIMD_Mul( SIMD_Sub( xy, wz ), scaleY ),
+			SIMD_Mul( SIMD_Sub( one, SIMD_Add( xx, zz ) ), scaleY ),
+			SIMD_Mul( SIMD_Add( yz, wx ), scaleY ),
+			zero
+		};
+		simd4f_t c2[ 4 ] = {
+			SIMD_Mul( SIMD_Add( xz, wy ), scaleZ ),
+			SIMD_Mul( SIMD_Sub( yz, wx ), scaleZ ),
+			SIMD_Mul( SIMD_Sub( one, SIMD_Add( xx, yy ) ), scaleZ ),
+			zero
+		};
+		simd4f_t c3[ 4 ] = {
+			SIMD_LoadUnaligned( transforms.posX.data() + i ),
+			SIMD_LoadUnaligned( transforms.posY.data() + i ),
+			SIMD_LoadUnaligned( transforms.posZ.data() + i ),
+			one
+		};
+		SIMD_Transpose( c0[ 0 ], c0[ 1 ], c0[ 2 ], c0[ 3 ] );
+		SIMD_Transpose( c1[ 0 ], c1[ 1 ], c1[ 2 ], c1[ 3 ] );
+		SIMD_Transpose( c2[ 0 ], c2[ 1 ], c2[ 2 ], c2[ 3 ] );
+		SIMD_Transpose( c3[ 0 ], c3[ 1 ], c3[ 2 ], c3[ 3 ] );
+
+		for ( int j = 0; j < 4; j++ ) {
+			float * mat = (float *)( out + (size_t)( i + j ) * dstStride );
+			SIMD_StoreUnaligned( mat + 0, c0[ j ] );
+			SIMD_StoreUnaligned( mat + 4, c1[ j ] );
+			SIMD_StoreUnaligned( mat + 8, c2[ j ] );
+			SIMD_StoreUnaligned( mat + 12, c3[ j ] );
+		}
+	}
+
+	for ( ; i < end; i++ ) {
+		const Vec3 pos( transforms.posX[ i ], transforms.posY[ i ], transforms.posZ[ i ] );
+		const Quat orient( transforms.quatX[ i ], transforms.quatY[ i ], transforms.quatZ[ i ], transforms.quatW[ i ] );
+		const Vec3 scale( transforms.scaleX[ i ], transforms.scaleY[ i ], transforms.scaleZ[ i ] );
+		BuildMatrix( pos, orient, scale, (float *)( out + (size_t)i * dstStride ) );
+	}
+}
@@ -0,0 +1,50 @@
+//
+//	Transforms.h
+//
+#pragma once
+#include <vector>
+#include "Vector.h"
+#include "Quat.h"
+
+/*
+====================================================
+transformsSoA_t
+
+Positions, orientations and scales of many instances, one array per
+component so four instances load straight into one SIMD register.
+An instance's matrix is the same as building it with Mat4::Orient from
+the rotated x and z axes and multiplying by Mat4::Scaling.
+====================================================
+*/
+struct transformsSoA_t {
+	std::vector< float > posX;
+	std::vector< float > posY;
+	std::vector< float > posZ;
+	std::vector< float > quatW;
+	std::vector< float > quatX;
+	std::vector< float > quatY;
+	std::vector< float > quatZ;
+	std::vector< float > scaleX;
+	std::vector< float > scaleY;
+	std::vector< float > scaleZ;
+
+	int Num() const { return (int)posX.size(); }
+	void Resize( const int num );
+	void Set( const int idx, const Vec3 & pos, const Quat & orient, const Vec3 & scale );
+};
+
+/*
+====================================================
+BuildMatrices
+
+Writes the matrices of instances [ begin, end ) to dst as column major
+float[ 16 ]s, ready for the shaders, instance i at dst + i * dstStride
+bytes.  dst doesn't need to be aligned, so it can be a mapped uniform
+or storage buffer.  Ranges that don't overlap can be built on
+different threads.
+====================================================
+*/
+void BuildMatrices( const transformsSoA_t & transforms, const int begin, const int end, void * dst, const int dstStride );
+
+// A single instance, same output as BuildMatrices
+void BuildMatrix( const Vec3 & pos, const Quat & orient, const Vec3 & scale, float * dst );
@@ -5,6 +5,8 @@
 #include <assert.h>
 #include <math.h>
 #include <stdio.h>
+#include "SIMD.h"
+#include "FastMath.h"
 
 /*
  ================================
@@ -230,6 +232,8 @@ public:
     float Dot(const Vec3 &rhs) const;
 
     const Vec3 &Normalize();
+    template <mathAccuracy_t accuracy>
+    const Vec3 &Normalize(); // Normalize<MATH_ACCURACY_...>(), see FastMath.h
     float GetMagnitude() const;
     float GetLengthSqr() const { return Dot(*this); }
     bool IsValid() const;
@@ -408,6 +412,19 @@ inline const Vec3 &Vec3::Normalize()
     return *this;
 }
 
+template <mathAccuracy_t accuracy>
+inline const Vec3 &Vec3::Normalize()
+{
+    float invMag = MathFunctions<accuracy>::RSqrt(x * x + y * y + z * z);
+    if (0.0f * invMag == 0.0f * invMag)
+    {
+        x *= invMag;
+        y *= invMag;
+        z *= invMag;
+    }
+    return *this;
+}
+
 inline float Vec3::GetMagnitude() const
 {
     float mag;
@@ -453,12 +470,67 @@ inline void Vec3::GetOrtho(Vec3 &u, Vec3 &v) const
     u.Normalize();
 }
 
+/*
+ ================================
+ Vec3d
+
+ Double precision world position.  Only used where float runs out, the
+ scene origin and the camera, everything else stays float and relative
+ to one of those, see Scene::RebaseOrigin.
+ ================================
+ */
+class Vec3d
+{
+public:
+    Vec3d() : x(0), y(0), z(0) {}
+    Vec3d(double X, double Y, double Z) : x(X), y(Y), z(Z) {}
+    explicit Vec3d(const Vec3 &rhs) : x(rhs.x), y(rhs.y), z(rhs.z) {}
+
+    Vec3d operator+(const Vec3d &rhs) const { return Vec3d(x + rhs.x, y + rhs.y, z + rhs.z); }
+    Vec3d operator-(const Vec3d &rhs) const { return Vec3d(x - rhs.x, y - rhs.y, z - rhs.z); }
+    const Vec3d &operator+=(const Vec3d &rhs);
+    const Vec3d &operator-=(const Vec3d &rhs);
+
+    // Float offsets are added in double, only the final position is rounded
+    Vec3d operator+(const Vec3 &rhs) const { return *this + Vec3d(rhs); }
+    Vec3d operator-(const Vec3 &rhs) const { return *this - Vec3d(rhs); }
+
+    bool operator==(const Vec3d &rhs) const { return x == rhs.x && y == rhs.y && z == rhs.z; }
+    bool operator!=(const Vec3d &rhs) const { return !(*this == rhs); }
+
+    Vec3 ToVec3() const { return Vec3((float) x, (float) y, (float) z); }
+
+public:
+    double x;
+    double y;
+    double z;
+};
+
+inline const Vec3d &Vec3d::operator+=(const Vec3d &rhs)
+{
+    x += rhs.x;
+    y += rhs.y;
+    z += rhs.z;
+    return *this;
+}
+
+inline const Vec3d &Vec3d::operator-=(const Vec3d &rhs)
+{
+    x -= rhs.x;
+    y -= rhs.y;
+    z -= rhs.z;
+    return *this;
+}
+
 /*
  ================================
  Vec4
+
+ 16 byte aligned so the operators can load and store it as a single
+ SIMD register, see SIMD.h for the backends.
  ================================
  */
-class Vec4
+class alignas(16) Vec4
 {
 public:
     Vec4();
@@ -466,6 +538,7 @@ public:
     Vec4(const Vec4 &rhs);
     Vec4(float X, float Y, float Z, float W);
     Vec4(const float *rhs);
+    explicit Vec4(const simd4f_t &rhs) { SIMD_Store(&x, rhs); }
     Vec4 &operator=(const Vec4 &rhs);
 
     bool operator==(const Vec4 &rhs) const;
@@ -494,6 +567,7 @@ public:
 
     const float *ToPtr() const { return &x; }
     float *ToPtr() { return &x; }
+    simd4f_t ToSIMD() const { return SIMD_Load(&x); }
 
 public:
     float x;
@@ -562,71 +636,35 @@ inline bool Vec4::operator!=(const Vec4 &rhs) const
     return true;
 }
 
-inline Vec4 Vec4::operator+(const Vec4 &rhs) const
-{
-    Vec4 temp;
-    temp.x = x + rhs.x;
-    temp.y = y + rhs.y;
-    temp.z = z + rhs.z;
-    temp.w = w + rhs.w;
-    return temp;
-}
+inline Vec4 Vec4::operator+(const Vec4 &rhs) const { return Vec4(SIMD_Add(ToSIMD(), rhs.ToSIMD())); }
 
 inline const Vec4 &Vec4::operator+=(const Vec4 &rhs)
 {
-    x += rhs.x;
-    y += rhs.y;
-    z += rhs.z;
-    w += rhs.w;
+    SIMD_Store(&x, SIMD_Add(ToSIMD(), rhs.ToSIMD()));
     return *this;
 }
 
 inline const Vec4 &Vec4::operator-=(const Vec4 &rhs)
 {
-    x -= rhs.x;
-    y -= rhs.y;
-    z -= rhs.z;
-    w -= rhs.w;
+    SIMD_Store(&x, SIMD_Sub(ToSIMD(), rhs.ToSIMD()));
     return *this;
 }
 
 inline const Vec4 &Vec4::operator*=(const Vec4 &rhs)
 {
-    x *= rhs.x;
-    y *= rhs.y;
-    z *= rhs.z;
-    w *= rhs.w;
+    SIMD_Store(&x, SIMD_Mul(ToSIMD(), rhs.ToSIMD()));
     return *this;
 }
 
 inline const Vec4 &Vec4::operator/=(const Vec4 &rhs)
 {
-    x /= rhs.x;
-    y /= rhs.y;
-    z /= rhs.z;
-    w /= rhs.w;
+    SIMD_Store(&x, SIMD_Div(ToSIMD(), rhs.ToSIMD()));
     return *this;
 }
 
-inline Vec4 Vec4::operator-(const Vec4 &rhs) const
-{
-    Vec4 temp;
-    temp.x = x - rhs.x;
-    temp.y = y - rhs.y;
-    temp.z = z - rhs.z;
-    temp.w = w - rhs.w;
-    return temp;
-}
+inline Vec4 Vec4::operator-(const Vec4 &rhs) const { return Vec4(SIMD_Sub(ToSIMD(), rhs.ToSIMD())); }
 
-inline Vec4 Vec4::operator*(const float rhs) const
-{
-    Vec4 temp;
-    temp.x = x * rhs;
-    temp.y = y * rhs;
-    temp.z = z * rhs;
-    temp.w = w * rhs;
-    return temp;
-}
+inline Vec4 Vec4::operator*(const float rhs) const { return Vec4(SIMD_Mul(ToSIMD(), SIMD_Splat(rhs))); }
 
 inline float Vec4::operator[](const int idx) const
 {
@@ -640,14 +678,7 @@ inline float &Vec4::operator[](const int idx)
     return (&x)[idx];
 }
 
-inline float Vec4::Dot(const Vec4 &rhs) const
-{
-    float xx = x * rhs.x;
-    float yy = y * rhs.y;
-    float zz = z * rhs.z;
-    float ww = w * rhs.w;
-    return (xx + yy + zz + ww);
-}
+inline float Vec4::Dot(const Vec4 &rhs) const { return SIMD_HorizontalAdd(SIMD_Mul(ToSIMD(), rhs.ToSIMD())); }
 
 inline const Vec4 &Vec4::Normalize()
 {
@@ -655,10 +686,7 @@ inline const Vec4 &Vec4::Normalize()
     float invMag = 1.0f / mag;
     if (0.0f * invMag == 0.0f * invMag)
     {
-        x *= invMag;
-        y *= invMag;
-        z *= invMag;
-        w *= invMag;
+        SIMD_Store(&x, SIMD_Mul(ToSIMD(), SIMD_Splat(invMag)));
     }
 
     return *this;
@@ -666,12 +694,7 @@ inline const Vec4 &Vec4::Normalize()
 
 inline float Vec4::GetMagnitude() const
 {
-    float mag;
-
-    mag = x * x + y * y + z * z + w * w;
-    mag = sqrtf(mag);
-
-    return mag;
+    return sqrtf(Dot(*this));
 }
 
 inline bool Vec4::IsValid() const
@@ -702,16 +725,26 @@ inline bool Vec4::IsValid() const
 /*
  ================================
  VecN
+
+ Vectors up to INLINE_SIZE long live in the object itself, only longer
+ ones go to the heap.  The constraint solver only needs 12 or less, so
+ its temporaries never allocate.
  ================================
  */
 class VecN
 {
 public:
-    VecN() : N(0), data(NULL) {}
+    static const int INLINE_SIZE = 12;
+
+    VecN() : N(0), data(m_inline), m_capacity(INLINE_SIZE) {}
     VecN(int _N);
     VecN(const VecN &rhs);
+    VecN(VecN &&rhs) noexcept;
     VecN &operator=(const VecN &rhs);
-    ~VecN() { delete[] data; }
+    VecN &operator=(VecN &&rhs) noexcept;
+    ~VecN() { FreeHeap(); }
+
+    void Resize(const int _N); // keeps the storage if it is large enough, contents are undefined
 
     float operator[](const int idx) const { return data[idx]; }
     float &operator[](const int idx) { return data[idx]; }
@@ -728,30 +761,64 @@ public:
 public:
     int N;
     float *data;
+
+private:
+    void FreeHeap();
+
+    float m_inline[INLINE_SIZE];
+    int m_capacity;
 };
 
-inline VecN::VecN(int _N)
+inline VecN::VecN(int _N) : N(0), data(m_inline), m_capacity(INLINE_SIZE) { Resize(_N); }
+
+inline VecN::VecN(const VecN &rhs) : N(0), data(m_inline), m_capacity(INLINE_SIZE)
 {
-    N = _N;
-    data = new float[_N];
+    Resize(rhs.N);
+    for (int i = 0; i < N; i++)
+    {
+        data[i] = rhs.data[i];
+    }
 }
 
-inline VecN::VecN(const VecN &rhs)
+inline VecN::VecN(VecN &&rhs) noexcept : N(0), data(m_inline), m_capacity(INLINE_SIZE) { *this = static_cast<VecN &&>(rhs); }
+
+inline VecN &VecN::operator=(const VecN &rhs)
 {
-    N = rhs.N;
-    data = new float[N];
+    if (this == &rhs)
+    {
+        return *this;
+    }
+
+    Resize(rhs.N);
     for (int i = 0; i < N; i++)
     {
         data[i] = rhs.data[i];
     }
+    return *this;
 }
 
-inline VecN &VecN::operator=(const VecN &rhs)
+inline VecN &VecN::operator=(VecN &&rhs) noexcept
 {
-    delete[] data;
+    if (this == &rhs)
+    {
+        return *this;
+    }
+
+    if (rhs.data != rhs.m_inline)
+    {
+        // Take over the heap block
+        FreeHeap();
+        N = rhs.N;
+        data = rhs.data;
+        m_capacity = rhs.m_capacity;
 
-    N = rhs.N;
-    data = new float[N];
+        rhs.N = 0;
+        rhs.data = rhs.m_inline;
+        rhs.m_capacity = INLINE_SIZE;
+        return *this;
+    }
+
+    Resize(rhs.N);
     for (int i = 0; i < N; i++)
     {
         data[i] = rhs.data[i];
@@ -759,6 +826,27 @@ inline VecN &VecN::operator=(const VecN &rhs)
     return *this;
 }
 
+inline void VecN::Resize(const int _N)
+{
+    if (_N > m_capacity)
+    {
+        FreeHeap();
+        data = new float[_N];
+        m_capacity = _N;
+    }
+    N = _N;
+}
+
+inline void VecN::FreeHeap()
+{
+    if (data != m_inline)
+    {
+        delete[] data;
+        data = m_inline;
+        m_capacity = INLINE_SIZE;
+    }
+}
+
 inline const VecN &VecN::operator*=(float rhs)
 {
     for (int i = 0; i < N; i++)
@@ -0,0 +1,184 @@
+//
+//	Parallel.cpp
+//
+#include "Parallel.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <vector>
+#include <algorithm>
+
+/*
+====================================================
+parallelJob_t
+====================================================
+*/
+struct parallelJob_t {
+	const std::function< void( int, int ) > * func;
+	int num;
+	int chunkSize;
+	int numChunks;
+	std::atomic< int > nextChunk;
+	std::atomic< int > chunksDone;
+};
+
+/*
+====================================================
+WorkerPool
+====================================================
+*/
+class WorkerPool {
+public:
+	WorkerPool();
+	~WorkerPool();
+
+	void Run( parallelJob_t & job );
+	int GetNumThreads() const { return (int)m_threads.size(); }
+
+	std::mutex m_callMutex;		// one ParallelFor at a time
+
+private:
+	void WorkerMain();
+	void RunChunks( parallelJob_t & job );
+
+	std::vector< std::thread > m_threads;
+
+	std::mutex m_mutex;
+	std::condition_variable m_wake;
+	std::condition_variable m_done;
+
+	parallelJob_t * m_job;
+	unsigned int m_generation;
+	int m_numActive;	// workers that picked up m_job and haven't let go of it
+	bool m_quit;
+};
+
+static thread_local bool t_isInsideChunk = false;
+
+WorkerPool::WorkerPool() : m_job( NULL ), m_generation( 0 ), m_numActive( 0 ), m_quit( false ) {
+	const unsigned int numCores = std::thread::hardware_concurrency();
+	const int numWorkers = ( numCores > 1 ) ? (int)numCores - 1 : 0;
+	for ( int i = 0; i < numWorkers; i++ ) {
+		m_threads.emplace_back( &WorkerPool::WorkerMain, this );
+	}
+}
+
+WorkerPool::~WorkerPool() {
+	{
+		std::lock_guard< std::mutex > lock( m_mutex );
+		m_quit = true;
+	}
+	m_wake.notify_all();
+	for ( std::thread & thread : m_threads ) {
+		thread.join();
+	}
+}
+
+void WorkerPool::RunChunks( parallelJob_t & job ) {
+	t_isInsideChunk = true;
+	while ( true ) {
+		const int chunk = job.nextChunk.fetch_add( 1 );
+		if ( chunk >= job.numChunks ) {
+			break;
+		}
+
+		const int begin = chunk * job.chunkSize;
+		const int end = std::min( job.num, begin + job.chunkSize );
+		( *job.func )( begin, end );
+
+		if ( job.chunksDone.fetch_add( 1 ) + 1 == job.numChunks ) {
+			std::lock_guard< std::mutex > lock( m_mutex );
+			m_done.notify_all();
+		}
+	}
+	t_isInsideChunk = false;
+}
+
+void WorkerPool::WorkerMain() {
+	unsigned int seenGeneration = 0;
+
+	std::unique_lock< std::mutex > lock( m_mutex );
+	while ( true ) {
+		m_wake.wait( lock, [ & ] { return m_quit || ( m_job != NULL && m_generation != seenGeneration ); } );
+		if ( m_quit ) {
+			break;
+		}
+
+		seenGeneration = m_generation;
+		parallelJob_t * job = m_job;
+		m_numActive++;
+
+		lock.unlock();
+		RunChunks( *job );
+		lock.lock();
+
+		m_numActive--;
+		if ( m_numActive == 0 ) {
+			m_done.notify_all();
+		}
+	}
+}
+
+void WorkerPool::Run( parallelJob_t & job ) {
+	{
+		std::lock_guard< std::mutex > lock( m_mutex );
+		m_job = &job;
+		m_generation++;
+	}
+	m_wake.notify_all();
+
+	RunChunks( job );
+
+	// The job lives on the caller's stack, wait until no worker can touch it
+	std::unique_lock< std::mutex > lock( m_mutex );
+	m_done.wait( lock, [ & ] { return job.chunksDone.load() == job.numChunks && m_numActive == 0; } );
+	m_job = NULL;
+}
+
+static WorkerPool & GetWorkerPool() {
+	static WorkerPool pool;
+	return pool;
+}
+
+/*
+====================================================
+ParallelFor
+====================================================
+*/
+void ParallelFor( const int num, const int chunkSize, const std::function< void( int begin, int end ) > & func ) {
+	if ( num <= 0 ) {
+		return;
+	}
+
+	const int size = std::max( 1, chunkSize );
+	WorkerPool & pool = GetWorkerPool();
+	if ( num <= size || pool.GetNumThreads() == 0 || t_isInsideChunk ) {
+		func( 0, num );
+		return;
+	}
+
+	std::unique_lock< std::mutex > callLock( pool.m_callMutex, std::try_to_lock );
+	if ( !callLock.owns_lock() ) {
+		func( 0, num );
+		return;
+	}
+
+	parallelJob_t job;
+	job.func = &func;
+	job.num = num;
+	job.chunkSize = size;
+	job.numChunks = ( num + size - 1 ) / size;
+	job.nextChunk = 0;
+	job.chunksDone = 0;
+	pool.Run( job );
+}
+
+/*
+====================================================
+GetNumWorkerThreads
+====================================================
+*/
+int GetNumWorkerThreads() {
+	return GetWorkerPool().GetNumThreads();
+}
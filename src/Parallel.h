@@ -0,0 +1,22 @@
+//
+//	Parallel.h
+//
+#pragma once
+#include <functional>
+
+/*
+====================================================
+ParallelFor
+
+Splits [ 0, num ) into chunks of chunkSize and runs them on a pool of
+worker threads that lives for the whole program, the calling thread
+works on chunks too.  Returns once every chunk is done.
+
+The chunks of one call run concurrently, so they must only write to
+their own range.  Calls made from inside a chunk, or while another
+thread is in a ParallelFor, run serially on the calling thread.
+====================================================
+*/
+void ParallelFor( const int num, const int chunkSize, const std::function< void( int begin, int end ) > & func );
+
+int GetNumWorkerThreads();
@@ -0,0 +1,424 @@
+//
+//  Articulation.cpp
+//
+#include "Articulation.h"
+#include <unordered_map>
+
+// Fraction of the joint error removed each step.  The solve is exact,
+// so this can be a lot stiffer than the iterative constraints use.
+static const float BAUMGARTE_BETA = 0.2f;
+
+// Tiny compliance on every joint row, keeps the factorization well
+// conditioned when a joint is redundant (e.g. two hinges on one axis).
+static const float JOINT_COMPLIANCE = 1e-6f;
+
+/*
+====================================================
+SetRow
+
+Writes one constraint row, the linear terms are in the first
+three columns and the angular terms in the last three.
+====================================================
+*/
+template< typename T >
+static void SetRow( T & jacobian, const int row, const Vec3 & linear, const Vec3 & angular ) {
+	jacobian( row, 0 ) = linear.x;
+	jacobian( row, 1 ) = linear.y;
+	jacobian( row, 2 ) = linear.z;
+	jacobian( row, 3 ) = angular.x;
+	jacobian( row, 4 ) = angular.y;
+	jacobian( row, 5 ) = angular.z;
+}
+
+/*
+====================================================
+Articulation::AddJoint
+====================================================
+*/
+int Articulation::AddJoint( const jointType_t type, Body * bodyA, Body * bodyB, const Vec3 & worldAnchor, const Vec3 & worldAxis ) {
+	Vec3 axis = worldAxis;
+	axis.Normalize();
+
+	// Built in place, copying the partly filled blocks would read uninitialized storage
+	m_joints.emplace_back();
+	joint_t & joint = m_joints.back();
+	joint.type = type;
+	joint.bodyA = bodyA;
+	joint.bodyB = bodyB;
+	joint.anchorA = bodyA->WorldSpaceToBodySpace( worldAnchor );
+	joint.anchorB = bodyB->WorldSpaceToBodySpace( worldAnchor );
+	joint.axisA = bodyA->m_orientation.Inverse().RotatePoint( axis );
+	joint.axisB = bodyB->m_orientation.Inverse().RotatePoint( axis );
+	joint.q0 = bodyA->m_orientation.Inverse() * bodyB->m_orientation;
+	joint.nodeA = -1;	// assigned by Build
+	joint.nodeB = -1;
+
+	switch ( type ) {
+		default:
+		case JOINT_BALL: { joint.numRows = 3; } break;
+		case JOINT_HINGE: { joint.numRows = 5; } break;
+		case JOINT_FIXED: { joint.numRows = 6; } break;
+	}
+
+	m_isValid = false;
+	return (int)m_joints.size() - 1;
+}
+
+/*
+====================================================
+Articulation::Clear
+====================================================
+*/
+void Articulation::Clear() {
+	m_joints.clear();
+	m_nodes.clear();
+	m_order.clear();
+	m_isValid = false;
+}
+
+/*
+====================================================
+Articulation::Build
+
+Turns the joints into a tree of body and joint nodes and
+orders it so that every node is eliminated before its parent.
+Joints anchored to the world are used as roots first, so a
+hanging chain is factored from its free end towards the anchor.
+====================================================
+*/
+bool Articulation::Build() {
+	m_nodes.clear();
+	m_order.clear();
+	m_isValid = false;
+
+	const int numJoints = (int)m_joints.size();
+
+	//
+	//	Create the nodes and the adjacency between them
+	//
+	std::unordered_map< Body *, int > bodyNodes;
+	std::vector< std::vector< int > > adjacency;
+	for ( int i = 0; i < numJoints; i++ ) {
+		const joint_t & joint = m_joints[ i ];
+
+		m_nodes.emplace_back();
+		node_t & node = m_nodes.back();
+		node.parent = -1;
+		node.joint = i;
+		node.body = NULL;
+		node.dim = joint.numRows;
+		adjacency.emplace_back();
+	}
+
+	for ( int i = 0; i < numJoints; i++ ) {
+		Body * bodies[ 2 ] = { m_joints[ i ].bodyA, m_joints[ i ].bodyB };
+		int * jointNodes[ 2 ] = { &m_joints[ i ].nodeA, &m_joints[ i ].nodeB };
+		for ( int b = 0; b < 2; b++ ) {
+			Body * body = bodies[ b ];
+			*jointNodes[ b ] = -1;
+			if ( 0.0f == body->m_invMass ) {
+				continue;
+			}
+
+			auto iter = bodyNodes.find( body );
+			int bodyNode;
+			if ( iter == bodyNodes.end() ) {
+				bodyNode = (int)m_nodes.size();
+				m_nodes.emplace_back();
+				node_t & node = m_nodes.back();
+				node.parent = -1;
+				node.joint = -1;
+				node.body = body;
+				node.dim = 6;
+				adjacency.emplace_back();
+				bodyNodes[ body ] = bodyNode;
+			} else {
+				bodyNode = iter->second;
+			}
+
+			*jointNodes[ b ] = bodyNode;
+			adjacency[ i ].push_back( bodyNode );
+			adjacency[ bodyNode ].push_back( i );
+		}
+	}
+
+	//
+	//	Breadth first search from the roots, any edge back to a visited node is a loop
+	//
+	const int numNodes = (int)m_nodes.size();
+	std::vector< bool > visited( numNodes, false );
+	std::vector< int > bfsOrder;
+	bfsOrder.reserve( numNodes );
+
+	std::vector< int > roots;
+	for ( int i = 0; i < numJoints; i++ ) {
+		if ( adjacency[ i ].size() < 2 ) {
+			roots.push_back( i );
+		}
+	}
+	for ( int i = 0; i < numNodes; i++ ) {
+		roots.push_back( i );
+	}
+
+	for ( int r = 0; r < roots.size(); r++ ) {
+		const int root = roots[ r ];
+		if ( visited[ root ] ) {
+			continue;
+		}
+
+		visited[ root ] = true;
+		size_t head = bfsOrder.size();
+		bfsOrder.push_back( root );
+		while ( head < bfsOrder.size() ) {
+			const int idx = bfsOrder[ head ];
+			head++;
+
+			bool skippedParent = false;
+			for ( int n = 0; n < adjacency[ idx ].size(); n++ ) {
+				const int neighbor = adjacency[ idx ][ n ];
+				if ( neighbor == m_nodes[ idx ].parent && !skippedParent ) {
+					skippedParent = true;
+					continue;
+				}
+				if ( visited[ neighbor ] ) {
+					return false;
+				}
+
+				visited[ neighbor ] = true;
+				m_nodes[ neighbor ].parent = idx;
+				bfsOrder.push_back( neighbor );
+			}
+		}
+	}
+
+	m_order.assign( bfsOrder.rbegin(), bfsOrder.rend() );
+	m_isValid = true;
+	return true;
+}
+
+/*
+====================================================
+Articulation::OffDiagonal
+
+The block of the system matrix that couples a node to its parent,
+which is the joint's Jacobian with respect to the body, or its
+transpose.
+====================================================
+*/
+Articulation::block_t Articulation::OffDiagonal( const node_t & node ) const {
+	const node_t & parent = m_nodes[ node.parent ];
+	if ( node.joint >= 0 ) {
+		const joint_t & joint = m_joints[ node.joint ];
+		return ( parent.body == joint.bodyA ) ? joint.jacobianA : joint.jacobianB;
+	}
+
+	const joint_t & joint = m_joints[ parent.joint ];
+	const block_t & jacobian = ( node.body == joint.bodyA ) ? joint.jacobianA : joint.jacobianB;
+	return jacobian.transpose();
+}
+
+/*
+====================================================
+Articulation::PreSolve
+
+Builds the joint Jacobians and factors the system.  The factors
+are reused by every Solve this step.
+====================================================
+*/
+void Articulation::PreSolve( const float dt_sec ) {
+	if ( !m_isValid ) {
+		return;
+	}
+
+	//
+	//	Jacobians and position errors of the joints
+	//
+	for ( int i = 0; i < m_joints.size(); i++ ) {
+		joint_t & joint = m_joints[ i ];
+		Body * bodyA = joint.bodyA;
+		Body * bodyB = joint.bodyB;
+
+		joint.jacobianA.setZero( joint.numRows, 6 );
+		joint.jacobianB.setZero( joint.numRows, 6 );
+		joint.bias.setZero( joint.numRows );
+
+		const Vec3 worldAnchorA = bodyA->BodySpaceToWorldSpace( joint.anchorA );
+		const Vec3 worldAnchorB = bodyB->BodySpaceToWorldSpace( joint.anchorB );
+		const Vec3 ra = worldAnchorA - bodyA->GetCenterOfMassWorldSpace();
+		const Vec3 rb = worldAnchorB - bodyB->GetCenterOfMassWorldSpace();
+		const Vec3 error = worldAnchorB - worldAnchorA;
+
+		// The anchor points move together, d/dt( b - a ) = vb + wb x rb - va - wa x ra
+		const Vec3 axes[ 3 ] = { Vec3( 1, 0, 0 ), Vec3( 0, 1, 0 ), Vec3( 0, 0, 1 ) };
+		for ( int row = 0; row < 3; row++ ) {
+			SetRow( joint.jacobianA, row, axes[ row ] * -1.0f, axes[ row ].Cross( ra ) );
+			SetRow( joint.jacobianB, row, axes[ row ], rb.Cross( axes[ row ] ) );
+			joint.bias[ row ] = error[ row ];
+		}
+
+		if ( JOINT_HINGE == joint.type ) {
+			// Only the rotation about the hinge axis is free
+			const Vec3 axisA = bodyA->m_orientation.RotatePoint( joint.axisA );
+			const Vec3 axisB = bodyB->m_orientation.RotatePoint( joint.axisB );
+			const Vec3 drift = axisA.Cross( axisB );
+
+			Vec3 u;
+			Vec3 v;
+			axisA.GetOrtho( u, v );
+
+			SetRow( joint.jacobianA, 3, Vec3( 0.0f ), u * -1.0f );
+			SetRow( joint.jacobianB, 3, Vec3( 0.0f ), u );
+			joint.bias[ 3 ] = u.Dot( drift );
+
+			SetRow( joint.jacobianA, 4, Vec3( 0.0f ), v * -1.0f );
+			SetRow( joint.jacobianB, 4, Vec3( 0.0f ), v );
+			joint.bias[ 4 ] = v.Dot( drift );
+		} else if ( JOINT_FIXED == joint.type ) {
+			// Rotation that takes the current orientation of bodyB to where it should be
+			const Quat target = bodyA->m_orientation * joint.q0;
+			const Quat qerr = bodyB->m_orientation * target.Inverse();
+			Vec3 drift = qerr.xyz() * 2.0f;
+			if ( qerr.w < 0.0f ) {
+				drift *= -1.0f;
+			}
+
+			for ( int i = 0; i < 3; i++ ) {
+				SetRow( joint.jacobianA, 3 + i, Vec3( 0.0f ), axes[ i ] * -1.0f );
+				SetRow( joint.jacobianB, 3 + i, Vec3( 0.0f ), axes[ i ] );
+				joint.bias[ 3 + i ] = drift[ i ];
+			}
+		}
+
+		joint.bias *= BAUMGARTE_BETA / dt_sec;
+	}
+
+	//
+	//	Diagonal blocks, the mass matrix for bodies and the compliance for joints
+	//
+	for ( int i = 0; i < m_nodes.size(); i++ ) {
+		node_t & node = m_nodes[ i ];
+		node.D.setZero( node.dim, node.dim );
+		if ( node.joint >= 0 ) {
+			node.D.diagonal().setConstant( -JOINT_COMPLIANCE );
+			continue;
+		}
+
+		const Body * body = node.body;
+		const float mass = 1.0f / body->m_invMass;
+		const Mat3 orient = body->m_orientation.ToMat3();
+		const Mat3 inertia = orient * body->m_shape->InertiaTensor() * orient.Transpose() * mass;
+		for ( int r = 0; r < 3; r++ ) {
+			node.D( r, r ) = mass;
+			for ( int c = 0; c < 3; c++ ) {
+				node.D( 3 + r, 3 + c ) = inertia.rows[ r ][ c ];
+			}
+		}
+	}
+
+	//
+	//	Factor from the leaves up, each node folds its Schur complement into its parent
+	//
+	for ( int i = 0; i < m_order.size(); i++ ) {
+		node_t & node = m_nodes[ m_order[ i ] ];
+		node.Dinv = node.D.inverse();
+		if ( node.parent < 0 ) {
+			continue;
+		}
+
+		const block_t H = OffDiagonal( node );
+		node.L = node.Dinv * H;
+		m_nodes[ node.parent ].D -= H.transpose() * node.L;
+	}
+}
+
+/*
+====================================================
+Articulation::Solve
+
+Solves for the velocity change that makes every joint row exact,
+given the velocities the other constraints have left behind.
+====================================================
+*/
+void Articulation::Solve() {
+	if ( !m_isValid ) {
+		return;
+	}
+
+	//
+	//	Right hand side, only the joint rows are non zero
+	//
+	for ( int i = 0; i < m_nodes.size(); i++ ) {
+		node_t & node = m_nodes[ i ];
+		if ( node.joint < 0 ) {
+			node.x.setZero( node.dim );
+			continue;
+		}
+
+		const joint_t & joint = m_joints[ node.joint ];
+		vec6_t velA;
+		velA << joint.bodyA->m_linearVelocity.x, joint.bodyA->m_linearVelocity.y, joint.bodyA->m_linearVelocity.z,
+			joint.bodyA->m_angularVelocity.x, joint.bodyA->m_angularVelocity.y, joint.bodyA->m_angularVelocity.z;
+		vec6_t velB;
+		velB << joint.bodyB->m_linearVelocity.x, joint.bodyB->m_linearVelocity.y, joint.bodyB->m_linearVelocity.z,
+			joint.bodyB->m_angularVelocity.x, joint.bodyB->m_angularVelocity.y, joint.bodyB->m_angularVelocity.z;
+
+		node.x = -( joint.jacobianA * velA + joint.jacobianB * velB + joint.bias );
+	}
+
+	//
+	//	Forward substitution, leaves to root
+	//
+	for ( int i = 0; i < m_order.size(); i++ ) {
+		const node_t & node = m_nodes[ m_order[ i ] ];
+		if ( node.parent >= 0 ) {
+			m_nodes[ node.parent ].x -= node.L.transpose() * node.x;
+		}
+	}
+
+	for ( int i = 0; i < m_nodes.size(); i++ ) {
+		m_nodes[ i ].x = m_nodes[ i ].Dinv * m_nodes[ i ].x;
+	}
+
+	//
+	//	Back substitution, root to leaves
+	//
+	for ( int i = (int)m_order.size() - 1; i >= 0; i-- ) {
+		node_t & node = m_nodes[ m_order[ i ] ];
+		if ( node.parent >= 0 ) {
+			node.x -= node.L * m_nodes[ node.parent ].x;
+		}
+	}
+
+	//
+	//	The joint rows of the solution are the negated impulses.  They're summed per body
+	//	and applied once, like the other constraints apply theirs, so the speed limits on
+	//	the bodies don't clip the large internal impulses of a stiff chain part way through.
+	//
+	for ( int i = 0; i < m_nodes.size(); i++ ) {
+		if ( m_nodes[ i ].joint < 0 ) {
+			m_nodes[ i ].x.setZero( 6 );
+		}
+	}
+	for ( int i = 0; i < m_nodes.size(); i++ ) {
+		const node_t & node = m_nodes[ i ];
+		if ( node.joint < 0 ) {
+			continue;
+		}
+
+		const joint_t & joint = m_joints[ node.joint ];
+		if ( joint.nodeA >= 0 ) {
+			m_nodes[ joint.nodeA ].x -= joint.jacobianA.transpose() * node.x;
+		}
+		if ( joint.nodeB >= 0 ) {
+			m_nodes[ joint.nodeB ].x -= joint.jacobianB.transpose() * node.x;
+		}
+	}
+	for ( int i = 0; i < m_nodes.size(); i++ ) {
+		const node_t & node = m_nodes[ i ];
+		if ( node.joint >= 0 ) {
+			continue;
+		}
+		node.body->ApplyImpulseLinear( Vec3( node.x[ 0 ], node.x[ 1 ], node.x[ 2 ] ) );
+		node.body->ApplyImpulseAngular( Vec3( node.x[ 3 ], node.x[ 4 ], node.x[ 5 ] ) );
+	}
+}
@@ -0,0 +1,96 @@
+//
+//	Articulation.h
+//
+#pragma once
+#include "Body.h"
+#include <vector>
+#include <Dense>
+
+/*
+====================================================
+Articulation
+
+Tree of bodies connected by bilateral joints, solved directly
+instead of iteratively.  The joints and the bodies they connect
+form a sparse symmetric system
+
+	[ M  J^T ] [ dv ]   [ 0   ]
+	[ J  0   ] [ mu ] = [ rhs ]
+
+whose graph is the joint tree itself.  Eliminating it from the
+leaves to the root has no fill in (Baraff, "Linear-Time Dynamics
+using Lagrange Multipliers"), so factoring and solving are both
+O(n) in the number of links.  Long chains are made rigid in a
+single pass instead of needing hundreds of Gauss-Seidel sweeps.
+
+Bodies with infinite mass are treated as the world, joints to
+them anchor the tree.  The joints must not form a loop, and
+limits and motors still belong in the iterative constraints.
+Very long or heavily loaded chains are still limited by the
+explicit integration and may need substeps.
+====================================================
+*/
+class Articulation {
+public:
+	enum jointType_t {
+		JOINT_BALL,		// anchors coincide, free rotation
+		JOINT_HINGE,	// anchors coincide, rotation only about the axis
+		JOINT_FIXED,	// anchors coincide, no relative rotation
+	};
+
+	Articulation() : m_isValid( false ) {}
+
+	int AddJoint( const jointType_t type, Body * bodyA, Body * bodyB, const Vec3 & worldAnchor, const Vec3 & worldAxis = Vec3( 0, 0, 1 ) );
+	void Clear();
+
+	bool Build();	// returns false if the joints form a loop
+	bool IsValid() const { return m_isValid; }
+
+	void PreSolve( const float dt_sec );
+	void Solve();
+
+	int GetNumJoints() const { return (int)m_joints.size(); }
+
+private:
+	static const int MAX_ROWS = 6;
+	typedef Eigen::Matrix< float, Eigen::Dynamic, Eigen::Dynamic, 0, MAX_ROWS, MAX_ROWS > block_t;
+	typedef Eigen::Matrix< float, Eigen::Dynamic, 1, 0, MAX_ROWS, 1 > blockVec_t;
+	typedef Eigen::Matrix< float, 6, 1 > vec6_t;
+
+	struct joint_t {
+		jointType_t type;
+		Body * bodyA;
+		Body * bodyB;
+		Vec3 anchorA;	// anchor in bodyA's space
+		Vec3 anchorB;	// anchor in bodyB's space
+		Vec3 axisA;		// hinge axis in bodyA's space
+		Vec3 axisB;		// hinge axis in bodyB's space
+		Quat q0;		// initial relative orientation q1^-1 * q2
+		int nodeA;		// body nodes, -1 for bodies with infinite mass
+		int nodeB;
+
+		int numRows;
+		block_t jacobianA;	// numRows x 6, linear then angular
+		block_t jacobianB;
+		blockVec_t bias;
+	};
+
+	struct node_t {
+		int parent;		// index of the parent node, or -1 for a root
+		int joint;		// index of the joint, or -1 for a body node
+		Body * body;	// the body for body nodes
+		int dim;
+
+		block_t D;		// diagonal block of the factorization
+		block_t Dinv;
+		block_t L;		// Dinv * H( node, parent )
+		blockVec_t x;
+	};
+
+	block_t OffDiagonal( const node_t & node ) const;
+
+	std::vector< joint_t > m_joints;
+	std::vector< node_t > m_nodes;
+	std::vector< int > m_order;		// leaves first, every node comes before its parent
+	bool m_isValid;
+};
@@ -11,5 +11,168 @@ Body::Body
 Body::Body() :
 m_position( 0.0f ),
 m_orientation( 0.0f, 0.0f, 0.0f, 1.0f ),
-m_shape( NULL ) {
-}
\ No newline at end of file
+m_linearVelocity( 0.0f ),
+m_angularVelocity( 0.0f ),
+m_invMass( 1.0f ),
+m_elasticity( 0.5f ),
+m_friction( 0.5f ),
+m_shape( NULL ),
+m_useSpeculativeContacts( false ) {
+}
+
+/*
+====================================================
+Body::GetCenterOfMassWorldSpace
+====================================================
+*/
+Vec3 Body::GetCenterOfMassWorldSpace() const {
+	const Vec3 centerOfMass = m_shape->GetCenterOfMass();
+	const Vec3 pos = m_position + m_orientation.RotatePoint( centerOfMass );
+	return pos;
+}
+
+/*
+====================================================
+Body::GetCenterOfMassModelSpace
+====================================================
+*/
+Vec3 Body::GetCenterOfMassModelSpace() const {
+	const Vec3 centerOfMass = m_shape->GetCenterOfMass();
+	return centerOfMass;
+}
+
+/*
+====================================================
+Body::WorldSpaceToBodySpace
+====================================================
+*/
+Vec3 Body::WorldSpaceToBodySpace( const Vec3 & worldPt ) const {
+	const Vec3 tmp = worldPt - GetCenterOfMassWorldSpace();
+	const Quat inverseOrient = m_orientation.Inverse();
+	Vec3 bodySpace = inverseOrient.RotatePoint( tmp );
+	return bodySpace;
+}
+
+/*
+====================================================
+Body::BodySpaceToWorldSpace
+====================================================
+*/
+Vec3 Body::BodySpaceToWorldSpace( const Vec3 & bodyPt ) const {
+	Vec3 worldSpace = GetCenterOfMassWorldSpace() + m_orientation.RotatePoint( bodyPt );
+	return worldSpace;
+}
+
+/*
+====================================================
+Body::GetInverseInertiaTensorBodySpace
+====================================================
+*/
+Mat3 Body::GetInverseInertiaTensorBodySpace() const {
+	const Mat3 inertiaTensor = m_shape->InertiaTensor();
+	const Mat3 invInertiaTensor = inertiaTensor.Inverse() * m_invMass;
+	return invInertiaTensor;
+}
+
+/*
+====================================================
+Body::GetInverseInertiaTensorWorldSpace
+====================================================
+*/
+Mat3 Body::GetInverseInertiaTensorWorldSpace() const {
+	const Mat3 inertiaTensor = m_shape->InertiaTensor();
+	const Mat3 invInertiaTensor = inertiaTensor.Inverse() * m_invMass;
+	const Mat3 orient = m_orientation.ToMat3();
+	return orient * invInertiaTensor * orient.Transpose();
+}
+
+/*
+====================================================
+Body::ApplyImpulse
+====================================================
+*/
+void Body::ApplyImpulse( const Vec3 & impulsePoint, const Vec3 & impulse ) {
+	if ( 0.0f == m_invMass ) {
+		return;
+	}
+
+	// impulsePoint is in world space, it's the location where the impulse is applied
+	ApplyImpulseLinear( impulse );
+
+	const Vec3 position = GetCenterOfMassWorldSpace();
+	const Vec3 r = impulsePoint - position;
+	const Vec3 dL = r.Cross( impulse );	// this is in world space
+	ApplyImpulseAngular( dL );
+}
+
+/*
+====================================================
+Body::ApplyImpulseLinear
+====================================================
+*/
+void Body::ApplyImpulseLinear( const Vec3 & impulse ) {
+	if ( 0.0f == m_invMass ) {
+		return;
+	}
+
+	// p = mv
+	// dp = m dv = J
+	// => dv = J / m
+	m_linearVelocity += impulse * m_invMass;
+}
+
+/*
+====================================================
+Body::ApplyImpulseAngular
+====================================================
+*/
+void Body::ApplyImpulseAngular( const Vec3 & impulse ) {
+	if ( 0.0f == m_invMass ) {
+		return;
+	}
+
+	// L = I w = r x p
+	// dL = I dw = r x J
+	// => dw = I^-1 * ( r x J )
+	m_angularVelocity += GetInverseInertiaTensorWorldSpace() * impulse;
+
+	// Clamp the angular velocity, tiny shapes can spin fast enough to blow up the simulation
+	const float maxAngularSpeed = 30.0f;
+	if ( m_angularVelocity.GetLengthSqr() > maxAngularSpeed * maxAngularSpeed ) {
+		m_angularVelocity.Normalize();
+		m_angularVelocity *= maxAngularSpeed;
+	}
+}
+
+/*
+====================================================
+Body::Update
+====================================================
+*/
+void Body::Update( const float dt_sec ) {
+	m_position += m_linearVelocity * dt_sec;
+
+	// We have an angular velocity around the center of mass, this needs to be converted to
+	// relative the body's position
+	const Vec3 positionCM = GetCenterOfMassWorldSpace();
+	const Vec3 cmToPos = m_position - positionCM;
+
+	// Total torque is equal to external applied torques + internal torque (precession)
+	// Euler's equations: T_external = Ia + w x I * w
+	// T_external = 0 because it was applied in the collision response function
+	// Ia = -( w x I * w )
+	// a = -I^-1 ( w x I * w )
+	const Mat3 orientation = m_orientation.ToMat3();
+	const Mat3 inertiaTensor = orientation * m_shape->InertiaTensor() * orientation.Transpose();
+	const Vec3 alpha = inertiaTensor.Inverse() * ( m_angularVelocity.Cross( inertiaTensor * m_angularVelocity ) ) * -1.0f;
+	m_angularVelocity += alpha * dt_sec;
+
+	// Update orientation
+	const Vec3 dAngle = m_angularVelocity * dt_sec;
+	const Quat dq = Quat( dAngle, dAngle.GetMagnitude() );
+	m_orientation = dq * m_orientation;
+	m_orientation.Normalize();
+
+	// Now get the new model position
+	m_position = positionCM + dq.RotatePoint( cmToPos );
+}
@@ -8,9 +8,6 @@
 #include "../Math/Bounds.h"
 #include "Shapes.h"
 
-#include "../RHI/model.h"
-#include "../RHI/shader.h"
-
 /*
 ====================================================
 Body
@@ -22,6 +19,30 @@ public:
 
 	Vec3		m_position;
 	Quat		m_orientation;
+	Vec3		m_linearVelocity;
+	Vec3		m_angularVelocity;
 
+	float		m_invMass;
+	float		m_elasticity;
+	float		m_friction;
 	Shape *		m_shape;
-};
\ No newline at end of file
+
+	// Fast movers generate contacts ahead of time instead of tunneling,
+	// at the cost of more contacts.  Off by default.
+	bool		m_useSpeculativeContacts;
+
+	Vec3 GetCenterOfMassWorldSpace() const;
+	Vec3 GetCenterOfMassModelSpace() const;
+
+	Vec3 WorldSpaceToBodySpace( const Vec3 & pt ) const;
+	Vec3 BodySpaceToWorldSpace( const Vec3 & pt ) const;
+
+	Mat3 GetInverseInertiaTensorBodySpace() const;
+	Mat3 GetInverseInertiaTensorWorldSpace() const;
+
+	void ApplyImpulse( const Vec3 & impulsePoint, const Vec3 & impulse );
+	void ApplyImpulseLinear( const Vec3 & impulse );
+	void ApplyImpulseAngular( const Vec3 & impulse );
+
+	void Update( const float dt_sec );
+};
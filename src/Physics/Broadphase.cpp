@@ -2,6 +2,111 @@
 //  Broadphase.cpp
 //
 #include "Broadphase.h"
+#include <algorithm>
+
+struct psuedoBody_t {
+	int id;
+	float value;
+};
+
+/*
+====================================================
+CompareSAP
+====================================================
+*/
+static bool CompareSAP( const psuedoBody_t & a, const psuedoBody_t & b ) {
+	return a.value < b.value;
+}
+
+/*
+====================================================
+SortBodiesBounds
+
+Only bodies that use speculative contacts have their bounds swept by
+their velocity, everything else only finds pairs that already touch.
+
+The bounds are stored in the order of their min along the axis, so the
+bodies that overlap one body along the axis are the ones after it up
+to the first whose min is past its max.
+====================================================
+*/
+static void SortBodiesBounds( const Body * bodies, const int num, psuedoBody_t * sortedArray, std::vector< float > & sortedMaxs, boundsSoA_t & sortedBounds, const float dt_sec ) {
+	Vec3 axis = Vec3( 1, 1, 1 );
+	axis.Normalize();
+
+	std::vector< Bounds > bounds( num );
+	for ( int i = 0; i < num; i++ ) {
+		const Body & body = bodies[ i ];
+		bounds[ i ] = body.m_shape->GetBounds( body.m_position, body.m_orientation );
+
+		// Expand the bounds by the linear velocity
+		if ( body.m_useSpeculativeContacts ) {
+			bounds[ i ].Expand( bounds[ i ].mins + body.m_linearVelocity * dt_sec );
+			bounds[ i ].Expand( bounds[ i ].maxs + body.m_linearVelocity * dt_sec );
+		}
+
+		const float epsilon = 0.01f;
+		bounds[ i ].Expand( bounds[ i ].mins + Vec3( -1, -1, -1 ) * epsilon );
+		bounds[ i ].Expand( bounds[ i ].maxs + Vec3( 1, 1, 1 ) * epsilon );
+
+		sortedArray[ i ].id = i;
+		sortedArray[ i ].value = axis.Dot( bounds[ i ].mins );
+	}
+
+	std::sort( sortedArray, sortedArray + num, CompareSAP );
+
+	sortedMaxs.resize( num );
+	sortedBounds.Resize( num );
+	for ( int i = 0; i < num; i++ ) {
+		const Bounds & b = bounds[ sortedArray[ i ].id ];
+		sortedMaxs[ i ] = axis.Dot( b.maxs );
+		sortedBounds.Set( i, b );
+	}
+}
+
+/*
+====================================================
+BuildPairs
+
+Sweeps along the axis for the candidates, then tests all of them
+against the full bounds four at a time.
+====================================================
+*/
+static void BuildPairs( std::vector< collisionPair_t > & collisionPairs, const psuedoBody_t * sortedBodies, const std::vector< float > & sortedMaxs, const boundsSoA_t & sortedBounds, const int num ) {
+	collisionPairs.clear();
+
+	std::vector< int > hits( num );
+	for ( int i = 0; i < num; i++ ) {
+		// if we've hit the end of the a element, then we're done creating pairs with a
+		int end = i + 1;
+		while ( end < num && sortedBodies[ end ].value <= sortedMaxs[ i ] ) {
+			end++;
+		}
+
+		const int numHits = IntersectBounds( sortedBounds.Get( i ), sortedBounds, i + 1, end, hits.data() );
+
+		collisionPair_t pair;
+		pair.a = sortedBodies[ i ].id;
+		for ( int j = 0; j < numHits; j++ ) {
+			pair.b = sortedBodies[ hits[ j ] ].id;
+			collisionPairs.push_back( pair );
+		}
+	}
+}
+
+/*
+====================================================
+SweepAndPrune1D
+====================================================
+*/
+static void SweepAndPrune1D( const Body * bodies, const int num, std::vector< collisionPair_t > & finalPairs, const float dt_sec ) {
+	std::vector< psuedoBody_t > sortedBodies( num );
+	std::vector< float > sortedMaxs;
+	boundsSoA_t sortedBounds;
+
+	SortBodiesBounds( bodies, num, sortedBodies.data(), sortedMaxs, sortedBounds, dt_sec );
+	BuildPairs( finalPairs, sortedBodies.data(), sortedMaxs, sortedBounds, num );
+}
 
 /*
 ====================================================
@@ -9,5 +114,7 @@ BroadPhase
 ====================================================
 */
 void BroadPhase( const Body * bodies, const int num, std::vector< collisionPair_t > & finalPairs, const float dt_sec ) {
-	// TODO: Add Code
-}
\ No newline at end of file
+	finalPairs.clear();
+
+	SweepAndPrune1D( bodies, num, finalPairs, dt_sec );
+}
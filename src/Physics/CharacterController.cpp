@@ -0,0 +1,360 @@
+//
+//  CharacterController.cpp
+//
+#include "CharacterController.h"
+#include <algorithm>
+#include <vector>
+
+static const int MAX_SLIDE_ITERATIONS = 4;
+
+/*
+====================================================
+CharacterController::CharacterController
+====================================================
+*/
+CharacterController::CharacterController() :
+m_radius( 0.3f ),
+m_height( 1.8f ),
+m_stepHeight( 0.4f ),
+m_maxSlopeCos( 0.64f ),	// ~50 degrees
+m_snapDistance( 0.2f ),
+m_skinWidth( 0.01f ),
+m_isGrounded( false ),
+m_groundNormal( 0.0f, 0.0f, 1.0f ) {
+}
+
+/*
+====================================================
+CharacterController::MakeCast
+====================================================
+*/
+capsuleCast_t CharacterController::MakeCast( const Vec3 & start, const Vec3 & delta ) const {
+	capsuleCast_t cast;
+	cast.start = start;
+	cast.delta = delta;
+	cast.radius = m_radius;
+	cast.halfHeight = GetHalfHeight();
+	cast.ignoreCapsule = -1;
+	return cast;
+}
+
+/*
+====================================================
+CharacterController::Move
+====================================================
+*/
+void CharacterController::Move( const castWorld_t & world, const Vec3 & displacement ) {
+	MoveCharacters( world, this, &displacement, 1 );
+}
+
+/*
+====================================================
+MoveAlongCast
+
+Moves up to the hit point, backed off by the skin width
+along the direction of travel.
+====================================================
+*/
+static void MoveAlongCast( Vec3 & position, const Vec3 & delta, const castResult_t & result, const float skin ) {
+	if ( !result.hit ) {
+		position += delta;
+		return;
+	}
+
+	const float length = delta.GetMagnitude();
+	if ( length < 1e-6f ) {
+		return;
+	}
+
+	const float travel = result.fraction * length - skin;
+	if ( travel > 0.0f ) {
+		position += delta * ( travel / length );
+	}
+}
+
+/*
+====================================================
+GetGroundNormal
+
+The contact normal of a cast that lands on an edge tilts
+towards the side of the edge, so the face that was hit is
+used as well.  This lets characters stand on the lip of a
+ledge rather than sliding off it.
+====================================================
+*/
+static Vec3 GetGroundNormal( const castWorld_t & world, const castResult_t & result ) {
+	if ( result.triangle < 0 || result.normal.z <= 0.0f ) {
+		return result.normal;
+	}
+
+	Vec3 faceNormal = world.mesh->GetTriangle( result.triangle ).normal;
+	if ( faceNormal.Dot( result.normal ) < 0.0f ) {
+		faceNormal *= -1.0f;
+	}
+	return ( faceNormal.z > result.normal.z ) ? faceNormal : result.normal;
+}
+
+/*
+====================================================
+characterMove_t
+
+Scratch state for a single character while the batch is
+being resolved.
+====================================================
+*/
+struct characterMove_t {
+	Vec3 remaining;		// displacement still left in the slide phase
+	Vec3 firstPlane;	// normal of the first plane slid along this move
+	int numPlanes;
+	float stepped;		// height gained by the step up
+	float fall;			// downward part of the requested displacement
+};
+
+/*
+====================================================
+MoveCharacters
+
+Resolves the displacements of a group of characters.  Each
+phase issues one batch of casts for all the characters that
+still need one, so the world is walked in tight loops rather
+than interleaved with the per character bookkeeping.  The
+characters collide with each other as capsules, each batch
+sees the others where the previous phase left them.
+
+	1. push out of anything the character is already inside of, triangles, bodies and
+	   the other characters, since those may have moved into it since the last move
+	2. step up by the step height
+	3. collide and slide along the horizontal displacement
+	4. cast down to undo the step, apply the fall and snap to the ground
+====================================================
+*/
+void MoveCharacters( const castWorld_t & world, CharacterController * characters, const Vec3 * displacements, const int num ) {
+	if ( num <= 0 ) {
+		return;
+	}
+
+	std::vector< characterMove_t > moves( num );
+	std::vector< capsuleCast_t > casts( num );
+	std::vector< castResult_t > results( num );
+	std::vector< int > active( num );
+
+	//
+	//	The bodies hold still while the characters move, so their bounds are sorted once.
+	//	The characters are added after any capsules the world already has.
+	//
+	castWorld_t characterWorld = world;
+	sortedBounds_t bodyBounds;
+	if ( NULL == world.bodyBounds && world.numBodies > 0 ) {
+		BuildBodyBounds( world.bodies, world.numBodies, bodyBounds );
+		characterWorld.bodyBounds = &bodyBounds;
+	}
+
+	const int firstCapsule = world.numCapsules;
+	std::vector< castCapsule_t > capsules( world.capsules, world.capsules + world.numCapsules );
+	capsules.resize( firstCapsule + num );
+	sortedBounds_t capsuleBounds;
+	characterWorld.capsules = capsules.data();
+	characterWorld.numCapsules = (int)capsules.size();
+	characterWorld.capsuleBounds = &capsuleBounds;
+
+	auto updateCapsules = [ & ]() {
+		for ( int i = 0; i < num; i++ ) {
+			castCapsule_t & capsule = capsules[ firstCapsule + i ];
+			capsule.center = characters[ i ].m_position;
+			capsule.radius = characters[ i ].m_radius;
+			capsule.halfHeight = characters[ i ].GetHalfHeight();
+		}
+		BuildCapsuleBounds( capsules.data(), (int)capsules.size(), capsuleBounds );
+	};
+
+	// Casts from where the character is, without hitting its own capsule
+	auto makeCast = [ & ]( const int i, const Vec3 & delta ) {
+		capsuleCast_t cast = characters[ i ].MakeCast( characters[ i ].m_position, delta );
+		cast.ignoreCapsule = firstCapsule + i;
+		return cast;
+	};
+
+	//
+	//	Depenetrate and split the displacement into the slide and fall parts.  A character's
+	//	capsule follows it as soon as it is pushed out, the sorted bounds only have to find
+	//	the candidates.
+	//
+	updateCapsules();
+	for ( int i = 0; i < num; i++ ) {
+		CharacterController & cc = characters[ i ];
+		CapsuleDepenetrate( characterWorld, cc.m_position, cc.m_radius, cc.GetHalfHeight(), cc.m_skinWidth, firstCapsule + i );
+		capsules[ firstCapsule + i ].center = cc.m_position;
+
+		characterMove_t & move = moves[ i ];
+		move.remaining = displacements[ i ];
+		move.fall = 0.0f;
+		if ( move.remaining.z < 0.0f ) {
+			move.fall = -move.remaining.z;
+			move.remaining.z = 0.0f;
+		}
+		move.numPlanes = 0;
+		move.stepped = 0.0f;
+	}
+
+	//
+	//	Step up, only grounded characters that are moving sideways need to
+	//
+	int numActive = 0;
+	for ( int i = 0; i < num; i++ ) {
+		const CharacterController & cc = characters[ i ];
+		const Vec3 & rem = moves[ i ].remaining;
+		if ( !cc.m_isGrounded || ( rem.x * rem.x + rem.y * rem.y ) < 1e-10f ) {
+			continue;
+		}
+		casts[ numActive ] = makeCast( i, Vec3( 0.0f, 0.0f, cc.m_stepHeight ) );
+		active[ numActive ] = i;
+		numActive++;
+	}
+	updateCapsules();
+	CapsuleCastBatch( characterWorld, casts.data(), results.data(), numActive );
+	for ( int j = 0; j < numActive; j++ ) {
+		CharacterController & cc = characters[ active[ j ] ];
+		const float before = cc.m_position.z;
+		MoveAlongCast( cc.m_position, casts[ j ].delta, results[ j ], cc.m_skinWidth );
+		moves[ active[ j ] ].stepped = cc.m_position.z - before;
+	}
+
+	//
+	//	Collide and slide
+	//
+	for ( int iter = 0; iter < MAX_SLIDE_ITERATIONS; iter++ ) {
+		numActive = 0;
+		for ( int i = 0; i < num; i++ ) {
+			if ( moves[ i ].remaining.GetLengthSqr() < 1e-10f ) {
+				continue;
+			}
+			casts[ numActive ] = makeCast( i, moves[ i ].remaining );
+			active[ numActive ] = i;
+			numActive++;
+		}
+		if ( 0 == numActive ) {
+			break;
+		}
+
+		updateCapsules();
+		CapsuleCastBatch( characterWorld, casts.data(), results.data(), numActive );
+
+		for ( int j = 0; j < numActive; j++ ) {
+			CharacterController & cc = characters[ active[ j ] ];
+			characterMove_t & move = moves[ active[ j ] ];
+			const castResult_t & result = results[ j ];
+
+			MoveAlongCast( cc.m_position, move.remaining, result, cc.m_skinWidth );
+			if ( !result.hit ) {
+				move.remaining.Zero();
+				continue;
+			}
+
+			// Walls and steep slopes are treated as vertical, so they can't be climbed by sliding up them
+			Vec3 normal = result.normal;
+			if ( !cc.IsWalkable( normal ) ) {
+				normal.z = 0.0f;
+				if ( normal.GetLengthSqr() < 1e-10f ) {
+					normal = result.normal;
+				}
+				normal.Normalize();
+			}
+
+			Vec3 slide = move.remaining * ( 1.0f - result.fraction );
+			if ( 0 == move.numPlanes ) {
+				slide -= normal * slide.Dot( normal );
+				move.firstPlane = normal;
+			} else {
+				// Slide along the crease between the two planes
+				Vec3 crease = move.firstPlane.Cross( normal );
+				if ( crease.GetLengthSqr() < 1e-10f ) {
+					slide -= normal * slide.Dot( normal );
+				} else {
+					crease.Normalize();
+					slide = crease * slide.Dot( crease );
+				}
+				move.firstPlane = normal;
+			}
+			move.numPlanes++;
+
+			// Never slide back against the requested direction, that causes jitter in corners
+			if ( slide.Dot( displacements[ active[ j ] ] ) <= 0.0f ) {
+				slide.Zero();
+			}
+			move.remaining = slide;
+		}
+	}
+
+	//
+	//	Cast down to undo the step up, apply the fall and snap to the ground.  Airborne
+	//	characters still probe a little further than they fall, so they land on ground
+	//	that is within the skin instead of hovering above it.
+	//
+	for ( int i = 0; i < num; i++ ) {
+		const CharacterController & cc = characters[ i ];
+		const characterMove_t & move = moves[ i ];
+		const bool isRising = displacements[ i ].z > 0.0f;
+		float probe = 2.0f * cc.m_skinWidth;
+		if ( cc.m_isGrounded && !isRising ) {
+			probe += cc.m_snapDistance;
+		}
+		const float down = move.stepped + move.fall + probe;
+		casts[ i ] = makeCast( i, Vec3( 0.0f, 0.0f, -down ) );
+	}
+	updateCapsules();
+	CapsuleCastBatch( characterWorld, casts.data(), results.data(), num );
+	numActive = 0;
+	for ( int i = 0; i < num; i++ ) {
+		CharacterController & cc = characters[ i ];
+		const characterMove_t & move = moves[ i ];
+		const castResult_t & result = results[ i ];
+		const bool isRising = displacements[ i ].z > 0.0f;
+		const float requested = move.stepped + move.fall;
+
+		if ( !result.hit || isRising ) {
+			// Nothing to stand on, only apply the part of the move that was asked for
+			cc.m_position.z -= requested;
+			cc.m_isGrounded = false;
+			cc.m_groundNormal = Vec3( 0.0f, 0.0f, 1.0f );
+			continue;
+		}
+
+		const float drop = std::max( result.fraction * -casts[ i ].delta.z - cc.m_skinWidth, 0.0f );
+		cc.m_position.z -= cc.m_isGrounded ? drop : std::min( drop, requested );
+
+		const Vec3 groundNormal = GetGroundNormal( world, result );
+		cc.m_isGrounded = cc.IsWalkable( groundNormal );
+		cc.m_groundNormal = cc.m_isGrounded ? groundNormal : Vec3( 0.0f, 0.0f, 1.0f );
+		if ( cc.m_isGrounded ) {
+			continue;
+		}
+
+		// Landed on something too steep to stand on, slide the rest of the fall down it
+		const float leftover = requested - std::min( drop, requested );
+		Vec3 slide( 0.0f, 0.0f, -leftover );
+		slide -= result.normal * slide.Dot( result.normal );
+		if ( slide.GetLengthSqr() < 1e-10f ) {
+			continue;
+		}
+		casts[ numActive ] = makeCast( i, slide );
+		active[ numActive ] = i;
+		numActive++;
+	}
+
+	updateCapsules();
+	CapsuleCastBatch( characterWorld, casts.data(), results.data(), numActive );
+	for ( int j = 0; j < numActive; j++ ) {
+		CharacterController & cc = characters[ active[ j ] ];
+		const castResult_t & result = results[ j ];
+		MoveAlongCast( cc.m_position, casts[ j ].delta, result, cc.m_skinWidth );
+
+		// Sliding down a steep slope usually ends on the floor at its foot
+		if ( result.hit ) {
+			const Vec3 groundNormal = GetGroundNormal( world, result );
+			if ( cc.IsWalkable( groundNormal ) ) {
+				cc.m_isGrounded = true;
+				cc.m_groundNormal = groundNormal;
+			}
+		}
+	}
+}
@@ -0,0 +1,42 @@
+//
+//	CharacterController.h
+//
+#pragma once
+#include "ShapeCast.h"
+
+/*
+====================================================
+CharacterController
+
+Kinematic upright capsule.  Movement is resolved with
+collide and slide against the cast world, with step up
+and ground snapping.  The caller owns velocity and gravity,
+the controller only turns a desired displacement into a
+legal one.
+====================================================
+*/
+class CharacterController {
+public:
+	CharacterController();
+
+	void Move( const castWorld_t & world, const Vec3 & displacement );
+
+	float GetHalfHeight() const { return 0.5f * m_height - m_radius; }
+	capsuleCast_t MakeCast( const Vec3 & start, const Vec3 & delta ) const;
+	bool IsWalkable( const Vec3 & normal ) const { return normal.z >= m_maxSlopeCos; }
+
+public:
+	Vec3 m_position;		// center of the capsule
+
+	float m_radius;
+	float m_height;			// total height, including the caps
+	float m_stepHeight;		// tallest ledge that can be walked onto
+	float m_maxSlopeCos;	// cosine of the steepest walkable slope
+	float m_snapDistance;	// how far down to look for ground when walking off a ledge
+	float m_skinWidth;		// gap kept between the capsule and the world
+
+	bool m_isGrounded;
+	Vec3 m_groundNormal;
+};
+
+void MoveCharacters( const castWorld_t & world, CharacterController * characters, const Vec3 * displacements, const int num );
@@ -0,0 +1,154 @@
+//
+//  CollisionMesh.cpp
+//
+#include "CollisionMesh.h"
+#include <algorithm>
+
+/*
+====================================================
+CollisionMesh::Clear
+====================================================
+*/
+void CollisionMesh::Clear() {
+	m_tris.clear();
+	m_nodes.clear();
+	m_bounds.Clear();
+}
+
+/*
+====================================================
+CollisionMesh::AddTriangles
+====================================================
+*/
+void CollisionMesh::AddTriangles( const Vec3 * verts, const int numVerts, const uint32_t * indices, const int numIndices ) {
+	m_tris.reserve( m_tris.size() + numIndices / 3 );
+
+	for ( int i = 0; i + 2 < numIndices; i += 3 ) {
+		assert( (int)indices[ i + 0 ] < numVerts );
+		assert( (int)indices[ i + 1 ] < numVerts );
+		assert( (int)indices[ i + 2 ] < numVerts );
+
+		collisionTri_t tri;
+		tri.a = verts[ indices[ i + 0 ] ];
+		tri.b = verts[ indices[ i + 1 ] ];
+		tri.c = verts[ indices[ i + 2 ] ];
+
+		tri.normal = ( tri.b - tri.a ).Cross( tri.c - tri.a );
+		if ( tri.normal.GetLengthSqr() < 1e-12f ) {
+			// Degenerate triangles can't be collided with
+			continue;
+		}
+		tri.normal.Normalize();
+
+		m_tris.push_back( tri );
+	}
+}
+
+/*
+====================================================
+CollisionMesh::Build
+====================================================
+*/
+void CollisionMesh::Build() {
+	m_nodes.clear();
+	m_bounds.Clear();
+	if ( m_tris.empty() ) {
+		return;
+	}
+
+	const int numTris = (int)m_tris.size();
+	std::vector< Vec3 > centroids( numTris );
+	std::vector< int > order( numTris );
+	for ( int i = 0; i < numTris; i++ ) {
+		const collisionTri_t & tri = m_tris[ i ];
+		centroids[ i ] = ( tri.a + tri.b + tri.c ) * ( 1.0f / 3.0f );
+		order[ i ] = i;
+	}
+
+	// A balanced tree has at most 2n / MAX_TRIS_PER_LEAF nodes
+	m_nodes.reserve( 2 * numTris / MAX_TRIS_PER_LEAF + 1 );
+	BuildRecursive( 0, numTris, centroids, order );
+
+	// Store the triangles in leaf order so each leaf is a contiguous range
+	std::vector< collisionTri_t > sorted( numTris );
+	for ( int i = 0; i < numTris; i++ ) {
+		sorted[ i ] = m_tris[ order[ i ] ];
+	}
+	m_tris.swap( sorted );
+
+	m_bounds = m_nodes[ 0 ].bounds;
+}
+
+/*
+====================================================
+CollisionMesh::Translate
+====================================================
+*/
+void CollisionMesh::Translate( const Vec3 & offset ) {
+	for ( int i = 0; i < (int)m_tris.size(); i++ ) {
+		m_tris[ i ].a += offset;
+		m_tris[ i ].b += offset;
+		m_tris[ i ].c += offset;
+	}
+	for ( int i = 0; i < (int)m_nodes.size(); i++ ) {
+		m_nodes[ i ].bounds.mins += offset;
+		m_nodes[ i ].bounds.maxs += offset;
+	}
+	if ( !m_tris.empty() ) {
+		m_bounds.mins += offset;
+		m_bounds.maxs += offset;
+	}
+}
+
+/*
+====================================================
+CollisionMesh::BuildRecursive
+
+Median split along the longest axis of the centroid bounds.
+Returns the depth of the subtree.
+====================================================
+*/
+int CollisionMesh::BuildRecursive( const int first, const int count, const std::vector< Vec3 > & centroids, std::vector< int > & order ) {
+	const int nodeIdx = (int)m_nodes.size();
+	m_nodes.emplace_back();
+
+	Bounds bounds;
+	Bounds centroidBounds;
+	for ( int i = first; i < first + count; i++ ) {
+		const collisionTri_t & tri = m_tris[ order[ i ] ];
+		bounds.Expand( tri.a );
+		bounds.Expand( tri.b );
+		bounds.Expand( tri.c );
+		centroidBounds.Expand( centroids[ order[ i ] ] );
+	}
+	m_nodes[ nodeIdx ].bounds = bounds;
+
+	if ( count <= MAX_TRIS_PER_LEAF ) {
+		m_nodes[ nodeIdx ].first = first;
+		m_nodes[ nodeIdx ].count = count;
+		return 1;
+	}
+
+	const float widths[ 3 ] = { centroidBounds.WidthX(), centroidBounds.WidthY(), centroidBounds.WidthZ() };
+	int axis = 0;
+	if ( widths[ 1 ] > widths[ axis ] ) {
+		axis = 1;
+	}
+	if ( widths[ 2 ] > widths[ axis ] ) {
+		axis = 2;
+	}
+
+	const int half = count / 2;
+	std::nth_element( order.begin() + first, order.begin() + first + half, order.begin() + first + count, [ & ]( const int lhs, const int rhs ) {
+		return centroids[ lhs ][ axis ] < centroids[ rhs ][ axis ];
+	} );
+
+	const int depthLeft = BuildRecursive( first, half, centroids, order );
+	m_nodes[ nodeIdx ].first = (int)m_nodes.size();
+	m_nodes[ nodeIdx ].count = 0;
+	const int depthRight = BuildRecursive( first + half, count - half, centroids, order );
+
+	const int depth = 1 + std::max( depthLeft, depthRight );
+	assert( depth < MAX_DEPTH );
+	return depth;
+}
@@ -0,0 +1,98 @@
+//
+//	CollisionMesh.h
+//
+#pragma once
+#include "../Math/Vector.h"
+#include "../Math/Bounds.h"
+#include <vector>
+#include <stdint.h>
+
+/*
+====================================================
+collisionTri_t
+====================================================
+*/
+struct collisionTri_t {
+	Vec3 a;
+	Vec3 b;
+	Vec3 c;
+	Vec3 normal;
+};
+
+/*
+====================================================
+CollisionMesh
+
+Static triangle soup for level geometry, with a flattened
+AABB tree built over it.  Nodes are stored depth first so the
+left child of an interior node is always the next node.
+====================================================
+*/
+class CollisionMesh {
+public:
+	CollisionMesh() {}
+
+	void Clear();
+	void AddTriangles( const Vec3 * verts, const int numVerts, const uint32_t * indices, const int numIndices );
+	void Build();
+	void Translate( const Vec3 & offset );	// moves the triangles and the tree without rebuilding it
+
+	bool IsEmpty() const { return m_tris.empty(); }
+	int GetNumTriangles() const { return (int)m_tris.size(); }
+	const collisionTri_t & GetTriangle( const int idx ) const { return m_tris[ idx ]; }
+	const Bounds & GetBounds() const { return m_bounds; }
+
+	// Calls func( triIdx ) for every triangle whose bounds overlap the query bounds
+	template < typename func_t >
+	void Walk( const Bounds & bounds, func_t & func ) const;
+
+private:
+	int BuildRecursive( const int first, const int count, const std::vector< Vec3 > & centroids, std::vector< int > & order );
+
+	struct node_t {
+		Bounds bounds;
+		int first;	// first triangle for leaves, right child for interior nodes
+		int count;	// number of triangles in a leaf, 0 for interior nodes
+	};
+
+	static const int MAX_TRIS_PER_LEAF = 4;
+	static const int MAX_DEPTH = 64;
+
+	std::vector< collisionTri_t > m_tris;
+	std::vector< node_t > m_nodes;
+	Bounds m_bounds;
+};
+
+/*
+====================================================
+CollisionMesh::Walk
+====================================================
+*/
+template < typename func_t >
+inline void CollisionMesh::Walk( const Bounds & bounds, func_t & func ) const {
+	if ( m_nodes.empty() ) {
+		return;
+	}
+
+	int stack[ MAX_DEPTH ];
+	int stackSize = 0;
+	stack[ stackSize++ ] = 0;
+
+	while ( stackSize > 0 ) {
+		const node_t & node = m_nodes[ stack[ --stackSize ] ];
+		if ( !node.bounds.DoesIntersect( bounds ) ) {
+			continue;
+		}
+
+		if ( node.count > 0 ) {
+			for ( int i = 0; i < node.count; i++ ) {
+				func( node.first + i );
+			}
+			continue;
+		}
+
+		const int nodeIdx = (int)( &node - m_nodes.data() );
+		stack[ stackSize++ ] = node.first;
+		stack[ stackSize++ ] = nodeIdx + 1;
+	}
+}
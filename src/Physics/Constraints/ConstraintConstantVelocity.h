@@ -11,7 +11,7 @@ ConstraintConstantVelocity
 */
 class ConstraintConstantVelocity : public Constraint {
 public:
-	ConstraintConstantVelocity() : Constraint(), m_cachedLambda( 2 ), m_Jacobian( 2, 12 ) {
+	ConstraintConstantVelocity() : Constraint() {
 		m_cachedLambda.Zero();
 		m_baumgarte = 0.0f;
 	}
@@ -21,8 +21,8 @@ public:
 
 	Quat m_q0;	// The initial relative quaternion q1 * q2^-1
 
-	VecN m_cachedLambda;
-	MatMN m_Jacobian;
+	Vec< 2 > m_cachedLambda;
+	Mat< 2, 12 > m_Jacobian;
 
 	float m_baumgarte;
 };
@@ -34,7 +34,7 @@ ConstraintConstantVelocityLimited
 */
 class ConstraintConstantVelocityLimited : public Constraint {
 public:
-	ConstraintConstantVelocityLimited() : Constraint(), m_cachedLambda( 4 ), m_Jacobian( 4, 12 ) {
+	ConstraintConstantVelocityLimited() : Constraint() {
 		m_cachedLambda.Zero();
 		m_baumgarte = 0.0f;
 		m_isAngleViolatedU = false;
@@ -48,8 +48,8 @@ public:
 
 	Quat m_q0;	// The initial relative quaternion q1^-1 * q2
 
-	VecN m_cachedLambda;
-	MatMN m_Jacobian;
+	Vec< 4 > m_cachedLambda;
+	Mat< 4, 12 > m_Jacobian;
 
 	float m_baumgarte;
 
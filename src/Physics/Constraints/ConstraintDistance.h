@@ -11,9 +11,7 @@ ConstraintDistance
 */
 class ConstraintDistance : public Constraint {
 public:
-	ConstraintDistance() : Constraint(),
-		m_cachedLambda( 1 ),
-		m_Jacobian( 1, 12 ) {
+	ConstraintDistance() : Constraint() {
 		m_cachedLambda.Zero();
 		m_baumgarte = 0.0f;
 	}
@@ -23,8 +21,8 @@ public:
 	void PostSolve() override;
 
 private:
-	MatMN m_Jacobian;
+	Mat< 1, 12 > m_Jacobian;
 
-	VecN m_cachedLambda;
+	Vec< 1 > m_cachedLambda;
 	float m_baumgarte;
 };
\ No newline at end of file
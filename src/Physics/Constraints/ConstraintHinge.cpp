@@ -3,6 +3,49 @@
 //
 #include "ConstraintHinge.h"
 
+/*
+================================
+SetJacobianRow
+
+Writes the linear and angular terms for both bodies into a row
+of the Jacobian.
+================================
+*/
+template< int ROWS >
+static void SetJacobianRow( Mat< ROWS, 12 > & jacobian, const int row, const Vec3 & J1, const Vec3 & J2, const Vec3 & J3, const Vec3 & J4 ) {
+	jacobian.rows[ row ][ 0 ] = J1.x;
+	jacobian.rows[ row ][ 1 ] = J1.y;
+	jacobian.rows[ row ][ 2 ] = J1.z;
+
+	jacobian.rows[ row ][ 3 ] = J2.x;
+	jacobian.rows[ row ][ 4 ] = J2.y;
+	jacobian.rows[ row ][ 5 ] = J2.z;
+
+	jacobian.rows[ row ][ 6 ] = J3.x;
+	jacobian.rows[ row ][ 7 ] = J3.y;
+	jacobian.rows[ row ][ 8 ] = J3.z;
+
+	jacobian.rows[ row ][ 9 ] = J4.x;
+	jacobian.rows[ row ][ 10 ] = J4.y;
+	jacobian.rows[ row ][ 11 ] = J4.z;
+}
+
+/*
+================================
+AngularRow
+
+Angular Jacobian terms that lock the relative rotation about
+an axis in bodyA's space.
+================================
+*/
+static void AngularRow( const Mat4 & matA, const Mat4 & matB, const Vec3 & axis, Vec3 & J2, Vec3 & J4 ) {
+	Vec4 tmp = matA * Vec4( 0, axis.x, axis.y, axis.z );
+	J2 = Vec3( tmp[ 1 ], tmp[ 2 ], tmp[ 3 ] );
+
+	tmp = matB * Vec4( 0, axis.x, axis.y, axis.z );
+	J4 = Vec3( tmp[ 1 ], tmp[ 2 ], tmp[ 3 ] );
+}
+
 /*
 ================================================================
 
@@ -17,7 +60,64 @@ ConstraintHingeQuat::PreSolve
 ================================
 */
 void ConstraintHingeQuat::PreSolve( const float dt_sec ) {
-	// TODO: Add code
+	// Get the world space position of the anchor points
+	const Vec3 worldAnchorA = m_bodyA->BodySpaceToWorldSpace( m_anchorA );
+	const Vec3 worldAnchorB = m_bodyB->BodySpaceToWorldSpace( m_anchorB );
+
+	const Vec3 r = worldAnchorB - worldAnchorA;
+	const Vec3 ra = worldAnchorA - m_bodyA->GetCenterOfMassWorldSpace();
+	const Vec3 rb = worldAnchorB - m_bodyB->GetCenterOfMassWorldSpace();
+	const Vec3 a = worldAnchorA;
+	const Vec3 b = worldAnchorB;
+
+	const Quat q1 = m_bodyA->m_orientation;
+	const Quat q2 = m_bodyB->m_orientation;
+	const Quat q0_inv = q0.Inverse();
+	const Quat q1_inv = q1.Inverse();
+
+	// The hinge axis is in bodyA's space, the other two axes are locked
+	Vec3 u;
+	Vec3 v;
+	Vec3 hingeAxis = m_axisA;
+	hingeAxis.GetOrtho( u, v );
+
+	Mat4 P;
+	P.rows[ 0 ] = Vec4( 0, 0, 0, 0 );
+	P.rows[ 1 ] = Vec4( 0, 1, 0, 0 );
+	P.rows[ 2 ] = Vec4( 0, 0, 1, 0 );
+	P.rows[ 3 ] = Vec4( 0, 0, 0, 1 );
+	const Mat4 P_T = P.Transpose();
+
+	const Mat4 MatA = P * Left( q1_inv ) * Right( q2 * q0_inv ) * P_T * -0.5f;
+	const Mat4 MatB = P * Left( q1_inv ) * Right( q2 * q0_inv ) * P_T * 0.5f;
+
+	m_Jacobian.Zero();
+
+	// First row is the primary distance constraint that holds the anchor points together
+	SetJacobianRow( m_Jacobian, 0, ( a - b ) * 2.0f, ra.Cross( ( a - b ) * 2.0f ), ( b - a ) * 2.0f, rb.Cross( ( b - a ) * 2.0f ) );
+
+	// The second and third rows lock rotation about the axes perpendicular to the hinge
+	Vec3 J2;
+	Vec3 J4;
+	AngularRow( MatA, MatB, u, J2, J4 );
+	SetJacobianRow( m_Jacobian, 1, Vec3( 0.0f ), J2, Vec3( 0.0f ), J4 );
+
+	AngularRow( MatA, MatB, v, J2, J4 );
+	SetJacobianRow( m_Jacobian, 2, Vec3( 0.0f ), J2, Vec3( 0.0f ), J4 );
+
+	//
+	// Apply warm starting from last frame
+	//
+	const Vec< 12 > impulses = m_Jacobian.TransposeMultiply( m_cachedLambda );
+	ApplyImpulses( impulses );
+
+	//
+	// Calculate the baumgarte stabilization
+	//
+	float C = r.Dot( r );
+	C = std::max( 0.0f, C - 0.01f );
+	const float Beta = 0.05f;
+	m_baumgarte = ( Beta / dt_sec ) * C;
 }
 
 /*
@@ -26,7 +126,22 @@ ConstraintHingeQuat::Solve
 ================================
 */
 void ConstraintHingeQuat::Solve() {
-	// TODO: Add code
+	// Build the system of equations
+	const Vec< 12 > q_dt = GetVelocities();
+	const Mat< 12, 12 > invMassMatrix = GetInverseMassMatrix();
+	const Mat< 3, 3 > J_W_Jt = ( m_Jacobian * invMassMatrix ).MultiplyTranspose( m_Jacobian );
+	Vec< 3 > rhs = m_Jacobian * q_dt * -1.0f;
+	rhs[ 0 ] -= m_baumgarte;
+
+	// Solve for the Lagrange multipliers
+	const Vec< 3 > lambdaN = LCP_GaussSeidel( J_W_Jt, rhs );
+
+	// Apply the impulses
+	const Vec< 12 > impulses = m_Jacobian.TransposeMultiply( lambdaN );
+	ApplyImpulses( impulses );
+
+	// Accumulate the impulses for warm starting
+	m_cachedLambda += lambdaN;
 }
 
 /*
@@ -35,7 +150,19 @@ ConstraintHingeQuat::PostSolve
 ================================
 */
 void ConstraintHingeQuat::PostSolve() {
-	// TODO: Add code
+	// Limit the warm starting to reasonable limits
+	for ( int i = 0; i < m_cachedLambda.N; i++ ) {
+		if ( m_cachedLambda[ i ] * 0.0f != m_cachedLambda[ i ] * 0.0f ) {
+			m_cachedLambda[ i ] = 0.0f;
+		}
+		const float limit = 20.0f;
+		if ( m_cachedLambda[ i ] > limit ) {
+			m_cachedLambda[ i ] = limit;
+		}
+		if ( m_cachedLambda[ i ] < -limit ) {
+			m_cachedLambda[ i ] = -limit;
+		}
+	}
 }
 
 /*
@@ -52,7 +179,81 @@ ConstraintHingeQuatLimited::PreSolve
 ================================
 */
 void ConstraintHingeQuatLimited::PreSolve( const float dt_sec ) {
-	// TODO: Add code
+	// Get the world space position of the anchor points
+	const Vec3 worldAnchorA = m_bodyA->BodySpaceToWorldSpace( m_anchorA );
+	const Vec3 worldAnchorB = m_bodyB->BodySpaceToWorldSpace( m_anchorB );
+
+	const Vec3 r = worldAnchorB - worldAnchorA;
+	const Vec3 ra = worldAnchorA - m_bodyA->GetCenterOfMassWorldSpace();
+	const Vec3 rb = worldAnchorB - m_bodyB->GetCenterOfMassWorldSpace();
+	const Vec3 a = worldAnchorA;
+	const Vec3 b = worldAnchorB;
+
+	const Quat q1 = m_bodyA->m_orientation;
+	const Quat q2 = m_bodyB->m_orientation;
+	const Quat q0_inv = m_q0.Inverse();
+	const Quat q1_inv = q1.Inverse();
+
+	// The hinge axis is in bodyA's space, the other two axes are locked
+	Vec3 u;
+	Vec3 v;
+	Vec3 hingeAxis = m_axisA;
+	hingeAxis.GetOrtho( u, v );
+
+	Mat4 P;
+	P.rows[ 0 ] = Vec4( 0, 0, 0, 0 );
+	P.rows[ 1 ] = Vec4( 0, 1, 0, 0 );
+	P.rows[ 2 ] = Vec4( 0, 0, 1, 0 );
+	P.rows[ 3 ] = Vec4( 0, 0, 0, 1 );
+	const Mat4 P_T = P.Transpose();
+
+	const Mat4 MatA = P * Left( q1_inv ) * Right( q2 * q0_inv ) * P_T * -0.5f;
+	const Mat4 MatB = P * Left( q1_inv ) * Right( q2 * q0_inv ) * P_T * 0.5f;
+
+	// Get the relative angle about the hinge axis, in degrees
+	const Quat qr = q1_inv * q2;
+	const Quat qrr = qr * q0_inv;
+	const Vec3 axis = qrr.xyz();
+	const float halfSine = std::min( 1.0f, std::max( -1.0f, axis.Dot( hingeAxis ) ) );
+	m_relativeAngle = ElecNeko::Degrees( 2.0f * asinf( halfSine ) );
+
+	// Check if there's an angle violation
+	const float angleLimit = 45.0f;
+	m_isAngleViolated = ( m_relativeAngle > angleLimit ) || ( m_relativeAngle < -angleLimit );
+
+	m_Jacobian.Zero();
+
+	// First row is the primary distance constraint that holds the anchor points together
+	SetJacobianRow( m_Jacobian, 0, ( a - b ) * 2.0f, ra.Cross( ( a - b ) * 2.0f ), ( b - a ) * 2.0f, rb.Cross( ( b - a ) * 2.0f ) );
+
+	// The second and third rows lock rotation about the axes perpendicular to the hinge
+	Vec3 J2;
+	Vec3 J4;
+	AngularRow( MatA, MatB, u, J2, J4 );
+	SetJacobianRow( m_Jacobian, 1, Vec3( 0.0f ), J2, Vec3( 0.0f ), J4 );
+
+	AngularRow( MatA, MatB, v, J2, J4 );
+	SetJacobianRow( m_Jacobian, 2, Vec3( 0.0f ), J2, Vec3( 0.0f ), J4 );
+
+	// The fourth row stops rotation about the hinge once it's past the limit
+	if ( m_isAngleViolated ) {
+		AngularRow( MatA, MatB, hingeAxis, J2, J4 );
+		SetJacobianRow( m_Jacobian, 3, Vec3( 0.0f ), J2, Vec3( 0.0f ), J4 );
+	}
+
+	//
+	// Apply warm starting from last frame
+	//
+	const Vec< 12 > impulses = m_Jacobian.TransposeMultiply( m_cachedLambda );
+	ApplyImpulses( impulses );
+
+	//
+	// Calculate the baumgarte stabilization
+	//
+	float C = r.Dot( r );
+	C = std::max( 0.0f, C - 0.01f );
+	const float Beta = 0.05f;
+	m_baumgarte = ( Beta / dt_sec ) * C;
 }
 
 /*
@@ -61,7 +262,32 @@ ConstraintHingeQuatLimited::Solve
 ================================
 */
 void ConstraintHingeQuatLimited::Solve() {
-	// TODO: Add code
+	// Build the system of equations
+	const Vec< 12 > q_dt = GetVelocities();
+	const Mat< 12, 12 > invMassMatrix = GetInverseMassMatrix();
+	const Mat< 4, 4 > J_W_Jt = ( m_Jacobian * invMassMatrix ).MultiplyTranspose( m_Jacobian );
+	Vec< 4 > rhs = m_Jacobian * q_dt * -1.0f;
+	rhs[ 0 ] -= m_baumgarte;
+
+	// Solve for the Lagrange multipliers
+	Vec< 4 > lambdaN = LCP_GaussSeidel( J_W_Jt, rhs );
+
+	// Clamp the torque from the angle constraint, it may only push back towards the limit
+	if ( m_isAngleViolated ) {
+		if ( m_relativeAngle > 0.0f ) {
+			lambdaN[ 3 ] = std::min( 0.0f, lambdaN[ 3 ] );
+		}
+		if ( m_relativeAngle < 0.0f ) {
+			lambdaN[ 3 ] = std::max( 0.0f, lambdaN[ 3 ] );
+		}
+	}
+
+	// Apply the impulses
+	const Vec< 12 > impulses = m_Jacobian.TransposeMultiply( lambdaN );
+	ApplyImpulses( impulses );
+
+	// Accumulate the impulses for warm starting
+	m_cachedLambda += lambdaN;
 }
 
 /*
@@ -70,5 +296,17 @@ ConstraintHingeQuatLimited::PostSolve
 ================================
 */
 void ConstraintHingeQuatLimited::PostSolve() {
-	// TODO: Add code
-}
\ No newline at end of file
+	// Limit the warm starting to reasonable limits
+	for ( int i = 0; i < m_cachedLambda.N; i++ ) {
+		if ( m_cachedLambda[ i ] * 0.0f != m_cachedLambda[ i ] * 0.0f ) {
+			m_cachedLambda[ i ] = 0.0f;
+		}
+		const float limit = 20.0f;
+		if ( m_cachedLambda[ i ] > limit ) {
+			m_cachedLambda[ i ] = limit;
+		}
+		if ( m_cachedLambda[ i ] < -limit ) {
+			m_cachedLambda[ i ] = -limit;
+		}
+	}
+}
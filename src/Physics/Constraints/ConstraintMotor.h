@@ -11,7 +11,7 @@ ConstraintMotor
 */
 class ConstraintMotor : public Constraint {
 public:
-	ConstraintMotor() : Constraint(), m_Jacobian( 4, 12 ) {
+	ConstraintMotor() : Constraint() {
 		m_motorSpeed = 0.0f;
 		m_motorAxis = Vec3( 0, 0, 1 );
 		m_baumgarte = 0.0f;
@@ -24,7 +24,7 @@ public:
 	Vec3 m_motorAxis;	// Motor Axis in BodyA's local space
 	Quat m_q0;		// The initial relative quaternion q1^-1 * q2
 
-	MatMN m_Jacobian;
+	Mat< 4, 12 > m_Jacobian;
 
 	Vec3 m_baumgarte;
 };
\ No newline at end of file
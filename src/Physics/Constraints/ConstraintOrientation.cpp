@@ -9,7 +9,78 @@ ConstraintOrientation::PreSolve
 ================================
 */
 void ConstraintOrientation::PreSolve( const float dt_sec ) {
-	// TODO: Add code
+	// Get the world space position of the anchor points
+	const Vec3 worldAnchorA = m_bodyA->BodySpaceToWorldSpace( m_anchorA );
+	const Vec3 worldAnchorB = m_bodyB->BodySpaceToWorldSpace( m_anchorB );
+
+	const Vec3 r = worldAnchorB - worldAnchorA;
+	const Vec3 ra = worldAnchorA - m_bodyA->GetCenterOfMassWorldSpace();
+	const Vec3 rb = worldAnchorB - m_bodyB->GetCenterOfMassWorldSpace();
+	const Vec3 a = worldAnchorA;
+	const Vec3 b = worldAnchorB;
+
+	const Quat q1 = m_bodyA->m_orientation;
+	const Quat q2 = m_bodyB->m_orientation;
+	const Quat q0_inv = m_q0.Inverse();
+	const Quat q1_inv = q1.Inverse();
+
+	Mat4 P;
+	P.rows[ 0 ] = Vec4( 0, 0, 0, 0 );
+	P.rows[ 1 ] = Vec4( 0, 1, 0, 0 );
+	P.rows[ 2 ] = Vec4( 0, 0, 1, 0 );
+	P.rows[ 3 ] = Vec4( 0, 0, 0, 1 );
+	const Mat4 P_T = P.Transpose();
+
+	const Mat4 MatA = P * Left( q1_inv ) * Right( q2 * q0_inv ) * P_T * -0.5f;
+	const Mat4 MatB = P * Left( q1_inv ) * Right( q2 * q0_inv ) * P_T * 0.5f;
+
+	m_Jacobian.Zero();
+
+	// First row is the primary distance constraint that holds the anchor points together
+	Vec3 J1 = ( a - b ) * 2.0f;
+	m_Jacobian.rows[ 0 ][ 0 ] = J1.x;
+	m_Jacobian.rows[ 0 ][ 1 ] = J1.y;
+	m_Jacobian.rows[ 0 ][ 2 ] = J1.z;
+
+	Vec3 J2 = ra.Cross( ( a - b ) * 2.0f );
+	m_Jacobian.rows[ 0 ][ 3 ] = J2.x;
+	m_Jacobian.rows[ 0 ][ 4 ] = J2.y;
+	m_Jacobian.rows[ 0 ][ 5 ] = J2.z;
+
+	Vec3 J3 = ( b - a ) * 2.0f;
+	m_Jacobian.rows[ 0 ][ 6 ] = J3.x;
+	m_Jacobian.rows[ 0 ][ 7 ] = J3.y;
+	m_Jacobian.rows[ 0 ][ 8 ] = J3.z;
+
+	Vec3 J4 = rb.Cross( ( b - a ) * 2.0f );
+	m_Jacobian.rows[ 0 ][ 9 ] = J4.x;
+	m_Jacobian.rows[ 0 ][ 10 ] = J4.y;
+	m_Jacobian.rows[ 0 ][ 11 ] = J4.z;
+
+	// The other three rows lock the relative rotation about every axis
+	const Vec3 axes[ 3 ] = { Vec3( 1, 0, 0 ), Vec3( 0, 1, 0 ), Vec3( 0, 0, 1 ) };
+	for ( int i = 0; i < 3; i++ ) {
+		const int row = i + 1;
+		const Vec4 axis( 0, axes[ i ].x, axes[ i ].y, axes[ i ].z );
+
+		Vec4 tmp = MatA * axis;
+		m_Jacobian.rows[ row ][ 3 ] = tmp[ 1 ];
+		m_Jacobian.rows[ row ][ 4 ] = tmp[ 2 ];
+		m_Jacobian.rows[ row ][ 5 ] = tmp[ 3 ];
+
+		tmp = MatB * axis;
+		m_Jacobian.rows[ row ][ 9 ] = tmp[ 1 ];
+		m_Jacobian.rows[ row ][ 10 ] = tmp[ 2 ];
+		m_Jacobian.rows[ row ][ 11 ] = tmp[ 3 ];
+	}
+
+	//
+	// Calculate the baumgarte stabilization
+	//
+	float C = r.Dot( r );
+	C = std::max( 0.0f, C - 0.01f );
+	const float Beta = 0.05f;
+	m_baumgarte = ( Beta / dt_sec ) * C;
 }
 
 /*
@@ -18,5 +89,17 @@ ConstraintOrientation::Solve
 ================================
 */
 void ConstraintOrientation::Solve() {
-	// TODO: Add code
-}
\ No newline at end of file
+	// Build the system of equations
+	const Vec< 12 > q_dt = GetVelocities();
+	const Mat< 12, 12 > invMassMatrix = GetInverseMassMatrix();
+	const Mat< 4, 4 > J_W_Jt = ( m_Jacobian * invMassMatrix ).MultiplyTranspose( m_Jacobian );
+	Vec< 4 > rhs = m_Jacobian * q_dt * -1.0f;
+	rhs[ 0 ] -= m_baumgarte;
+
+	// Solve for the Lagrange multipliers
+	const Vec< 4 > lambdaN = LCP_GaussSeidel( J_W_Jt, rhs );
+
+	// Apply the impulses
+	const Vec< 12 > impulses = m_Jacobian.TransposeMultiply( lambdaN );
+	ApplyImpulses( impulses );
+}
@@ -11,7 +11,7 @@ ConstraintOrientation
 */
 class ConstraintOrientation : public Constraint {
 public:
-	ConstraintOrientation() : Constraint(), m_Jacobian( 4, 12 ) {
+	ConstraintOrientation() : Constraint() {
 		m_baumgarte = 0.0f;
 	}
 
@@ -20,7 +20,7 @@ public:
 
 	Quat m_q0;			// The initial relative quaternion q1^-1 * q2
 
-	MatMN m_Jacobian;
+	Mat< 4, 12 > m_Jacobian;
 
 	float m_baumgarte;
 };
\ No newline at end of file
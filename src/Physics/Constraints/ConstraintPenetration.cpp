@@ -9,14 +9,174 @@ ConstraintPenetration::PreSolve
 ================================
 */
 void ConstraintPenetration::PreSolve( const float dt_sec ) {
-	// TODO: Add code
+	// Get the world space position of the hit point
+	const Vec3 worldAnchorA = m_bodyA->BodySpaceToWorldSpace( m_anchorA );
+	const Vec3 worldAnchorB = m_bodyB->BodySpaceToWorldSpace( m_anchorB );
+
+	const Vec3 ra = worldAnchorA - m_bodyA->GetCenterOfMassWorldSpace();
+	const Vec3 rb = worldAnchorB - m_bodyB->GetCenterOfMassWorldSpace();
+	const Vec3 a = worldAnchorA;
+	const Vec3 b = worldAnchorB;
+
+	const float frictionA = m_bodyA->m_friction;
+	const float frictionB = m_bodyB->m_friction;
+	m_friction = frictionA * frictionB;
+
+	Vec3 u;
+	Vec3 v;
+	m_normal.GetOrtho( u, v );
+
+	// Convert tangent space from model space to world space, the normal points from A to B
+	Vec3 normal = m_bodyA->m_orientation.RotatePoint( m_normal );
+	u = m_bodyA->m_orientation.RotatePoint( u );
+	v = m_bodyA->m_orientation.RotatePoint( v );
+
+	//
+	// Penetration Constraint
+	//
+	m_Jacobian.Zero();
+
+	// First row is the primary distance constraint that holds the anchor points together
+	Vec3 J1 = normal * -1.0f;
+	m_Jacobian.rows[ 0 ][ 0 ] = J1.x;
+	m_Jacobian.rows[ 0 ][ 1 ] = J1.y;
+	m_Jacobian.rows[ 0 ][ 2 ] = J1.z;
+
+	Vec3 J2 = ra.Cross( normal * -1.0f );
+	m_Jacobian.rows[ 0 ][ 3 ] = J2.x;
+	m_Jacobian.rows[ 0 ][ 4 ] = J2.y;
+	m_Jacobian.rows[ 0 ][ 5 ] = J2.z;
+
+	Vec3 J3 = normal * 1.0f;
+	m_Jacobian.rows[ 0 ][ 6 ] = J3.x;
+	m_Jacobian.rows[ 0 ][ 7 ] = J3.y;
+	m_Jacobian.rows[ 0 ][ 8 ] = J3.z;
+
+	Vec3 J4 = rb.Cross( normal * 1.0f );
+	m_Jacobian.rows[ 0 ][ 9 ] = J4.x;
+	m_Jacobian.rows[ 0 ][ 10 ] = J4.y;
+	m_Jacobian.rows[ 0 ][ 11 ] = J4.z;
+
+	//
+	// Friction Jacobians
+	//
+	if ( m_friction > 0.0f ) {
+		Vec3 J1 = u * -1.0f;
+		m_Jacobian.rows[ 1 ][ 0 ] = J1.x;
+		m_Jacobian.rows[ 1 ][ 1 ] = J1.y;
+		m_Jacobian.rows[ 1 ][ 2 ] = J1.z;
+
+		Vec3 J2 = ra.Cross( u * -1.0f );
+		m_Jacobian.rows[ 1 ][ 3 ] = J2.x;
+		m_Jacobian.rows[ 1 ][ 4 ] = J2.y;
+		m_Jacobian.rows[ 1 ][ 5 ] = J2.z;
+
+		Vec3 J3 = u * 1.0f;
+		m_Jacobian.rows[ 1 ][ 6 ] = J3.x;
+		m_Jacobian.rows[ 1 ][ 7 ] = J3.y;
+		m_Jacobian.rows[ 1 ][ 8 ] = J3.z;
+
+		Vec3 J4 = rb.Cross( u * 1.0f );
+		m_Jacobian.rows[ 1 ][ 9 ] = J4.x;
+		m_Jacobian.rows[ 1 ][ 10 ] = J4.y;
+		m_Jacobian.rows[ 1 ][ 11 ] = J4.z;
+	}
+	if ( m_friction > 0.0f ) {
+		Vec3 J1 = v * -1.0f;
+		m_Jacobian.rows[ 2 ][ 0 ] = J1.x;
+		m_Jacobian.rows[ 2 ][ 1 ] = J1.y;
+		m_Jacobian.rows[ 2 ][ 2 ] = J1.z;
+
+		Vec3 J2 = ra.Cross( v * -1.0f );
+		m_Jacobian.rows[ 2 ][ 3 ] = J2.x;
+		m_Jacobian.rows[ 2 ][ 4 ] = J2.y;
+		m_Jacobian.rows[ 2 ][ 5 ] = J2.z;
+
+		Vec3 J3 = v * 1.0f;
+		m_Jacobian.rows[ 2 ][ 6 ] = J3.x;
+		m_Jacobian.rows[ 2 ][ 7 ] = J3.y;
+		m_Jacobian.rows[ 2 ][ 8 ] = J3.z;
+
+		Vec3 J4 = rb.Cross( v * 1.0f );
+		m_Jacobian.rows[ 2 ][ 9 ] = J4.x;
+		m_Jacobian.rows[ 2 ][ 10 ] = J4.y;
+		m_Jacobian.rows[ 2 ][ 11 ] = J4.z;
+	}
+
+	//
+	//	Calculate the stabilization.  A positive C is a speculative contact,
+	//	the bodies may still close C this step but no more.  A negative C is
+	//	penetration and is pushed out gradually with baumgarte stabilization.
+	//
+	const float C = ( b - a ).Dot( normal );
+	m_isSpeculative = ( C > 0.0f );
+	if ( m_isSpeculative ) {
+		m_baumgarte = C / dt_sec;
+
+		// Warm starting a contact that isn't touching would push the bodies apart early
+		m_cachedLambda.Zero();
+	} else {
+		const float Beta = 0.25f;
+		m_baumgarte = Beta * std::min( 0.0f, C + 0.02f ) / dt_sec;	// Add slop
+
+		//
+		// Apply warm starting from last frame
+		//
+		const Vec< 12 > impulses = m_Jacobian.TransposeMultiply( m_cachedLambda );
+		ApplyImpulses( impulses );
+	}
 }
 
 /*
 ================================
-ConstraintPenetration::PreSolve
+ConstraintPenetration::Solve
 ================================
 */
 void ConstraintPenetration::Solve() {
-	// TODO: Add code
-}
\ No newline at end of file
+	// Build the system of equations
+	const Vec< 12 > q_dt = GetVelocities();
+	const Mat< 12, 12 > invMassMatrix = GetInverseMassMatrix();
+	const Mat< 3, 3 > J_W_Jt = ( m_Jacobian * invMassMatrix ).MultiplyTranspose( m_Jacobian );
+	Vec< 3 > rhs = m_Jacobian * q_dt * -1.0f;
+	rhs[ 0 ] -= m_baumgarte;
+
+	// Solve for the Lagrange multipliers
+	Vec< 3 > lambdaN = LCP_GaussSeidel( J_W_Jt, rhs );
+
+	// Accumulate the impulses and clamp to within the constraint limits
+	Vec< 3 > oldLambda = m_cachedLambda;
+	m_cachedLambda += lambdaN;
+	const float lambdaLimit = 0.0f;
+	if ( m_cachedLambda[ 0 ] < lambdaLimit ) {
+		m_cachedLambda[ 0 ] = lambdaLimit;
+	}
+	if ( m_friction > 0.0f ) {
+		const float umg = m_friction * 10.0f * 1.0f / ( m_bodyA->m_invMass + m_bodyB->m_invMass );
+		const float normalForce = fabsf( lambdaN[ 0 ] * m_friction );
+		float maxForce = ( umg > normalForce ) ? umg : normalForce;
+
+		// No friction until a speculative contact actually pushes back
+		if ( m_isSpeculative ) {
+			maxForce = m_friction * m_cachedLambda[ 0 ];
+		}
+
+		if ( m_cachedLambda[ 1 ] > maxForce ) {
+			m_cachedLambda[ 1 ] = maxForce;
+		}
+		if ( m_cachedLambda[ 1 ] < -maxForce ) {
+			m_cachedLambda[ 1 ] = -maxForce;
+		}
+
+		if ( m_cachedLambda[ 2 ] > maxForce ) {
+			m_cachedLambda[ 2 ] = maxForce;
+		}
+		if ( m_cachedLambda[ 2 ] < -maxForce ) {
+			m_cachedLambda[ 2 ] = -maxForce;
+		}
+	}
+	lambdaN = m_cachedLambda - oldLambda;
+
+	// Apply the impulses
+	const Vec< 12 > impulses = m_Jacobian.TransposeMultiply( lambdaN );
+	ApplyImpulses( impulses );
+}
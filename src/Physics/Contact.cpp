@@ -6,8 +6,94 @@
 /*
 ====================================================
 ResolveContact
+
+Instantaneous impulse response for a single contact.  The contact
+normal points from A to B.
 ====================================================
 */
 void ResolveContact( contact_t & contact ) {
-	// TODO: Add Code
-}
\ No newline at end of file
+	Body * bodyA = contact.bodyA;
+	Body * bodyB = contact.bodyB;
+
+	const Vec3 ptOnA = bodyA->BodySpaceToWorldSpace( contact.ptOnA_LocalSpace );
+	const Vec3 ptOnB = bodyB->BodySpaceToWorldSpace( contact.ptOnB_LocalSpace );
+
+	const float elasticityA = bodyA->m_elasticity;
+	const float elasticityB = bodyB->m_elasticity;
+	const float elasticity = elasticityA * elasticityB;
+
+	const float invMassA = bodyA->m_invMass;
+	const float invMassB = bodyB->m_invMass;
+	if ( 0.0f == invMassA + invMassB ) {
+		return;
+	}
+
+	const Mat3 invWorldInertiaA = bodyA->GetInverseInertiaTensorWorldSpace();
+	const Mat3 invWorldInertiaB = bodyB->GetInverseInertiaTensorWorldSpace();
+
+	const Vec3 & n = contact.normal;
+
+	const Vec3 ra = ptOnA - bodyA->GetCenterOfMassWorldSpace();
+	const Vec3 rb = ptOnB - bodyB->GetCenterOfMassWorldSpace();
+
+	const Vec3 angularJA = ( invWorldInertiaA * ra.Cross( n ) ).Cross( ra );
+	const Vec3 angularJB = ( invWorldInertiaB * rb.Cross( n ) ).Cross( rb );
+	const float angularFactor = ( angularJA + angularJB ).Dot( n );
+
+	// Get the world space velocity of the motion and rotation
+	const Vec3 velA = bodyA->m_linearVelocity + bodyA->m_angularVelocity.Cross( ra );
+	const Vec3 velB = bodyB->m_linearVelocity + bodyB->m_angularVelocity.Cross( rb );
+
+	// Calculate the collision impulse, only if the bodies are moving towards each other
+	const Vec3 vab = velA - velB;
+	const float approachSpeed = vab.Dot( n );
+	if ( approachSpeed <= 0.0f ) {
+		return;
+	}
+	const float impulseJ = ( 1.0f + elasticity ) * approachSpeed / ( invMassA + invMassB + angularFactor );
+	const Vec3 vectorImpulseJ = n * impulseJ;
+
+	bodyA->ApplyImpulse( ptOnA, vectorImpulseJ * -1.0f );
+	bodyB->ApplyImpulse( ptOnB, vectorImpulseJ * 1.0f );
+
+	//
+	// Calculate the impulse caused by friction
+	//
+	const float frictionA = bodyA->m_friction;
+	const float frictionB = bodyB->m_friction;
+	const float friction = frictionA * frictionB;
+
+	// Find the normal direction of the velocity with respect to the normal of the collision
+	const Vec3 velNorm = n * n.Dot( vab );
+
+	// Find the tangent direction of the velocity with respect to the normal of the collision
+	const Vec3 velTang = vab - velNorm;
+
+	// Get the tangential velocities relative to the other body
+	Vec3 relativeVelTang = velTang;
+	relativeVelTang.Normalize();
+
+	const Vec3 inertiaA = ( invWorldInertiaA * ra.Cross( relativeVelTang ) ).Cross( ra );
+	const Vec3 inertiaB = ( invWorldInertiaB * rb.Cross( relativeVelTang ) ).Cross( rb );
+	const float invInertia = ( inertiaA + inertiaB ).Dot( relativeVelTang );
+
+	// Calculate the tangential impulse for friction
+	const float reducedMass = 1.0f / ( bodyA->m_invMass + bodyB->m_invMass + invInertia );
+	const Vec3 impulseFriction = velTang * reducedMass * friction;
+
+	// Apply kinetic friction
+	bodyA->ApplyImpulse( ptOnA, impulseFriction * -1.0f );
+	bodyB->ApplyImpulse( ptOnB, impulseFriction * 1.0f );
+
+	//
+	// Let's also move our colliding objects to just outside of each other (projection method)
+	//
+	if ( contact.separationDistance < 0.0f ) {
+		const float tA = bodyA->m_invMass / ( bodyA->m_invMass + bodyB->m_invMass );
+		const float tB = bodyB->m_invMass / ( bodyA->m_invMass + bodyB->m_invMass );
+
+		const Vec3 ds = n * contact.separationDistance;
+		bodyA->m_position += ds * tA;
+		bodyB->m_position -= ds * tB;
+	}
+}
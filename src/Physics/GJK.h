@@ -12,3 +12,4 @@
 bool GJK_DoesIntersect( const Body * bodyA, const Body * bodyB );
 bool GJK_DoesIntersect( const Body * bodyA, const Body * bodyB, const float bias, Vec3 & ptOnA, Vec3 & ptOnB );
 void GJK_ClosestPoints( const Body * bodyA, const Body * bodyB, Vec3 & ptOnA, Vec3 & ptOnB );
+void GJK_ClosestPoints( const Vec3 & segStart, const Vec3 & segEnd, const Body * body, Vec3 & ptOnSegment, Vec3 & ptOnBody );	// the segment against a convex body
@@ -6,44 +6,152 @@
 
 /*
 ====================================================
-Intersect
+SphereSphereContact
+
+Fills out the contact for a pair of spheres, the normal points from A to B.
 ====================================================
 */
-bool Intersect( Body * bodyA, Body * bodyB, contact_t & contact ) {
-	// TODO: Add Code
+static void SphereSphereContact( Body * bodyA, Body * bodyB, contact_t & contact ) {
+	const ShapeSphere * sphereA = (const ShapeSphere *)bodyA->m_shape;
+	const ShapeSphere * sphereB = (const ShapeSphere *)bodyB->m_shape;
 
-	return false;
+	const Vec3 ab = bodyB->m_position - bodyA->m_position;
+	const float dist = ab.GetMagnitude();
+
+	contact.normal = ( dist > 1e-6f ) ? ab / dist : Vec3( 0, 0, 1 );
+	contact.ptOnA_WorldSpace = bodyA->m_position + contact.normal * sphereA->m_radius;
+	contact.ptOnB_WorldSpace = bodyB->m_position - contact.normal * sphereB->m_radius;
+	contact.separationDistance = dist - ( sphereA->m_radius + sphereB->m_radius );
 }
 
 /*
 ====================================================
-Intersect
+FinishContact
 ====================================================
 */
-bool Intersect( Body * bodyA, Body * bodyB, const float dt, contact_t & contact ) {
-	// TODO: Add Code
-
-	return false;
+static void FinishContact( contact_t & contact ) {
+	contact.ptOnA_LocalSpace = contact.bodyA->WorldSpaceToBodySpace( contact.ptOnA_WorldSpace );
+	contact.ptOnB_LocalSpace = contact.bodyB->WorldSpaceToBodySpace( contact.ptOnB_WorldSpace );
 }
 
+/*
+====================================================
+Intersect
 
+Finds contacts between overlapping bodies.  The contact normal
+always points from A to B.
+====================================================
+*/
+bool Intersect( Body * bodyA, Body * bodyB, contact_t & contact ) {
+	contact.bodyA = bodyA;
+	contact.bodyB = bodyB;
+	contact.timeOfImpact = 0.0f;
+
+	if ( bodyA->m_shape->GetType() == Shape::SHAPE_SPHERE && bodyB->m_shape->GetType() == Shape::SHAPE_SPHERE ) {
+		SphereSphereContact( bodyA, bodyB, contact );
+		if ( contact.separationDistance > 0.0f ) {
+			return false;
+		}
+		FinishContact( contact );
+		return true;
+	}
+
+	Vec3 ptOnA;
+	Vec3 ptOnB;
+	const float bias = 0.001f;
+	if ( !GJK_DoesIntersect( bodyA, bodyB, bias, ptOnA, ptOnB ) ) {
+		return false;
+	}
+
+	// The witness points are on the shapes grown by the bias, pull them back to the real surfaces.
+	// ptOnA is inside of B and ptOnB is inside of A, so A to B is from ptOnB to ptOnA.
+	Vec3 normal = ptOnA - ptOnB;
+	normal.Normalize();
+
+	ptOnA -= normal * bias;
+	ptOnB += normal * bias;
+
+	contact.normal = normal;
+	contact.ptOnA_WorldSpace = ptOnA;
+	contact.ptOnB_WorldSpace = ptOnB;
+	contact.separationDistance = ( ptOnB - ptOnA ).Dot( normal );
+	FinishContact( contact );
+	return true;
+}
 
+/*
+====================================================
+SpeculativeMargin
 
+How far apart the pair can be and still touch by the end of the step,
+from the closing speed along the contact normal.  Rotation adds the
+fastest speed of any point on the shape.
+====================================================
+*/
+static float SpeculativeMargin( const Body * bodyA, const Body * bodyB, const Vec3 & normal, const float dt ) {
+	const Vec3 relativeVelocity = bodyA->m_linearVelocity - bodyB->m_linearVelocity;
+	float closingSpeed = relativeVelocity.Dot( normal );
+	closingSpeed += bodyA->m_shape->FastestLinearSpeed( bodyA->m_angularVelocity, normal );
+	closingSpeed += bodyB->m_shape->FastestLinearSpeed( bodyB->m_angularVelocity, normal * -1.0f );
+	if ( closingSpeed < 0.0f ) {
+		return 0.0f;
+	}
+	return closingSpeed * dt;
+}
 
+/*
+====================================================
+Intersect
 
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
+Speculative version.  If either body opted into speculative contacts,
+a contact with a positive separation is also generated when the pair
+is close enough to touch within dt.  The solver only removes the part
+of the approach velocity that would close more than the gap, so fast
+bodies can't tunnel and no time of impact search is needed.
+====================================================
+*/
+bool Intersect( Body * bodyA, Body * bodyB, const float dt, contact_t & contact ) {
+	if ( !bodyA->m_useSpeculativeContacts && !bodyB->m_useSpeculativeContacts ) {
+		return Intersect( bodyA, bodyB, contact );
+	}
+
+	contact.bodyA = bodyA;
+	contact.bodyB = bodyB;
+	contact.timeOfImpact = 0.0f;
+
+	if ( bodyA->m_shape->GetType() == Shape::SHAPE_SPHERE && bodyB->m_shape->GetType() == Shape::SHAPE_SPHERE ) {
+		SphereSphereContact( bodyA, bodyB, contact );
+		if ( contact.separationDistance > SpeculativeMargin( bodyA, bodyB, contact.normal, dt ) ) {
+			return false;
+		}
+		FinishContact( contact );
+		return true;
+	}
+
+	if ( Intersect( bodyA, bodyB, contact ) ) {
+		return true;
+	}
+
+	// Not touching yet, see if they will be by the end of the step
+	Vec3 ptOnA;
+	Vec3 ptOnB;
+	GJK_ClosestPoints( bodyA, bodyB, ptOnA, ptOnB );
+
+	const Vec3 ab = ptOnB - ptOnA;
+	const float dist = ab.GetMagnitude();
+	if ( dist < 1e-6f ) {
+		return false;
+	}
+
+	const Vec3 normal = ab / dist;
+	if ( dist > SpeculativeMargin( bodyA, bodyB, normal, dt ) ) {
+		return false;
+	}
+
+	contact.normal = normal;
+	contact.ptOnA_WorldSpace = ptOnA;
+	contact.ptOnB_WorldSpace = ptOnB;
+	contact.separationDistance = dist;
+	FinishContact( contact );
+	return true;
+}
@@ -56,6 +56,7 @@ public:
 
 	void RemoveExpired();
 	void Clear() { m_manifolds.clear(); }	// For resetting the demo
+	void Translate( const Vec3 & offset );	// For moving the scene origin
 
 public:
 	std::vector< Manifold > m_manifolds;
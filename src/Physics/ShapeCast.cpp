@@ -0,0 +1,746 @@
+//
+//  ShapeCast.cpp
+//
+#include "ShapeCast.h"
+#include "GJK.h"
+#include "../Parallel.h"
+#include <algorithm>
+
+static const int MAX_ADVANCE_ITERATIONS = 32;
+static const float ADVANCE_TOLERANCE = 1e-4f;
+static const float TIE_FRACTION = 1e-3f;
+static const int MAX_DEPENETRATION_ITERATIONS = 4;
+static const int CASTS_PER_CHUNK = 4;
+
+/*
+================================================================================================
+
+Closest point helpers
+
+================================================================================================
+*/
+
+/*
+====================================================
+ClosestPtPointSegment
+====================================================
+*/
+static Vec3 ClosestPtPointSegment( const Vec3 & pt, const Vec3 & a, const Vec3 & b ) {
+	const Vec3 ab = b - a;
+	const float lengthSqr = ab.GetLengthSqr();
+	if ( lengthSqr < 1e-12f ) {
+		return a;
+	}
+
+	float t = ( pt - a ).Dot( ab ) / lengthSqr;
+	t = std::max( 0.0f, std::min( 1.0f, t ) );
+	return a + ab * t;
+}
+
+/*
+====================================================
+ClosestPtPointTriangle
+
+Walks the voronoi regions of the triangle
+====================================================
+*/
+static Vec3 ClosestPtPointTriangle( const Vec3 & pt, const Vec3 & a, const Vec3 & b, const Vec3 & c ) {
+	const Vec3 ab = b - a;
+	const Vec3 ac = c - a;
+
+	const Vec3 ap = pt - a;
+	const float d1 = ab.Dot( ap );
+	const float d2 = ac.Dot( ap );
+	if ( d1 <= 0.0f && d2 <= 0.0f ) {
+		return a;
+	}
+
+	const Vec3 bp = pt - b;
+	const float d3 = ab.Dot( bp );
+	const float d4 = ac.Dot( bp );
+	if ( d3 >= 0.0f && d4 <= d3 ) {
+		return b;
+	}
+
+	const float vc = d1 * d4 - d3 * d2;
+	if ( vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f ) {
+		return a + ab * ( d1 / ( d1 - d3 ) );
+	}
+
+	const Vec3 cp = pt - c;
+	const float d5 = ab.Dot( cp );
+	const float d6 = ac.Dot( cp );
+	if ( d6 >= 0.0f && d5 <= d6 ) {
+		return c;
+	}
+
+	const float vb = d5 * d2 - d1 * d6;
+	if ( vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f ) {
+		return a + ac * ( d2 / ( d2 - d6 ) );
+	}
+
+	const float va = d3 * d6 - d5 * d4;
+	if ( va <= 0.0f && ( d4 - d3 ) >= 0.0f && ( d5 - d6 ) >= 0.0f ) {
+		return b + ( c - b ) * ( ( d4 - d3 ) / ( ( d4 - d3 ) + ( d5 - d6 ) ) );
+	}
+
+	const float invDenom = 1.0f / ( va + vb + vc );
+	return a + ab * ( vb * invDenom ) + ac * ( vc * invDenom );
+}
+
+/*
+====================================================
+ClosestPtSegmentSegment
+
+Returns the squared distance between the two segments
+====================================================
+*/
+static float ClosestPtSegmentSegment( const Vec3 & p1, const Vec3 & q1, const Vec3 & p2, const Vec3 & q2, Vec3 & c1, Vec3 & c2 ) {
+	const Vec3 d1 = q1 - p1;
+	const Vec3 d2 = q2 - p2;
+	const Vec3 r = p1 - p2;
+	const float a = d1.Dot( d1 );
+	const float e = d2.Dot( d2 );
+	const float f = d2.Dot( r );
+	const float eps = 1e-12f;
+
+	float s = 0.0f;
+	float t = 0.0f;
+	if ( a <= eps && e <= eps ) {
+		// Both segments are points
+	} else if ( a <= eps ) {
+		t = std::max( 0.0f, std::min( 1.0f, f / e ) );
+	} else {
+		const float c = d1.Dot( r );
+		if ( e <= eps ) {
+			s = std::max( 0.0f, std::min( 1.0f, -c / a ) );
+		} else {
+			const float b = d1.Dot( d2 );
+			const float denom = a * e - b * b;
+			if ( denom > eps ) {
+				s = std::max( 0.0f, std::min( 1.0f, ( b * f - c * e ) / denom ) );
+			}
+
+			t = ( b * s + f ) / e;
+			if ( t < 0.0f ) {
+				t = 0.0f;
+				s = std::max( 0.0f, std::min( 1.0f, -c / a ) );
+			} else if ( t > 1.0f ) {
+				t = 1.0f;
+				s = std::max( 0.0f, std::min( 1.0f, ( b - c ) / a ) );
+			}
+		}
+	}
+
+	c1 = p1 + d1 * s;
+	c2 = p2 + d2 * t;
+	return ( c1 - c2 ).GetLengthSqr();
+}
+
+/*
+====================================================
+ClosestPtSegmentTriangle
+
+Returns the distance between the segment and the triangle
+====================================================
+*/
+static float ClosestPtSegmentTriangle( const Vec3 & p, const Vec3 & q, const collisionTri_t & tri, Vec3 & ptSeg, Vec3 & ptTri ) {
+	// Check if the segment pierces the triangle
+	const float dp = tri.normal.Dot( p - tri.a );
+	const float dq = tri.normal.Dot( q - tri.a );
+	if ( dp * dq <= 0.0f && dp != dq ) {
+		const Vec3 x = p + ( q - p ) * ( dp / ( dp - dq ) );
+		const bool insideAB = tri.normal.Dot( ( tri.b - tri.a ).Cross( x - tri.a ) ) >= 0.0f;
+		const bool insideBC = tri.normal.Dot( ( tri.c - tri.b ).Cross( x - tri.b ) ) >= 0.0f;
+		const bool insideCA = tri.normal.Dot( ( tri.a - tri.c ).Cross( x - tri.c ) ) >= 0.0f;
+		if ( insideAB && insideBC && insideCA ) {
+			ptSeg = x;
+			ptTri = x;
+			return 0.0f;
+		}
+	}
+
+	// Otherwise the closest points involve a segment end point or a triangle edge
+	ptSeg = p;
+	ptTri = ClosestPtPointTriangle( p, tri.a, tri.b, tri.c );
+	float bestDistSqr = ( ptSeg - ptTri ).GetLengthSqr();
+
+	Vec3 pt = ClosestPtPointTriangle( q, tri.a, tri.b, tri.c );
+	float distSqr = ( q - pt ).GetLengthSqr();
+	if ( distSqr < bestDistSqr ) {
+		bestDistSqr = distSqr;
+		ptSeg = q;
+		ptTri = pt;
+	}
+
+	const Vec3 * edges[ 3 ][ 2 ] = {
+		{ &tri.a, &tri.b },
+		{ &tri.b, &tri.c },
+		{ &tri.c, &tri.a },
+	};
+	for ( int i = 0; i < 3; i++ ) {
+		Vec3 c1;
+		Vec3 c2;
+		distSqr = ClosestPtSegmentSegment( p, q, *edges[ i ][ 0 ], *edges[ i ][ 1 ], c1, c2 );
+		if ( distSqr < bestDistSqr ) {
+			bestDistSqr = distSqr;
+			ptSeg = c1;
+			ptTri = c2;
+		}
+	}
+
+	return sqrtf( bestDistSqr );
+}
+
+/*
+================================================================================================
+
+Sweeps
+
+================================================================================================
+*/
+
+/*
+====================================================
+SegmentVsTriangle
+====================================================
+*/
+struct SegmentVsTriangle {
+	const collisionTri_t & tri;
+
+	float operator()( const Vec3 & p, const Vec3 & q, const Vec3 & delta, Vec3 & ptOther, Vec3 & normal ) const {
+		Vec3 ptSeg;
+		const float dist = ClosestPtSegmentTriangle( p, q, tri, ptSeg, ptOther );
+		if ( dist > 1e-6f ) {
+			normal = ( ptSeg - ptOther ) * ( 1.0f / dist );
+		} else {
+			// The segment is touching the triangle, push back against the motion
+			normal = ( tri.normal.Dot( delta ) > 0.0f ) ? tri.normal * -1.0f : tri.normal;
+		}
+		return dist;
+	}
+};
+
+/*
+====================================================
+SegmentVsPoint
+====================================================
+*/
+struct SegmentVsPoint {
+	const Vec3 & center;
+
+	float operator()( const Vec3 & p, const Vec3 & q, const Vec3 & delta, Vec3 & ptOther, Vec3 & normal ) const {
+		const Vec3 ptSeg = ClosestPtPointSegment( center, p, q );
+		ptOther = center;
+		const float dist = ( ptSeg - center ).GetMagnitude();
+		if ( dist > 1e-6f ) {
+			normal = ( ptSeg - center ) * ( 1.0f / dist );
+		} else {
+			normal = delta * -1.0f;
+			normal.Normalize();
+		}
+		return dist;
+	}
+};
+
+/*
+====================================================
+SegmentVsSegment
+
+The inner segment of another capsule
+====================================================
+*/
+struct SegmentVsSegment {
+	const Vec3 & a;
+	const Vec3 & b;
+
+	float operator()( const Vec3 & p, const Vec3 & q, const Vec3 & delta, Vec3 & ptOther, Vec3 & normal ) const {
+		Vec3 ptSeg;
+		const float dist = sqrtf( ClosestPtSegmentSegment( p, q, a, b, ptSeg, ptOther ) );
+		if ( dist > 1e-6f ) {
+			normal = ( ptSeg - ptOther ) * ( 1.0f / dist );
+		} else {
+			normal = delta * -1.0f;
+			normal.Normalize();
+		}
+		return dist;
+	}
+};
+
+/*
+====================================================
+SegmentVsBody
+
+Any convex body, through GJK on the segment and the shape
+====================================================
+*/
+struct SegmentVsBody {
+	const Body & body;
+
+	float operator()( const Vec3 & p, const Vec3 & q, const Vec3 & delta, Vec3 & ptOther, Vec3 & normal ) const {
+		Vec3 ptSeg;
+		GJK_ClosestPoints( p, q, &body, ptSeg, ptOther );
+		const float dist = ( ptSeg - ptOther ).GetMagnitude();
+		if ( dist > 1e-6f ) {
+			normal = ( ptSeg - ptOther ) * ( 1.0f / dist );
+		} else {
+			normal = delta * -1.0f;
+			normal.Normalize();
+		}
+		return dist;
+	}
+};
+
+/*
+====================================================
+SweepSegment
+
+Conservative advancement of the capsule's inner segment.
+Pure translation makes the distance between two convex
+shapes a convex function of time, so stepping by
+gap / closing speed never overshoots the time of impact.
+====================================================
+*/
+template < typename distFunc_t >
+static bool SweepSegment( const distFunc_t & distFunc, const Vec3 & p, const Vec3 & q, const Vec3 & delta, const float radius, const float maxFraction, float & fraction, Vec3 & point, Vec3 & normal ) {
+	// Moving almost parallel to a surface that is being touched shouldn't count as a hit
+	const float minClosingSpeed = 1e-3f * delta.GetMagnitude();
+
+	float t = 0.0f;
+	Vec3 ptOther;
+	Vec3 n;
+	for ( int iter = 0; iter < MAX_ADVANCE_ITERATIONS; iter++ ) {
+		const Vec3 offset = delta * t;
+		const float gap = distFunc( p + offset, q + offset, delta, ptOther, n ) - radius;
+		const float closingSpeed = -n.Dot( delta );
+
+		if ( closingSpeed <= minClosingSpeed ) {
+			// Moving apart (or sliding along), this shape can't be hit
+			return false;
+		}
+		if ( gap <= ADVANCE_TOLERANCE ) {
+			break;
+		}
+
+		t += gap / closingSpeed;
+		if ( t >= maxFraction ) {
+			return false;
+		}
+	}
+
+	fraction = t;
+	point = ptOther;
+	normal = n;
+	return true;
+}
+
+/*
+================================================================================================
+
+Casts
+
+================================================================================================
+*/
+
+/*
+====================================================
+sortedBounds_t::Build
+====================================================
+*/
+void sortedBounds_t::Build( const Bounds * unsorted, const int num ) {
+	ids.resize( num );
+	for ( int i = 0; i < num; i++ ) {
+		ids[ i ] = i;
+	}
+	std::sort( ids.begin(), ids.end(), [ unsorted ]( const int a, const int b ) {
+		return unsorted[ a ].mins.x < unsorted[ b ].mins.x;
+	} );
+
+	maxWidth = 0.0f;
+	bounds.Resize( num );
+	for ( int i = 0; i < num; i++ ) {
+		const Bounds & b = unsorted[ ids[ i ] ];
+		bounds.Set( i, b );
+		maxWidth = std::max( maxWidth, b.maxs.x - b.mins.x );
+	}
+}
+
+/*
+====================================================
+BuildBodyBounds
+====================================================
+*/
+void BuildBodyBounds( const Body * bodies, const int num, sortedBounds_t & sorted ) {
+	std::vector< Bounds > bounds( num );
+	for ( int i = 0; i < num; i++ ) {
+		const Body & body = bodies[ i ];
+		if ( NULL != body.m_shape ) {
+			bounds[ i ] = body.m_shape->GetBounds( body.m_position, body.m_orientation );
+		}
+	}
+	sorted.Build( bounds.data(), num );
+}
+
+/*
+====================================================
+BuildCapsuleBounds
+====================================================
+*/
+void BuildCapsuleBounds( const castCapsule_t * capsules, const int num, sortedBounds_t & sorted ) {
+	std::vector< Bounds > bounds( num );
+	for ( int i = 0; i < num; i++ ) {
+		const castCapsule_t & capsule = capsules[ i ];
+		const Vec3 extents( capsule.radius, capsule.radius, capsule.radius + capsule.halfHeight );
+		bounds[ i ].mins = capsule.center - extents;
+		bounds[ i ].maxs = capsule.center + extents;
+	}
+	sorted.Build( bounds.data(), num );
+}
+
+/*
+====================================================
+CapsuleCast
+====================================================
+*/
+bool CapsuleCast( const castWorld_t & world, const capsuleCast_t & cast, castResult_t & result ) {
+	result.hit = false;
+	result.fraction = 1.0f;
+	result.point = cast.start + cast.delta;
+	result.normal.Zero();
+	result.triangle = -1;
+	result.body = -1;
+	result.capsule = -1;
+
+	const Vec3 axis( 0.0f, 0.0f, cast.halfHeight );
+	const Vec3 p = cast.start - axis;
+	const Vec3 q = cast.start + axis;
+
+	Bounds sweptBounds;
+	sweptBounds.Expand( p );
+	sweptBounds.Expand( q );
+	sweptBounds.Expand( p + cast.delta );
+	sweptBounds.Expand( q + cast.delta );
+	sweptBounds.mins -= Vec3( cast.radius );
+	sweptBounds.maxs += Vec3( cast.radius );
+
+	if ( NULL != world.mesh ) {
+		const CollisionMesh & mesh = *world.mesh;
+		float bestFaceDot = 0.0f;
+		auto sweepTriangle = [ & ]( const int triIdx ) {
+			const collisionTri_t & tri = mesh.GetTriangle( triIdx );
+			const float maxFraction = std::min( result.fraction + TIE_FRACTION, 1.0f );
+
+			float fraction;
+			Vec3 point;
+			Vec3 normal;
+			SegmentVsTriangle distFunc = { tri };
+			if ( !SweepSegment( distFunc, p, q, cast.delta, cast.radius, maxFraction, fraction, point, normal ) ) {
+				return;
+			}
+
+			// Edges and vertices are shared by several triangles that all report the same
+			// fraction, prefer the face that most directly opposes the motion.  That way
+			// landing on the lip of a ledge reports the ledge's top and not its wall.
+			const float faceDot = -fabsf( tri.normal.Dot( cast.delta ) );
+			const bool isTie = result.hit && fraction > result.fraction - TIE_FRACTION;
+			if ( isTie && faceDot >= bestFaceDot ) {
+				return;
+			}
+
+			bestFaceDot = faceDot;
+			if ( !isTie || fraction < result.fraction ) {
+				result.fraction = fraction;
+				result.point = point;
+				result.normal = normal;
+			}
+			result.hit = true;
+			result.triangle = triIdx;
+		};
+		mesh.Walk( sweptBounds, sweepTriangle );
+	}
+
+	auto sweepBody = [ & ]( const int bodyIdx ) {
+		const Body & body = world.bodies[ bodyIdx ];
+		if ( NULL == body.m_shape ) {
+			return;
+		}
+
+		float fraction;
+		Vec3 point;
+		Vec3 normal;
+		if ( Shape::SHAPE_SPHERE == body.m_shape->GetType() ) {
+			// A sphere is a point with a radius, cheaper than going through GJK
+			const float sphereRadius = ( (const ShapeSphere *)body.m_shape )->m_radius;
+			SegmentVsPoint distFunc = { body.m_position };
+			if ( !SweepSegment( distFunc, p, q, cast.delta, cast.radius + sphereRadius, result.fraction, fraction, point, normal ) ) {
+				return;
+			}
+			point += normal * sphereRadius;
+		} else {
+			SegmentVsBody distFunc = { body };
+			if ( !SweepSegment( distFunc, p, q, cast.delta, cast.radius, result.fraction, fraction, point, normal ) ) {
+				return;
+			}
+		}
+
+		result.hit = true;
+		result.fraction = fraction;
+		result.point = point;
+		result.normal = normal;
+		result.triangle = -1;
+		result.body = bodyIdx;
+	};
+
+	if ( NULL != world.bodyBounds ) {
+		world.bodyBounds->Walk( sweptBounds, sweepBody );
+	} else {
+		for ( int i = 0; i < world.numBodies; i++ ) {
+			const Body & body = world.bodies[ i ];
+			if ( NULL != body.m_shape && body.m_shape->GetBounds( body.m_position, body.m_orientation ).DoesIntersect( sweptBounds ) ) {
+				sweepBody( i );
+			}
+		}
+	}
+
+	auto sweepCapsule = [ & ]( const int capsuleIdx ) {
+		if ( capsuleIdx == cast.ignoreCapsule ) {
+			return;
+		}
+
+		const castCapsule_t & capsule = world.capsules[ capsuleIdx ];
+		const Vec3 capsuleAxis( 0.0f, 0.0f, capsule.halfHeight );
+		const Vec3 a = capsule.center - capsuleAxis;
+		const Vec3 b = capsule.center + capsuleAxis;
+
+		float fraction;
+		Vec3 point;
+		Vec3 normal;
+		SegmentVsSegment distFunc = { a, b };
+		if ( SweepSegment( distFunc, p, q, cast.delta, cast.radius + capsule.radius, result.fraction, fraction, point, normal ) ) {
+			result.hit = true;
+			result.fraction = fraction;
+			result.point = point + normal * capsule.radius;
+			result.normal = normal;
+			result.triangle = -1;
+			result.body = -1;
+			result.capsule = capsuleIdx;
+		}
+	};
+
+	if ( NULL != world.capsuleBounds ) {
+		world.capsuleBounds->Walk( sweptBounds, sweepCapsule );
+	} else {
+		for ( int i = 0; i < world.numCapsules; i++ ) {
+			sweepCapsule( i );
+		}
+	}
+
+	return result.hit;
+}
+
+/*
+====================================================
+CapsuleCastBatch
+
+The casts share no state, so they are spread over the worker
+threads.  Bounds the world doesn't bring are sorted once here
+for the whole batch.
+====================================================
+*/
+void CapsuleCastBatch( const castWorld_t & world, const capsuleCast_t * casts, castResult_t * results, const int num ) {
+	if ( num <= 0 ) {
+		return;
+	}
+
+	castWorld_t batchWorld = world;
+	sortedBounds_t bodyBounds;
+	if ( NULL == world.bodyBounds && world.numBodies > 0 ) {
+		BuildBodyBounds( world.bodies, world.numBodies, bodyBounds );
+		batchWorld.bodyBounds = &bodyBounds;
+	}
+	sortedBounds_t capsuleBounds;
+	if ( NULL == world.capsuleBounds && world.numCapsules > 0 ) {
+		BuildCapsuleBounds( world.capsules, world.numCapsules, capsuleBounds );
+		batchWorld.capsuleBounds = &capsuleBounds;
+	}
+
+	ParallelFor( num, CASTS_PER_CHUNK, [ & ]( int begin, int end ) {
+		for ( int i = begin; i < end; i++ ) {
+			CapsuleCast( batchWorld, casts[ i ], results[ i ] );
+		}
+	} );
+}
+
+/*
+====================================================
+SeparateSegmentBody
+
+How far and which way the capsule has to move to clear a
+body.  While the inner segment is still outside the body the
+closest points give both.  Once it is inside, the capsule is
+pushed out along whichever of a few separating axes needs
+the shortest push: the body's own axes, straight up and
+away from the body's center.
+====================================================
+*/
+static float SeparateSegmentBody( const Vec3 & p, const Vec3 & q, const float radius, const Body & body, Vec3 & push ) {
+	if ( Shape::SHAPE_SPHERE == body.m_shape->GetType() ) {
+		const float sphereRadius = ( (const ShapeSphere *)body.m_shape )->m_radius;
+		Vec3 ptOther;
+		SegmentVsPoint distFunc = { body.m_position };
+		const float dist = distFunc( p, q, Vec3( 0.0f, 0.0f, -1.0f ), ptOther, push );
+		return radius + sphereRadius - dist;
+	}
+
+	Vec3 ptSeg;
+	Vec3 ptBody;
+	GJK_ClosestPoints( p, q, &body, ptSeg, ptBody );
+	const float dist = ( ptSeg - ptBody ).GetMagnitude();
+	if ( dist > 1e-6f ) {
+		push = ( ptSeg - ptBody ) * ( 1.0f / dist );
+		return radius - dist;
+	}
+
+	Vec3 away = ( p + q ) * 0.5f - body.GetCenterOfMassWorldSpace();
+	away.z = 0.0f;
+	const Vec3 axes[ 5 ] = {
+		body.m_orientation.RotatePoint( Vec3( 1.0f, 0.0f, 0.0f ) ),
+		body.m_orientation.RotatePoint( Vec3( 0.0f, 1.0f, 0.0f ) ),
+		body.m_orientation.RotatePoint( Vec3( 0.0f, 0.0f, 1.0f ) ),
+		Vec3( 0.0f, 0.0f, 1.0f ),
+		( away.GetLengthSqr() > 1e-10f ) ? away * ( 1.0f / away.GetMagnitude() ) : Vec3( 1.0f, 0.0f, 0.0f ),
+	};
+
+	float best = 1e30f;
+	for ( int i = 0; i < 5; i++ ) {
+		for ( int sign = 0; sign < 2; sign++ ) {
+			const Vec3 n = sign ? axes[ i ] * -1.0f : axes[ i ];
+			const float bodyMax = body.m_shape->Support( n, body.m_position, body.m_orientation, 0.0f ).Dot( n );
+			const float depth = bodyMax - std::min( p.Dot( n ), q.Dot( n ) ) + radius;
+			if ( depth < best ) {
+				best = depth;
+				push = n;
+			}
+		}
+	}
+	return best;
+}
+
+/*
+====================================================
+CapsuleDepenetrate
+
+Pushes the capsule out of the deepest overlap, a few times,
+until it's at least skin away from everything.  Triangles,
+bodies and the other capsules are all pushed out of, so a
+body or a character that moved into a standing character
+doesn't leave it stuck inside.  Returns true if the capsule
+was moved.
+====================================================
+*/
+bool CapsuleDepenetrate( const castWorld_t & world, Vec3 & center, const float radius, const float halfHeight, const float skin, const int ignoreCapsule ) {
+	bool wasMoved = false;
+	for ( int iter = 0; iter < MAX_DEPENETRATION_ITERATIONS; iter++ ) {
+		const Vec3 axis( 0.0f, 0.0f, halfHeight );
+		const Vec3 p = center - axis;
+		const Vec3 q = center + axis;
+
+		Bounds bounds;
+		bounds.Expand( p );
+		bounds.Expand( q );
+		bounds.mins -= Vec3( radius );
+		bounds.maxs += Vec3( radius );
+
+		float deepest = 0.0f;
+		Vec3 push;
+		if ( NULL != world.mesh ) {
+			const CollisionMesh & mesh = *world.mesh;
+			auto findDeepest = [ & ]( const int triIdx ) {
+				const collisionTri_t & tri = mesh.GetTriangle( triIdx );
+				Vec3 ptSeg;
+				Vec3 ptTri;
+				const float dist = ClosestPtSegmentTriangle( p, q, tri, ptSeg, ptTri );
+				const float depth = radius - dist;
+				if ( depth <= deepest ) {
+					return;
+				}
+
+				deepest = depth;
+				if ( dist > 1e-6f ) {
+					push = ( ptSeg - ptTri ) * ( 1.0f / dist );
+				} else {
+					push = ( tri.normal.Dot( center - tri.a ) >= 0.0f ) ? tri.normal : tri.normal * -1.0f;
+				}
+			};
+			mesh.Walk( bounds, findDeepest );
+		}
+
+		auto findDeepestBody = [ & ]( const int bodyIdx ) {
+			const Body & body = world.bodies[ bodyIdx ];
+			if ( NULL == body.m_shape ) {
+				return;
+			}
+
+			Vec3 n;
+			const float depth = SeparateSegmentBody( p, q, radius, body, n );
+			if ( depth > deepest ) {
+				deepest = depth;
+				push = n;
+			}
+		};
+
+		if ( NULL != world.bodyBounds ) {
+			world.bodyBounds->Walk( bounds, findDeepestBody );
+		} else {
+			for ( int i = 0; i < world.numBodies; i++ ) {
+				const Body & body = world.bodies[ i ];
+				if ( NULL != body.m_shape && body.m_shape->GetBounds( body.m_position, body.m_orientation ).DoesIntersect( bounds ) ) {
+					findDeepestBody( i );
+				}
+			}
+		}
+
+		auto findDeepestCapsule = [ & ]( const int capsuleIdx ) {
+			if ( capsuleIdx == ignoreCapsule ) {
+				return;
+			}
+
+			const castCapsule_t & capsule = world.capsules[ capsuleIdx ];
+			const Vec3 capsuleAxis( 0.0f, 0.0f, capsule.halfHeight );
+			Vec3 ptSeg;
+			Vec3 ptOther;
+			const float dist = sqrtf( ClosestPtSegmentSegment( p, q, capsule.center - capsuleAxis, capsule.center + capsuleAxis, ptSeg, ptOther ) );
+			const float depth = radius + capsule.radius - dist;
+			if ( depth <= deepest ) {
+				return;
+			}
+
+			deepest = depth;
+			if ( dist > 1e-6f ) {
+				push = ( ptSeg - ptOther ) * ( 1.0f / dist );
+			} else {
+				// Standing inside each other, separate sideways
+				push = center - capsule.center;
+				push.z = 0.0f;
+				push = ( push.GetLengthSqr() > 1e-10f ) ? push * ( 1.0f / push.GetMagnitude() ) : Vec3( 1.0f, 0.0f, 0.0f );
+			}
+		};
+
+		if ( NULL != world.capsuleBounds ) {
+			world.capsuleBounds->Walk( bounds, findDeepestCapsule );
+		} else {
+			for ( int i = 0; i < world.numCapsules; i++ ) {
+				findDeepestCapsule( i );
+			}
+		}
+
+		if ( deepest <= 0.0f ) {
+			break;
+		}
+
+		center += push * ( deepest + skin );
+		wasMoved = true;
+	}
+
+	return wasMoved;
+}
@@ -0,0 +1,123 @@
+//
+//	ShapeCast.h
+//
+#pragma once
+#include "Body.h"
+#include "CollisionMesh.h"
+#include <algorithm>
+#include <vector>
+
+/*
+====================================================
+sortedBounds_t
+
+Bounds sorted by their min x, so a query only tests the run
+whose min x is below its max x and that can still reach back
+to its min x, four at a time.  Built once and shared by every
+cast of a batch.
+====================================================
+*/
+struct sortedBounds_t {
+	std::vector< int > ids;		// what each sorted bounds belongs to
+	boundsSoA_t bounds;
+	float maxWidth;				// widest bounds along x
+
+	sortedBounds_t() : maxWidth( 0.0f ) {}
+
+	void Build( const Bounds * unsorted, const int num );
+
+	// Calls func( id ) for every bounds that overlaps the query bounds
+	template < typename func_t >
+	void Walk( const Bounds & query, func_t & func ) const;
+};
+
+/*
+====================================================
+castCapsule_t
+
+An upright capsule that casts collide with, like the other
+characters.  The inner segment runs along +z from center -
+halfHeight to center + halfHeight.
+====================================================
+*/
+struct castCapsule_t {
+	Vec3 center;
+	float radius;
+	float halfHeight;
+};
+
+/*
+====================================================
+castWorld_t
+
+Everything a shape cast is tested against, all of it is
+optional.  Bodies of any convex shape are swept against, a
+batch sorts their bounds itself unless bodyBounds is given.
+capsuleBounds has to come with the capsules.
+====================================================
+*/
+struct castWorld_t {
+	const CollisionMesh * mesh;
+	const Body * bodies;
+	int numBodies;
+	const sortedBounds_t * bodyBounds;		// of the bodies, ids are body indices
+	const castCapsule_t * capsules;
+	int numCapsules;
+	const sortedBounds_t * capsuleBounds;	// of the capsules, ids are capsule indices
+};
+
+/*
+====================================================
+capsuleCast_t
+
+An upright capsule, the inner segment runs along +z
+from center - halfHeight to center + halfHeight.
+====================================================
+*/
+struct capsuleCast_t {
+	Vec3 start;		// center of the capsule at the beginning of the cast
+	Vec3 delta;		// displacement of the cast
+	float radius;
+	float halfHeight;
+	int ignoreCapsule;	// the world capsule that is the caster itself, or -1
+};
+
+struct castResult_t {
+	bool hit;
+	float fraction;	// fraction of delta travelled before touching, 1 if nothing was hit
+	Vec3 point;		// contact point in world space
+	Vec3 normal;	// points away from the surface that was hit
+	int triangle;	// index into the collision mesh or -1
+	int body;		// index into the bodies or -1
+	int capsule;	// index into the capsules or -1
+};
+
+void BuildBodyBounds( const Body * bodies, const int num, sortedBounds_t & sorted );
+void BuildCapsuleBounds( const castCapsule_t * capsules, const int num, sortedBounds_t & sorted );
+
+bool CapsuleCast( const castWorld_t & world, const capsuleCast_t & cast, castResult_t & result );
+void CapsuleCastBatch( const castWorld_t & world, const capsuleCast_t * casts, castResult_t * results, const int num );
+
+bool CapsuleDepenetrate( const castWorld_t & world, Vec3 & center, const float radius, const float halfHeight, const float skin, const int ignoreCapsule );
+
+/*
+====================================================
+sortedBounds_t::Walk
+====================================================
+*/
+template < typename func_t >
+inline void sortedBounds_t::Walk( const Bounds & query, func_t & func ) const {
+	// Everything that starts before the query ends, minus what ends before it starts
+	const int end = (int)( std::upper_bound( bounds.minX.begin(), bounds.minX.end(), query.maxs.x ) - bounds.minX.begin() );
+	const int begin = (int)( std::lower_bound( bounds.minX.begin(), bounds.minX.begin() + end, query.mins.x - maxWidth ) - bounds.minX.begin() );
+
+	static const int MAX_HITS_PER_PASS = 64;
+	int hits[ MAX_HITS_PER_PASS ];
+	for ( int first = begin; first < end; first += MAX_HITS_PER_PASS ) {
+		const int last = std::min( first + MAX_HITS_PER_PASS, end );
+		const int numHits = IntersectBounds( query, bounds, first, last, hits );
+		for ( int i = 0; i < numHits; i++ ) {
+			func( ids[ hits[ i ] ] );
+		}
+	}
+}
@@ -19,7 +19,7 @@ ShapeSphere::Support
 Vec3 ShapeSphere::Support( const Vec3 & dir, const Vec3 & pos, const Quat & orient, const float bias ) const {
 	Vec3 supportPt;
 	
-	// TODO: Add code
+	supportPt = pos + dir * ( m_radius + bias );
 
 	return supportPt;
 }
@@ -32,7 +32,10 @@ ShapeSphere::InertiaTensor
 Mat3 ShapeSphere::InertiaTensor() const {
 	Mat3 tensor;
 	
-	// TODO: Add code
+	tensor.Zero();
+	tensor.rows[ 0 ][ 0 ] = 2.0f * m_radius * m_radius / 5.0f;
+	tensor.rows[ 1 ][ 1 ] = 2.0f * m_radius * m_radius / 5.0f;
+	tensor.rows[ 2 ][ 2 ] = 2.0f * m_radius * m_radius / 5.0f;
 
 	return tensor;
 }
@@ -45,7 +48,8 @@ ShapeSphere::GetBounds
 Bounds ShapeSphere::GetBounds( const Vec3 & pos, const Quat & orient ) const {
 	Bounds tmp;
 	
-	// TODO: Add code
+	tmp.mins = Vec3( -m_radius ) + pos;
+	tmp.maxs = Vec3( m_radius ) + pos;
 
 	return tmp;
 }
@@ -58,7 +62,8 @@ ShapeSphere::GetBounds
 Bounds ShapeSphere::GetBounds() const {
 	Bounds tmp;
 	
-	// TODO: Add code
+	tmp.mins = Vec3( -m_radius );
+	tmp.maxs = Vec3( m_radius );
 
 	return tmp;
-}
\ No newline at end of file
+}
@@ -0,0 +1,310 @@
+//
+//  DebugDraw.cpp
+//
+#include "DebugDraw.h"
+#include "DeviceContext.h"
+#include "FrameBuffer.h"
+#include "../Physics/Body.h"
+#include "../Physics/Manifold.h"
+#include "../Physics/Constraints.h"
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+static const Vec4 COLOR_CONTACT_A( 1.0f, 0.2f, 0.2f, 1.0f );
+static const Vec4 COLOR_CONTACT_B( 0.2f, 0.4f, 1.0f, 1.0f );
+static const Vec4 COLOR_NORMAL( 1.0f, 1.0f, 0.2f, 1.0f );
+static const Vec4 COLOR_BOUNDS_DYNAMIC( 0.2f, 1.0f, 0.3f, 1.0f );
+static const Vec4 COLOR_BOUNDS_STATIC( 0.5f, 0.5f, 0.5f, 1.0f );
+static const Vec4 COLOR_ANCHOR( 1.0f, 0.5f, 0.0f, 1.0f );
+static const Vec4 COLOR_AXIS( 1.0f, 0.2f, 1.0f, 1.0f );
+
+/*
+====================================================
+PackColor
+====================================================
+*/
+static void PackColor( const Vec4 & color, unsigned char * rgba ) {
+	for ( int i = 0; i < 4; i++ ) {
+		float c = color[ i ];
+		c = ( c < 0.0f ) ? 0.0f : ( ( c > 1.0f ) ? 1.0f : c );
+		rgba[ i ] = (unsigned char)( c * 255.0f + 0.5f );
+	}
+}
+
+/*
+========================================================================================================
+
+DebugDraw
+
+========================================================================================================
+*/
+
+/*
+====================================================
+DebugDraw::Create
+====================================================
+*/
+bool DebugDraw::Create( DeviceContext * device, FrameBuffer * frameBuffer, const int maxLines ) {
+	bool result;
+
+	m_maxVertsPerSlot = maxLines * 2;
+	m_numSlots = MAX_FRAMES_IN_FLIGHT;
+	m_frameCount = 0;
+	m_verts.reserve( m_maxVertsPerSlot );
+
+	result = m_shader.Load( device, "debugLines" );
+	if ( !result || NULL == m_shader.m_vkShaderModules[ Shader::SHADER_STAGE_VERTEX ] || NULL == m_shader.m_vkShaderModules[ Shader::SHADER_STAGE_FRAGMENT ] ) {
+		// Not fatal, the overlay is just unavailable
+		printf( "WARNING: Failed to load the debug line shader, debug draw is disabled\n" );
+		m_shader.Cleanup( device );
+		return false;
+	}
+
+	Descriptors::CreateParms_t descriptorParms;
+	memset( &descriptorParms, 0, sizeof( descriptorParms ) );
+	descriptorParms.numUniformsVertex = 1;
+	result = m_descriptors.Create( device, descriptorParms );
+	if ( !result ) {
+		printf( "ERROR: Failed to build descriptors\n" );
+		assert( 0 );
+		return false;
+	}
+
+	// Depth tested so the lines sit in the world, but they don't write depth
+	Pipeline::CreateParms_t pipelineParms;
+	pipelineParms.framebuffer = frameBuffer;
+	pipelineParms.descriptors = &m_descriptors;
+	pipelineParms.shader = &m_shader;
+	pipelineParms.width = frameBuffer->m_parms.width;
+	pipelineParms.height = frameBuffer->m_parms.height;
+	pipelineParms.cullMode = Pipeline::CULL_MODE_NONE;
+	pipelineParms.depthTest = true;
+	pipelineParms.depthWrite = false;
+	result = m_pipeline.CreateForLines( device, pipelineParms );
+	if ( !result ) {
+		printf( "ERROR: Failed to build pipeline\n" );
+		assert( 0 );
+		return false;
+	}
+
+	const int bufferSize = m_numSlots * m_maxVertsPerSlot * (int)sizeof( debugVert_t );
+	result = m_vertexBuffer.Allocate( device, NULL, bufferSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT );
+	if ( !result ) {
+		printf( "ERROR: Failed to allocate debug line buffer\n" );
+		assert( 0 );
+		return false;
+	}
+
+	// The memory is host coherent, so it stays mapped for the lifetime of the buffer
+	m_mapped = (unsigned char *)m_vertexBuffer.MapBuffer( device );
+
+	m_isValid = true;
+	return true;
+}
+
+/*
+====================================================
+DebugDraw::Cleanup
+====================================================
+*/
+void DebugDraw::Cleanup( DeviceContext * device ) {
+	if ( !m_isValid ) {
+		return;
+	}
+
+	m_vertexBuffer.UnmapBuffer( device );
+	m_vertexBuffer.Cleanup( device );
+	m_mapped = NULL;
+
+	m_pipeline.Cleanup( device );
+	m_descriptors.Cleanup( device );
+	m_shader.Cleanup( device );
+	m_isValid = false;
+}
+
+/*
+====================================================
+DebugDraw::AddLine
+====================================================
+*/
+void DebugDraw::AddLine( const Vec3 & a, const Vec3 & b, const Vec4 & color ) {
+	debugVert_t vert;
+	PackColor( color, vert.rgba );
+
+	vert.xyz[ 0 ] = a.x - m_viewOrigin.x;
+	vert.xyz[ 1 ] = a.y - m_viewOrigin.y;
+	vert.xyz[ 2 ] = a.z - m_viewOrigin.z;
+	m_verts.push_back( vert );
+
+	vert.xyz[ 0 ] = b.x - m_viewOrigin.x;
+	vert.xyz[ 1 ] = b.y - m_viewOrigin.y;
+	vert.xyz[ 2 ] = b.z - m_viewOrigin.z;
+	m_verts.push_back( vert );
+}
+
+/*
+====================================================
+DebugDraw::AddPoint
+
+Points are drawn as a small three axis cross, so they still go through the line pipeline
+====================================================
+*/
+void DebugDraw::AddPoint( const Vec3 & pt, const float size, const Vec4 & color ) {
+	const float h = size * 0.5f;
+	AddLine( pt - Vec3( h, 0, 0 ), pt + Vec3( h, 0, 0 ), color );
+	AddLine( pt - Vec3( 0, h, 0 ), pt + Vec3( 0, h, 0 ), color );
+	AddLine( pt - Vec3( 0, 0, h ), pt + Vec3( 0, 0, h ), color );
+}
+
+/*
+====================================================
+DebugDraw::AddArrow
+====================================================
+*/
+void DebugDraw::AddArrow( const Vec3 & pt, const Vec3 & dir, const Vec4 & color ) {
+	const Vec3 tip = pt + dir;
+	AddLine( pt, tip, color );
+
+	const float length = dir.GetMagnitude();
+	if ( length < 1e-6f ) {
+		return;
+	}
+
+	Vec3 u;
+	Vec3 v;
+	Vec3 n = dir / length;
+	n.GetOrtho( u, v );
+
+	const float head = length * 0.2f;
+	AddLine( tip, tip - n * head + u * head * 0.5f, color );
+	AddLine( tip, tip - n * head - u * head * 0.5f, color );
+}
+
+/*
+====================================================
+DebugDraw::AddBounds
+====================================================
+*/
+void DebugDraw::AddBounds( const Bounds & bounds, const Vec4 & color ) {
+	Vec3 corners[ 8 ];
+	for ( int i = 0; i < 8; i++ ) {
+		corners[ i ].x = ( i & 1 ) ? bounds.maxs.x : bounds.mins.x;
+		corners[ i ].y = ( i & 2 ) ? bounds.maxs.y : bounds.mins.y;
+		corners[ i ].z = ( i & 4 ) ? bounds.maxs.z : bounds.mins.z;
+	}
+
+	// Every edge connects two corners that differ in exactly one bit
+	for ( int i = 0; i < 8; i++ ) {
+		for ( int bit = 1; bit < 8; bit <<= 1 ) {
+			if ( 0 == ( i & bit ) ) {
+				AddLine( corners[ i ], corners[ i | bit ], color );
+			}
+		}
+	}
+}
+
+/*
+====================================================
+DebugDraw::AddAxes
+====================================================
+*/
+void DebugDraw::AddAxes( const Vec3 & pos, const Quat & orient, const float size ) {
+	AddLine( pos, pos + orient.RotatePoint( Vec3( size, 0, 0 ) ), Vec4( 1, 0, 0, 1 ) );
+	AddLine( pos, pos + orient.RotatePoint( Vec3( 0, size, 0 ) ), Vec4( 0, 1, 0, 1 ) );
+	AddLine( pos, pos + orient.RotatePoint( Vec3( 0, 0, size ) ), Vec4( 0, 0, 1, 1 ) );
+}
+
+/*
+====================================================
+DebugDraw::AddContacts
+
+Both contact points and the normal, from the points the solver is
+currently using rather than where the contact was first found
+====================================================
+*/
+void DebugDraw::AddContacts( const ManifoldCollector & manifolds ) {
+	for ( int m = 0; m < manifolds.m_manifolds.size(); m++ ) {
+		const Manifold & manifold = manifolds.m_manifolds[ m ];
+		for ( int i = 0; i < manifold.GetNumContacts(); i++ ) {
+			const contact_t contact = manifold.GetContact( i );
+			const Vec3 ptA = contact.bodyA->BodySpaceToWorldSpace( contact.ptOnA_LocalSpace );
+			const Vec3 ptB = contact.bodyB->BodySpaceToWorldSpace( contact.ptOnB_LocalSpace );
+
+			AddPoint( ptA, 0.1f, COLOR_CONTACT_A );
+			AddPoint( ptB, 0.1f, COLOR_CONTACT_B );
+			AddArrow( ptA, contact.normal * 0.3f, COLOR_NORMAL );
+		}
+	}
+}
+
+/*
+====================================================
+DebugDraw::AddBodyBounds
+====================================================
+*/
+void DebugDraw::AddBodyBounds( const Body * bodies, const int num ) {
+	for ( int i = 0; i < num; i++ ) {
+		const Body & body = bodies[ i ];
+		const Bounds bounds = body.m_shape->GetBounds( body.m_position, body.m_orientation );
+		AddBounds( bounds, ( 0.0f == body.m_invMass ) ? COLOR_BOUNDS_STATIC : COLOR_BOUNDS_DYNAMIC );
+	}
+}
+
+/*
+====================================================
+DebugDraw::AddConstraints
+
+Anchors, the arms from each center of mass to its anchor and the constraint axis
+====================================================
+*/
+void DebugDraw::AddConstraints( Constraint * const * constraints, const int num ) {
+	for ( int i = 0; i < num; i++ ) {
+		const Constraint * constraint = constraints[ i ];
+		const Body * bodyA = constraint->m_bodyA;
+		const Body * bodyB = constraint->m_bodyB;
+
+		const Vec3 anchorA = bodyA->BodySpaceToWorldSpace( constraint->m_anchorA );
+		const Vec3 anchorB = bodyB->BodySpaceToWorldSpace( constraint->m_anchorB );
+		AddLine( bodyA->GetCenterOfMassWorldSpace(), anchorA, COLOR_ANCHOR );
+		AddLine( bodyB->GetCenterOfMassWorldSpace(), anchorB, COLOR_ANCHOR );
+		AddPoint( anchorA, 0.1f, COLOR_ANCHOR );
+
+		const Vec3 axis = bodyA->m_orientation.RotatePoint( constraint->m_axisA );
+		AddArrow( anchorA, axis * 0.5f, COLOR_AXIS );
+	}
+}
+
+/*
+====================================================
+DebugDraw::Draw
+====================================================
+*/
+void DebugDraw::Draw( DeviceContext * device, int cmdBufferIndex, Buffer * uniforms, const int camOffset, const int camSize ) {
+	if ( !m_isValid || m_verts.empty() ) {
+		return;
+	}
+
+	int numVerts = (int)m_verts.size();
+	if ( numVerts > m_maxVertsPerSlot ) {
+		numVerts = m_maxVertsPerSlot;
+	}
+
+	// Each frame in flight has its own slot of the ring
+	const int slot = m_frameCount % m_numSlots;
+	m_frameCount++;
+	const int byteOffset = slot * m_maxVertsPerSlot * (int)sizeof( debugVert_t );
+	memcpy( m_mapped + byteOffset, m_verts.data(), numVerts * sizeof( debugVert_t ) );
+
+	VkCommandBuffer cmdBuffer = device->m_vkCommandBuffers[ cmdBufferIndex ];
+	m_pipeline.BindPipeline( cmdBuffer );
+
+	Descriptor descriptor = m_pipeline.GetFreeDescriptor();
+	descriptor.BindBuffer( uniforms, camOffset, camSize, 0 );
+	descriptor.BindDescriptor( device, cmdBuffer, &m_pipeline );
+
+	VkBuffer vertexBuffers[] = { m_vertexBuffer.m_vkBuffer };
+	VkDeviceSize offsets[] = { (VkDeviceSize)byteOffset };
+	vkCmdBindVertexBuffers( cmdBuffer, 0, 1, vertexBuffers, offsets );
+	vkCmdDraw( cmdBuffer, (uint32_t)numVerts, 1, 0, 0 );
+}
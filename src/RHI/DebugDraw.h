@@ -0,0 +1,110 @@
+//
+//  DebugDraw.h
+//
+#pragma once
+#include <vulkan/vulkan.hpp>
+#include <vector>
+#include <array>
+#include "Buffer.h"
+#include "Descriptor.h"
+#include "Pipeline.h"
+#include "shader.h"
+#include "../Math/Vector.h"
+#include "../Math/Quat.h"
+#include "../Math/Bounds.h"
+
+class Body;
+class Constraint;
+class Articulation;
+class ManifoldCollector;
+class FrameBuffer;
+
+/*
+====================================================
+debugVert_t
+// 4 * 4 = 16 bytes
+====================================================
+*/
+struct debugVert_t {
+	float			xyz[ 3 ];	// 12 bytes
+	unsigned char	rgba[ 4 ];	// 4 bytes
+
+	static VkVertexInputBindingDescription GetBindingDescription() {
+		VkVertexInputBindingDescription bindingDescription = {};
+		bindingDescription.binding = 0;
+		bindingDescription.stride = sizeof( debugVert_t );
+		bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+		return bindingDescription;
+	}
+
+	static std::array< VkVertexInputAttributeDescription, 2 > GetAttributeDescriptions() {
+		std::array< VkVertexInputAttributeDescription, 2 > attributeDescriptions = {};
+
+		attributeDescriptions[ 0 ].binding = 0;
+		attributeDescriptions[ 0 ].location = 0;
+		attributeDescriptions[ 0 ].format = VK_FORMAT_R32G32B32_SFLOAT;
+		attributeDescriptions[ 0 ].offset = offsetof( debugVert_t, xyz );
+
+		attributeDescriptions[ 1 ].binding = 0;
+		attributeDescriptions[ 1 ].location = 1;
+		attributeDescriptions[ 1 ].format = VK_FORMAT_R8G8B8A8_UNORM;
+		attributeDescriptions[ 1 ].offset = offsetof( debugVert_t, rgba );
+
+		return attributeDescriptions;
+	}
+};
+
+/*
+====================================================
+DebugDraw
+
+Collects lines for the frame on the cpu and draws all of them with
+one line list pipeline and a single draw call.  The vertex buffer is
+host visible, stays mapped and is split into one slot per frame in
+flight, so writing this frame's lines never touches memory that a
+previous frame may still be reading.
+====================================================
+*/
+class DebugDraw {
+public:
+	DebugDraw() : m_maxVertsPerSlot( 0 ), m_numSlots( 0 ), m_frameCount( 0 ), m_mapped( NULL ), m_isValid( false ) {}
+
+	bool Create( DeviceContext * device, FrameBuffer * frameBuffer, const int maxLines );
+	void Cleanup( DeviceContext * device );
+
+	void Clear() { m_verts.clear(); }
+	void SetViewOrigin( const Vec3 & origin ) { m_viewOrigin = origin; }	// lines are stored relative to it, like the camera
+	int GetNumLines() const { return (int)m_verts.size() / 2; }
+
+	void AddLine( const Vec3 & a, const Vec3 & b, const Vec4 & color );
+	void AddPoint( const Vec3 & pt, const float size, const Vec4 & color );
+	void AddArrow( const Vec3 & pt, const Vec3 & dir, const Vec4 & color );
+	void AddBounds( const Bounds & bounds, const Vec4 & color );
+	void AddAxes( const Vec3 & pos, const Quat & orient, const float size );
+
+	// Physics overlays
+	void AddContacts( const ManifoldCollector & manifolds );
+	void AddBodyBounds( const Body * bodies, const int num );
+	void AddConstraints( Constraint * const * constraints, const int num );
+
+	// Records the copy of this frame's lines and the one draw call, must be inside a render pass
+	void Draw( DeviceContext * device, int cmdBufferIndex, Buffer * uniforms, const int camOffset, const int camSize );
+
+private:
+	int m_maxVertsPerSlot;
+	int m_numSlots;
+	int m_frameCount;	// frames drawn, picks the slot
+
+	std::vector< debugVert_t > m_verts;
+	Vec3 m_viewOrigin;
+
+	Buffer m_vertexBuffer;
+	unsigned char * m_mapped;
+
+	Shader m_shader;
+	Descriptors m_descriptors;
+	Pipeline m_pipeline;
+
+	bool m_isValid;
+};
@@ -551,6 +551,7 @@ bool DeviceContext::CreateLogicalDevice()
 
     VkPhysicalDeviceFeatures deviceFeatures = {};
     deviceFeatures.samplerAnisotropy = VK_TRUE;
+    deviceFeatures.textureCompressionBC = m_physicalDevices[m_deviceIndex].m_vkFeatures.textureCompressionBC; // baked textures, see TextureCompressor.h
 
     VkDeviceCreateInfo createInfo = {};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
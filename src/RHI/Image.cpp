@@ -22,6 +22,23 @@ bool Image::Create( DeviceContext * device, const CreateParms_t & parms ) {
 	VkResult result;
 
 	m_parms = parms;
+	if ( m_parms.mipLevels < 1 ) {
+		m_parms.mipLevels = 1;
+	}
+	m_vkImageLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+	// Block compressed formats can only be copied to and sampled, and not every device has them
+	if ( GetBlockBytes( m_parms.format ) > 0 ) {
+		if ( !SupportsSampling( device, m_parms.format ) ) {
+			printf( "ERROR: Compressed image format isn't supported by the device\n" );
+			return false;
+		}
+		if ( 0 != ( m_parms.usageFlags & ( VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_STORAGE_BIT ) ) ) {
+			printf( "ERROR: Compressed images can't be rendered to\n" );
+			assert( 0 );
+			return false;
+		}
+	}
 
 	//
 	//	Create the Image
@@ -40,7 +57,7 @@ bool Image::Create( DeviceContext * device, const CreateParms_t & parms ) {
 	image.extent.width = m_parms.width;
 	image.extent.height = m_parms.height;
 	image.extent.depth = m_parms.depth;
-	image.mipLevels = 1;
+	image.mipLevels = m_parms.mipLevels;
 	image.arrayLayers = 1;
 	image.samples = VK_SAMPLE_COUNT_1_BIT;
 	image.tiling = VK_IMAGE_TILING_OPTIMAL;
@@ -68,6 +85,7 @@ bool Image::Create( DeviceContext * device, const CreateParms_t & parms ) {
 	VkMemoryRequirements memReqs;
 	vkGetImageMemoryRequirements( device->m_vkDevice, m_vkImage, &memReqs );
 	memAlloc.allocationSize = memReqs.size;
+	m_vkMemorySize = memReqs.size;
 	memAlloc.memoryTypeIndex = device->FindMemoryTypeIndex( memReqs.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT );
 
 	result = vkAllocateMemory( device->m_vkDevice, &memAlloc, nullptr, &m_vkDeviceMemory );
@@ -107,7 +125,7 @@ bool Image::Create( DeviceContext * device, const CreateParms_t & parms ) {
 	}
 
 	imageView.subresourceRange.baseMipLevel = 0;
-	imageView.subresourceRange.levelCount = 1;
+	imageView.subresourceRange.levelCount = m_parms.mipLevels;
 	imageView.subresourceRange.baseArrayLayer = 0;
 	imageView.subresourceRange.layerCount = 1;
 	imageView.image = m_vkImage;
@@ -155,7 +173,7 @@ void Image::TransitionLayout( DeviceContext * device ) {
 		barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
 	}
 	barrier.subresourceRange.baseMipLevel = 0;
-	barrier.subresourceRange.levelCount = 1;
+	barrier.subresourceRange.levelCount = m_parms.mipLevels;
 	barrier.subresourceRange.baseArrayLayer = 0;
 	barrier.subresourceRange.layerCount = 1;
 	barrier.srcAccessMask = 0;
@@ -205,7 +223,7 @@ void Image::TransitionLayout( VkCommandBuffer cmdBuffer, VkImageLayout newLayout
 		barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
 	}
 	barrier.subresourceRange.baseMipLevel = 0;
-	barrier.subresourceRange.levelCount = 1;
+	barrier.subresourceRange.levelCount = m_parms.mipLevels;
 	barrier.subresourceRange.baseArrayLayer = 0;
 	barrier.subresourceRange.layerCount = 1;
 	barrier.srcAccessMask = 0;
@@ -228,4 +246,139 @@ void Image::TransitionLayout( VkCommandBuffer cmdBuffer, VkImageLayout newLayout
 	);
 
 	m_vkImageLayout = newLayout;
+}
+
+/*
+====================================================
+Image::GetNumMipLevels
+====================================================
+*/
+int Image::GetNumMipLevels( const int width, const int height ) {
+	int numLevels = 1;
+	int size = ( width > height ) ? width : height;
+	while ( size > 1 ) {
+		size >>= 1;
+		numLevels++;
+	}
+	return numLevels;
+}
+
+/*
+====================================================
+Image::SupportsLinearBlit
+====================================================
+*/
+bool Image::SupportsLinearBlit( DeviceContext * device, VkFormat format ) {
+	VkFormatProperties formatProperties;
+	vkGetPhysicalDeviceFormatProperties( device->m_vkPhysicalDevice, format, &formatProperties );
+	return 0 != ( formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT );
+}
+
+/*
+====================================================
+Image::SupportsSampling
+====================================================
+*/
+bool Image::SupportsSampling( DeviceContext * device, VkFormat format ) {
+	VkFormatProperties formatProperties;
+	vkGetPhysicalDeviceFormatProperties( device->m_vkPhysicalDevice, format, &formatProperties );
+	return 0 != ( formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT );
+}
+
+/*
+====================================================
+Image::GetBlockBytes
+====================================================
+*/
+int Image::GetBlockBytes( VkFormat format ) {
+	switch ( format ) {
+		case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+		case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+		case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+		case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+		case VK_FORMAT_BC4_UNORM_BLOCK:
+		case VK_FORMAT_BC4_SNORM_BLOCK:
+			return 8;
+		case VK_FORMAT_BC2_UNORM_BLOCK:
+		case VK_FORMAT_BC2_SRGB_BLOCK:
+		case VK_FORMAT_BC3_UNORM_BLOCK:
+		case VK_FORMAT_BC3_SRGB_BLOCK:
+		case VK_FORMAT_BC5_UNORM_BLOCK:
+		case VK_FORMAT_BC5_SNORM_BLOCK:
+		case VK_FORMAT_BC6H_UFLOAT_BLOCK:
+		case VK_FORMAT_BC6H_SFLOAT_BLOCK:
+		case VK_FORMAT_BC7_UNORM_BLOCK:
+		case VK_FORMAT_BC7_SRGB_BLOCK:
+			return 16;
+		default:
+			return 0;
+	}
+}
+
+/*
+====================================================
+Image::GenerateMipmaps
+====================================================
+*/
+void Image::GenerateMipmaps( VkCommandBuffer cmdBuffer ) {
+	VkImageMemoryBarrier barrier = {};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image = m_vkImage;
+	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	barrier.subresourceRange.baseArrayLayer = 0;
+	barrier.subresourceRange.layerCount = 1;
+	barrier.subresourceRange.levelCount = 1;
+
+	int mipWidth = m_parms.width;
+	int mipHeight = m_parms.height;
+	for ( int i = 1; i < m_parms.mipLevels; i++ ) {
+		// The level above is done being written, read it
+		barrier.subresourceRange.baseMipLevel = i - 1;
+		barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		vkCmdPipelineBarrier( cmdBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier );
+
+		const int nextWidth = ( mipWidth > 1 ) ? mipWidth / 2 : 1;
+		const int nextHeight = ( mipHeight > 1 ) ? mipHeight / 2 : 1;
+
+		VkImageBlit blit = {};
+		blit.srcOffsets[ 0 ] = { 0, 0, 0 };
+		blit.srcOffsets[ 1 ] = { mipWidth, mipHeight, 1 };
+		blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		blit.srcSubresource.mipLevel = i - 1;
+		blit.srcSubresource.baseArrayLayer = 0;
+		blit.srcSubresource.layerCount = 1;
+		blit.dstOffsets[ 0 ] = { 0, 0, 0 };
+		blit.dstOffsets[ 1 ] = { nextWidth, nextHeight, 1 };
+		blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		blit.dstSubresource.mipLevel = i;
+		blit.dstSubresource.baseArrayLayer = 0;
+		blit.dstSubresource.layerCount = 1;
+
+		vkCmdBlitImage( cmdBuffer, m_vkImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, m_vkImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR );
+
+		// The level above is final
+		barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		vkCmdPipelineBarrier( cmdBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier );
+
+		mipWidth = nextWidth;
+		mipHeight = nextHeight;
+	}
+
+	// The last level was only written
+	barrier.subresourceRange.baseMipLevel = m_parms.mipLevels - 1;
+	barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	vkCmdPipelineBarrier( cmdBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier );
+
+	m_vkImageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 }
\ No newline at end of file
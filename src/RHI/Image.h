@@ -21,6 +21,7 @@ public:
 		int width;
 		int height;
 		int depth;
+		int mipLevels = 1;
 	};
 
 	bool Create( DeviceContext * device, const CreateParms_t & parms );
@@ -28,10 +29,22 @@ public:
 	void TransitionLayout( DeviceContext * device );
 	void TransitionLayout( VkCommandBuffer cmdBuffer, VkImageLayout newLayout );
 
+	// Fills the levels below the first by blitting each from the one above.  The whole image
+	// has to be in VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, all of it ends up shader read only.
+	void GenerateMipmaps( VkCommandBuffer cmdBuffer );
+
+	static int GetNumMipLevels( const int width, const int height );
+	static bool SupportsLinearBlit( DeviceContext * device, VkFormat format );
+	static bool SupportsSampling( DeviceContext * device, VkFormat format );
+
+	// Bytes per 4x4 block of the BC formats, 0 for formats that aren't block compressed
+	static int GetBlockBytes( VkFormat format );
+
 	CreateParms_t	m_parms;
 	VkImage			m_vkImage;
 	VkImageView		m_vkImageView;
 	VkDeviceMemory	m_vkDeviceMemory;
+	VkDeviceSize	m_vkMemorySize;
 
 	VkImageLayout	m_vkImageLayout;
 };
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include "model.h"
 #include "Samplers.h"
 #include "Loader/Mesh.h"
+#include "DebugDraw.h"
 
 #include "../application.h"
 #include <assert.h>
@@ -35,6 +36,8 @@ Pipeline g_meshShadowPipeline;
 Shader g_meshShadowShader;
 Descriptors g_meshShadowDescriptors;
 
+DebugDraw g_debugDraw;
+
 /*
 ====================================================
 InitOffscreen
@@ -85,7 +88,7 @@ bool InitOffscreen( DeviceContext * device, int width, int height ) {
 
 		Descriptors::CreateParms_t descriptorParms;
 		memset( &descriptorParms, 0, sizeof( descriptorParms ) );
-		descriptorParms.numUniformsVertex = 2;
+		descriptorParms.numUniformsVertex = 3;	// camera, model and the part's dequantization
 		result = g_shadowDescriptors.Create( device, descriptorParms );
 		if ( !result ) {
 			printf( "ERROR: Failed to build descriptors\n" );
@@ -225,6 +228,11 @@ bool InitOffscreen( DeviceContext * device, int width, int height ) {
         }
 	}
 
+	//
+	//	Debug lines, optional so a failure here doesn't stop the renderer
+	//
+	g_debugDraw.Create( device, &g_offscreenFrameBuffer, 64 * 1024 );
+
 	return true;
 }
 
@@ -240,6 +248,8 @@ bool CleanupOffscreen( DeviceContext * device ) {
 	g_offscreenFrameBuffer.Cleanup( device );
 	g_skyModel.Cleanup( *device );
 
+	g_debugDraw.Cleanup( device );
+
 	/*g_checkerboardShadowPipeline.Cleanup( device );
 	g_checkerboardShadowShader.Cleanup( device );
 	g_checkerboardShadowDescriptors.Cleanup( device );*/
@@ -337,6 +347,11 @@ void DrawOffscreen( DeviceContext * device, int cmdBufferIndex, Buffer * uniform
 			//}
 		}
 
+		//
+		//	Draw the debug lines
+		//
+		g_debugDraw.Draw( device, cmdBufferIndex, uniforms, camOffset, camSize );
+
 		g_offscreenFrameBuffer.EndRenderPass( device, cmdBufferIndex );
 
 		g_offscreenFrameBuffer.m_imageColor.TransitionLayout( cmdBuffer, VK_IMAGE_LAYOUT_GENERAL );		
@@ -345,10 +360,22 @@ void DrawOffscreen( DeviceContext * device, int cmdBufferIndex, Buffer * uniform
 
 namespace ElecNeko
 {
-	void DrawOffscreen(DeviceContext* device, int cmdBufferIndex, Buffer* uniforms, std::vector<Mesh*> mesh)
+	void DrawOffscreen(DeviceContext* device, int cmdBufferIndex, Buffer* uniforms, std::vector<Mesh*> mesh, const float pixelsPerUnit)
 	{
         VkCommandBuffer cmdBuffer = device->m_vkCommandBuffers[cmdBufferIndex];
 
+        // Levels of detail from the main camera, the shadow pass draws the same ones
+        // so the shadows fall on the geometry that casts them
+        std::vector<std::vector<int>> lods(mesh.size());
+        for (int i = 0; i < mesh.size(); i++)
+        {
+            lods[i].resize(mesh[i]->m_meshParts.size());
+            for (int j = 0; j < mesh[i]->m_meshParts.size(); j++)
+            {
+                lods[i][j] = mesh[i]->SelectLod(j, pixelsPerUnit);
+            }
+        }
+
         const int camOffset = 0;
         const int camSize = sizeof(float) * 16 * 4;
 
@@ -371,8 +398,9 @@ namespace ElecNeko
                     Descriptor descriptor = g_shadowPipeline.GetFreeDescriptor();
                     descriptor.BindBuffer(uniforms, shadowCamOffset, shadowCamSize, 0);
                     descriptor.BindBuffer(&mesh[i]->uniformBuffer, 0, mesh[i]->uniformBuffer.m_vkBufferSize, 1);
+                    descriptor.BindBuffer(&mesh[i]->m_meshParts[j].m_uniformBuffer, 0, mesh[i]->m_meshParts[j].m_uniformBuffer.m_vkBufferSize, 2);
                     descriptor.BindDescriptor(device, cmdBuffer, &g_shadowPipeline);
-                    mesh[i]->m_meshParts[j].DrawIndexed(cmdBuffer);
+                    mesh[i]->m_meshParts[j].DrawIndexed(cmdBuffer, lods[i][j]);
 				}
 			}
 
@@ -404,6 +432,10 @@ namespace ElecNeko
 
 				for (int i = 0; i < mesh.size(); i++)
 				{
+                    // Full detail parts skip their back facing meshlets, the shadow pass culls
+                    // front faces so it always draws whole parts
+                    Vec3 viewPos;
+                    const bool cullMeshlets = mesh[i]->GetLocalViewPosition(viewPos);
 					for (int j = 0; j < mesh[i]->m_meshParts.size(); j++)
 					{
                         if (mesh[i]->m_meshParts[j].m_vertices.empty())
@@ -416,14 +448,25 @@ namespace ElecNeko
                         descriptor.BindImage(VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL, g_shadowFrameBuffer.m_imageDepth.m_vkImageView, Samplers::m_samplerStandard, 0);
                         if (mesh[i]->m_meshParts[j].albTexIndex >= 0)
                         {
-                            descriptor.BindImage(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, mesh[i]->albedoMaps[mesh[i]->m_meshParts[j].albTexIndex].m_image.m_vkImageView, ElecNeko::ElecNekoSampler::m_samplerTexture, 1);
+                            const ElecNeko::Texture *albedoMap = ElecNeko::g_textureManager.GetTexture(mesh[i]->albedoMaps[mesh[i]->m_meshParts[j].albTexIndex]);
+                            descriptor.BindImage(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, albedoMap->m_image.m_vkImageView, ElecNeko::ElecNekoSampler::m_samplerTexture, 1);
                         }
                         descriptor.BindDescriptor(device, cmdBuffer, &g_meshShadowPipeline);
-                        mesh[i]->m_meshParts[j].DrawIndexed(cmdBuffer);
+                        if (cullMeshlets && lods[i][j] == 0 && !mesh[i]->m_meshParts[j].m_meshlets.empty())
+                        {
+                            mesh[i]->m_meshParts[j].DrawMeshlets(cmdBuffer, viewPos);
+                        }
+                        else
+                        {
+                            mesh[i]->m_meshParts[j].DrawIndexed(cmdBuffer, lods[i][j]);
+                        }
 					}
 				}
 			}
 
+            // draw the debug lines last, all of them in one draw call
+            g_debugDraw.Draw(device, cmdBufferIndex, uniforms, camOffset, camSize);
+
 			g_offscreenFrameBuffer.EndRenderPass(device, cmdBufferIndex);
 
             g_offscreenFrameBuffer.m_imageColor.TransitionLayout(cmdBuffer, VK_IMAGE_LAYOUT_GENERAL);	
@@ -17,5 +17,6 @@ namespace ElecNeko
 {
     class Mesh;
 
-    void DrawOffscreen(DeviceContext *device, int cmdBufferIndex, Buffer *uniforms, std::vector<Mesh*> mesh);
+    // pixelsPerUnit is the size in pixels of one unit at distance one from the camera, for the levels of detail
+    void DrawOffscreen(DeviceContext *device, int cmdBufferIndex, Buffer *uniforms, std::vector<Mesh*> mesh, const float pixelsPerUnit);
 }
\ No newline at end of file
@@ -8,6 +8,7 @@
 #include "Descriptor.h"
 #include "model.h"
 #include "Loader/Mesh.h"
+#include "DebugDraw.h"
 #include <assert.h>
 
 /*
@@ -216,6 +217,164 @@ bool Pipeline::Create( DeviceContext * device, const CreateParms_t & parms ) {
 	return true;
 }
 
+/*
+====================================================
+Pipeline::CreateForLines
+
+Line list pipeline for the debugVert_t format, only uses the
+vertex and fragment stages
+====================================================
+*/
+bool Pipeline::CreateForLines( DeviceContext * device, const CreateParms_t & parms ) {
+	VkResult result;
+
+	m_parms = parms;
+
+	const int width = parms.width;
+	const int height = parms.height;
+
+	std::vector< VkPipelineShaderStageCreateInfo > shaderStages;
+	const int stageIndices[ 2 ] = { Shader::SHADER_STAGE_VERTEX, Shader::SHADER_STAGE_FRAGMENT };
+	const VkShaderStageFlagBits stageBits[ 2 ] = { VK_SHADER_STAGE_VERTEX_BIT, VK_SHADER_STAGE_FRAGMENT_BIT };
+	for ( int i = 0; i < 2; i++ ) {
+		if ( NULL == parms.shader->m_vkShaderModules[ stageIndices[ i ] ] ) {
+			printf( "ERROR: Line pipeline is missing a shader stage\n" );
+			return false;
+		}
+
+		VkPipelineShaderStageCreateInfo shaderStageInfo = {};
+		shaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		shaderStageInfo.stage = stageBits[ i ];
+		shaderStageInfo.module = parms.shader->m_vkShaderModules[ stageIndices[ i ] ];
+		shaderStageInfo.pName = "main";
+
+		shaderStages.push_back( shaderStageInfo );
+	}
+
+	VkPipelineVertexInputStateCreateInfo vertexInputInfo = {};
+	vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+
+	VkVertexInputBindingDescription bindingDescription = debugVert_t::GetBindingDescription();
+	std::array< VkVertexInputAttributeDescription, 2 > attributeDescriptions = debugVert_t::GetAttributeDescriptions();
+
+	vertexInputInfo.vertexBindingDescriptionCount = 1;
+	vertexInputInfo.vertexAttributeDescriptionCount = (uint32_t)attributeDescriptions.size();
+	vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
+	vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
+
+	VkPipelineInputAssemblyStateCreateInfo inputAssembly = {};
+	inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+	inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_LINE_LIST;
+	inputAssembly.primitiveRestartEnable = VK_FALSE;
+
+	VkViewport viewport = {};
+	viewport.x = 0.0f;
+	viewport.y = 0.0f;
+	viewport.width = (float)width;
+	viewport.height = (float)height;
+	viewport.minDepth = 0.0f;
+	viewport.maxDepth = 1.0f;
+
+	VkRect2D scissor = {};
+	scissor.offset = { 0, 0 };
+	scissor.extent = { (uint32_t)width, (uint32_t)height };
+
+	VkPipelineViewportStateCreateInfo viewportState = {};
+	viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+	viewportState.viewportCount = 1;
+	viewportState.pViewports = &viewport;
+	viewportState.scissorCount = 1;
+	viewportState.pScissors = &scissor;
+
+	// Wide lines are an optional feature, so stick to one pixel
+	VkPipelineRasterizationStateCreateInfo rasterizer = {};
+	rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+	rasterizer.depthClampEnable = VK_FALSE;
+	rasterizer.rasterizerDiscardEnable = VK_FALSE;
+	rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
+	rasterizer.lineWidth = 1.0f;
+	rasterizer.cullMode = VK_CULL_MODE_NONE;
+	rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+	rasterizer.depthBiasEnable = VK_FALSE;
+
+	VkPipelineMultisampleStateCreateInfo multisampling = {};
+	multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+	multisampling.sampleShadingEnable = VK_FALSE;
+	multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+	VkPipelineDepthStencilStateCreateInfo depthStencil = {};
+	depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+	depthStencil.depthTestEnable = parms.depthTest ? VK_TRUE : VK_FALSE;
+	depthStencil.depthWriteEnable = parms.depthWrite ? VK_TRUE : VK_FALSE;
+	depthStencil.depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
+	depthStencil.depthBoundsTestEnable = VK_FALSE;
+	depthStencil.stencilTestEnable = VK_FALSE;
+
+	VkPipelineColorBlendAttachmentState colorBlendAttachment = {};
+	colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+	colorBlendAttachment.blendEnable = VK_FALSE;
+
+	VkPipelineColorBlendStateCreateInfo colorBlending = {};
+	colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+	colorBlending.logicOpEnable = VK_FALSE;
+	colorBlending.logicOp = VK_LOGIC_OP_COPY;
+	colorBlending.attachmentCount = 1;
+	colorBlending.pAttachments = &colorBlendAttachment;
+
+	VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+	pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	pipelineLayoutInfo.setLayoutCount = 1;
+	pipelineLayoutInfo.pSetLayouts = &parms.descriptors->m_vkDescriptorSetLayout;
+
+	result = vkCreatePipelineLayout( device->m_vkDevice, &pipelineLayoutInfo, nullptr, &m_vkPipelineLayout );
+	if ( VK_SUCCESS != result ) {
+		printf( "ERROR: Failed to create pipeline layout\n" );
+		assert( 0 );
+		return false;
+	}
+
+	VkDynamicState dynamicSate[ 2 ] = {
+		VK_DYNAMIC_STATE_VIEWPORT,
+		VK_DYNAMIC_STATE_SCISSOR
+	};
+
+	VkPipelineDynamicStateCreateInfo dynamicState = {};
+	dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+	dynamicState.flags = 0;
+	dynamicState.dynamicStateCount = 2;
+	dynamicState.pDynamicStates = dynamicSate;
+
+	VkGraphicsPipelineCreateInfo pipelineInfo = {};
+	pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+	pipelineInfo.stageCount = (uint32_t)shaderStages.size();
+	pipelineInfo.pStages = shaderStages.data();
+	pipelineInfo.pVertexInputState = &vertexInputInfo;
+	pipelineInfo.pInputAssemblyState = &inputAssembly;
+	pipelineInfo.pViewportState = &viewportState;
+	pipelineInfo.pRasterizationState = &rasterizer;
+	pipelineInfo.pMultisampleState = &multisampling;
+	pipelineInfo.pDepthStencilState = &depthStencil;
+	pipelineInfo.pColorBlendState = &colorBlending;
+	pipelineInfo.pDynamicState = &dynamicState;
+	pipelineInfo.layout = m_vkPipelineLayout;
+	if ( NULL == parms.framebuffer ) {
+		pipelineInfo.renderPass = parms.renderPass;
+	} else {
+		pipelineInfo.renderPass = parms.framebuffer->m_vkRenderPass;
+	}
+	pipelineInfo.subpass = 0;
+	pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+
+	result = vkCreateGraphicsPipelines( device->m_vkDevice, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_vkPipeline );
+	if ( VK_SUCCESS != result ) {
+		printf( "ERROR: Failed to create pipeline\n" );
+		assert( 0 );
+		return false;
+	}
+
+	return true;
+}
+
 /*
 ====================================================
 Pipeline::CreateCompute
@@ -419,8 +578,8 @@ bool Pipeline::CreateForMesh(DeviceContext *device, const CreateParms_t &parms)
     VkPipelineVertexInputStateCreateInfo vertexInputInfo = {};
     vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
 
-    VkVertexInputBindingDescription bindingDescription = ElecNeko::VVertex::GetBindingDescription();
-    std::array<VkVertexInputAttributeDescription, 3> attributeDescriptions = ElecNeko::VVertex::GetAttributeDescriptions();
+    VkVertexInputBindingDescription bindingDescription = ElecNeko::VVertexPacked::GetBindingDescription();
+    std::array<VkVertexInputAttributeDescription, 3> attributeDescriptions = ElecNeko::VVertexPacked::GetAttributeDescriptions();
 
     vertexInputInfo.vertexBindingDescriptionCount = 1;
     vertexInputInfo.vertexAttributeDescriptionCount = (uint32_t) attributeDescriptions.size();
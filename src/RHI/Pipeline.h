@@ -78,6 +78,7 @@ public:
 	};
 	bool Create( DeviceContext * device, const CreateParms_t & parms );
     bool CreateForMesh(DeviceContext *device, const CreateParms_t &parms);
+	bool CreateForLines( DeviceContext * device, const CreateParms_t & parms );
 	bool CreateCompute( DeviceContext * device, const CreateParms_t & parms );
 	void Cleanup( DeviceContext * device );
 
@@ -96,6 +96,9 @@ namespace ElecNeko
         samplerInfo.compareEnable = VK_FALSE;
         samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
         samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+        samplerInfo.mipLodBias = 0.0f;
+        samplerInfo.minLod = 0.0f;
+        samplerInfo.maxLod = VK_LOD_CLAMP_NONE; // a maxLod of 0 would only ever sample the first level
 
 		if (vkCreateSampler(device->m_vkDevice, &samplerInfo, nullptr, &m_samplerTexture))
 		{
@@ -103,6 +106,8 @@ namespace ElecNeko
             assert(0);
             return false;
 		}
+
+		return true;
 	}
 
 	void ElecNekoSampler::Cleanup(DeviceContext* device) 
@@ -7,6 +7,9 @@
 
 class DeviceContext;
 
+// Frames recorded before the gpu has to be done with the oldest one, EndFrame waits for the queue so it never gets that far
+const int MAX_FRAMES_IN_FLIGHT = 2;
+
 /*
 ====================================================
 SwapChain
@@ -5,6 +5,22 @@
  #include "Physics/Broadphase.h"
  #include "Physics/Contact.h"
  #include "Physics/Intersections.h"
+ #include <chrono>
+
+ typedef std::chrono::steady_clock sceneClock_t;
+
+ /*
+ ====================================================
+ ElapsedMS
+ ====================================================
+ */
+ static float ElapsedMS(sceneClock_t::time_point &start)
+ {
+     const sceneClock_t::time_point now = sceneClock_t::now();
+     const float ms = std::chrono::duration<float, std::milli>(now - start).count();
+     start = now;
+     return ms;
+ }
 
  /*
  ========================================================================================================
@@ -26,6 +42,18 @@
          delete m_bodies[i].m_shape;
      }
      m_bodies.clear();
+
+     for (int i = 0; i < m_constraints.size(); i++)
+     {
+         delete m_constraints[i];
+     }
+     m_constraints.clear();
+
+     for (int i = 0; i < m_articulations.size(); i++)
+     {
+         delete m_articulations[i];
+     }
+     m_articulations.clear();
  }
 
  /*
@@ -41,6 +69,23 @@
      }
      m_bodies.clear();
 
+     for (int i = 0; i < m_constraints.size(); i++)
+     {
+         delete m_constraints[i];
+     }
+     m_constraints.clear();
+
+     for (int i = 0; i < m_articulations.size(); i++)
+     {
+         delete m_articulations[i];
+     }
+     m_articulations.clear();
+     m_manifolds.Clear();
+
+     // The bodies are created relative to the world origin again
+     m_staticGeometry.Translate(m_origin.ToVec3());
+     m_origin = Vec3d();
+
      Initialize();
  }
 
@@ -55,14 +100,18 @@
      body.m_position = Vec3(0, 0, 0);
      body.m_orientation = Quat(0, 0, 0, 1);
      body.m_shape = new ShapeSphere(1.0f);
+     body.m_invMass = 1.0f;
+     body.m_elasticity = 0.5f;
+     body.m_friction = 0.5f;
      m_bodies.push_back(body);
 
      body.m_position = Vec3(0, 0, -101);
      body.m_orientation = Quat(0, 0, 0, 1);
      body.m_shape = new ShapeSphere(100.0f);
+     body.m_invMass = 0.0f;
+     body.m_elasticity = 1.0f;
+     body.m_friction = 0.5f;
      m_bodies.push_back(body);
-
-     // TODO: Add code
  }
 
  /*
@@ -72,6 +121,137 @@
  */
  void Scene::Update(const float dt_sec)
  {
-     // TODO: Add code
+     sceneClock_t::time_point phaseStart = sceneClock_t::now();
+
+     m_manifolds.RemoveExpired();
+
+     for (int i = 0; i < m_bodies.size(); i++)
+     {
+         Body *body = &m_bodies[i];
+
+         // Gravity needs to be an impulse
+         // I = dp, F = dp/dt => dp = F * dt => I = F * dt
+         // F = mgs
+         float mass = 1.0f / body->m_invMass;
+         if (0.0f == body->m_invMass)
+         {
+             continue;
+         }
+         Vec3 impulseGravity = Vec3(0, 0, -10) * mass * dt_sec;
+         body->ApplyImpulseLinear(impulseGravity);
+     }
+
+     //
+     // Broadphase
+     //
+     std::vector<collisionPair_t> collisionPairs;
+     BroadPhase(m_bodies.data(), (int) m_bodies.size(), collisionPairs, dt_sec);
+     m_timings.broadphase = ElapsedMS(phaseStart);
+
+     //
+     //	NarrowPhase (perform actual collision detection)
+     //
+     // Bodies that opted into speculative contacts also get contacts for pairs that will
+     // touch within this step.  They go through the same solver as resting contacts, which
+     // only lets the pair close the gap, so there is no time of impact stepping.
+     for (int i = 0; i < collisionPairs.size(); i++)
+     {
+         const collisionPair_t pair = collisionPairs[i];
+         Body *bodyA = &m_bodies[pair.a];
+         Body *bodyB = &m_bodies[pair.b];
+
+         // Skip body pairs with infinite mass
+         if (0.0f == bodyA->m_invMass && 0.0f == bodyB->m_invMass)
+         {
+             continue;
+         }
+
+         contact_t contact;
+         if (Intersect(bodyA, bodyB, dt_sec, contact))
+         {
+             m_manifolds.AddContact(contact);
+         }
+     }
+     m_timings.narrowphase = ElapsedMS(phaseStart);
+
+     //
+     // Solve Constraints
+     //
+     for (int i = 0; i < m_constraints.size(); i++)
+     {
+         m_constraints[i]->PreSolve(dt_sec);
+     }
+     m_manifolds.PreSolve(dt_sec);
+     for (int i = 0; i < m_articulations.size(); i++)
+     {
+         m_articulations[i]->PreSolve(dt_sec);
+     }
+
+     const int maxIters = 5;
+     for (int iters = 0; iters < maxIters; iters++)
+     {
+         for (int i = 0; i < m_constraints.size(); i++)
+         {
+             m_constraints[i]->Solve();
+         }
+         m_manifolds.Solve();
+
+         // The direct solve goes last so the joints are exact after every iteration
+         for (int i = 0; i < m_articulations.size(); i++)
+         {
+             m_articulations[i]->Solve();
+         }
+     }
+
+     for (int i = 0; i < m_constraints.size(); i++)
+     {
+         m_constraints[i]->PostSolve();
+     }
+     m_manifolds.PostSolve();
+     m_timings.solve = ElapsedMS(phaseStart);
+
+     //
+     // Update the positions
+     //
+     for (int i = 0; i < m_bodies.size(); i++)
+     {
+         m_bodies[i].Update(dt_sec);
+     }
+     m_timings.integrate = ElapsedMS(phaseStart);
  }
 
+ /*
+ ====================================================
+ Scene::RebaseOrigin
+
+ Large worlds lose float precision far from the origin, so the scene
+ keeps its origin in double and everything else within a sector of it.
+ While focus stays inside that sector this is only a few compares.
+ ====================================================
+ */
+ Vec3 Scene::RebaseOrigin(const Vec3 &focus)
+ {
+     const float halfSector = SECTOR_SIZE * 0.5f;
+     if (fabsf(focus.x) <= halfSector && fabsf(focus.y) <= halfSector && fabsf(focus.z) <= halfSector)
+     {
+         return Vec3(0.0f);
+     }
+
+     // Whole sectors only, every float that needs the precision subtracts exactly
+     Vec3 shift;
+     for (int i = 0; i < 3; i++)
+     {
+         shift[i] = floorf(focus[i] / SECTOR_SIZE + 0.5f) * SECTOR_SIZE;
+     }
+     const Vec3 offset = shift * -1.0f;
+
+     for (int i = 0; i < m_bodies.size(); i++)
+     {
+         m_bodies[i].m_position += offset;
+     }
+     m_manifolds.Translate(offset);
+     m_staticGeometry.Translate(offset);
+     m_origin += Vec3d(shift);
+
+     return offset;
+ }
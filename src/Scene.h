@@ -4,11 +4,28 @@
 #pragma once
 #include <vector>
 
+#include "Physics/Articulation.h"
 #include "Physics/Body.h"
+#include "Physics/CollisionMesh.h"
 #include "Physics/Constraints.h"
 #include "Physics/Manifold.h"
 #include "Physics/Shapes.h"
 
+/*
+====================================================
+sceneTimings_t
+
+Wall clock time of each phase of the last Scene::Update, in milliseconds
+====================================================
+*/
+ struct sceneTimings_t
+ {
+     float broadphase;
+     float narrowphase;
+     float solve;
+     float integrate;
+ };
+
 /*
 ====================================================
 Scene
@@ -17,14 +34,29 @@ Scene
  class Scene
  {
  public:
-     Scene() { m_bodies.reserve(128); }
+     Scene() : m_timings() { m_bodies.reserve(128); }
      ~Scene();
 
      void Reset();
      void Initialize();
      void Update(const float dt_sec);
 
+     // Moves the origin by whole sectors once focus leaves the sector around it,
+     // returns the offset that was added to everything stored relative to it
+     Vec3 RebaseOrigin(const Vec3 &focus);
+     Vec3d GetWorldPosition(const Vec3 &pos) const { return m_origin + pos; }
+     Vec3 GetLocalPosition(const Vec3d &pos) const { return (pos - m_origin).ToVec3(); }
+
+     // Power of two, so shifting by whole sectors is exact in float
+     static constexpr float SECTOR_SIZE = 1024.0f;
+
      std::vector<Body> m_bodies;
      std::vector<Constraint *> m_constraints;
+     std::vector<Articulation *> m_articulations; // joint trees solved directly, after the constraints
      ManifoldCollector m_manifolds;
+     CollisionMesh m_staticGeometry; // level geometry the characters walk on
+     sceneTimings_t m_timings;
+
+     // Bodies, contacts and the static geometry are all relative to this
+     Vec3d m_origin;
  };
@@ -10,8 +10,10 @@
 #include <vector>
 
 #include "Math/Quat.h"
+#include "Math/Transforms.h"
 #include "Math/Vector.h"
 #include "Physics/Body.h"
+#include "Physics/CharacterController.h"
 #include "Physics/Shapes.h"
 
 #include "RHI/DeviceContext.h"
@@ -19,6 +21,7 @@
 #include "RHI/model.h"
 #include "RHI/shader.h"
 
+#include "Loader/AssetStreamer.h"
 #include "Loader/Mesh.h"
 
 /*
@@ -49,6 +52,8 @@ private:
     void Cleanup();
 
     void UpdateUniforms();
+    void MoveLocalFrame(const Vec3 &offset);
+    void UpdateStreaming();
 
     void DrawFrame();
 
@@ -93,7 +98,10 @@ private:
     Model m_modelFullScreen;
     std::vector<Model *> m_models; // models for the bodies
 
-    std::vector<ElecNeko::Mesh *> m_meshes;
+    std::vector<ElecNeko::Mesh *> m_meshes; // only meshes that are ready to draw
+
+    ElecNeko::AssetStreamer m_assetStreamer;
+    std::vector<ElecNeko::assetHandle_t> m_pendingMeshes;
 
     //
     //	Pipeline for copying the offscreen framebuffer to the swapchain
@@ -112,7 +120,7 @@ private:
     bool m_stepFrame;
     bool m_isMouseDown = false;
 
-    Vec3 m_cameraPosition = Vec3(-.7f, -7, 3);
+    Vec3 m_cameraPosition = Vec3(-.7f, -7, 3); // relative to the scene origin, see Scene::RebaseOrigin
     float m_cameraYaw = -90.f;
     float m_cameraPitch = 0.f;
     Vec3 m_cameraFront = Vec3(0, 1, 0);
@@ -120,8 +128,21 @@ private:
     Vec3 m_cameraRight = Vec3(1, 0, 0);
     float m_cameraMoveSpeed = 5.0f;
     float m_mouseSensitivity = 0.1f;
+    float m_lodPixelsPerUnit = 1.0f; // from the projection, for the mesh levels of detail
+
+    // Walk mode (toggled with F) moves the camera with a character controller, fly mode ignores collision
+    CharacterController m_character;
+    bool m_isWalking = false;
+    float m_fallSpeed = 0.0f;
+    float m_eyeHeight = 0.7f; // above the center of the capsule
 
     std::vector<RenderModel> m_renderModels;
+    transformsSoA_t m_bodyTransforms;
+
+    // Physics debug overlays
+    bool m_drawContacts = false;
+    bool m_drawBounds = false;
+    bool m_drawConstraints = false;
 
     static const int WINDOW_WIDTH = 2560;
     static const int WINDOW_HEIGHT = 1440;
@@ -0,0 +1,26 @@
+#version 450
+
+/*
+==========================================
+input
+==========================================
+*/
+
+layout( location = 0 ) in vec4 fragColor;
+
+/*
+==========================================
+output
+==========================================
+*/
+
+layout( location = 0 ) out vec4 outColor;
+
+/*
+==========================================
+main
+==========================================
+*/
+void main() {
+    outColor = fragColor;
+}
\ No newline at end of file
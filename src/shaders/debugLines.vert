@@ -0,0 +1,46 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+/*
+==========================================
+uniforms
+==========================================
+*/
+
+layout( binding = 0 ) uniform uboCamera {
+    mat4 view;
+    mat4 proj;
+} camera;
+
+/*
+==========================================
+attributes
+==========================================
+*/
+
+layout( location = 0 ) in vec3 inPosition;
+layout( location = 1 ) in vec4 inColor;
+
+/*
+==========================================
+output
+==========================================
+*/
+
+layout( location = 0 ) out vec4 fragColor;
+
+out gl_PerVertex {
+    vec4 gl_Position;
+};
+
+/*
+==========================================
+main
+==========================================
+*/
+void main() {
+    fragColor = inColor;
+
+    // The lines are already in world space
+    gl_Position = camera.proj * camera.view * vec4( inPosition, 1.0 );
+}
\ No newline at end of file
@@ -18,10 +18,13 @@ layout(binding = 2) uniform uboShadow {
     mat4 view;
     mat4 proj;
 } shadow;
-layout(binding = 3) uniform uboHasTex {
+layout(binding = 3) uniform uboPart {
+    vec4 posScale;
+    vec4 posBias;
+    vec4 uvScaleBias;
     int hasAlbedoMap;
     int hasNormalMap;
-} hasTex;
+} part;
 
 /*
     ==========================================
@@ -29,9 +32,10 @@ attributes
     ==========================================
 */
 
-layout(location = 0) in vec3 inPosition;
+// VVertexPacked, unorm positions and uvs and an octahedral normal
+layout(location = 0) in vec4 inPosition;
 layout(location = 1) in vec2 inTexCoord;
-layout(location = 2) in vec3 inNormal;
+layout(location = 2) in vec2 inNormal;
 
 /*
     ==========================================
@@ -50,25 +54,39 @@ out gl_PerVertex {
     vec4 gl_Position;
 };
 
+/*
+    ==========================================
+DecodeOctahedral
+    ==========================================
+*/
+vec3 DecodeOctahedral(vec2 e) {
+    vec3 n = vec3(e.xy, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.x += (n.x >= 0.0) ? -t : t;
+    n.y += (n.y >= 0.0) ? -t : t;
+    return normalize(n);
+}
+
 /*
     ==========================================
 main
     ==========================================
 */
 void main() {
-    vec3 normal = 2.0 * (inNormal.xyz - vec3(0.5));
+    vec3 position = part.posBias.xyz + part.posScale.xyz * inPosition.xyz;
+    vec3 normal = DecodeOctahedral(inNormal);
     modelNormal = normal;
-    modelPos = vec4(inPosition, 1.0);
+    modelPos = vec4(position, 1.0);
 
     // Get the tangent space in world coordinates
     worldNormal = model.model * vec4(normal.xyz, 0.0);
 
     // Project coordinate to screen
-    gl_Position = camera.proj * camera.view * model.model * vec4(inPosition, 1.0);
+    gl_Position = camera.proj * camera.view * model.model * vec4(position, 1.0);
 
     // Project the world position into the shadow texture position
-    shadowPos = shadow.proj * shadow.view * model.model * vec4(inPosition, 1.0);
+    shadowPos = shadow.proj * shadow.view * model.model * vec4(position, 1.0);
 
-    texCoord=inTexCoord;
-    hasTexture=ivec2(hasTex.hasAlbedoMap, hasTex.hasNormalMap);
+    texCoord = part.uvScaleBias.zw + part.uvScaleBias.xy * inTexCoord;
+    hasTexture = ivec2(part.hasAlbedoMap, part.hasNormalMap);
 }
\ No newline at end of file
@@ -14,6 +14,13 @@ layout(binding = 0) uniform uboCamera {
 layout(binding = 1) uniform uboModel {
     mat4 model;
 } model;
+layout(binding = 2) uniform uboPart {
+    vec4 posScale;
+    vec4 posBias;
+    vec4 uvScaleBias;
+    int hasAlbedoMap;
+    int hasNormalMap;
+} part;
 
 /*
     ==========================================
@@ -21,9 +28,8 @@ attributes
     ==========================================
 */
 
-layout(location = 0) in vec3 inPosition;
-layout(location = 1) in vec2 inTexCoord;
-layout(location = 2) in vec3 inNormal;
+// VVertexPacked, only the position is needed
+layout(location = 0) in vec4 inPosition;
 
 out gl_PerVertex {
     vec4 gl_Position;
@@ -35,6 +41,8 @@ main
     ==========================================
 */
 void main() {
+    vec3 position = part.posBias.xyz + part.posScale.xyz * inPosition.xyz;
+
     // Project coordinate to screen
-    gl_Position = camera.proj * camera.view * model.model * vec4(inPosition, 1.0);
+    gl_Position = camera.proj * camera.view * model.model * vec4(position, 1.0);
 }
\ No newline at end of file